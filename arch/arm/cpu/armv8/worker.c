@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Worker pool for arm64, using PSCI to start and stop the secondary CPUs
+ *
+ * Each CPU is started with CPU_ON at worker_secondary_entry(), which switches
+ * on the boot CPU's page tables and calls worker_main(). Once the pool is
+ * parked, the CPU calls CPU_OFF so that it is in the state the OS expects.
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <cpu_func.h>
+#include <dm.h>
+#include <log.h>
+#include <malloc.h>
+#include <time.h>
+#include <worker.h>
+#include <asm/cache.h>
+#include <asm/global_data.h>
+#include <asm/system.h>
+#include <asm/armv8/worker.h>
+#include <linux/psci.h>
+#include <linux/sizes.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Affinity fields of MPIDR_EL1, as used in the devicetree and by PSCI */
+#define MPIDR_HWID_MASK		0xff00ffffffULL
+
+enum {
+	WORKER_STACK_SIZE	= SZ_16K,
+
+	/* ms to wait for a CPU to turn off */
+	WORKER_OFF_TIMEOUT_MS	= 100,
+};
+
+/**
+ * struct arm_worker - A secondary CPU started to run workers
+ *
+ * This is cache-line aligned so that it can be flushed on its own
+ *
+ * @boot: State used by worker_secondary_entry()
+ * @mpidr: Affinity of the CPU
+ * @stack: Stack allocated for the CPU
+ */
+struct arm_worker {
+	struct worker_boot boot;
+	u64 mpidr;
+	void *stack;
+} __aligned(ARCH_DMA_MINALIGN);
+
+static struct arm_worker *workers;
+static int num_workers;
+
+void worker_secondary_main(void)
+{
+	worker_main();
+	invoke_psci_fn(PSCI_0_2_FN_CPU_OFF, 0, 0, 0);
+}
+
+/**
+ * worker_get_boot() - Get the state of the boot CPU, for the workers to copy
+ *
+ * @boot: Returns the state, except for the stack pointer
+ */
+static void worker_get_boot(struct worker_boot *boot)
+{
+	if (current_el() == 2) {
+		asm volatile("mrs %0, ttbr0_el2" : "=r" (boot->ttbr));
+		asm volatile("mrs %0, tcr_el2" : "=r" (boot->tcr));
+		asm volatile("mrs %0, mair_el2" : "=r" (boot->mair));
+		asm volatile("mrs %0, vbar_el2" : "=r" (boot->vbar));
+		asm volatile("mrs %0, cptr_el2" : "=r" (boot->cptr));
+	} else {
+		asm volatile("mrs %0, ttbr0_el1" : "=r" (boot->ttbr));
+		asm volatile("mrs %0, tcr_el1" : "=r" (boot->tcr));
+		asm volatile("mrs %0, mair_el1" : "=r" (boot->mair));
+		asm volatile("mrs %0, vbar_el1" : "=r" (boot->vbar));
+		asm volatile("mrs %0, cpacr_el1" : "=r" (boot->cptr));
+	}
+	boot->sctlr = get_sctlr();
+	boot->gd_ptr = (ulong)gd;
+}
+
+/**
+ * worker_cpu_on() - Start a secondary CPU
+ *
+ * @worker: Worker to set up
+ * @mpidr: Affinity of the CPU
+ * @boot: State of the boot CPU
+ * Return: 0 if OK, -ve on error
+ */
+static int worker_cpu_on(struct arm_worker *worker, u64 mpidr,
+			 const struct worker_boot *boot)
+{
+	long ret;
+
+	BUILD_BUG_ON(offsetof(struct worker_boot, ttbr) != WORKER_BOOT_TTBR);
+	BUILD_BUG_ON(offsetof(struct worker_boot, sctlr) != WORKER_BOOT_SCTLR);
+
+	worker->stack = malloc(WORKER_STACK_SIZE);
+	if (!worker->stack)
+		return -ENOMEM;
+	worker->boot = *boot;
+	worker->boot.sp = ALIGN_DOWN((ulong)worker->stack + WORKER_STACK_SIZE,
+				     16);
+	worker->mpidr = mpidr;
+
+	/* the CPU reads this with the MMU off */
+	flush_dcache_range((ulong)worker, (ulong)(worker + 1));
+
+	ret = invoke_psci_fn(PSCI_0_2_FN64_CPU_ON, mpidr,
+			     (ulong)worker_secondary_entry,
+			     (ulong)&worker->boot);
+	if (ret != PSCI_RET_SUCCESS) {
+		log_debug("CPU %llx did not start (err=%ld)\n", mpidr, ret);
+		free(worker->stack);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+int arch_worker_start(void)
+{
+	struct worker_boot boot;
+	struct udevice *dev;
+	ofnode cpus, node;
+	int max, cells;
+	u64 self;
+
+	/* PSCI is handled by the secure firmware, which runs at EL3 */
+	if (current_el() == 3)
+		return 0;
+	if (uclass_get_device_by_name(UCLASS_FIRMWARE, "psci", &dev))
+		return 0;
+
+	cpus = ofnode_path("/cpus");
+	if (!ofnode_valid(cpus))
+		return 0;
+	max = ofnode_get_child_count(cpus);
+	if (!max)
+		return 0;
+	workers = memalign(ARCH_DMA_MINALIGN, max * sizeof(*workers));
+	if (!workers)
+		return -ENOMEM;
+
+	/* code run with the MMU off must be in memory, not just in the cache */
+	flush_dcache_range(ALIGN_DOWN((ulong)worker_secondary_entry,
+				      ARCH_DMA_MINALIGN),
+			   ALIGN((ulong)worker_secondary_entry_end,
+				 ARCH_DMA_MINALIGN));
+
+	worker_get_boot(&boot);
+	cells = ofnode_read_simple_addr_cells(cpus);
+	self = read_mpidr() & MPIDR_HWID_MASK;
+	ofnode_for_each_subnode(node, cpus) {
+		const char *method;
+		u64 mpidr;
+		u32 val;
+
+		if (!ofnode_is_enabled(node))
+			continue;
+		method = ofnode_read_string(node, "enable-method");
+		if (!method || strcmp(method, "psci"))
+			continue;
+		if (cells == 2) {
+			if (ofnode_read_u64(node, "reg", &mpidr))
+				continue;
+		} else {
+			if (ofnode_read_u32(node, "reg", &val))
+				continue;
+			mpidr = val;
+		}
+		if ((mpidr & MPIDR_HWID_MASK) == self)
+			continue;
+
+		if (!worker_cpu_on(&workers[num_workers], mpidr, &boot))
+			num_workers++;
+	}
+	if (!num_workers) {
+		free(workers);
+		workers = NULL;
+	}
+
+	return num_workers;
+}
+
+void arch_worker_park(void)
+{
+	while (num_workers) {
+		struct arm_worker *worker = &workers[--num_workers];
+		ulong start = get_timer(0);
+		bool off = true;
+
+		/* Linux cannot start the CPU until it is fully off */
+		while (invoke_psci_fn(PSCI_0_2_FN64_AFFINITY_INFO,
+				      worker->mpidr, 0, 0) !=
+		       PSCI_0_2_AFFINITY_LEVEL_OFF) {
+			if (get_timer(start) > WORKER_OFF_TIMEOUT_MS) {
+				log_err("CPU %llx did not turn off\n",
+					worker->mpidr);
+				off = false;
+				break;
+			}
+		}
+
+		/* a CPU which is still running may be using its stack */
+		if (off)
+			free(worker->stack);
+	}
+	free(workers);
+	workers = NULL;
+}
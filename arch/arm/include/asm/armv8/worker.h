@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * State passed to a secondary CPU started to run U-Boot workers
+ */
+
+#ifndef __ASM_ARMV8_WORKER_H
+#define __ASM_ARMV8_WORKER_H
+
+/* Offsets into struct worker_boot, for worker_secondary_entry */
+#define WORKER_BOOT_SP		0x00
+#define WORKER_BOOT_GD		0x08
+#define WORKER_BOOT_TTBR	0x10
+#define WORKER_BOOT_TCR		0x18
+#define WORKER_BOOT_MAIR	0x20
+#define WORKER_BOOT_VBAR	0x28
+#define WORKER_BOOT_CPTR	0x30
+#define WORKER_BOOT_SCTLR	0x38
+
+#ifndef __ASSEMBLY__
+
+/**
+ * struct worker_boot - State needed by a secondary CPU to run U-Boot code
+ *
+ * The system registers are copied from the boot CPU, at the exception level
+ * U-Boot runs at, so that the secondary CPU shares its page tables and
+ * exception vectors. This is read with the MMU off, so must be flushed to
+ * memory before the CPU is started.
+ *
+ * @sp: Top of the stack for the CPU
+ * @gd_ptr: Global data pointer
+ * @ttbr: Translation table base (TTBR0_ELx)
+ * @tcr: Translation control (TCR_ELx)
+ * @mair: Memory attributes (MAIR_ELx)
+ * @vbar: Exception vectors (VBAR_ELx)
+ * @cptr: FP / SIMD access control (CPTR_EL2 or CPACR_EL1)
+ * @sctlr: System control, enabling the MMU and caches (SCTLR_ELx)
+ */
+struct worker_boot {
+	u64 sp;
+	u64 gd_ptr;
+	u64 ttbr;
+	u64 tcr;
+	u64 mair;
+	u64 vbar;
+	u64 cptr;
+	u64 sctlr;
+};
+
+/**
+ * worker_secondary_entry() - Entry point for a secondary CPU
+ *
+ * This is passed to PSCI CPU_ON, with the address of the CPU's
+ * struct worker_boot as the context ID. It sets up the CPU to match the boot
+ * CPU and calls worker_main(), then turns the CPU off again.
+ */
+void worker_secondary_entry(void);
+
+/* End of the code of worker_secondary_entry(), which runs with the MMU off */
+extern char worker_secondary_entry_end[];
+
+/**
+ * worker_secondary_main() - Run workers on a secondary CPU, then turn it off
+ *
+ * This is called by worker_secondary_entry() once the MMU is on
+ */
+void worker_secondary_main(void);
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* __ASM_ARMV8_WORKER_H */
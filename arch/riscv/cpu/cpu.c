@@ -33,6 +33,9 @@ u32 available_harts_lock = 1;
 #endif
 #endif
 
+/* This is set before relocation, so must not be in bss */
+int riscv_vector __section(".data");
+
 static inline bool supports_extension(char ext)
 {
 #if CONFIG_IS_ENABLED(RISCV_MMODE)
@@ -68,7 +71,7 @@ static inline bool supports_extension(char ext)
 	/*
 	 * Skip the first 4 characters (rv32|rv64).
 	 */
-	for (i = 4; i < sizeof(isa); i++) {
+	for (i = 4; i < strlen(isa); i++) {
 		switch (isa[i]) {
 		case 's':
 		case 'x':
@@ -94,6 +97,17 @@ static inline bool supports_extension(char ext)
 #endif /* CONFIG_CPU */
 }
 
+void riscv_vector_enable(void)
+{
+	if (!riscv_vector)
+		return;
+	csr_set(MODE_PREFIX(status), SR_VS_INITIAL);
+
+	/* the field stays at zero if the vector unit cannot be used */
+	if (!(csr_read(MODE_PREFIX(status)) & SR_VS))
+		riscv_vector = 0;
+}
+
 static int riscv_cpu_probe(void)
 {
 #ifdef CONFIG_CPU
@@ -130,6 +144,12 @@ int riscv_cpu_setup(void)
 		csr_write(CSR_FCSR, 0);
 	}
 
+	/* Let the memory routines use the vector unit */
+	if (CONFIG_IS_ENABLED(RISCV_ISA_V)) {
+		riscv_vector = supports_extension('v');
+		riscv_vector_enable();
+	}
+
 	if (CONFIG_IS_ENABLED(RISCV_MMODE)) {
 		/*
 		 * Enable perf counters for cycle, time,
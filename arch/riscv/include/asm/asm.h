@@ -65,4 +65,25 @@
 #error "Unexpected __SIZEOF_SHORT__"
 #endif
 
+#ifdef __ASSEMBLY__
+/* Smallest size for which the memory routines use the vector unit */
+#define RVV_MIN_SIZE		64
+
+/*
+ * Jump to the vector version of a memory routine, if the vector unit is
+ * enabled and the size in a2 is large enough. Clobbers a3.
+ */
+.macro rvv_dispatch func
+#if CONFIG_IS_ENABLED(RISCV_ISA_V)
+	li	a3, RVV_MIN_SIZE
+	bltu	a2, a3, .Lno_rvv\@
+	la	a3, riscv_vector
+	lw	a3, 0(a3)
+	beqz	a3, .Lno_rvv\@
+	tail	\func
+.Lno_rvv\@:
+#endif
+.endm
+#endif
+
 #endif /* _ASM_RISCV_ASM_H */
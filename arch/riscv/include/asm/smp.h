@@ -60,6 +60,13 @@ void handle_ipi(ulong hart);
  */
 int smp_call_function(ulong addr, ulong arg0, ulong arg1, int wait);
 
+/**
+ * smp_count_harts() - Count the harts which smp_call_function() calls
+ *
+ * Return: number of other available harts, or -ve on error
+ */
+int smp_count_harts(void);
+
 /**
  * riscv_init_ipi() - Initialize inter-process interrupt (IPI) driver
  *
@@ -40,6 +40,12 @@ extern void *memmove(void *, const void *, __kernel_size_t);
 #endif
 extern void *memset(void *, int, __kernel_size_t);
 
+#undef __HAVE_ARCH_MEMCMP
+#if CONFIG_IS_ENABLED(RISCV_ISA_V)
+#define __HAVE_ARCH_MEMCMP
+#endif
+extern int memcmp(const void *, const void *, __kernel_size_t);
+
 #undef __HAVE_ARCH_STRLEN
 #if CONFIG_IS_ENABLED(USE_ARCH_STRLEN)
 #define __HAVE_ARCH_STRLEN
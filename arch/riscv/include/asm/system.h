@@ -28,4 +28,13 @@ struct event;
 /* Hook to set up the CPU (called from SPL too) */
 int riscv_cpu_setup(void);
 
+/*
+ * Non-zero once the vector unit is enabled on the boot hart, so that the
+ * memory routines can use it. Only set if CONFIG_RISCV_ISA_V is enabled.
+ */
+extern int riscv_vector;
+
+/* Enable the vector unit on the current hart, if riscv_vector is set */
+void riscv_vector_enable(void);
+
 #endif	/* __ASM_RISCV_SYSTEM_H */
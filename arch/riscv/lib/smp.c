@@ -13,6 +13,49 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/**
+ * smp_get_hart() - Check whether a CPU node is a hart which can be sent IPIs
+ *
+ * @node: CPU node
+ * @hartp: Returns the hart ID
+ * Return: true if the hart is available and is not the one we are running on
+ */
+static bool smp_get_hart(ofnode node, u32 *hartp)
+{
+	u32 reg;
+	int ret;
+
+	/* skip if hart is marked as not available in the device tree */
+	if (!ofnode_is_enabled(node))
+		return false;
+
+	/* read hart ID of CPU */
+	ret = ofnode_read_u32(node, "reg", &reg);
+	if (ret)
+		return false;
+
+	/* skip if it is the hart we are running on */
+	if (reg == gd->arch.boot_hart)
+		return false;
+
+	if (reg >= CONFIG_NR_CPUS) {
+		pr_err("Hart ID %d is out of range, increase CONFIG_NR_CPUS\n",
+		       reg);
+		return false;
+	}
+
+#if !CONFIG_IS_ENABLED(XIP)
+#ifdef CONFIG_AVAILABLE_HARTS
+	/* skip if hart is not available */
+	if (!(gd->arch.available_harts & (1 << reg)))
+		return false;
+#endif
+#endif
+	*hartp = reg;
+
+	return true;
+}
+
 static int send_ipi_many(struct ipi_data *ipi, int wait)
 {
 	ofnode node, cpus;
@@ -26,33 +69,9 @@ static int send_ipi_many(struct ipi_data *ipi, int wait)
 	}
 
 	ofnode_for_each_subnode(node, cpus) {
-		/* skip if hart is marked as not available in the device tree */
-		if (!ofnode_is_enabled(node))
-			continue;
-
-		/* read hart ID of CPU */
-		ret = ofnode_read_u32(node, "reg", &reg);
-		if (ret)
-			continue;
-
-		/* skip if it is the hart we are running on */
-		if (reg == gd->arch.boot_hart)
+		if (!smp_get_hart(node, &reg))
 			continue;
 
-		if (reg >= CONFIG_NR_CPUS) {
-			pr_err("Hart ID %d is out of range, increase CONFIG_NR_CPUS\n",
-			       reg);
-			continue;
-		}
-
-#if !CONFIG_IS_ENABLED(XIP)
-#ifdef CONFIG_AVAILABLE_HARTS
-		/* skip if hart is not available */
-		if (!(gd->arch.available_harts & (1 << reg)))
-			continue;
-#endif
-#endif
-
 		gd->arch.ipi[reg].addr = ipi->addr;
 		gd->arch.ipi[reg].arg0 = ipi->arg0;
 		gd->arch.ipi[reg].arg1 = ipi->arg1;
@@ -126,3 +145,21 @@ int smp_call_function(ulong addr, ulong arg0, ulong arg1, int wait)
 
 	return send_ipi_many(&ipi, wait);
 }
+
+int smp_count_harts(void)
+{
+	ofnode node, cpus;
+	int count = 0;
+	u32 reg;
+
+	cpus = ofnode_path("/cpus");
+	if (!ofnode_valid(cpus))
+		return -EINVAL;
+
+	ofnode_for_each_subnode(node, cpus) {
+		if (smp_get_hart(node, &reg))
+			count++;
+	}
+
+	return count;
+}
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Worker pool for RISC-V
+ *
+ * The other harts wait in secondary_hart_loop for an IPI. They are sent one
+ * which calls worker_main() and when that returns they go back to waiting,
+ * ready for the OS to send them its own IPI.
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <log.h>
+#include <worker.h>
+#include <asm/smp.h>
+#include <asm/system.h>
+
+static void riscv_worker(ulong hart, ulong arg0, ulong arg1)
+{
+	/* jobs use the memory routines, which may use the vector unit */
+	if (CONFIG_IS_ENABLED(RISCV_ISA_V))
+		riscv_vector_enable();
+	worker_main();
+}
+
+int arch_worker_start(void)
+{
+	int count, ret;
+
+	count = smp_count_harts();
+	if (count <= 0)
+		return count;
+
+	ret = smp_call_function((ulong)riscv_worker, 0, 0, 1);
+	if (ret)
+		return log_msg_ret("ipi", ret);
+
+	return count;
+}
@@ -7,6 +7,7 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <execinfo.h>
 #include <fcntl.h>
 #include <pthread.h>
 #include <getopt.h>
@@ -387,24 +388,36 @@ static void os_sigint_handler(int sig)
 	raise(SIGINT);
 }
 
-static void os_signal_handler(int sig, siginfo_t *info, void *con)
+/**
+ * os_context_pc() - get the interrupted program counter from a signal context
+ *
+ * @context:	signal context
+ * Return:	program counter, or 0 if not supported on this architecture
+ */
+static unsigned long os_context_pc(ucontext_t __maybe_unused *context)
 {
-	ucontext_t __maybe_unused *context = con;
-	unsigned long pc;
-
 #if defined(__x86_64__)
-	pc = context->uc_mcontext.gregs[REG_RIP];
+	return context->uc_mcontext.gregs[REG_RIP];
 #elif defined(__aarch64__)
-	pc = context->uc_mcontext.pc;
+	return context->uc_mcontext.pc;
 #elif defined(__riscv)
-	pc = context->uc_mcontext.__gregs[REG_PC];
+	return context->uc_mcontext.__gregs[REG_PC];
 #else
-	const char msg[] =
-		"\nUnsupported architecture, cannot read program counter\n";
-
-	os_write(1, msg, sizeof(msg));
-	pc = 0;
+	return 0;
 #endif
+}
+
+static void os_signal_handler(int sig, siginfo_t *info, void *con)
+{
+	unsigned long pc;
+
+	pc = os_context_pc(con);
+	if (!pc) {
+		const char msg[] =
+			"\nUnsupported architecture, cannot read program counter\n";
+
+		os_write(1, msg, sizeof(msg));
+	}
 
 	os_signal_action(sig, pc);
 }
@@ -423,6 +436,86 @@ int os_setup_signal_handlers(void)
 	return 0;
 }
 
+/* Maximum number of frames to unwind for each profiling sample */
+#define OS_PROFILE_MAX_FRAMES	32
+
+static void os_profile_handler(int sig, siginfo_t *info, void *con)
+{
+	void *frames[OS_PROFILE_MAX_FRAMES];
+	unsigned long pcs[OS_PROFILE_MAX_FRAMES];
+	unsigned long pc;
+	int count, i, n;
+
+	if (!IS_ENABLED(CONFIG_TRACE_SAMPLE))
+		return;
+	pc = os_context_pc(con);
+	if (!pc)
+		return;
+
+	/*
+	 * The first few frames are this handler and the signal trampoline.
+	 * Skip those by looking for the interrupted program counter. If it
+	 * is not found, the unwinder could not cross the signal frame, so just
+	 * record the program counter on its own.
+	 */
+	count = backtrace(frames, OS_PROFILE_MAX_FRAMES);
+	for (i = 0; i < count; i++) {
+		if ((unsigned long)frames[i] == pc)
+			break;
+	}
+	if (i == count) {
+		pcs[0] = pc;
+		n = 1;
+	} else {
+		for (n = 0; i < count; i++)
+			pcs[n++] = (unsigned long)frames[i];
+	}
+
+	os_profile_action(pcs, n);
+}
+
+int os_profile_start(unsigned int hz)
+{
+	struct itimerval timer;
+	struct sigaction act;
+	void *frame;
+
+	if (!IS_ENABLED(CONFIG_TRACE_SAMPLE))
+		return -ENOSYS;
+	if (!hz)
+		return -EINVAL;
+
+	/*
+	 * backtrace() loads the unwinder on first use, which is not safe from
+	 * a signal handler, so make sure that has happened already
+	 */
+	backtrace(&frame, 1);
+
+	memset(&act, '\0', sizeof(act));
+	act.sa_sigaction = os_profile_handler;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	if (sigaction(SIGPROF, &act, NULL))
+		return -errno;
+
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = 1000000 / hz;
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, NULL))
+		return -errno;
+
+	return 0;
+}
+
+void os_profile_stop(void)
+{
+	struct itimerval timer;
+
+	memset(&timer, '\0', sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+	signal(SIGPROF, SIG_IGN);
+}
+
 /* Put tty into raw mode so <tab> and <ctrl+c> work */
 void os_tty_raw(int fd, bool allow_sigs)
 {
@@ -540,6 +633,25 @@ void os_usleep(unsigned long usec)
 	usleep(usec);
 }
 
+int os_thread_start(void *(*func)(void *arg), void *arg,
+		    unsigned long *threadp)
+{
+	pthread_t thread;
+	int ret;
+
+	ret = pthread_create(&thread, NULL, func, arg);
+	if (ret)
+		return -ret;
+	*threadp = (unsigned long)thread;
+
+	return 0;
+}
+
+int os_thread_join(unsigned long thread)
+{
+	return -pthread_join((pthread_t)thread, NULL);
+}
+
 uint64_t __attribute__((no_instrument_function)) os_get_nsec(void)
 {
 #if defined(CLOCK_MONOTONIC) && defined(_POSIX_MONOTONIC_CLOCK)
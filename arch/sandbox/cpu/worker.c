@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Worker pool for sandbox, using host threads in place of secondary CPUs
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <log.h>
+#include <os.h>
+#include <worker.h>
+
+enum {
+	/* behave like a quad-core SoC */
+	SANDBOX_WORKERS		= 3,
+
+	/* us to sleep when idle, so that idle workers don't use host CPU */
+	SANDBOX_WORKER_IDLE_US	= 20,
+};
+
+static unsigned long threads[SANDBOX_WORKERS];
+static int num_threads;
+
+static void *sandbox_worker(void *arg)
+{
+	worker_main();
+
+	return NULL;
+}
+
+int arch_worker_start(void)
+{
+	int ret;
+
+	for (num_threads = 0; num_threads < SANDBOX_WORKERS; num_threads++) {
+		ret = os_thread_start(sandbox_worker, NULL,
+				      &threads[num_threads]);
+		if (ret) {
+			log_debug("Cannot start thread (err=%dE)\n", ret);
+			break;
+		}
+	}
+
+	return num_threads;
+}
+
+void arch_worker_park(void)
+{
+	while (num_threads)
+		os_thread_join(threads[--num_threads]);
+}
+
+void arch_worker_idle(void)
+{
+	os_usleep(SANDBOX_WORKER_IDLE_US);
+}
@@ -0,0 +1,14 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Copyright 2026 Google LLC
+ */
+
+#ifndef __ASM_SANDBOX_ATOMIC_H
+#define __ASM_SANDBOX_ATOMIC_H
+
+/* sandbox is single-threaded, so the generic version is enough */
+
+#include <asm/system.h>
+#include <asm-generic/atomic.h>
+
+#endif
@@ -38,6 +38,15 @@ size_t sandbox_serial_written(void);
  */
 void sandbox_serial_endisable(bool enabled);
 
+/**
+ * sandbox_serial_set_tx_space() - Set the space in the emulated TX FIFO
+ * @space: Number of characters putc() accepts before returning -EAGAIN, or
+ *	-1 for no limit (the default)
+ *
+ * This allows tests to emulate a UART which is busy sending characters.
+ */
+void sandbox_serial_set_tx_space(int space);
+
 /**
  * struct sandbox_serial_priv - Private data for this driver
  *
@@ -7,10 +7,10 @@
 #define __ASM_SANDBOX_SYSTEM_H
 
 /* Define this as nops for sandbox architecture */
-#define local_irq_save(x)
+#define local_irq_save(x)	((void)(x))
 #define local_irq_enable()
 #define local_irq_disable()
-#define local_save_flags(x)
-#define local_irq_restore(x)
+#define local_save_flags(x)	((void)(x))
+#define local_irq_restore(x)	((void)(x))
 
 #endif
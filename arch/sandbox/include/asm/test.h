@@ -10,6 +10,7 @@
 
 #include <pci_ids.h>
 
+struct cqhci_host;
 struct unit_test_state;
 struct mouse_event;
 
@@ -386,4 +387,54 @@ void sandbox_mouse_inject(struct udevice *dev, struct mouse_event *event);
  */
 bool sandbox_mouse_get_ptr_visible(struct udevice *dev);
 
+/**
+ * sandbox_dma_set_fail() - Make memory-to-memory transfers fail
+ *
+ * Transfers then report -EIO, without copying anything
+ *
+ * @dev: DMA device
+ * @fail: true to make transfers fail, false to make them succeed
+ */
+void sandbox_dma_set_fail(struct udevice *dev, bool fail);
+
+/**
+ * sandbox_dma_get_copied() - Get the number of bytes copied by a DMA device
+ *
+ * @dev: DMA device
+ * Return: total number of bytes copied by memory-to-memory transfers
+ */
+ulong sandbox_dma_get_copied(struct udevice *dev);
+
+/**
+ * sandbox_mmc_get_cqe() - Get the command queue engine of an MMC device
+ *
+ * @dev: MMC device
+ * Return: engine, or NULL if the device does not have "supports-cqe"
+ */
+struct cqhci_host *sandbox_mmc_get_cqe(struct udevice *dev);
+
+/**
+ * sandbox_mmc_get_cqe_queued() - Get the most tasks queued on the engine
+ *
+ * @dev: MMC device
+ * Return: largest number of tasks which the engine has had queued at once
+ */
+uint sandbox_mmc_get_cqe_queued(struct udevice *dev);
+
+/**
+ * sandbox_mmc_get_cmdq_en() - Check if command queueing is enabled on a card
+ *
+ * @dev: MMC device
+ * Return: true if the card is in command-queue mode
+ */
+bool sandbox_mmc_get_cmdq_en(struct udevice *dev);
+
+/**
+ * sandbox_flash_get_max_blocks() - Get the largest transfer to a flash stick
+ *
+ * @dev: USB flash-stick emulator
+ * Return: largest number of blocks read or written by a single command
+ */
+int sandbox_flash_get_max_blocks(struct udevice *dev);
+
 #endif
@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler support for sandbox, using SIGPROF
+ */
+
+#include <os.h>
+#include <trace.h>
+
+int notrace arch_trace_sample_start(uint hz)
+{
+	return os_profile_start(hz);
+}
+
+void notrace arch_trace_sample_stop(void)
+{
+	os_profile_stop();
+}
+
+void notrace os_profile_action(const unsigned long *pcs, int count)
+{
+	trace_add_sample(pcs, count);
+}
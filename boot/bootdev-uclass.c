@@ -732,6 +732,13 @@ int bootdev_setup_iter(struct bootflow_iter *iter, const char *label,
 
 	/* hunt for any pre-scan devices */
 	if (iter->flags & BOOTFLOWIF_HUNT) {
+		/* get slow hardware going while the fast bootdevs are scanned */
+		if (IS_ENABLED(CONFIG_BOOTDEV_HUNT_START) && !label) {
+			ret = bootdev_hunt_start(show);
+			if (ret)
+				log_warning("Failed to start hunters (err=%dE)\n",
+					    ret);
+		}
 		ret = bootdev_hunt_prio(BOOTDEVP_1_PRE_SCAN, show);
 		log_debug("- bootdev_hunt_prio() ret %d\n", ret);
 		if (ret)
@@ -906,6 +913,38 @@ int bootdev_hunt_prio(enum bootdev_prio_t prio, bool show)
 	return result;
 }
 
+int bootdev_hunt_start(bool show)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+	int result;
+
+	result = bootstd_get_priv(&std);
+	if (result)
+		return log_msg_ret("std", result);
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (i = 0; i < n_ent; i++) {
+		struct bootdev_hunter *info = start + i;
+		int ret;
+
+		if (!info->start || (std->hunters_used & BIT(i)))
+			continue;
+		if (show)
+			printf("Starting hunter: %s\n",
+			       uclass_get_name(info->uclass));
+		ret = info->start(info, show);
+		log_debug("start %s: ret %d\n", uclass_get_name(info->uclass),
+			  ret);
+		if (ret && ret != -ENOENT)
+			result = ret;
+	}
+
+	return result;
+}
+
 void bootdev_list_hunters(struct bootstd_priv *std)
 {
 	struct bootdev_hunter *orig, *start;
@@ -36,7 +36,6 @@
 
 #include <bootm.h>
 #include <image.h>
-#include <u-boot/zlib.h>
 
 #define MAX_CMDLINE_SIZE	SZ_4K
 
@@ -721,8 +720,7 @@ static int handle_decomp_error(int comp_type, size_t uncomp_size,
 	if (ret == -ENOSYS)
 		return BOOTM_ERR_UNIMPLEMENTED;
 
-	if ((comp_type == IH_COMP_GZIP && ret == Z_BUF_ERROR) ||
-	    uncomp_size >= buf_size)
+	if (ret == -ENOSPC || uncomp_size >= buf_size)
 		printf("Image too large: increase CONFIG_SYS_BOOTM_LEN\n");
 	else
 		printf("%s: uncompress error %d\n", name, ret);
@@ -852,6 +850,8 @@ static int bootm_load_os(struct bootm_info *bmi, int boot_progress)
 			       load, relocated_addr,
 			       relocated_addr + image_size);
 			memmove((void *)relocated_addr, load_buf, image_size);
+			bootstage_count(BOOTSTAGE_ID_COUNT_COPY, "copy_bytes",
+					image_size);
 		}
 
 		images->ep = relocated_addr;
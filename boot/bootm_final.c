@@ -38,6 +38,9 @@ void bootm_final(enum bootm_final_t flags)
 
 	board_quiesce_devices();
 
+	/* Make sure any buffered console output reaches the UART */
+	flush();
+
 	if (IS_ENABLED(CONFIG_USB_DEVICE))
 		udc_disconnect();
 
@@ -0,0 +1,639 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Applying batches of devicetree overlays using an index of the base tree
+ *
+ * fdt_overlay_apply() finds the base-tree nodes it needs by scanning: each
+ * phandle-based fragment target needs a walk of the whole tree, and each
+ * label is looked up among all the /__symbols__ properties. When applying a
+ * batch of overlays this is repeated for every one of them.
+ *
+ * Here the base tree is scanned once to record its phandles (with the path of
+ * each node) and the phandle of each label. Each overlay is copied, its
+ * references and targets are resolved from the index, and the copy is passed
+ * to fdt_overlay_apply(). Whatever the overlay adds to the tree is then added
+ * to the index. Paths and phandles are used rather than offsets, since
+ * offsets change as the tree grows.
+ */
+
+#include <fdt_support.h>
+#include <malloc.h>
+#include <sort.h>
+#include <vsprintf.h>
+#include <linux/libfdt.h>
+#include <linux/sizes.h>
+
+/* Maximum length of a node path, including the terminator */
+#define FDT_INDEX_PATH_MAX	512
+
+/* Maximum depth of nodes to index, below the starting node */
+#define FDT_INDEX_MAX_DEPTH	32
+
+static int index_phandle_cmp(const void *a, const void *b)
+{
+	const struct fdt_index_phandle *pa = a, *pb = b;
+
+	if (pa->phandle == pb->phandle)
+		return 0;
+
+	return pa->phandle < pb->phandle ? -1 : 1;
+}
+
+static int index_label_cmp(const void *a, const void *b)
+{
+	const struct fdt_index_label *la = a, *lb = b;
+
+	return strcmp(la->label, lb->label);
+}
+
+/*
+ * index_find_phandle() - Find a phandle, or where it should be inserted
+ *
+ * Return: position of the phandle; *foundp is set to true if it is present
+ */
+static int index_find_phandle(const struct fdt_overlay_index *idx,
+			      u32 phandle, bool *foundp)
+{
+	int lo = 0, hi = idx->phandle_count;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		u32 val = idx->phandles[mid].phandle;
+
+		if (val == phandle) {
+			*foundp = true;
+			return mid;
+		}
+		if (val < phandle)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*foundp = false;
+
+	return lo;
+}
+
+static int index_find_label(const struct fdt_overlay_index *idx,
+			    const char *label, bool *foundp)
+{
+	int lo = 0, hi = idx->label_count;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		int cmp = strcmp(idx->labels[mid].label, label);
+
+		if (!cmp) {
+			*foundp = true;
+			return mid;
+		}
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*foundp = false;
+
+	return lo;
+}
+
+/* index_grow() - Make room for another entry in an index array */
+static int index_grow(void **arrayp, int count, int *sizep, size_t ent_size)
+{
+	void *ptr;
+	int size;
+
+	if (count < *sizep)
+		return 0;
+	size = *sizep ? *sizep * 2 : 64;
+	ptr = realloc(*arrayp, size * ent_size);
+	if (!ptr)
+		return -FDT_ERR_NOSPACE;
+	*arrayp = ptr;
+	*sizep = size;
+
+	return 0;
+}
+
+/*
+ * index_set_phandle() - Record the path of a phandle
+ *
+ * If @sorted is false the entry is appended, and the caller must sort the
+ * array afterwards
+ */
+static int index_set_phandle(struct fdt_overlay_index *idx, u32 phandle,
+			     const char *path, bool sorted)
+{
+	struct fdt_index_phandle *ent;
+	bool found = false;
+	char *dup;
+	int pos, ret;
+
+	pos = idx->phandle_count;
+	if (sorted)
+		pos = index_find_phandle(idx, phandle, &found);
+	dup = strdup(path);
+	if (!dup)
+		return -FDT_ERR_NOSPACE;
+	if (found) {
+		free(idx->phandles[pos].path);
+		idx->phandles[pos].path = dup;
+		return 0;
+	}
+
+	ret = index_grow((void **)&idx->phandles, idx->phandle_count,
+			 &idx->phandle_size, sizeof(*ent));
+	if (ret) {
+		free(dup);
+		return ret;
+	}
+	ent = &idx->phandles[pos];
+	memmove(ent + 1, ent, (idx->phandle_count - pos) * sizeof(*ent));
+	ent->phandle = phandle;
+	ent->path = dup;
+	idx->phandle_count++;
+
+	return 0;
+}
+
+/* index_set_label() - Record the phandle of a label, as index_set_phandle() */
+static int index_set_label(struct fdt_overlay_index *idx, const char *label,
+			   u32 phandle, bool sorted)
+{
+	struct fdt_index_label *ent;
+	bool found = false;
+	char *dup;
+	int pos, ret;
+
+	pos = idx->label_count;
+	if (sorted)
+		pos = index_find_label(idx, label, &found);
+	if (found) {
+		idx->labels[pos].phandle = phandle;
+		return 0;
+	}
+
+	dup = strdup(label);
+	if (!dup)
+		return -FDT_ERR_NOSPACE;
+	ret = index_grow((void **)&idx->labels, idx->label_count,
+			 &idx->label_size, sizeof(*ent));
+	if (ret) {
+		free(dup);
+		return ret;
+	}
+	ent = &idx->labels[pos];
+	memmove(ent + 1, ent, (idx->label_count - pos) * sizeof(*ent));
+	ent->label = dup;
+	ent->phandle = phandle;
+	idx->label_count++;
+
+	return 0;
+}
+
+/*
+ * index_add_nodes() - Record the phandles of a node and its subnodes
+ *
+ * @idx: Index to update
+ * @fdt: Tree containing the nodes
+ * @node: Offset of the first node to record
+ * @prefix: Path which @node has in the base tree
+ * @delta: Value to add to each phandle, to give its value in the base tree
+ * @sorted: true to keep the index sorted, false to append
+ */
+static int index_add_nodes(struct fdt_overlay_index *idx, const void *fdt,
+			   int node, const char *prefix, u32 delta,
+			   bool sorted)
+{
+	int ends[FDT_INDEX_MAX_DEPTH];
+	char path[FDT_INDEX_PATH_MAX];
+	int depth = 0, len, ret;
+
+	/* the root node has an empty prefix, so its children are "/name" */
+	len = strlen(prefix);
+	if (len == 1 && *prefix == '/')
+		len = 0;
+	if (len >= sizeof(path))
+		return -FDT_ERR_NOSPACE;
+	memcpy(path, prefix, len);
+	path[len] = '\0';
+	ends[0] = len;
+
+	do {
+		u32 phandle = fdt_get_phandle(fdt, node);
+		const char *name;
+		int namelen;
+
+		if (phandle && phandle != (u32)-1) {
+			ret = index_set_phandle(idx, phandle + delta,
+						len ? path : "/", sorted);
+			if (ret)
+				return ret;
+		}
+
+		node = fdt_next_node(fdt, node, &depth);
+		if (node < 0 || depth <= 0)
+			break;
+		if (depth >= FDT_INDEX_MAX_DEPTH)
+			return -FDT_ERR_BADSTRUCTURE;
+
+		name = fdt_get_name(fdt, node, &namelen);
+		if (!name)
+			return namelen;
+		len = ends[depth - 1];
+		if (len + 1 + namelen >= sizeof(path))
+			return -FDT_ERR_NOSPACE;
+		path[len++] = '/';
+		memcpy(path + len, name, namelen);
+		len += namelen;
+		path[len] = '\0';
+		ends[depth] = len;
+	} while (1);
+
+	if (node < 0 && node != -FDT_ERR_NOTFOUND)
+		return node;
+
+	return 0;
+}
+
+static int index_path_cmp(const void *a, const void *b)
+{
+	const struct fdt_index_phandle *pa = a, *pb = b;
+
+	return strcmp(pa->path, pb->path);
+}
+
+/*
+ * index_add_base_symbols() - Record the phandle of each label in the base tree
+ *
+ * The labels are looked up in a copy of the phandle index sorted by path, to
+ * avoid looking up each path in the tree
+ */
+static int index_add_base_symbols(struct fdt_overlay_index *idx,
+				  const void *fdt, int sym)
+{
+	struct fdt_index_phandle *by_path;
+	int prop, ret = 0;
+
+	by_path = malloc(idx->phandle_count * sizeof(*by_path) + 1);
+	if (!by_path)
+		return -FDT_ERR_NOSPACE;
+	memcpy(by_path, idx->phandles, idx->phandle_count * sizeof(*by_path));
+	qsort(by_path, idx->phandle_count, sizeof(*by_path), index_path_cmp);
+
+	fdt_for_each_property_offset(prop, fdt, sym) {
+		struct fdt_index_phandle key, *ent = NULL;
+		const char *label;
+		int lo = 0, hi = idx->phandle_count;
+
+		key.path = (char *)fdt_getprop_by_offset(fdt, prop, &label,
+							 NULL);
+		if (!key.path) {
+			ret = -FDT_ERR_INTERNAL;
+			break;
+		}
+		while (lo < hi) {
+			int mid = (lo + hi) / 2;
+			int cmp = index_path_cmp(&by_path[mid], &key);
+
+			if (!cmp) {
+				ent = &by_path[mid];
+				break;
+			}
+			if (cmp < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		/* labelled nodes normally have a phandle, with dtc -@ */
+		ret = index_set_label(idx, label, ent ? ent->phandle : 0,
+				      false);
+		if (ret)
+			break;
+	}
+	free(by_path);
+
+	return ret;
+}
+
+/*
+ * index_add_overlay_symbols() - Record the labels which an overlay added
+ *
+ * Only labels within a fragment's __overlay__ node end up in the base tree.
+ * By now fdt_overlay_apply() has added them to its /__symbols__ node, so the
+ * phandle is read from the node there. This also covers an overlay node with
+ * no phandle which was merged into a base node with one.
+ */
+static int index_add_overlay_symbols(struct fdt_overlay_index *idx,
+				     const void *fdt, const void *fdto,
+				     int sym)
+{
+	int base_sym, prop, ret;
+
+	base_sym = fdt_subnode_offset(fdt, 0, "__symbols__");
+	if (base_sym < 0)
+		return 0;
+
+	fdt_for_each_property_offset(prop, fdto, sym) {
+		const char *label, *path;
+		int node;
+
+		path = fdt_getprop_by_offset(fdto, prop, &label, NULL);
+		if (!path)
+			return -FDT_ERR_INTERNAL;
+		if (!strstr(path, "/__overlay__"))
+			continue;
+
+		path = fdt_getprop(fdt, base_sym, label, NULL);
+		if (!path)
+			continue;
+		node = fdt_path_offset(fdt, path);
+		if (node < 0)
+			continue;
+
+		ret = index_set_label(idx, label, fdt_get_phandle(fdt, node),
+				      true);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+int fdt_overlay_index_init(struct fdt_overlay_index *idx, const void *fdt)
+{
+	int sym, ret;
+
+	memset(idx, '\0', sizeof(*idx));
+	ret = fdt_check_header(fdt);
+	if (ret)
+		return ret;
+
+	ret = index_add_nodes(idx, fdt, 0, "/", 0, false);
+	if (ret)
+		goto err;
+	qsort(idx->phandles, idx->phandle_count, sizeof(*idx->phandles),
+	      index_phandle_cmp);
+	if (idx->phandle_count)
+		idx->max_phandle = idx->phandles[idx->phandle_count - 1].phandle;
+
+	sym = fdt_subnode_offset(fdt, 0, "__symbols__");
+	if (sym >= 0) {
+		ret = index_add_base_symbols(idx, fdt, sym);
+		if (ret)
+			goto err;
+		qsort(idx->labels, idx->label_count, sizeof(*idx->labels),
+		      index_label_cmp);
+	}
+
+	return 0;
+
+err:
+	fdt_overlay_index_uninit(idx);
+
+	return ret;
+}
+
+void fdt_overlay_index_uninit(struct fdt_overlay_index *idx)
+{
+	int i;
+
+	for (i = 0; i < idx->phandle_count; i++)
+		free(idx->phandles[i].path);
+	for (i = 0; i < idx->label_count; i++)
+		free(idx->labels[i].label);
+	free(idx->phandles);
+	free(idx->labels);
+	memset(idx, '\0', sizeof(*idx));
+}
+
+/*
+ * overlay_fixup_label() - Write the phandle of a label into an overlay
+ *
+ * Each string in the __fixups__ property for the label has the form
+ * "path:property:offset", giving a cell which refers to the label
+ */
+static int overlay_fixup_label(const struct fdt_overlay_index *idx,
+			       void *fdto, int fixups, const char *label)
+{
+	fdt32_t val;
+	bool found;
+	int pos, count, i;
+
+	pos = index_find_label(idx, label, &found);
+	if (!found || !idx->labels[pos].phandle)
+		return -FDT_ERR_NOTFOUND;
+	val = cpu_to_fdt32(idx->labels[pos].phandle);
+
+	count = fdt_stringlist_count(fdto, fixups, label);
+	if (count < 0)
+		return count;
+	for (i = 0; i < count; i++) {
+		const char *fixup, *name, *sep;
+		int node, ret;
+		char *end;
+		ulong offset;
+
+		fixup = fdt_stringlist_get(fdto, fixups, label, i, NULL);
+		if (!fixup)
+			return -FDT_ERR_BADOVERLAY;
+
+		/* node and property names cannot contain a colon */
+		name = strchr(fixup, ':');
+		sep = strrchr(fixup, ':');
+		if (!name || name == fixup || sep <= name + 1)
+			return -FDT_ERR_BADOVERLAY;
+		name++;
+		offset = simple_strtoul(sep + 1, &end, 10);
+		if (end == sep + 1 || *end)
+			return -FDT_ERR_BADOVERLAY;
+
+		node = fdt_path_offset_namelen(fdto, fixup, name - 1 - fixup);
+		if (node == -FDT_ERR_NOTFOUND)
+			return -FDT_ERR_BADOVERLAY;
+		if (node < 0)
+			return node;
+
+		ret = fdt_setprop_inplace_namelen_partial(fdto, node, name,
+							  sep - name, offset,
+							  &val, sizeof(val));
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * overlay_index_fixup() - Resolve the references from an overlay to labels
+ *
+ * The __fixups__ node is then removed, so that fdt_overlay_apply() does not
+ * look up the labels again
+ */
+static int overlay_index_fixup(const struct fdt_overlay_index *idx,
+			       void *fdto)
+{
+	int fixups, prop, ret;
+
+	fixups = fdt_subnode_offset(fdto, 0, "__fixups__");
+	if (fixups == -FDT_ERR_NOTFOUND)
+		return 0;
+	if (fixups < 0)
+		return fixups;
+
+	fdt_for_each_property_offset(prop, fdto, fixups) {
+		const char *label;
+
+		if (!fdt_getprop_by_offset(fdto, prop, &label, NULL))
+			return -FDT_ERR_INTERNAL;
+		ret = overlay_fixup_label(idx, fdto, fixups, label);
+		if (ret)
+			return ret;
+	}
+
+	return fdt_del_node(fdto, fixups);
+}
+
+/*
+ * overlay_index_set_targets() - Convert phandle targets into target paths
+ *
+ * This lets fdt_overlay_apply() find each target without searching the base
+ * tree for its phandle. The overlay buffer is enlarged as needed.
+ */
+static int overlay_index_set_targets(const struct fdt_overlay_index *idx,
+				     void **fdtop)
+{
+	int fragment;
+
+	fdt_for_each_subnode(fragment, *fdtop, 0) {
+		const fdt32_t *target;
+		const char *path;
+		bool found;
+		int pos, len, ret;
+
+		if (fdt_subnode_offset(*fdtop, fragment, "__overlay__") < 0)
+			continue;
+
+		/* leave anything unusual for fdt_overlay_apply() to report */
+		target = fdt_getprop(*fdtop, fragment, "target", &len);
+		if (!target || len != sizeof(*target))
+			continue;
+
+		pos = index_find_phandle(idx, fdt32_to_cpu(*target), &found);
+		if (!found)
+			continue;
+		path = idx->phandles[pos].path;
+
+		for (;;) {
+			int size;
+			void *buf;
+
+			ret = fdt_setprop_string(*fdtop, fragment,
+						 "target-path", path);
+			if (ret != -FDT_ERR_NOSPACE)
+				break;
+			size = fdt_totalsize(*fdtop) * 2;
+			buf = realloc(*fdtop, size);
+			if (!buf)
+				return -FDT_ERR_NOSPACE;
+			*fdtop = buf;
+			ret = fdt_open_into(buf, buf, size);
+			if (ret)
+				return ret;
+		}
+		if (ret)
+			return ret;
+		ret = fdt_delprop(*fdtop, fragment, "target");
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * overlay_index_add_nodes() - Record the phandles of the nodes in an overlay
+ *
+ * This must be called before the overlay is applied, since
+ * fdt_overlay_apply() leaves it unusable. It adds idx->max_phandle to each
+ * phandle, as fdt_overlay_apply() does, since that is the largest phandle in
+ * the base tree.
+ */
+static int overlay_index_add_nodes(struct fdt_overlay_index *idx,
+				   const void *fdto)
+{
+	u32 delta = idx->max_phandle;
+	u32 max_phandle;
+	int fragment, ret;
+
+	ret = fdt_find_max_phandle(fdto, &max_phandle);
+	if (ret)
+		return ret;
+
+	fdt_for_each_subnode(fragment, fdto, 0) {
+		const char *path;
+		int overlay;
+
+		overlay = fdt_subnode_offset(fdto, fragment, "__overlay__");
+		if (overlay < 0)
+			continue;
+
+		/* the target could not be resolved, so the apply will fail */
+		path = fdt_getprop(fdto, fragment, "target-path", NULL);
+		if (!path)
+			continue;
+		ret = index_add_nodes(idx, fdto, overlay, path, delta, true);
+		if (ret)
+			return ret;
+	}
+	idx->max_phandle += max_phandle;
+
+	return 0;
+}
+
+int fdt_overlay_index_apply(struct fdt_overlay_index *idx, void *fdt,
+			    const void *fdto)
+{
+	void *copy;
+	int size, sym;
+	int ret;
+
+	ret = fdt_check_header(fdto);
+	if (ret)
+		return ret;
+
+	/* work on a copy, since the overlay is changed as it is applied */
+	size = fdt_totalsize(fdto) + SZ_1K;
+	copy = malloc(size);
+	if (!copy)
+		return -FDT_ERR_NOSPACE;
+
+	ret = fdt_open_into(fdto, copy, size);
+	if (ret)
+		goto out;
+
+	ret = overlay_index_fixup(idx, copy);
+	if (ret)
+		goto out;
+
+	ret = overlay_index_set_targets(idx, &copy);
+	if (ret)
+		goto out;
+
+	ret = overlay_index_add_nodes(idx, copy);
+	if (ret)
+		goto out;
+
+	ret = fdt_overlay_apply(fdt, copy);
+	if (ret)
+		goto out;
+
+	sym = fdt_subnode_offset(fdto, 0, "__symbols__");
+	if (sym >= 0)
+		ret = index_add_overlay_symbols(idx, fdt, fdto, sym);
+
+out:
+	free(copy);
+
+	return ret;
+}
@@ -2158,6 +2158,12 @@ int fdt_fixup_display(void *blob, const char *path, const char *display)
  * in the case of an error
  */
 int fdt_overlay_apply_verbose(void *fdt, void *fdto)
+{
+	return fdt_overlay_index_apply_verbose(NULL, fdt, fdto);
+}
+
+int fdt_overlay_index_apply_verbose(struct fdt_overlay_index *idx, void *fdt,
+				    void *fdto)
 {
 	int err;
 	bool has_symbols;
@@ -2165,7 +2171,10 @@ int fdt_overlay_apply_verbose(void *fdt, void *fdto)
 	err = fdt_path_offset(fdt, "/__symbols__");
 	has_symbols = err >= 0;
 
-	err = fdt_overlay_apply(fdt, fdto);
+	if (idx)
+		err = fdt_overlay_index_apply(idx, fdt, fdto);
+	else
+		err = fdt_overlay_apply(fdt, fdto);
 	if (err < 0) {
 		printf("failed on fdt_overlay_apply(): %s\n",
 				fdt_strerror(err));
@@ -14,10 +14,12 @@
 #include <bootstage.h>
 #include <cpu_func.h>
 #include <display_options.h>
+#include <dma.h>
 #include <env.h>
 #include <fpga.h>
 #include <image.h>
 #include <init.h>
+#include <lmb.h>
 #include <log.h>
 #include <mapmem.h>
 #include <rtc.h>
@@ -168,6 +170,12 @@ void memmove_wd(void *to, void *from, size_t len, ulong chunksz)
 	if (to == from)
 		return;
 
+	bootstage_count(BOOTSTAGE_ID_COUNT_COPY, "copy_bytes", len);
+
+	/* large, non-overlapping copies can be handed to a DMA engine */
+	if (CONFIG_IS_ENABLED(DMA_BULK_COPY) && !dma_bulk_copy(to, from, len))
+		return;
+
 	if (IS_ENABLED(CONFIG_HW_WATCHDOG) || IS_ENABLED(CONFIG_WATCHDOG)) {
 		if (to > from) {
 			from += len;
@@ -530,6 +538,33 @@ err:
 	return ret;
 }
 
+/**
+ * ramdisk_in_place() - Check if a ramdisk can be used where it was loaded
+ *
+ * This is the case if it is page-aligned, lies entirely below @initrd_high
+ * and does not overlap anything already reserved, such as the kernel. If so,
+ * the ramdisk is reserved, so that nothing is later placed on top of it.
+ *
+ * @rd_data: Start address of the ramdisk
+ * @rd_len: Length of the ramdisk in bytes
+ * @initrd_high: Address which the ramdisk must lie below, or 0 for no limit
+ * Return: true if the ramdisk can be used in place, false if it must be copied
+ */
+static bool ramdisk_in_place(ulong rd_data, ulong rd_len,
+			     phys_addr_t initrd_high)
+{
+	if (!IS_ENABLED(CONFIG_BOOT_RAMDISK_IN_PLACE))
+		return false;
+	if (!IS_ALIGNED(rd_data, 0x1000))
+		return false;
+	if (initrd_high && rd_data + rd_len > initrd_high)
+		return false;
+	if (lmb_get_free_size(rd_data) < rd_len)
+		return false;
+
+	return lmb_reserve(rd_data, rd_len) >= 0;
+}
+
 /**
  * boot_ramdisk_high - relocate init ramdisk
  * @rd_data: ramdisk data start address
@@ -578,6 +613,11 @@ int boot_ramdisk_high(ulong rd_data, ulong rd_len, ulong *initrd_start,
 			*initrd_start = rd_data;
 			*initrd_end = rd_data + rd_len;
 			lmb_reserve(rd_data, rd_len);
+		} else if (ramdisk_in_place(rd_data, rd_len, initrd_high)) {
+			*initrd_start = rd_data;
+			*initrd_end = rd_data + rd_len;
+			printf("   Using Ramdisk in place at %08lx, end %08lx\n",
+			       *initrd_start, *initrd_end);
 		} else {
 			if (initrd_high)
 				*initrd_start = (ulong)lmb_alloc_base(rd_len,
@@ -597,8 +637,8 @@ int boot_ramdisk_high(ulong rd_data, ulong rd_len, ulong *initrd_start,
 			printf("   Loading Ramdisk to %08lx, end %08lx ... ",
 			       *initrd_start, *initrd_end);
 
-			memmove_wd((void *)*initrd_start,
-				   (void *)rd_data, rd_len, CHUNKSZ);
+			memmove_wd(map_sysmem(*initrd_start, rd_len),
+				   map_sysmem(rd_data, rd_len), rd_len, CHUNKSZ);
 
 			/*
 			 * Ensure the image is flushed to memory to handle
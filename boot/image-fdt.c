@@ -10,6 +10,7 @@
 
 #define LOG_CATEGORY	LOGC_BOOT
 
+#include <abuf.h>
 #include <command.h>
 #include <fdt_support.h>
 #include <fdtdec.h>
@@ -19,6 +20,7 @@
 #include <lmb.h>
 #include <log.h>
 #include <malloc.h>
+#include <of_live.h>
 #include <asm/global_data.h>
 #include <linux/libfdt.h>
 #include <mapmem.h>
@@ -566,6 +568,74 @@ __weak int arch_fixup_fdt(void *blob)
 	return 0;
 }
 
+/**
+ * fdt_fixup_live() - Send the fixup event with a live tree
+ *
+ * With a live control devicetree the event cannot be sent with the flat
+ * @blob, so this creates a live tree from @blob, sends the event with that
+ * and then flattens the result back into @blob. Only the event handlers see
+ * the live tree; the libfdt fixups have already been applied to @blob.
+ *
+ * The reserve map and boot CPU are not held in the live tree, so these are
+ * copied over from the original FDT.
+ *
+ * @images: Images being booted
+ * @blob: FDT to fix up
+ * Return: 0 if OK, -ENOSPC if the resulting FDT does not fit in the space
+ *	available in @blob, other -ve value on other error
+ */
+static int fdt_fixup_live(struct bootm_headers *images, void *blob)
+{
+	struct event_ft_fixup fixup;
+	struct device_node *root;
+	int size = fdt_totalsize(blob);
+	int num_rsv, i, ret;
+	u64 *rsv = NULL;
+	struct abuf buf;
+	u32 cpuid;
+
+	ret = unflatten_device_tree(blob, &root);
+	if (ret)
+		return log_msg_ret("unf", ret);
+	fixup.tree = oftree_from_np(root);
+	fixup.images = images;
+	abuf_init(&buf);
+	ret = event_notify(EVT_FT_FIXUP, &fixup, sizeof(fixup));
+	if (!ret)
+		ret = of_live_flatten(root, &buf);
+	of_live_free(root);
+	if (ret)
+		goto err;
+
+	/* each reserve-map entry is an address and a size */
+	num_rsv = fdt_num_mem_rsv(blob);
+	if (num_rsv) {
+		rsv = malloc(num_rsv * 2 * sizeof(u64));
+		if (!rsv) {
+			ret = -ENOMEM;
+			goto err;
+		}
+	}
+	for (i = 0; i < num_rsv; i++)
+		fdt_get_mem_rsv(blob, i, &rsv[i * 2], &rsv[i * 2 + 1]);
+	cpuid = fdt_boot_cpuid_phys(blob);
+
+	ret = fdt_open_into(abuf_data(&buf), blob, size);
+	for (i = 0; !ret && i < num_rsv; i++)
+		ret = fdt_add_mem_rsv(blob, rsv[i * 2], rsv[i * 2 + 1]);
+	if (!ret)
+		fdt_set_boot_cpuid_phys(blob, cpuid);
+	free(rsv);
+	if (ret) {
+		log_debug("Cannot write FDT (err=%d)\n", ret);
+		ret = ret == -FDT_ERR_NOSPACE ? -ENOSPC : -EINVAL;
+	}
+err:
+	abuf_uninit(&buf);
+
+	return ret;
+}
+
 int image_setup_libfdt(struct bootm_headers *images, void *blob, bool lmb)
 {
 	ulong *initrd_start = &images->initrd_start;
@@ -651,7 +721,13 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob, bool lmb)
 		goto err;
 
 	/* after here we are using the ofnode interface */
-	if (!of_live_active() && CONFIG_IS_ENABLED(EVENT)) {
+	if (IS_ENABLED(CONFIG_OF_LIVE_FIXUP) && of_live_active()) {
+		ret = fdt_fixup_live(images, blob);
+		if (ret) {
+			printf("ERROR: fdt fixup event failed: %d\n", ret);
+			goto err;
+		}
+	} else if (!of_live_active() && CONFIG_IS_ENABLED(EVENT)) {
 		struct event_ft_fixup fixup;
 
 		fixup.tree = oftree_from_fdt(blob);
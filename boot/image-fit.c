@@ -2388,6 +2388,7 @@ int decomp_image(const void *fit, int noffset, const char *prop_name,
 		log_debug("copying\n");
 		loadbuf = map_sysmem(load, size);
 		memcpy(loadbuf, buf, size);
+		bootstage_count(BOOTSTAGE_ID_COUNT_COPY, "copy_bytes", size);
 	}
 
 	if (image_type == IH_TYPE_RAMDISK && comp != IH_COMP_NONE)
@@ -2576,10 +2577,11 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 	ulong load, len;
 #ifdef CONFIG_OF_LIBFDT_OVERLAY
 	ulong image_start, image_end;
-	ulong ovload, ovlen, ovcopylen;
+	struct fdt_overlay_index idx = { 0 };
+	ulong ovload, ovlen;
 	const char *uconfig;
 	const char *uname;
-	void *base, *ov, *ovcopy = NULL;
+	void *base, *ov;
 	int i, err, noffset, ov_noffset;
 #endif
 
@@ -2634,6 +2636,14 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 
 	base = map_sysmem(load, len);
 
+	/* index the base tree once, rather than searching it for each overlay */
+	err = fdt_overlay_index_init(&idx, base);
+	if (err < 0) {
+		printf("failed to index FDT for overlays\n");
+		fdt_noffset = err;
+		goto out;
+	}
+
 	/* apply extra configs in FIT first, followed by args */
 	for (i = 1; ; i++) {
 		if (i < count) {
@@ -2678,21 +2688,6 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 				uname, ovload, ovlen);
 		ov = map_sysmem(ovload, ovlen);
 
-		ovcopylen = ALIGN(fdt_totalsize(ov), SZ_4K);
-		ovcopy = malloc(ovcopylen);
-		if (!ovcopy) {
-			printf("failed to duplicate DTO before application\n");
-			fdt_noffset = -ENOMEM;
-			goto out;
-		}
-
-		err = fdt_open_into(ov, ovcopy, ovcopylen);
-		if (err < 0) {
-			printf("failed on fdt_open_into for DTO\n");
-			fdt_noffset = err;
-			goto out;
-		}
-
 		base = map_sysmem(load, len + ovlen);
 		err = fdt_open_into(base, base, len + ovlen);
 		if (err < 0) {
@@ -2701,8 +2696,11 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 			goto out;
 		}
 
-		/* the verbose method prints out messages on error */
-		err = fdt_overlay_apply_verbose(base, ovcopy);
+		/*
+		 * the verbose method prints out messages on error; the DTO is
+		 * left intact so there is no need to copy it
+		 */
+		err = fdt_overlay_index_apply_verbose(&idx, base, ov);
 		if (err < 0) {
 			fdt_noffset = err;
 			goto out;
@@ -2726,7 +2724,7 @@ out:
 		*fit_uname_configp = fit_uname_config;
 
 #ifdef CONFIG_OF_LIBFDT_OVERLAY
-	free(ovcopy);
+	fdt_overlay_index_uninit(&idx);
 #endif
 	free(fit_uname_config_copy);
 	return fdt_noffset;
@@ -14,6 +14,7 @@
 #include <log.h>
 #include <malloc.h>
 #include <u-boot/crc.h>
+#include <u-boot/schedule.h>
 
 #if CONFIG_IS_ENABLED(FIT) || CONFIG_IS_ENABLED(OF_LIBFDT)
 #include <linux/libfdt.h>
@@ -26,13 +27,6 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
-/* Set this if we have less than 4 MB of malloc() space */
-#if CONFIG_SYS_MALLOC_LEN < (4096 * 1024)
-#define CONSERVE_MEMORY		true
-#else
-#define CONSERVE_MEMORY		false
-#endif
-
 #else /* USE_HOSTCC */
 #include "mkimage.h"
 #include <linux/kconfig.h>
@@ -43,24 +37,16 @@ DECLARE_GLOBAL_DATA_PTR;
 # define __maybe_unused		/* unimplemented */
 #endif
 
-#define CONSERVE_MEMORY		false
-
 #endif /* !USE_HOSTCC*/
 
 #include <abuf.h>
-#include <bzlib.h>
+#include <decomp.h>
 #include <display_options.h>
-#include <gzip.h>
 #include <image.h>
 #include <imximage.h>
 #include <relocate.h>
-#include <linux/lzo.h>
 #include <linux/zstd.h>
-#include <lzma/LzmaTypes.h>
-#include <lzma/LzmaDec.h>
-#include <lzma/LzmaTools.h>
 #include <u-boot/crc.h>
-#include <u-boot/lz4.h>
 
 static const table_entry_t uimage_arch[] = {
 	{	IH_ARCH_INVALID,	"invalid",	"Invalid ARCH",	},
@@ -447,94 +433,129 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 		 void *load_buf, void *image_buf, ulong image_len,
 		 uint unc_len, ulong *load_end)
 {
-	int ret = -ENOSYS;
+	struct decomp_ctx ctx;
+	size_t size;
+	int ret;
 
 	*load_end = load;
 	print_decomp_msg(comp, type, load == image_start, load);
 
 	/*
 	 * Load the image to the right place, decompressing if needed. After
-	 * this, image_len will be set to the number of uncompressed bytes
-	 * loaded, ret will be non-zero on error.
+	 * this, size will be set to the number of uncompressed bytes loaded,
+	 * ret will be non-zero on error.
 	 */
-	switch (comp) {
-	case IH_COMP_NONE:
-		ret = 0;
+	if (comp == IH_COMP_NONE) {
 		if (load == image_start)
-			break;
-		if (image_len <= unc_len)
-			memmove_wd(load_buf, image_buf, image_len, CHUNKSZ);
-		else
-			ret = -ENOSPC;
-		break;
-	case IH_COMP_GZIP:
-		if (!tools_build() && CONFIG_IS_ENABLED(GZIP))
-			ret = gunzip(load_buf, unc_len, image_buf, &image_len);
-		break;
-	case IH_COMP_BZIP2:
-		if (!tools_build() && CONFIG_IS_ENABLED(BZIP2)) {
-			uint size = unc_len;
-
-			/*
-			 * If we've got less than 4 MB of malloc() space,
-			 * use slower decompression algorithm which requires
-			 * at most 2300 KB of memory.
-			 */
-			ret = BZ2_bzBuffToBuffDecompress(load_buf, &size,
-				image_buf, image_len, CONSERVE_MEMORY, 0);
-			image_len = size;
-		}
-		break;
-	case IH_COMP_LZMA:
-		if (!tools_build() && CONFIG_IS_ENABLED(LZMA)) {
-			SizeT lzma_len = unc_len;
-
-			ret = lzmaBuffToBuffDecompress(load_buf, &lzma_len,
-						       image_buf, image_len);
-			image_len = lzma_len;
-		}
-		break;
-	case IH_COMP_LZO:
-		if (!tools_build() && CONFIG_IS_ENABLED(LZO)) {
-			size_t size = unc_len;
+			return 0;
+		if (image_len > unc_len)
+			return -ENOSPC;
+		memmove_wd(load_buf, image_buf, image_len, CHUNKSZ);
+		*load_end = load + image_len;
 
-			ret = lzop_decompress(image_buf, image_len, load_buf, &size);
-			image_len = size;
-		}
-		break;
-	case IH_COMP_LZ4:
-		if (!tools_build() && CONFIG_IS_ENABLED(LZ4)) {
-			size_t size = unc_len;
+		return 0;
+	}
 
-			ret = ulz4fn(image_buf, image_len, load_buf, &size);
-			image_len = size;
-		}
-		break;
-	case IH_COMP_ZSTD:
-		if (!tools_build() && CONFIG_IS_ENABLED(ZSTD)) {
-			struct abuf in, out;
-
-			abuf_init_set(&in, image_buf, image_len);
-			abuf_init_set(&out, load_buf, unc_len);
-			ret = zstd_decompress(&in, &out);
-			if (ret >= 0) {
-				image_len = ret;
-				ret = 0;
-			}
+	/* seekable zstd has independent frames, so decompress them in parallel */
+	if (!tools_build() && CONFIG_IS_ENABLED(ZSTD) && comp == IH_COMP_ZSTD) {
+		struct abuf in, out;
+
+		abuf_init_set(&in, image_buf, image_len);
+		abuf_init_set(&out, load_buf, unc_len);
+		ret = zstd_decompress_seekable(&in, &out);
+		if (ret != -ENOENT) {
+			if (ret < 0)
+				return ret;
+			*load_end = load + ret;
+
+			return 0;
 		}
-		break;
 	}
+
+	ret = -ENOSYS;
+	if (!tools_build())
+		ret = decomp_init(&ctx, comp, load_buf, unc_len);
 	if (ret == -ENOSYS) {
 		printf("Unimplemented compression type %d\n", comp);
 		return ret;
+	} else if (ret) {
+		return ret;
+	}
+	decomp_feed(&ctx, image_buf, image_len);
+	ret = decomp_finish(&ctx, &size);
+	*load_end = load + size;
+
+	return ret;
+}
+
+#ifndef USE_HOSTCC
+int image_decomp_read(int comp, ulong load, int type, void *load_buf,
+		      image_read_func read, void *priv, ulong image_len,
+		      uint unc_len, ulong *load_end)
+{
+	struct decomp_ctx ctx;
+	ulong offset;
+	size_t size;
+	void *buf;
+	long len = 0;
+	int ret;
+
+	*load_end = load;
+	print_decomp_msg(comp, type, false, load);
+
+	if (comp == IH_COMP_NONE) {
+		if (image_len > unc_len)
+			return -ENOSPC;
+		for (offset = 0; offset < image_len; offset += len) {
+			len = read(priv, offset, load_buf + offset,
+				   min_t(ulong, image_len - offset,
+					 IMAGE_READ_CHUNK));
+			if (len < 0)
+				return len;
+			if (!len)
+				return -EIO;
+			schedule();
+		}
+		*load_end = load + image_len;
+
+		return 0;
 	}
 
-	*load_end = load + image_len;
-	if (ret)
+	ret = decomp_init(&ctx, comp, load_buf, unc_len);
+	if (ret == -ENOSYS) {
+		printf("Unimplemented compression type %d\n", comp);
+		return ret;
+	} else if (ret) {
 		return ret;
+	}
 
-	return 0;
+	/*
+	 * Each chunk is decompressed while it is still in the cache and the
+	 * compressed image never needs to be in memory as a whole
+	 */
+	buf = malloc(IMAGE_READ_CHUNK);
+	if (!buf) {
+		decomp_finish(&ctx, NULL);
+		return -ENOMEM;
+	}
+	for (offset = 0; offset < image_len && !ctx.done; offset += len) {
+		len = read(priv, offset, buf,
+			   min_t(ulong, image_len - offset, IMAGE_READ_CHUNK));
+		if (len <= 0)
+			break;
+		if (decomp_feed(&ctx, buf, len))
+			break;
+		schedule();
+	}
+	free(buf);
+	ret = decomp_finish(&ctx, &size);
+	*load_end = load + size;
+	if (len < 0)
+		return len;
+
+	return ret;
 }
+#endif
 
 const table_entry_t *get_table_entry(const table_entry_t *table, int id)
 {
@@ -314,6 +314,7 @@ static void label_boot_fdtoverlay(struct pxe_context *ctx,
 				  struct pxe_label *label)
 {
 	char *fdtoverlay = label->fdtoverlays;
+	struct fdt_overlay_index idx = { }, *idxp = &idx;
 	struct fdt_header *working_fdt;
 	char *fdtoverlay_addr_env;
 	ulong fdtoverlay_addr;
@@ -336,6 +337,10 @@ static void label_boot_fdtoverlay(struct pxe_context *ctx,
 
 	fdtoverlay_addr = hextoul(fdtoverlay_addr_env, NULL);
 
+	/* Index the main fdt once for all the overlays, if possible */
+	if (fdt_overlay_index_init(&idx, working_fdt))
+		idxp = NULL;
+
 	/* Cycle over the overlay files and apply them in order */
 	do {
 		struct fdt_header *blob;
@@ -382,7 +387,7 @@ static void label_boot_fdtoverlay(struct pxe_context *ctx,
 			goto skip_overlay;
 		}
 
-		err = fdt_overlay_apply_verbose(working_fdt, blob);
+		err = fdt_overlay_index_apply_verbose(idxp, working_fdt, blob);
 		if (err) {
 			printf("Failed to apply overlay %s, skipping\n",
 			       overlayfile);
@@ -393,6 +398,8 @@ skip_overlay:
 		if (end)
 			free(overlayfile);
 	} while ((fdtoverlay = strstr(fdtoverlay, " ")));
+
+	fdt_overlay_index_uninit(&idx);
 }
 #endif
 
@@ -15,7 +15,15 @@
 
 static LIST_HEAD(extension_list);
 
-static int extension_apply(struct extension *extension)
+/**
+ * extension_apply() - Apply the overlay for an extension board
+ *
+ * @extension: Extension board to apply
+ * @idx: Index of working_fdt to use, or NULL to apply without an index
+ * Return: CMD_RET_SUCCESS if OK, CMD_RET_FAILURE on error
+ */
+static int extension_apply(struct extension *extension,
+			   struct fdt_overlay_index *idx)
 {
 	char *overlay_cmd;
 	ulong extrasize, overlay_addr;
@@ -54,7 +62,7 @@ static int extension_apply(struct extension *extension)
 		return CMD_RET_FAILURE;
 
 	/* apply method prints messages on error */
-	if (fdt_overlay_apply_verbose(working_fdt, blob))
+	if (fdt_overlay_index_apply_verbose(idx, working_fdt, blob))
 		return CMD_RET_FAILURE;
 
 	return CMD_RET_SUCCESS;
@@ -121,12 +129,20 @@ static int do_extension_apply(struct cmd_tbl *cmdtp, int flag,
 		return CMD_RET_USAGE;
 
 	if (strcmp(argv[1], "all") == 0) {
+		struct fdt_overlay_index idx, *idxp = &idx;
+
+		/* index the tree once for all the overlays, if possible */
+		if (!working_fdt || fdt_overlay_index_init(&idx, working_fdt))
+			idxp = NULL;
+
 		ret = CMD_RET_FAILURE;
 		list_for_each_entry(extension, &extension_list, list) {
-			ret = extension_apply(extension);
+			ret = extension_apply(extension, idxp);
 			if (ret != CMD_RET_SUCCESS)
 				break;
 		}
+		if (idxp)
+			fdt_overlay_index_uninit(idxp);
 	} else {
 		extension_id = simple_strtol(argv[1], NULL, 10);
 		list_for_each(entry, &extension_list) {
@@ -142,7 +158,7 @@ static int do_extension_apply(struct cmd_tbl *cmdtp, int flag,
 			return CMD_RET_FAILURE;
 		}
 
-		ret = extension_apply(extension);
+		ret = extension_apply(extension, NULL);
 	}
 
 	return ret;
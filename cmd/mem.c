@@ -22,6 +22,7 @@
 #include <hash.h>
 #include <log.h>
 #include <mapmem.h>
+#include <memtest.h>
 #include <rand.h>
 #include <time.h>
 #include <watchdog.h>
@@ -31,6 +32,7 @@
 #include <linux/compiler.h>
 #include <linux/ctype.h>
 #include <linux/delay.h>
+#include <linux/math64.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -1058,6 +1060,65 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 	return errs;
 }
 
+static int mem_test_fast_progress(void *priv, u64 done, u64 total)
+{
+	int *percentp = priv;
+	int percent = div64_u64(done * 100, total);
+
+	if (percent != *percentp) {
+		printf("\b\b\b\b%3d%%", percent);
+		*percentp = percent;
+	}
+
+	return ctrlc() ? -EINTR : 0;
+}
+
+/*
+ * Run the fast multi-pattern test once, with up to @limit_ms to complete it.
+ * Sets *@timed_outp if the limit was reached before the whole range was
+ * tested.
+ */
+static ulong mem_test_fast(vu_long *buf, ulong start_addr, ulong end_addr,
+			   ulong seed, uint flags, ulong limit_ms,
+			   bool *timed_outp)
+{
+	const int plen = 2 * sizeof(ulong);
+	struct memtest_result res;
+	struct memtest_opts opts;
+	int percent = 0;
+	int ret;
+
+	memset(&opts, '\0', sizeof(opts));
+	opts.flags = flags;
+	opts.seed = seed;
+	opts.limit_ms = limit_ms;
+	opts.progress = mem_test_fast_progress;
+	opts.priv = &percent;
+	printf("\rSeed %0*lX  Testing...   0%%", plen, seed);
+
+	ret = memtest_run((void *)buf, start_addr, end_addr - start_addr, &opts,
+			  &res);
+	if (ret == -EINTR || ret == -ENOMEM) {
+		if (ret == -ENOMEM)
+			printf("\nOut of memory\n");
+		return -1;
+	}
+	if (res.errors)
+		printf("\nMem error @ 0x%0*lX: found %0*lX, expected %0*lX (%lu errors)\n",
+		       plen, res.addr, plen, res.found, plen, res.expected,
+		       res.errors);
+	if (ret == -ETIMEDOUT) {
+		printf("\nTime limit reached");
+		*timed_outp = true;
+	}
+	printf("\nTested %lu MiB in %lu ms with %d passes (%llu MiB/s)\n",
+	       res.tested >> 20, res.time_ms, res.passes,
+	       div64_u64((u64)res.tested * res.passes * 1000,
+			 (u64)max(res.time_ms, 1UL) << 20));
+
+	return res.errors;
+}
+
 /*
  * Perform a memory test. A more complete alternative test can be
  * configured using CONFIG_SYS_ALT_MEMTEST. The complete test loops until
@@ -1073,11 +1134,32 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 	ulong count = 0;
 	ulong errs = 0;	/* number of errors, or -1 if interrupted */
 	ulong pattern = 0;
+	ulong limit_ms = 0, left = 0, timer = get_timer(0);
+	bool fast = false, timed_out = false;
+	uint flags = 0;
 	int iteration;
 
 	start = CONFIG_SYS_MEMTEST_START;
 	end = CONFIG_SYS_MEMTEST_END;
 
+	for (; argc > 1 && *argv[1] == '-'; argc--, argv++) {
+		if (!IS_ENABLED(CONFIG_CMD_MEMTEST_FAST))
+			return CMD_RET_USAGE;
+		if (!strcmp(argv[1], "-f")) {
+			fast = true;
+		} else if (!strcmp(argv[1], "-d")) {
+			flags |= MEMTEST_F_DMA;
+		} else if (!strcmp(argv[1], "-t") && argc > 2) {
+			limit_ms = dectoul(argv[2], NULL);
+			argc--;
+			argv++;
+		} else {
+			return CMD_RET_USAGE;
+		}
+	}
+	if ((flags || limit_ms) && !fast)
+		return CMD_RET_USAGE;
+
 	if (argc > 1)
 		if (strict_strtoul(argv[1], 16, &start) < 0)
 			return CMD_RET_USAGE;
@@ -1112,9 +1194,18 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 			break;
 		}
 
+		if (limit_ms) {
+			left = limit_ms - min(get_timer(timer), limit_ms);
+			if (!left)
+				break;
+		}
+
 		printf("Iteration: %6d\r", iteration + 1);
 		debug("\n");
-		if (IS_ENABLED(CONFIG_SYS_ALT_MEMTEST)) {
+		if (IS_ENABLED(CONFIG_CMD_MEMTEST_FAST) && fast) {
+			errs = mem_test_fast(buf, start, end, pattern + iteration,
+					     flags, left, &timed_out);
+		} else if (IS_ENABLED(CONFIG_SYS_ALT_MEMTEST)) {
 			errs = mem_test_alt(buf, start, end, dummy);
 			if (errs == -1UL)
 				break;
@@ -1129,6 +1220,10 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 		if (errs == -1UL)
 			break;
 		count += errs;
+		if (timed_out) {
+			iteration++;
+			break;
+		}
 	}
 
 	unmap_sysmem((void *)buf);
@@ -1402,9 +1497,16 @@ U_BOOT_CMD(
 
 #ifdef CONFIG_CMD_MEMTEST
 U_BOOT_CMD(
-	mtest,	5,	1,	do_mem_mtest,
+	mtest,	9,	1,	do_mem_mtest,
 	"simple RAM read/write test",
+#ifdef CONFIG_CMD_MEMTEST_FAST
+	"[-f [-d] [-t ms]] [start [end [pattern [iterations]]]]\n"
+	"  -f  - fast multi-pattern test, using pattern as the seed\n"
+	"  -d  - also test writes by a DMA engine\n"
+	"  -t  - stop after this many milliseconds"
+#else
 	"[start [end [pattern [iterations]]]]"
+#endif
 );
 #endif	/* CONFIG_CMD_MEMTEST */
 
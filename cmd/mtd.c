@@ -10,6 +10,8 @@
 
 #include <command.h>
 #include <console.h>
+#include <display_options.h>
+#include <div64.h>
 #include <led.h>
 #if CONFIG_IS_ENABLED(CMD_MTD_OTP)
 #include <hexdump.h>
@@ -17,6 +19,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <mtd.h>
+#include <time.h>
 #include <dm/devres.h>
 #include <linux/err.h>
 
@@ -570,6 +573,14 @@ static int do_mtd_io(struct cmd_tbl *cmdtp, int flag, int argc,
 			continue;
 		}
 
+		/*
+		 * Read up to the end of the block at once so that the driver
+		 * can stream consecutive pages
+		 */
+		if (read && has_pages && !woob)
+			io_op.len = min_t(u64, remaining, mtd->erasesize -
+					  mtd_mod_by_eb(off, mtd));
+
 		if (read)
 			ret = mtd_read_oob(mtd, off, &io_op);
 		else
@@ -700,6 +711,74 @@ out_put_mtd:
 	return ret;
 }
 
+static int do_mtd_bench(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	u64 off, len, remaining, chunk;
+	ulong start, delta;
+	struct mtd_info *mtd;
+	size_t retlen;
+	u8 *buf;
+	int ret = 0;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	mtd = get_mtd_by_name(argv[1]);
+	if (IS_ERR_OR_NULL(mtd))
+		return CMD_RET_FAILURE;
+
+	off = argc > 2 ? hextoul(argv[2], NULL) : 0;
+	len = argc > 3 ? hextoul(argv[3], NULL) : mtd->size - off;
+	if (!mtd_is_aligned_with_block_size(mtd, off) || off >= mtd->size ||
+	    !len || len > mtd->size - off) {
+		printf("Offset must be block-aligned (0x%x) and within %s\n",
+		       mtd->erasesize, mtd->name);
+		ret = CMD_RET_FAILURE;
+		goto out_put_mtd;
+	}
+
+	buf = kmalloc(mtd->erasesize, GFP_KERNEL);
+	if (!buf) {
+		printf("Could not allocate a block buffer\n");
+		ret = CMD_RET_FAILURE;
+		goto out_put_mtd;
+	}
+
+	/* Read one block at a time, skipping bad ones like 'mtd read' does */
+	remaining = len;
+	start = timer_get_us();
+	for (; remaining && off < mtd->size; off += mtd->erasesize) {
+		if (mtd_block_isbad(mtd, off))
+			continue;
+
+		chunk = min_t(u64, remaining, mtd->erasesize);
+		ret = mtd_read(mtd, off, chunk, &retlen, buf);
+		if (ret && ret != -EUCLEAN) {
+			printf("Failure while reading at offset 0x%llx\n", off);
+			break;
+		}
+		ret = 0;
+		remaining -= chunk;
+	}
+	delta = max(timer_get_us() - start, 1UL);
+	kfree(buf);
+
+	if (ret) {
+		ret = CMD_RET_FAILURE;
+		goto out_put_mtd;
+	}
+
+	len -= remaining;
+	printf("%llu bytes read in %lu us, ", len, delta);
+	print_size(lldiv(len * 1000000, delta), "/s\n");
+
+out_put_mtd:
+	put_mtd_device(mtd);
+
+	return ret;
+}
+
 static int do_mtd_bad(struct cmd_tbl *cmdtp, int flag, int argc,
 		      char *const argv[])
 {
@@ -777,6 +856,7 @@ U_BOOT_LONGHELP(mtd,
 	"\n"
 	"Specific functions:\n"
 	"mtd bad                               <name>\n"
+	"mtd bench                             <name>        [<off> [<size>]]\n"
 #if CONFIG_IS_ENABLED(CMD_MTD_OTP)
 	"mtd otpread                           <name> [u|f] <off> <size>\n"
 	"mtd otpwrite                          <name> <off> <hex string>\n"
@@ -817,4 +897,6 @@ U_BOOT_CMD_WITH_SUBCMDS(mtd, "MTD utils", mtd_help_text,
 		U_BOOT_SUBCMD_MKENT_COMPLETE(erase, 4, 0, do_mtd_erase,
 					     mtd_name_complete),
 		U_BOOT_SUBCMD_MKENT_COMPLETE(bad, 2, 1, do_mtd_bad,
+					     mtd_name_complete),
+		U_BOOT_SUBCMD_MKENT_COMPLETE(bench, 4, 0, do_mtd_bench,
 					     mtd_name_complete));
@@ -585,6 +585,52 @@ static int do_spi_flash_test(int argc, char *const argv[])
 	return 0;
 }
 
+static int do_spi_flash_bench(int argc, char *const argv[])
+{
+	unsigned long offset, len, count = 1;
+	ulong start, delta;
+	u64 total;
+	char *endp;
+	void *buf;
+	int i, ret;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+	offset = hextoul(argv[1], &endp);
+	if (*argv[1] == 0 || *endp != 0)
+		return CMD_RET_USAGE;
+	len = hextoul(argv[2], &endp);
+	if (*argv[2] == 0 || *endp != 0 || !len)
+		return CMD_RET_USAGE;
+	if (argc > 3) {
+		count = dectoul(argv[3], &endp);
+		if (*endp != 0 || !count)
+			return CMD_RET_USAGE;
+	}
+
+	buf = memalign(ARCH_DMA_MINALIGN, len);
+	if (!buf) {
+		printf("Cannot allocate memory (%lu bytes)\n", len);
+		return CMD_RET_FAILURE;
+	}
+
+	start = timer_get_us();
+	for (i = 0, ret = 0; i < count && !ret; i++)
+		ret = spi_flash_read(flash, offset, len, buf);
+	delta = max(timer_get_us() - start, 1UL);
+	free(buf);
+	if (ret) {
+		printf("SPI flash read failed (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	total = (u64)len * count;
+	printf("%llu bytes read in %lu us, ", total, delta);
+	print_size(lldiv(total * 1000000, delta), "/s\n");
+
+	return 0;
+}
+
 static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 			char *const argv[])
 {
@@ -617,6 +663,8 @@ static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 		ret = do_spi_protect(argc, argv);
 	else if (IS_ENABLED(CONFIG_CMD_SF_TEST) && !strcmp(cmd, "test"))
 		ret = do_spi_flash_test(argc, argv);
+	else if (IS_ENABLED(CONFIG_CMD_SF_TEST) && !strcmp(cmd, "bench"))
+		ret = do_spi_flash_bench(argc, argv);
 	else
 		ret = CMD_RET_USAGE;
 
@@ -644,6 +692,8 @@ U_BOOT_LONGHELP(sf,
 #endif
 #ifdef CONFIG_CMD_SF_TEST
 	"\nsf test offset len		- run a very basic destructive test"
+	"\nsf bench offset len [count]	- time reading `len' bytes from\n"
+	"					  `offset', `count' times"
 #endif
 	);
 
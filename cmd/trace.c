@@ -76,6 +76,30 @@ static int create_call_list(int argc, char *const argv[])
 	return 0;
 }
 
+static int create_sample_list(int argc, char *const argv[])
+{
+	size_t buff_size, avail, buff_ptr, needed, used;
+	char *buff;
+	int err;
+
+	if (get_args(argc, argv, &buff, &buff_ptr, &buff_size))
+		return -1;
+
+	avail = buff_size - buff_ptr;
+	err = trace_list_samples(buff + buff_ptr, avail, &needed);
+	if (err)
+		printf("Error: truncated (%#zx bytes needed)\n", needed);
+	used = min(avail, (size_t)needed);
+	printf("Sample list dumped to %08lx, size %#zx\n",
+	       (ulong)map_to_sysmem(buff + buff_ptr), used);
+
+	env_set_hex("profbase", map_to_sysmem(buff));
+	env_set_hex("profsize", buff_size);
+	env_set_hex("profoffset", buff_ptr + used);
+
+	return 0;
+}
+
 int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 {
 	const char *cmd = argc < 2 ? NULL : argv[1];
@@ -98,6 +122,11 @@ int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 			return cmd_usage(cmdtp);
 		break;
 	case 's':
+		if (IS_ENABLED(CONFIG_TRACE_SAMPLE) && cmd[1] == 'a') {
+			if (create_sample_list(argc, argv))
+				return cmd_usage(cmdtp);
+			break;
+		}
 		trace_print_stats();
 		break;
 	case 'w':
@@ -121,4 +150,8 @@ U_BOOT_CMD(
 	"trace funclist [<addr> <size>]     - dump function list into buffer\n"
 	"trace calls  [<addr> <size>]       "
 		"- dump function call trace into buffer"
+#ifdef CONFIG_TRACE_SAMPLE
+	"\ntrace samples [<addr> <size>]      "
+		"- dump statistical samples into buffer"
+#endif
 );
@@ -16,6 +16,7 @@
 #include <exports.h>
 #include <led.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <memalign.h>
 #include <mtd.h>
 #include <nand.h>
@@ -822,6 +823,7 @@ static int do_ubi(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 	}
 
 	if (strncmp(argv[1], "write", 5) == 0) {
+		void *buf;
 		int ret;
 
 		if (argc < 5) {
@@ -831,21 +833,23 @@ static int do_ubi(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 
 		addr = hextoul(argv[2], NULL);
 		size = hextoul(argv[4], NULL);
+		buf = map_sysmem(addr, size);
 
 		if (strlen(argv[1]) == 10 &&
 		    strncmp(argv[1] + 5, ".part", 5) == 0) {
 			if (argc < 6) {
 				ret = ubi_volume_continue_write(argv[3],
-						(void *)addr, size);
+						buf, size);
 			} else {
 				size_t full_size;
 				full_size = hextoul(argv[5], NULL);
 				ret = ubi_volume_begin_write(argv[3],
-						(void *)addr, size, full_size);
+						buf, size, full_size);
 			}
 		} else {
-			ret = ubi_volume_write(argv[3], (void *)addr, 0, size);
+			ret = ubi_volume_write(argv[3], buf, 0, size);
 		}
+		unmap_sysmem(buf);
 		if (!ret) {
 			printf("%lld bytes written to volume %s\n", size,
 			       argv[3]);
@@ -870,7 +874,13 @@ static int do_ubi(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 		}
 
 		if (argc == 3) {
-			return ubi_volume_read(argv[3], (char *)addr, 0, size);
+			char *buf = map_sysmem(addr, size);
+			int ret;
+
+			ret = ubi_volume_read(argv[3], buf, 0, size);
+			unmap_sysmem(buf);
+
+			return ret;
 		}
 	}
 
@@ -212,6 +212,23 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+ulong bootstage_count(enum bootstage_id id, const char *name, ulong count)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_record *rec;
+
+	if (!data)
+		return 0;
+	rec = ensure_id(data, id);
+	if (!rec)
+		return 0;
+	rec->name = name;
+	rec->flags |= BOOTSTAGEF_COUNT;
+	rec->time_us += count;
+
+	return rec->time_us;
+}
+
 uint bootstage_get_rec_count(void)
 {
 	struct bootstage_data *data = gd->bootstage;
@@ -244,6 +261,7 @@ void bootstage_set_rec_count(uint count)
 	for (i = count; i < data->rec_count; i++) {
 		data->record[i].time_us = 0;
 		data->record[i].start_us = 0;
+		data->record[i].flags = 0;
 	}
 
 	data->rec_count = count;
@@ -348,8 +366,9 @@ static int add_bootstages_devicetree(struct fdt_header *blob)
 				       get_record_name(buf, sizeof(buf), rec)))
 			return -EINVAL;
 
-		/* Check if this is a 'mark' or 'accum' record */
+		/* Check if this is a 'mark', 'accum' or 'count' record */
 		if (fdt_setprop_cell(blob, node,
+				rec->flags & BOOTSTAGEF_COUNT ? "count" :
 				rec->start_us ? "accum" : "mark",
 				rec->time_us))
 			return -EINVAL;
@@ -371,6 +390,7 @@ void bootstage_report(void)
 {
 	struct bootstage_data *data = gd->bootstage;
 	struct bootstage_record *rec = data->record;
+	int counters = 0;
 	uint32_t prev;
 	int i;
 
@@ -381,7 +401,8 @@ void bootstage_report(void)
 	prev = print_time_record(rec, 0);
 
 	for (i = 1, rec++; i < data->rec_count; i++, rec++) {
-		if (rec->id && !rec->start_us)
+		if (rec->id && !rec->start_us &&
+		    !(rec->flags & BOOTSTAGEF_COUNT))
 			prev = print_time_record(rec, prev);
 	}
 	if (data->rec_count > RECORD_COUNT)
@@ -394,6 +415,18 @@ void bootstage_report(void)
 		if (rec->start_us)
 			prev = print_time_record(rec, -1);
 	}
+
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		char buf[20];
+
+		if (!(rec->flags & BOOTSTAGEF_COUNT))
+			continue;
+		if (!counters++)
+			puts("\nCounters:\n");
+		printf("%11s", "");
+		print_grouped_ull(rec->time_us, BOOTSTAGE_DIGITS);
+		printf("  %s\n", get_record_name(buf, sizeof(buf), rec));
+	}
 }
 
 /**
@@ -258,6 +258,30 @@ struct pipe {
 	reserved_style r_mode;		/* supports if, for, while, until */
 };
 
+#ifdef __U_BOOT__
+/*
+ * A script which has been parsed, kept so that running the same text again
+ * does not need to parse it again. Each parsed line is run in turn, just as
+ * parse_stream_outer() would do.
+ */
+struct parse_cache_ent {
+	struct parse_cache_ent *next;	/* most recently used is first */
+	unsigned int hash;		/* hash of @text, for quick lookup */
+	int flag;			/* parse flags (FLAG_...) */
+	char *text;			/* text of the script */
+	int users;			/* number of times it is being run */
+	int count;			/* number of lines in @lists */
+	struct pipe **lists;		/* parsed list for each line */
+	int bad;			/* a line could not be parsed */
+	int complete;			/* the whole of @text was parsed */
+};
+
+static struct parse_cache_ent *parse_cache;
+static int parse_cache_count;
+static unsigned long parse_cache_hits;		/* scripts found in the cache */
+static unsigned long parse_cache_misses;	/* scripts which were parsed */
+#endif
+
 #ifndef __U_BOOT__
 struct close_me {
 	int fd;
@@ -475,7 +499,12 @@ static int parse_string(o_string *dest, struct p_context *ctx, const char *src);
 #endif
 static int parse_stream(o_string *dest, struct p_context *ctx, struct in_str *input0, int end_trigger);
 /*   setup: */
+#ifndef __U_BOOT__
 static int parse_stream_outer(struct in_str *inp, int flag);
+#else
+static int parse_stream_outer(struct in_str *inp, int flag,
+			      struct parse_cache_ent *rec);
+#endif
 #ifndef __U_BOOT__
 static int parse_string_outer(const char *s, int flag);
 static int parse_file_outer(FILE *f);
@@ -1547,6 +1576,7 @@ static int run_pipe_real(struct pipe *pi)
 	int flag = do_repeat ? CMD_FLAG_REPEAT : 0;
 	struct child_prog *child;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1613,6 +1643,10 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+#ifdef __U_BOOT__
+		/* the parsed pipe may be run again, so leave it as it is */
+		sp = child->sp;
+#endif
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1621,11 +1655,19 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
+#ifndef __U_BOOT__
 				child->sp--;
+#else
+				sp--;
+#endif
 				free(p);
 			}
 		}
+#ifndef __U_BOOT__
 		if (child->sp) {
+#else
+		if (sp) {
+#endif
 			char * str = NULL;
 
 			str = make_string(child->argv + i,
@@ -1752,11 +1794,30 @@ static int run_pipe_real(struct pipe *pi)
 	return -1;
 }
 
+#ifdef __U_BOOT__
+/*
+ * Put back the variable name of a 'for' loop which is left before the end of
+ * its list, so that the parsed script can be run again
+ */
+static void restore_for_var(struct pipe *pi, char *name, char **save_list,
+			    char **list)
+{
+	while (*list)
+		free(*list++);
+	free(pi->progs->argv[0]);
+	free(save_list);
+	pi->progs->argv[0] = name;
+}
+#endif
+
 static int run_list_real(struct pipe *pi)
 {
 	char *save_name = NULL;
 	char **list = NULL;
 	char **save_list = NULL;
+#ifdef __U_BOOT__
+	struct pipe *for_pipe = NULL;
+#endif
 	struct pipe *rpipe;
 	int flag_rep = 0;
 #ifndef __U_BOOT__
@@ -1796,6 +1857,11 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
+					if (list)
+						restore_for_var(for_pipe,
+								save_name,
+								save_list,
+								list);
 					return 1;
 				}
 #endif
@@ -1825,6 +1891,9 @@ static int run_list_real(struct pipe *pi)
 				list = make_list_in(pi->next->progs->argv,
 					pi->progs->argv[0]);
 				save_list = list;
+#ifdef __U_BOOT__
+				for_pipe = pi;
+#endif
 				save_name = pi->progs->argv[0];
 				pi->progs->argv[0] = NULL;
 				flag_rep = 1;
@@ -1895,6 +1964,9 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
+			if (list)
+				restore_for_var(for_pipe, save_name, save_list,
+						list);
 			return -2;	/* exit */
 		}
 		last_return_code = rcode;
@@ -1915,6 +1987,10 @@ static int run_list_real(struct pipe *pi)
 		checkjobs(NULL);
 #endif
 	}
+#ifdef __U_BOOT__
+	if (list)
+		restore_for_var(for_pipe, save_name, save_list, list);
+#endif
 	return rcode;
 }
 
@@ -3172,7 +3248,13 @@ static void update_ifs_map(void)
 
 /* most recursion does not come through here, the exeception is
  * from builtin_source() */
+#ifndef __U_BOOT__
 static int parse_stream_outer(struct in_str *inp, int flag)
+#else
+/* if @rec is not NULL, the parsed lines are added to it rather than freed */
+static int parse_stream_outer(struct in_str *inp, int flag,
+			      struct parse_cache_ent *rec)
+#endif
 {
 
 	struct p_context ctx;
@@ -3204,7 +3286,15 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 #ifndef __U_BOOT__
 			run_list(ctx.list_head);
 #else
-			code = run_list(ctx.list_head);
+			if (rec) {
+				rec->lists = xrealloc(rec->lists,
+						      (rec->count + 1) *
+						      sizeof(struct pipe *));
+				rec->lists[rec->count++] = ctx.list_head;
+				code = run_list_real(ctx.list_head);
+			} else {
+				code = run_list(ctx.list_head);
+			}
 			if (code == -2) {	/* exit */
 				b_free(&temp);
 				code = 0;
@@ -3239,6 +3329,10 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 			temp.quote = 0;
 			inp->p = NULL;
 			free_pipe_list(ctx.list_head,0);
+#ifdef __U_BOOT__
+			if (rec)
+				rec->bad = 1;
+#endif
 		}
 		b_free(&temp);
 	/* loop on syntax errors, return on EOF */
@@ -3247,10 +3341,155 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 #ifndef __U_BOOT__
 	return 0;
 #else
+	if (rec && !rec->bad)
+		rec->complete = rcode == -1 || !b_peek(inp);
 	return (code != 0) ? 1 : 0;
 #endif /* __U_BOOT__ */
 }
 
+#ifdef __U_BOOT__
+static unsigned int parse_cache_hash(const char *s)
+{
+	unsigned int hash = 2166136261U;
+
+	/* FNV-1a */
+	while (*s)
+		hash = (hash ^ (unsigned char)*s++) * 16777619;
+
+	return hash;
+}
+
+static void parse_cache_free(struct parse_cache_ent *ent)
+{
+	int i;
+
+	for (i = 0; i < ent->count; i++)
+		free_pipe_list(ent->lists[i], 0);
+	free(ent->lists);
+	free(ent->text);
+	free(ent);
+}
+
+/* Find a parsed script which is not already being run, moving it to the front */
+static struct parse_cache_ent *parse_cache_find(const char *s, int flag,
+						unsigned int hash)
+{
+	struct parse_cache_ent **entp, *ent;
+
+	for (entp = &parse_cache; (ent = *entp); entp = &ent->next) {
+		if (ent->hash == hash && ent->flag == flag &&
+		    !strcmp(ent->text, s)) {
+			if (ent->users)
+				return NULL;
+			*entp = ent->next;
+			ent->next = parse_cache;
+			parse_cache = ent;
+			return ent;
+		}
+	}
+
+	return NULL;
+}
+
+/* Add a parsed script, dropping the least recently used one if needed */
+static void parse_cache_add(struct parse_cache_ent *ent)
+{
+	struct parse_cache_ent **entp, **lastp = NULL;
+
+	if (parse_cache_count == CONFIG_HUSH_CACHE) {
+		for (entp = &parse_cache; *entp; entp = &(*entp)->next) {
+			if (!(*entp)->users)
+				lastp = entp;
+		}
+		if (!lastp) {
+			/* everything is in use, so don't keep this one */
+			parse_cache_free(ent);
+			return;
+		}
+		ent->next = (*lastp)->next;
+		parse_cache_free(*lastp);
+		*lastp = ent->next;
+		parse_cache_count--;
+	}
+	ent->next = parse_cache;
+	parse_cache = ent;
+	parse_cache_count++;
+}
+
+/*
+ * Run each line of a parsed script in turn, handling the return codes in the
+ * same way as parse_stream_outer()
+ */
+static int parse_cache_run(struct parse_cache_ent *ent)
+{
+	int code = 1;
+	int i;
+
+	ent->users++;
+	for (i = 0; i < ent->count; i++) {
+		code = run_list_real(ent->lists[i]);
+		if (code == -2)
+			break;
+		if (code == -1)
+			flag_repeat = 0;
+	}
+	ent->users--;
+	if (code == -2)
+		return -2;
+
+	return (code != 0) ? 1 : 0;
+}
+
+/*
+ * Parse and run a string, using the parse cache if possible. Scripts are
+ * looked up by their text, so one which has changed (e.g. by 'setenv' of the
+ * variable holding it) is simply parsed again. The parser depends on $IFS, so
+ * the cache is not used if that is set. Nor is it used for text which is
+ * being parsed again after expansion, since that is unlikely to repeat and
+ * would push real scripts out of the cache.
+ */
+static int parse_string_cached(struct in_str *input, const char *s, int flag)
+{
+	struct parse_cache_ent *ent;
+	unsigned int hash;
+	int rcode;
+
+	if (!CONFIG_HUSH_CACHE || (flag & FLAG_REPARSING) || env_get("IFS"))
+		return parse_stream_outer(input, flag, NULL);
+
+	hash = parse_cache_hash(s);
+	ent = parse_cache_find(s, flag, hash);
+	if (ent) {
+		parse_cache_hits++;
+		return parse_cache_run(ent);
+	}
+
+	parse_cache_misses++;
+	ent = xmalloc(sizeof(*ent));
+	memset(ent, '\0', sizeof(*ent));
+	ent->hash = hash;
+	ent->flag = flag;
+	ent->users = 1;
+	rcode = parse_stream_outer(input, flag, ent);
+	ent->users = 0;
+	if (ent->complete) {
+		ent->text = xmalloc(strlen(s) + 1);
+		strcpy(ent->text, s);
+		parse_cache_add(ent);
+	} else {
+		parse_cache_free(ent);
+	}
+
+	return rcode;
+}
+
+void hush_cache_stats(unsigned long *hitsp, unsigned long *missesp)
+{
+	*hitsp = parse_cache_hits;
+	*missesp = parse_cache_misses;
+}
+#endif /* __U_BOOT__ */
+
 #ifndef __U_BOOT__
 static int parse_string_outer(const char *s, int flag)
 #else
@@ -3270,13 +3509,17 @@ int parse_string_outer(const char *s, int flag)
 		strcpy(p, s);
 		strcat(p, "\n");
 		setup_string_in_str(&input, p);
-		rcode = parse_stream_outer(&input, flag);
+		rcode = parse_string_cached(&input, s, flag);
 		free(p);
 		return rcode == -2 ? last_return_code : rcode;
 	} else {
 #endif
 	setup_string_in_str(&input, s);
+#ifndef __U_BOOT__
 	rcode = parse_stream_outer(&input, flag);
+#else
+	rcode = parse_string_cached(&input, s, flag);
+#endif
 	return rcode == -2 ? last_return_code : rcode;
 #ifdef __U_BOOT__
 	}
@@ -3296,7 +3539,11 @@ int parse_file_outer(void)
 #else
 	setup_file_in_str(&input);
 #endif
+#ifndef __U_BOOT__
 	rcode = parse_stream_outer(&input, FLAG_PARSE_SEMICOLON);
+#else
+	rcode = parse_stream_outer(&input, FLAG_PARSE_SEMICOLON, NULL);
+#endif
 	return rcode == -2 ? last_return_code : rcode;
 }
 
@@ -4,6 +4,7 @@
  * Written by Simon Glass <sjg@chromium.org>
  */
 
+#include <dma.h>
 #include <errno.h>
 #include <fpga.h>
 #include <gzip.h>
@@ -346,7 +347,8 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 			return -EIO;
 		}
 		length = loadEnd - CONFIG_SYS_LOAD_ADDR;
-	} else {
+	} else if (dma_bulk_copy(load_ptr, src, length)) {
+		/* DMA was not used, e.g. because the image is small */
 		memcpy(load_ptr, src, length);
 	}
 
@@ -60,6 +60,9 @@ struct usb_device_scan {
 
 static LIST_HEAD(usb_scan_list);
 
+/* true to leave the ports of newly configured hubs for a later scan */
+static bool usb_hub_defer;
+
 __weak void usb_hub_reset_devices(struct usb_hub_device *hub, int port)
 {
 	return;
@@ -876,6 +879,13 @@ static int usb_hub_configure(struct usb_device *dev)
 		list_add_tail(&usb_scan->list, &usb_scan_list);
 	}
 
+	/*
+	 * If the bus is only being started, leave the ports on the list so
+	 * that they are powered up while other work is done
+	 */
+	if (usb_hub_defer)
+		return 0;
+
 	/*
 	 * And now call the scanning code which loops over the generated list
 	 */
@@ -943,6 +953,26 @@ int usb_hub_scan(struct udevice *hub)
 	return usb_hub_configure(udev);
 }
 
+void usb_hub_set_defer(bool defer)
+{
+	usb_hub_defer = defer;
+}
+
+int usb_hub_scan_pending(void)
+{
+	return usb_device_list_scan();
+}
+
+void usb_hub_drop_pending(void)
+{
+	struct usb_device_scan *usb_scan, *tmp;
+
+	list_for_each_entry_safe(usb_scan, tmp, &usb_scan_list, list) {
+		list_del(&usb_scan->list);
+		free(usb_scan);
+	}
+}
+
 static int usb_hub_post_probe(struct udevice *dev)
 {
 	debug("%s\n", __func__);
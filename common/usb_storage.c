@@ -42,6 +42,7 @@
 #include <asm/byteorder.h>
 #include <asm/cache.h>
 #include <asm/processor.h>
+#include <asm/unaligned.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <linux/delay.h>
@@ -59,7 +60,7 @@
 static const unsigned char us_direction[256/8] = {
 	0x28, 0x81, 0x14, 0x14, 0x20, 0x01, 0x90, 0x77,
 	0x0C, 0x20, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01,
+	0x00, 0x01, 0x00, 0x40, 0x00, 0x01, 0x00, 0x01,
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 };
 #define US_DIRECTION(x) ((us_direction[x>>3] >> (x & 7)) & 1)
@@ -101,6 +102,7 @@ struct us_data {
 	trans_cmnd	transport;		/* transport routine */
 	unsigned short	max_xfer_blk;		/* maximum transfer blocks */
 	bool		cmd12;			/* use 12-byte commands (RBC/UFI) */
+	bool		cmd16;			/* use 16-byte READ/WRITE (> 2TiB) */
 };
 
 #if !CONFIG_IS_ENABLED(BLK)
@@ -974,6 +976,14 @@ static void usb_stor_set_max_xfer_blk(struct usb_device *udev,
 	 */
 	unsigned short blk = 240;
 
+	/*
+	 * USB 3 devices do not share this problem (Linux allows 2048 sectors)
+	 * and each command costs a full CBW/data/CSW round trip, so use much
+	 * larger transfers for them
+	 */
+	if (udev->speed >= USB_SPEED_SUPER)
+		blk = CONFIG_USB_STORAGE_SUPERSPEED_MAX_BLK;
+
 #if CONFIG_IS_ENABLED(DM_USB)
 	size_t size;
 	int ret;
@@ -1079,6 +1089,41 @@ static int usb_read_capacity(struct scsi_cmd *srb, struct us_data *ss)
 	return -1;
 }
 
+/*
+ * Devices with more than 2^32 blocks report 0xffffffff as the last block in
+ * READ CAPACITY(10) and must be asked again with READ CAPACITY(16)
+ */
+static int usb_read_capacity_16(struct scsi_cmd *srb, struct us_data *ss)
+{
+	int retry;
+
+	retry = 3;
+	do {
+		memset(&srb->cmd[0], 0, 16);
+		srb->cmd[0] = SCSI_RD_CAPAC16;
+		srb->cmd[1] = 0x10;	/* service action: READ CAPACITY(16) */
+		put_unaligned_be32(32, &srb->cmd[10]);
+		srb->datalen = 32;
+		srb->cmdlen = 16;
+		if (ss->transport(srb, ss) == USB_STOR_TRANSPORT_GOOD)
+			return 0;
+	} while (retry--);
+
+	return -1;
+}
+
+static int usb_rw_16(struct scsi_cmd *srb, struct us_data *ss, uint cmd,
+		     lbaint_t start, unsigned short blocks)
+{
+	memset(&srb->cmd[0], 0, 16);
+	srb->cmd[0] = cmd;
+	put_unaligned_be64(start, &srb->cmd[2]);
+	put_unaligned_be32(blocks, &srb->cmd[10]);
+	srb->cmdlen = 16;
+	debug("rw16 %02x: start " LBAF " blocks %x\n", cmd, start, blocks);
+	return ss->transport(srb, ss);
+}
+
 static int usb_read_10(struct scsi_cmd *srb, struct us_data *ss,
 		       unsigned long start, unsigned short blocks)
 {
@@ -1195,7 +1240,9 @@ retry_it:
 			usb_show_progress();
 		srb->datalen = block_dev->blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (usb_read_10(srb, ss, start, smallblks)) {
+		if (ss->cmd16 ?
+		    usb_rw_16(srb, ss, SCSI_READ16, start, smallblks) :
+		    usb_read_10(srb, ss, start, smallblks)) {
 			debug("Read ERROR\n");
 			ss->flags &= ~USB_READY;
 			usb_request_sense(srb, ss);
@@ -1282,7 +1329,9 @@ retry_it:
 			usb_show_progress();
 		srb->datalen = block_dev->blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (usb_write_10(srb, ss, start, smallblks)) {
+		if (ss->cmd16 ?
+		    usb_rw_16(srb, ss, SCSI_WRITE16, start, smallblks) :
+		    usb_write_10(srb, ss, start, smallblks)) {
 			debug("Write ERROR\n");
 			ss->flags &= ~USB_READY;
 			usb_request_sense(srb, ss);
@@ -1439,9 +1488,10 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 		      struct blk_desc *dev_desc)
 {
 	unsigned char perq, modi;
-	ALLOC_CACHE_ALIGN_BUFFER(u32, cap, 2);
+	ALLOC_CACHE_ALIGN_BUFFER(u32, cap, 8);
 	ALLOC_CACHE_ALIGN_BUFFER(u8, usb_stor_buf, 36);
-	u32 capacity, blksz;
+	lbaint_t capacity;
+	u32 blksz;
 	struct scsi_cmd *pccb = &usb_ccb;
 
 	pccb->pdata = usb_stor_buf;
@@ -1511,7 +1561,20 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 	capacity = be32_to_cpu(cap[0]) + 1;
 	blksz = be32_to_cpu(cap[1]);
 
-	debug("Capacity = 0x%08x, blocksz = 0x%08x\n", capacity, blksz);
+	ss->cmd16 = false;
+	if (IS_ENABLED(CONFIG_SYS_64BIT_LBA) && !ss->cmd12 &&
+	    be32_to_cpu(cap[0]) == 0xffffffff) {
+		memset(pccb->pdata, 0, 32);
+		if (usb_read_capacity_16(pccb, ss)) {
+			printf("READ_CAP(16) ERROR, using first 2TiB\n");
+		} else {
+			capacity = get_unaligned_be64(&cap[0]) + 1;
+			blksz = be32_to_cpu(cap[2]);
+			ss->cmd16 = true;
+		}
+	}
+
+	debug("Capacity = " LBAF ", blocksz = 0x%08x\n", capacity, blksz);
 	dev_desc->lba = capacity;
 	dev_desc->blksz = blksz;
 	dev_desc->log2blksz = LOG2(dev_desc->blksz);
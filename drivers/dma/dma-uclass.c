@@ -22,6 +22,7 @@
 #include <dt-structs.h>
 #include <errno.h>
 #include <linux/printk.h>
+#include <vsprintf.h>
 
 #ifdef CONFIG_DMA_CHANNELS
 static inline struct dma_ops *dma_dev_ops(struct udevice *dev)
@@ -260,6 +261,62 @@ int dma_memcpy(void *dst, void *src, size_t len)
 	return ret;
 }
 
+#if CONFIG_IS_ENABLED(DMA_BULK_COPY)
+int dma_bulk_copy(void *dst, const void *src, size_t len)
+{
+	ulong start = (ulong)dst, end = start + len;
+	dma_addr_t dst_addr, src_addr;
+	const struct dma_ops *ops;
+	struct udevice *dev;
+	size_t head, tail;
+	int ret;
+
+	if (len < max_t(size_t, CONFIG_DMA_BULK_COPY_MIN, 2 * ARCH_DMA_MINALIGN))
+		return -E2BIG;
+	if ((ulong)src < end && start < (ulong)src + len)
+		return -EINVAL;
+
+	ret = dma_get_device(DMA_SUPPORTS_MEM_TO_MEM, &dev);
+	if (ret)
+		return -ENOENT;
+	ops = device_get_ops(dev);
+	if (!ops->transfer)
+		return -ENOSYS;
+
+	/*
+	 * Only whole cache lines of the destination can be invalidated, so
+	 * leave the partial lines at each end for the CPU
+	 */
+	head = ALIGN(start, ARCH_DMA_MINALIGN) - start;
+	tail = end - ALIGN_DOWN(end, ARCH_DMA_MINALIGN);
+	dst_addr = dma_map_single(dst + head, len - head - tail,
+				  DMA_FROM_DEVICE);
+	src_addr = dma_map_single((void *)src + head, len - head - tail,
+				  DMA_TO_DEVICE);
+	ret = ops->transfer(dev, DMA_MEM_TO_MEM, dst_addr, src_addr,
+			    len - head - tail);
+	dma_unmap_single(dst_addr, len - head - tail, DMA_FROM_DEVICE);
+	dma_unmap_single(src_addr, len - head - tail, DMA_TO_DEVICE);
+
+	/*
+	 * The engine may still be writing to the destination, and there is no
+	 * way to stop it, so the CPU cannot safely take over the copy
+	 */
+	if (ret == -ETIMEDOUT)
+		panic("DMA copy to %p timed out\n", dst);
+	if (ret) {
+		log_debug("DMA copy failed (err=%dE)\n", ret);
+		return ret;
+	}
+
+	/* the ends do not share a cache line with the transfer */
+	memcpy(dst, src, head);
+	memcpy(dst + len - tail, src + len - tail, tail);
+
+	return 0;
+}
+#endif /* DMA_BULK_COPY */
+
 UCLASS_DRIVER(dma) = {
 	.id		= UCLASS_DMA,
 	.name		= "dma",
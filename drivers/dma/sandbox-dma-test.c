@@ -10,6 +10,7 @@
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
+#include <asm/test.h>
 #include <dm/read.h>
 #include <dma-uclass.h>
 #include <dt-structs.h>
@@ -36,12 +37,19 @@ struct sandbox_dma_dev {
 	uchar	*buf_rx;
 	size_t	data_len;
 	u32	meta;
+	bool	xfer_fail;
+	ulong	copied;
 };
 
 static int sandbox_dma_transfer(struct udevice *dev, int direction,
 				dma_addr_t dst, dma_addr_t src, size_t len)
 {
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	if (ud->xfer_fail)
+		return -EIO;
 	memcpy((void *)dst, (void *)src, len);
+	ud->copied += len;
 
 	return 0;
 }
@@ -227,6 +235,20 @@ static int sandbox_dma_prepare_rcv_buf(struct dma *dma, void *dst, size_t size)
 	return 0;
 }
 
+void sandbox_dma_set_fail(struct udevice *dev, bool fail)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	ud->xfer_fail = fail;
+}
+
+ulong sandbox_dma_get_copied(struct udevice *dev)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	return ud->copied;
+}
+
 static const struct dma_ops sandbox_dma_ops = {
 	.transfer	= sandbox_dma_transfer,
 	.of_xlate	= sandbox_dma_of_xlate,
@@ -254,7 +276,7 @@ static int sandbox_dma_probe(struct udevice *dev)
 	ud->meta = 0;
 	ud->data_len = 0;
 
-	pr_err("Number of channels: %u\n", ud->ch_count);
+	pr_debug("Number of channels: %u\n", ud->ch_count);
 
 	for (i = 0; i < ud->ch_count; i++) {
 		struct sandbox_dma_chan *uc = &ud->channels[i];
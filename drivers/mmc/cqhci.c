@@ -0,0 +1,343 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * eMMC Command Queue Host Controller Interface (CQHCI)
+ *
+ * This drives the command queue engine found alongside many SDHCI
+ * controllers. U-Boot has no interrupts, so completions are polled, but a
+ * large transfer is still split into many tasks which are all queued on the
+ * card at once. This lets the card fetch the data for one task while the
+ * controller is transferring another, which is where the speed-up comes from.
+ */
+
+#define LOG_CATEGORY UCLASS_MMC
+
+#include <cpu_func.h>
+#include <cqhci.h>
+#include <log.h>
+#include <malloc.h>
+#include <mmc.h>
+#include <phys2bus.h>
+#include <time.h>
+#include <asm/cache.h>
+#include <asm/io.h>
+#include <asm/unaligned.h>
+#include <linux/dma-mapping.h>
+#include <linux/iopoll.h>
+
+/* Maximum time to wait for the next task to complete */
+#define CQHCI_TASK_TIMEOUT_US	(1000 * 1000)
+#define CQHCI_HALT_TIMEOUT_US	(10 * 1000)
+
+static inline u32 cqhci_readl(struct cqhci_host *cq_host, int reg)
+{
+	return readl(cq_host->mmio + reg);
+}
+
+static inline void cqhci_writel(struct cqhci_host *cq_host, u32 val, int reg)
+{
+	writel(val, cq_host->mmio + reg);
+}
+
+static u8 *get_desc(struct cqhci_host *cq_host, int tag)
+{
+	return cq_host->desc_base + tag * cq_host->slot_sz;
+}
+
+static u8 *get_trans_desc(struct cqhci_host *cq_host, int tag)
+{
+	return cq_host->trans_desc_base +
+		tag * CQHCI_MAX_SEGS * cq_host->trans_desc_len;
+}
+
+static dma_addr_t cqhci_bus_addr(struct cqhci_host *cq_host, void *ptr)
+{
+	return dev_phys_to_bus(cq_host->mmc->dev, virt_to_phys(ptr));
+}
+
+/* Write the address part of a link or transfer descriptor */
+static void cqhci_set_desc_addr(struct cqhci_host *cq_host, u8 *desc,
+				dma_addr_t addr)
+{
+	if (cq_host->dma64)
+		put_unaligned_le64(addr, desc + 4);
+	else
+		put_unaligned_le32(addr, desc + 4);
+}
+
+static void cqhci_setup_link_desc(struct cqhci_host *cq_host, int tag)
+{
+	u8 *link = get_desc(cq_host, tag) + cq_host->task_desc_len;
+
+	memset(link, '\0', cq_host->link_desc_len);
+	put_unaligned_le32(CQHCI_VALID(1) | CQHCI_ACT(CQHCI_ACT_LINK), link);
+	cqhci_set_desc_addr(cq_host, link,
+			    cqhci_bus_addr(cq_host,
+					   get_trans_desc(cq_host, tag)));
+}
+
+static int cqhci_alloc(struct cqhci_host *cq_host)
+{
+	size_t desc_size, trans_size;
+	int tag;
+
+	if (cq_host->caps & CQHCI_TASK_DESC_SZ_128)
+		cq_host->task_desc_len = 16;
+	else
+		cq_host->task_desc_len = 8;
+	if (cq_host->dma64) {
+		cq_host->trans_desc_len = 16;
+		cq_host->link_desc_len = 16;
+	} else {
+		cq_host->trans_desc_len = 8;
+		cq_host->link_desc_len = 8;
+	}
+	cq_host->slot_sz = cq_host->task_desc_len + cq_host->link_desc_len;
+
+	desc_size = ALIGN(cq_host->slot_sz * CQHCI_NUM_SLOTS,
+			  ARCH_DMA_MINALIGN);
+	trans_size = ALIGN(cq_host->trans_desc_len * CQHCI_MAX_SEGS *
+			   CQHCI_NUM_SLOTS, ARCH_DMA_MINALIGN);
+	cq_host->desc_base = memalign(ARCH_DMA_MINALIGN, desc_size);
+	cq_host->trans_desc_base = memalign(ARCH_DMA_MINALIGN, trans_size);
+	if (!cq_host->desc_base || !cq_host->trans_desc_base) {
+		free(cq_host->desc_base);
+		free(cq_host->trans_desc_base);
+		cq_host->desc_base = NULL;
+		cq_host->trans_desc_base = NULL;
+		return -ENOMEM;
+	}
+	memset(cq_host->desc_base, '\0', desc_size);
+	memset(cq_host->trans_desc_base, '\0', trans_size);
+
+	/* each slot links to its own, fixed, list of transfer descriptors */
+	for (tag = 0; tag < CQHCI_NUM_SLOTS; tag++)
+		cqhci_setup_link_desc(cq_host, tag);
+	flush_dcache_range((ulong)cq_host->desc_base,
+			   (ulong)cq_host->desc_base + desc_size);
+
+	return 0;
+}
+
+int cqhci_init(struct cqhci_host *cq_host, struct mmc *mmc, bool dma64)
+{
+	int ret;
+
+	cq_host->mmc = mmc;
+	cq_host->dma64 = dma64;
+	cq_host->enabled = false;
+
+	ret = cqhci_alloc(cq_host);
+	if (ret)
+		return ret;
+	log_debug("CQHCI version %x, %d-bit DMA\n",
+		  cqhci_readl(cq_host, CQHCI_VER), dma64 ? 64 : 32);
+
+	return 0;
+}
+
+static int cqhci_halt(struct cqhci_host *cq_host)
+{
+	u32 ctl;
+
+	cqhci_writel(cq_host, cqhci_readl(cq_host, CQHCI_CTL) | CQHCI_HALT,
+		     CQHCI_CTL);
+
+	return readl_poll_timeout(cq_host->mmio + CQHCI_CTL, ctl,
+				  ctl & CQHCI_HALT, CQHCI_HALT_TIMEOUT_US);
+}
+
+static void cqhci_clear_all_tasks(struct cqhci_host *cq_host)
+{
+	u32 ctl;
+
+	cqhci_writel(cq_host, cqhci_readl(cq_host, CQHCI_CTL) |
+		     CQHCI_CLEAR_ALL_TASKS, CQHCI_CTL);
+	if (readl_poll_timeout(cq_host->mmio + CQHCI_CTL, ctl,
+			       !(ctl & CQHCI_CLEAR_ALL_TASKS),
+			       CQHCI_HALT_TIMEOUT_US))
+		log_warning("CQHCI: failed to clear tasks\n");
+}
+
+int cqhci_enable(struct cqhci_host *cq_host)
+{
+	dma_addr_t desc_dma;
+	u32 cqcfg;
+
+	if (!cq_host->desc_base)
+		return -ENOMEM;
+
+	cqcfg = cqhci_readl(cq_host, CQHCI_CFG);
+	if (cqcfg & CQHCI_ENABLE) {
+		cqcfg &= ~CQHCI_ENABLE;
+		cqhci_writel(cq_host, cqcfg, CQHCI_CFG);
+	}
+
+	/* direct commands (DCMD) are not used; slot 31 is a normal task */
+	cqcfg &= ~(CQHCI_DCMD | CQHCI_TASK_DESC_SZ);
+	if (cq_host->task_desc_len == 16)
+		cqcfg |= CQHCI_TASK_DESC_SZ;
+	cqhci_writel(cq_host, cqcfg, CQHCI_CFG);
+
+	desc_dma = cqhci_bus_addr(cq_host, cq_host->desc_base);
+	cqhci_writel(cq_host, lower_32_bits(desc_dma), CQHCI_TDLBA);
+	cqhci_writel(cq_host, upper_32_bits(desc_dma), CQHCI_TDLBAU);
+	cqhci_writel(cq_host, cq_host->mmc->rca, CQHCI_SSC2);
+
+	/* completions are polled, so latch status but never signal it */
+	cqhci_writel(cq_host, CQHCI_IS_MASK, CQHCI_ISTE);
+	cqhci_writel(cq_host, 0, CQHCI_ISGE);
+	cqhci_writel(cq_host, cqhci_readl(cq_host, CQHCI_IS), CQHCI_IS);
+
+	cqcfg |= CQHCI_ENABLE;
+	cqhci_writel(cq_host, cqcfg, CQHCI_CFG);
+	if (cqhci_readl(cq_host, CQHCI_CTL) & CQHCI_HALT)
+		cqhci_writel(cq_host, 0, CQHCI_CTL);
+	cq_host->enabled = true;
+
+	return 0;
+}
+
+void cqhci_disable(struct cqhci_host *cq_host)
+{
+	if (!cq_host->enabled)
+		return;
+
+	if (cqhci_halt(cq_host))
+		log_warning("CQHCI: failed to halt\n");
+	cqhci_writel(cq_host, 0, CQHCI_ISTE);
+	cqhci_writel(cq_host, cqhci_readl(cq_host, CQHCI_CFG) & ~CQHCI_ENABLE,
+		     CQHCI_CFG);
+	cq_host->enabled = false;
+}
+
+/* Fill in the task and transfer descriptors for one slot */
+static void cqhci_prep_task(struct cqhci_host *cq_host, int tag, bool read,
+			    lbaint_t blk, uint blocks, dma_addr_t addr,
+			    uint len)
+{
+	u8 *desc = get_desc(cq_host, tag);
+	u8 *trans = get_trans_desc(cq_host, tag);
+	u8 *end = trans;
+	u64 task;
+
+	task = CQHCI_VALID(1) | CQHCI_END(1) | CQHCI_INT(1) |
+		CQHCI_ACT(CQHCI_ACT_TASK) | CQHCI_DATA_DIR(read) |
+		CQHCI_BLK_COUNT(blocks) | CQHCI_BLK_ADDR((u64)blk);
+	memset(desc, '\0', cq_host->task_desc_len);
+	put_unaligned_le64(task, desc);
+
+	while (len) {
+		uint seg = min_t(uint, len, CQHCI_SEG_LEN);
+
+		len -= seg;
+		memset(end, '\0', cq_host->trans_desc_len);
+		put_unaligned_le32(CQHCI_VALID(1) | CQHCI_END(!len) |
+				   CQHCI_ACT(CQHCI_ACT_TRAN) |
+				   CQHCI_DAT_LENGTH(seg), end);
+		cqhci_set_desc_addr(cq_host, end, addr);
+		addr += seg;
+		end += cq_host->trans_desc_len;
+	}
+
+	flush_dcache_range(rounddown((ulong)desc, ARCH_DMA_MINALIGN),
+			   roundup((ulong)desc + cq_host->slot_sz,
+				   ARCH_DMA_MINALIGN));
+	flush_dcache_range((ulong)trans, roundup((ulong)end,
+						 ARCH_DMA_MINALIGN));
+	cq_host->slot_blocks[tag] = blocks;
+}
+
+/* Recover after an error: discard all tasks so legacy commands work */
+static void cqhci_recover(struct cqhci_host *cq_host)
+{
+	if (cqhci_halt(cq_host))
+		log_warning("CQHCI: failed to halt for recovery\n");
+	cqhci_clear_all_tasks(cq_host);
+	cqhci_writel(cq_host, cqhci_readl(cq_host, CQHCI_TCN), CQHCI_TCN);
+	cqhci_writel(cq_host, cqhci_readl(cq_host, CQHCI_IS), CQHCI_IS);
+	cqhci_writel(cq_host, 0, CQHCI_CTL);
+}
+
+int cqhci_rw(struct cqhci_host *cq_host, struct mmc_data *data,
+	     lbaint_t start)
+{
+	bool read = data->flags & MMC_DATA_READ;
+	void *buf = read ? data->dest : (void *)data->src;
+	uint max_blocks = CQHCI_MAX_SEGS * CQHCI_SEG_LEN / data->blocksize;
+	uint depth = min_t(uint, cq_host->mmc->cmdq_depth, CQHCI_NUM_SLOTS);
+	uint total = data->blocks, queued = 0, done = 0;
+	u32 free_mask, pending = 0;
+	ulong len = (ulong)total * data->blocksize;
+	dma_addr_t addr, bus_addr;
+	ulong start_us;
+	int ret = 0;
+
+	if (!cq_host->enabled)
+		return -EPERM;
+	free_mask = depth < 32 ? BIT(depth) - 1 : ~0U;
+
+	addr = dma_map_single(buf, len, mmc_get_dma_dir(data));
+	bus_addr = cqhci_bus_addr(cq_host, buf);
+
+	start_us = timer_get_us();
+	while (done < total) {
+		u32 ring = 0, is, tcn;
+
+		/* queue as many tasks as there are free slots */
+		while (queued < total && (free_mask & ~pending)) {
+			int tag = ffs(free_mask & ~pending) - 1;
+			uint blocks = min(max_blocks, total - queued);
+
+			cqhci_prep_task(cq_host, tag, read, start + queued,
+					blocks,
+					bus_addr + (ulong)queued *
+					data->blocksize,
+					blocks * data->blocksize);
+			pending |= BIT(tag);
+			ring |= BIT(tag);
+			queued += blocks;
+		}
+		if (ring)
+			cqhci_writel(cq_host, ring, CQHCI_TDBR);
+
+		is = cqhci_readl(cq_host, CQHCI_IS);
+		if (is & CQHCI_IS_ERROR) {
+			log_debug("CQHCI: error status %x, task error %x\n", is,
+				  cqhci_readl(cq_host, CQHCI_TERRI));
+			ret = -EIO;
+			break;
+		}
+		if (cq_host->ops && cq_host->ops->get_error) {
+			ret = cq_host->ops->get_error(cq_host);
+			if (ret)
+				break;
+		}
+
+		tcn = cqhci_readl(cq_host, CQHCI_TCN) & pending;
+		if (!tcn) {
+			if (timer_get_us() - start_us > CQHCI_TASK_TIMEOUT_US) {
+				log_debug("CQHCI: timeout, pending %x\n",
+					  pending);
+				ret = -ETIMEDOUT;
+				break;
+			}
+			continue;
+		}
+		cqhci_writel(cq_host, tcn, CQHCI_TCN);
+		cqhci_writel(cq_host, is & CQHCI_IS_TCC, CQHCI_IS);
+		pending &= ~tcn;
+		while (tcn) {
+			int tag = ffs(tcn) - 1;
+
+			done += cq_host->slot_blocks[tag];
+			tcn &= ~BIT(tag);
+		}
+		start_us = timer_get_us();
+	}
+
+	if (ret)
+		cqhci_recover(cq_host);
+	dma_unmap_single(addr, len, mmc_get_dma_dir(data));
+
+	return ret;
+}
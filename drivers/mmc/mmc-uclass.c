@@ -40,6 +40,10 @@ static int dm_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 	struct dm_mmc_ops *ops = mmc_get_ops(dev);
 	int ret;
 
+	/* the command queue engine owns the bus while it is enabled */
+	if (mmc_cqe_is_on(mmc))
+		mmc_cqe_exit(mmc);
+
 	mmmc_trace_before_send(mmc, cmd);
 	if (ops->send_cmd)
 		ret = ops->send_cmd(dev, cmd, data);
@@ -55,6 +59,51 @@ int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd, struct mmc_data *data)
 	return dm_mmc_send_cmd(mmc->dev, cmd, data);
 }
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+static int dm_mmc_cqe_enable(struct udevice *dev)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+
+	if (!ops->cqe_enable)
+		return -ENOSYS;
+	return ops->cqe_enable(dev);
+}
+
+int mmc_cqe_enable(struct mmc *mmc)
+{
+	return dm_mmc_cqe_enable(mmc->dev);
+}
+
+static int dm_mmc_cqe_disable(struct udevice *dev)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+
+	if (!ops->cqe_disable)
+		return -ENOSYS;
+	return ops->cqe_disable(dev);
+}
+
+int mmc_cqe_disable(struct mmc *mmc)
+{
+	return dm_mmc_cqe_disable(mmc->dev);
+}
+
+static int dm_mmc_cqe_rw(struct udevice *dev, struct mmc_data *data,
+			 lbaint_t start)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+
+	if (!ops->cqe_rw)
+		return -ENOSYS;
+	return ops->cqe_rw(dev, data, start);
+}
+
+int mmc_cqe_rw(struct mmc *mmc, struct mmc_data *data, lbaint_t start)
+{
+	return dm_mmc_cqe_rw(mmc->dev, data, start);
+}
+#endif
+
 static int dm_mmc_set_ios(struct udevice *dev)
 {
 	struct dm_mmc_ops *ops = mmc_get_ops(dev);
@@ -131,6 +180,34 @@ int mmc_execute_tuning(struct mmc *mmc, uint opcode)
 
 	return ret;
 }
+
+static int dm_mmc_get_tuning(struct udevice *dev, u32 *tuningp)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+
+	if (!ops->get_tuning)
+		return -ENOSYS;
+	return ops->get_tuning(dev, tuningp);
+}
+
+int mmc_get_tuning(struct mmc *mmc, u32 *tuningp)
+{
+	return dm_mmc_get_tuning(mmc->dev, tuningp);
+}
+
+static int dm_mmc_set_tuning(struct udevice *dev, u32 tuning)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+
+	if (!ops->set_tuning)
+		return -ENOSYS;
+	return ops->set_tuning(dev, tuning);
+}
+
+int mmc_set_tuning(struct mmc *mmc, u32 tuning)
+{
+	return dm_mmc_set_tuning(mmc->dev, tuning);
+}
 #endif
 
 #if CONFIG_IS_ENABLED(MMC_HS400_ES_SUPPORT)
@@ -265,6 +342,9 @@ int mmc_of_parse(struct udevice *dev, struct mmc_config *cfg)
 		cfg->host_caps &= ~(MMC_CAP(MMC_HS_400) |
 				    MMC_CAP(MMC_HS_400_ES));
 
+	if (dev_read_bool(dev, "supports-cqe"))
+		cfg->host_caps |= MMC_CAP_CQE;
+
 	if (dev_read_bool(dev, "non-removable")) {
 		cfg->host_caps |= MMC_CAP_NONREMOVABLE;
 	} else {
@@ -9,6 +9,8 @@
 
 #include <config.h>
 #include <blk.h>
+#include <bloblist.h>
+#include <bootstage.h>
 #include <command.h>
 #include <dm.h>
 #include <log.h>
@@ -18,8 +20,10 @@
 #include <part.h>
 #include <time.h>
 #include <linux/bitops.h>
+#include <linux/bug.h>
 #include <linux/delay.h>
 #include <linux/printk.h>
+#include <spl.h>
 #include <power/regulator.h>
 #include <malloc.h>
 #include <memalign.h>
@@ -478,6 +482,15 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 	data.blocksize = mmc->read_bl_len;
 	data.flags = MMC_DATA_READ;
 
+	if (mmc_cqe_is_on(mmc)) {
+		if (mmc_cqe_rw(mmc, &data, start)) {
+			pr_debug("%s: command queue read failed\n", __func__);
+			mmc_cqe_exit(mmc);
+			return 0;
+		}
+		return blkcnt;
+	}
+
 	if (mmc_send_cmd(mmc, &cmd, &data))
 		return 0;
 
@@ -541,7 +554,8 @@ ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 		return 0;
 	}
 
-	if (mmc_set_blocklen(mmc, mmc->read_bl_len)) {
+	/* with the command queue the block length is always 512 bytes */
+	if (mmc_cqe_enter(mmc) && mmc_set_blocklen(mmc, mmc->read_bl_len)) {
 		pr_debug("%s: Failed to set blocklen\n", __func__);
 		return 0;
 	}
@@ -914,6 +928,52 @@ int mmc_switch(struct mmc *mmc, u8 set, u8 index, u8 value)
 	return __mmc_switch(mmc, set, index, value, true);
 }
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+int mmc_cqe_enter(struct mmc *mmc)
+{
+	int ret;
+
+	if (mmc->cqe_on)
+		return 0;
+	if (!mmc->cmdq_depth || !(mmc->host_caps & MMC_CAP_CQE) ||
+	    !mmc->high_capacity)
+		return -ENOSYS;
+
+	ret = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_CMDQ_MODE_EN, 1);
+	if (ret)
+		return ret;
+
+	ret = mmc_cqe_enable(mmc);
+	if (ret) {
+		/* don't try again; the legacy path still works */
+		log_debug("Cannot enable command queue (err=%d)\n", ret);
+		mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_CMDQ_MODE_EN, 0);
+		mmc->cmdq_depth = 0;
+		return ret;
+	}
+	mmc->cqe_on = true;
+
+	return 0;
+}
+
+void mmc_cqe_exit(struct mmc *mmc)
+{
+	int ret;
+
+	if (!mmc->cqe_on)
+		return;
+
+	/* clear this first, so that the switch goes out as a legacy command */
+	mmc->cqe_on = false;
+	ret = mmc_cqe_disable(mmc);
+	if (!ret)
+		ret = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL,
+				 EXT_CSD_CMDQ_MODE_EN, 0);
+	if (ret)
+		log_debug("Cannot disable command queue (err=%d)\n", ret);
+}
+#endif
+
 int mmc_boot_wp(struct mmc *mmc)
 {
 	return mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_BOOT_WP, 1);
@@ -2502,6 +2562,13 @@ static int mmc_startup_v4(struct mmc *mmc)
 
 	mmc->wr_rel_set = ext_csd[EXT_CSD_WR_REL_SET];
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	mmc->cmdq_depth = 0;
+	if (mmc->version >= MMC_VERSION_5_1 &&
+	    (ext_csd[EXT_CSD_CMDQ_SUPPORT] & 1))
+		mmc->cmdq_depth = (ext_csd[EXT_CSD_CMDQ_DEPTH] & 0x1f) + 1;
+#endif
+
 	mmc->can_trim =
 		!!(ext_csd[EXT_CSD_SEC_FEATURE] & EXT_CSD_SEC_FEATURE_TRIM_EN);
 
@@ -2516,73 +2583,15 @@ error:
 	return err;
 }
 
-static int mmc_startup(struct mmc *mmc)
+/* Work out the version, speed, block size and capacity from the CSD */
+static void mmc_decode_csd(struct mmc *mmc)
 {
-	int err, i;
 	uint mult, freq;
 	u64 cmult, csize;
-	struct mmc_cmd cmd;
-	struct blk_desc *bdesc;
-
-#ifdef CONFIG_MMC_SPI_CRC_ON
-	if (mmc_host_is_spi(mmc)) { /* enable CRC check for spi */
-		cmd.cmdidx = MMC_CMD_SPI_CRC_ON_OFF;
-		cmd.resp_type = MMC_RSP_R1;
-		cmd.cmdarg = 1;
-		err = mmc_send_cmd(mmc, &cmd, NULL);
-		if (err)
-			return err;
-	}
-#endif
-
-	/* Put the Card in Identify Mode */
-	cmd.cmdidx = mmc_host_is_spi(mmc) ? MMC_CMD_SEND_CID :
-		MMC_CMD_ALL_SEND_CID; /* cmd not supported in spi */
-	cmd.resp_type = MMC_RSP_R2;
-	cmd.cmdarg = 0;
-
-	err = mmc_send_cmd_quirks(mmc, &cmd, NULL, MMC_QUIRK_RETRY_SEND_CID, 4);
-	if (err)
-		return err;
-
-	memcpy(mmc->cid, cmd.response, 16);
-
-	/*
-	 * For MMC cards, set the Relative Address.
-	 * For SD cards, get the Relatvie Address.
-	 * This also puts the cards into Standby State
-	 */
-	if (!mmc_host_is_spi(mmc)) { /* cmd not supported in spi */
-		cmd.cmdidx = SD_CMD_SEND_RELATIVE_ADDR;
-		cmd.cmdarg = mmc->rca << 16;
-		cmd.resp_type = MMC_RSP_R6;
-
-		err = mmc_send_cmd(mmc, &cmd, NULL);
-
-		if (err)
-			return err;
-
-		if (IS_SD(mmc))
-			mmc->rca = (cmd.response[0] >> 16) & 0xffff;
-	}
-
-	/* Get the Card-Specific Data */
-	cmd.cmdidx = MMC_CMD_SEND_CSD;
-	cmd.resp_type = MMC_RSP_R2;
-	cmd.cmdarg = mmc->rca << 16;
-
-	err = mmc_send_cmd(mmc, &cmd, NULL);
-
-	if (err)
-		return err;
-
-	mmc->csd[0] = cmd.response[0];
-	mmc->csd[1] = cmd.response[1];
-	mmc->csd[2] = cmd.response[2];
-	mmc->csd[3] = cmd.response[3];
+	int i;
 
 	if (mmc->version == MMC_VERSION_UNKNOWN) {
-		int version = (cmd.response[0] >> 26) & 0xf;
+		int version = (mmc->csd[0] >> 26) & 0xf;
 
 		switch (version) {
 		case 0:
@@ -2607,22 +2616,22 @@ static int mmc_startup(struct mmc *mmc)
 	}
 
 	/* divide frequency by 10, since the mults are 10x bigger */
-	freq = fbase[(cmd.response[0] & 0x7)];
-	mult = multipliers[((cmd.response[0] >> 3) & 0xf)];
+	freq = fbase[(mmc->csd[0] & 0x7)];
+	mult = multipliers[((mmc->csd[0] >> 3) & 0xf)];
 
 	mmc->legacy_speed = freq * mult;
 	if (!mmc->legacy_speed)
 		log_debug("TRAN_SPEED: reserved value");
 	mmc_select_mode(mmc, MMC_LEGACY);
 
-	mmc->dsr_imp = ((cmd.response[1] >> 12) & 0x1);
-	mmc->read_bl_len = 1 << ((cmd.response[1] >> 16) & 0xf);
+	mmc->dsr_imp = ((mmc->csd[1] >> 12) & 0x1);
+	mmc->read_bl_len = 1 << ((mmc->csd[1] >> 16) & 0xf);
 #if CONFIG_IS_ENABLED(MMC_WRITE)
 
 	if (IS_SD(mmc))
 		mmc->write_bl_len = mmc->read_bl_len;
 	else
-		mmc->write_bl_len = 1 << ((cmd.response[3] >> 22) & 0xf);
+		mmc->write_bl_len = 1 << ((mmc->csd[3] >> 22) & 0xf);
 #endif
 
 	if (mmc->high_capacity) {
@@ -2649,6 +2658,114 @@ static int mmc_startup(struct mmc *mmc)
 	if (mmc->write_bl_len > MMC_MAX_BLOCK_LEN)
 		mmc->write_bl_len = MMC_MAX_BLOCK_LEN;
 #endif
+}
+
+/* Set up the block device, once the card is ready for data transfer */
+static void mmc_setup_blk_desc(struct mmc *mmc)
+{
+	struct blk_desc *bdesc;
+
+	/* Fix the block length for DDR mode */
+	if (mmc->ddr_mode) {
+		mmc->read_bl_len = MMC_MAX_BLOCK_LEN;
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+		mmc->write_bl_len = MMC_MAX_BLOCK_LEN;
+#endif
+	}
+
+	/* fill in device description */
+	bdesc = mmc_get_blk_desc(mmc);
+	bdesc->lun = 0;
+	bdesc->type = 0;
+	bdesc->blksz = mmc->read_bl_len;
+	bdesc->log2blksz = LOG2(bdesc->blksz);
+	bdesc->lba = lldiv(mmc->capacity, mmc->read_bl_len);
+#if !defined(CONFIG_XPL_BUILD) || \
+		(defined(CONFIG_SPL_LIBCOMMON_SUPPORT) && \
+		!CONFIG_IS_ENABLED(USE_TINY_PRINTF))
+	sprintf(bdesc->vendor, "Man %06x Snr %04x%04x",
+		mmc->cid[0] >> 24, (mmc->cid[2] & 0xffff),
+		(mmc->cid[3] >> 16) & 0xffff);
+	sprintf(bdesc->product, "%c%c%c%c%c%c", mmc->cid[0] & 0xff,
+		(mmc->cid[1] >> 24), (mmc->cid[1] >> 16) & 0xff,
+		(mmc->cid[1] >> 8) & 0xff, mmc->cid[1] & 0xff,
+		(mmc->cid[2] >> 24) & 0xff);
+	sprintf(bdesc->revision, "%d.%d", (mmc->cid[2] >> 20) & 0xf,
+		(mmc->cid[2] >> 16) & 0xf);
+#else
+	bdesc->vendor[0] = 0;
+	bdesc->product[0] = 0;
+	bdesc->revision[0] = 0;
+#endif
+
+#if !defined(CONFIG_DM_MMC) && (!defined(CONFIG_XPL_BUILD) || defined(CONFIG_SPL_LIBDISK_SUPPORT))
+	part_init(bdesc);
+#endif
+}
+
+/* Identify the card and put it into the transfer state */
+static int mmc_startup_ident(struct mmc *mmc)
+{
+	struct mmc_cmd cmd;
+	int err;
+
+#ifdef CONFIG_MMC_SPI_CRC_ON
+	if (mmc_host_is_spi(mmc)) { /* enable CRC check for spi */
+		cmd.cmdidx = MMC_CMD_SPI_CRC_ON_OFF;
+		cmd.resp_type = MMC_RSP_R1;
+		cmd.cmdarg = 1;
+		err = mmc_send_cmd(mmc, &cmd, NULL);
+		if (err)
+			return err;
+	}
+#endif
+
+	/* Put the Card in Identify Mode */
+	cmd.cmdidx = mmc_host_is_spi(mmc) ? MMC_CMD_SEND_CID :
+		MMC_CMD_ALL_SEND_CID; /* cmd not supported in spi */
+	cmd.resp_type = MMC_RSP_R2;
+	cmd.cmdarg = 0;
+
+	err = mmc_send_cmd_quirks(mmc, &cmd, NULL, MMC_QUIRK_RETRY_SEND_CID, 4);
+	if (err)
+		return err;
+
+	memcpy(mmc->cid, cmd.response, 16);
+
+	/*
+	 * For MMC cards, set the Relative Address.
+	 * For SD cards, get the Relatvie Address.
+	 * This also puts the cards into Standby State
+	 */
+	if (!mmc_host_is_spi(mmc)) { /* cmd not supported in spi */
+		cmd.cmdidx = SD_CMD_SEND_RELATIVE_ADDR;
+		cmd.cmdarg = mmc->rca << 16;
+		cmd.resp_type = MMC_RSP_R6;
+
+		err = mmc_send_cmd(mmc, &cmd, NULL);
+
+		if (err)
+			return err;
+
+		if (IS_SD(mmc))
+			mmc->rca = (cmd.response[0] >> 16) & 0xffff;
+	}
+
+	/* Get the Card-Specific Data */
+	cmd.cmdidx = MMC_CMD_SEND_CSD;
+	cmd.resp_type = MMC_RSP_R2;
+	cmd.cmdarg = mmc->rca << 16;
+
+	err = mmc_send_cmd(mmc, &cmd, NULL);
+
+	if (err)
+		return err;
+
+	mmc->csd[0] = cmd.response[0];
+	mmc->csd[1] = cmd.response[1];
+	mmc->csd[2] = cmd.response[2];
+	mmc->csd[3] = cmd.response[3];
+	mmc_decode_csd(mmc);
 
 	if ((mmc->dsr_imp) && (0xffffffff != mmc->dsr)) {
 		cmd.cmdidx = MMC_CMD_SET_DSR;
@@ -2685,6 +2802,14 @@ static int mmc_startup(struct mmc *mmc)
 	if (err)
 		return err;
 
+	return 0;
+}
+
+/* Select the fastest bus mode and width supported by both card and host */
+static int mmc_startup_mode(struct mmc *mmc)
+{
+	int err = 0;
+
 #if CONFIG_IS_ENABLED(MMC_TINY)
 	mmc_set_clock(mmc, mmc->legacy_speed, false);
 	mmc_select_mode(mmc, MMC_LEGACY);
@@ -2702,48 +2827,29 @@ static int mmc_startup(struct mmc *mmc)
 		err = mmc_select_mode_and_width(mmc, mmc->card_caps);
 	}
 #endif
-	if (err)
-		return err;
 
-	mmc->best_mode = mmc->selected_mode;
+	return err;
+}
 
-	/* Fix the block length for DDR mode */
-	if (mmc->ddr_mode) {
-		mmc->read_bl_len = MMC_MAX_BLOCK_LEN;
-#if CONFIG_IS_ENABLED(MMC_WRITE)
-		mmc->write_bl_len = MMC_MAX_BLOCK_LEN;
-#endif
-	}
+static int mmc_startup(struct mmc *mmc)
+{
+	int err;
 
-	/* fill in device description */
-	bdesc = mmc_get_blk_desc(mmc);
-	bdesc->lun = 0;
-	bdesc->hwpart = 0;
-	bdesc->type = 0;
-	bdesc->blksz = mmc->read_bl_len;
-	bdesc->log2blksz = LOG2(bdesc->blksz);
-	bdesc->lba = lldiv(mmc->capacity, mmc->read_bl_len);
-#if !defined(CONFIG_XPL_BUILD) || \
-		(defined(CONFIG_SPL_LIBCOMMON_SUPPORT) && \
-		!CONFIG_IS_ENABLED(USE_TINY_PRINTF))
-	sprintf(bdesc->vendor, "Man %06x Snr %04x%04x",
-		mmc->cid[0] >> 24, (mmc->cid[2] & 0xffff),
-		(mmc->cid[3] >> 16) & 0xffff);
-	sprintf(bdesc->product, "%c%c%c%c%c%c", mmc->cid[0] & 0xff,
-		(mmc->cid[1] >> 24), (mmc->cid[1] >> 16) & 0xff,
-		(mmc->cid[1] >> 8) & 0xff, mmc->cid[1] & 0xff,
-		(mmc->cid[2] >> 24) & 0xff);
-	sprintf(bdesc->revision, "%d.%d", (mmc->cid[2] >> 20) & 0xf,
-		(mmc->cid[2] >> 16) & 0xf);
-#else
-	bdesc->vendor[0] = 0;
-	bdesc->product[0] = 0;
-	bdesc->revision[0] = 0;
-#endif
+	bootstage_start(BOOTSTAGE_ID_ACCUM_MMC_IDENT, "mmc_ident");
+	err = mmc_startup_ident(mmc);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_MMC_IDENT);
+	if (err)
+		return err;
 
-#if !defined(CONFIG_DM_MMC) && (!defined(CONFIG_XPL_BUILD) || defined(CONFIG_SPL_LIBDISK_SUPPORT))
-	part_init(bdesc);
-#endif
+	bootstage_start(BOOTSTAGE_ID_ACCUM_MMC_MODE, "mmc_mode");
+	err = mmc_startup_mode(mmc);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_MMC_MODE);
+	if (err)
+		return err;
+
+	mmc->best_mode = mmc->selected_mode;
+	mmc_get_blk_desc(mmc)->hwpart = 0;
+	mmc_setup_blk_desc(mmc);
 
 	return 0;
 }
@@ -2878,6 +2984,217 @@ static int mmc_power_cycle(struct mmc *mmc)
 	return mmc_power_on(mmc);
 }
 
+#if IS_ENABLED(CONFIG_MMC_HANDOFF) && CONFIG_IS_ENABLED(BLOBLIST) && \
+	!CONFIG_IS_ENABLED(MMC_TINY)
+/* Find the state left by SPL, if it is for this device */
+static struct mmc_handoff *mmc_handoff_find(struct mmc *mmc)
+{
+	struct mmc_handoff *ho;
+
+	if (xpl_phase() == PHASE_SPL || mmc_host_is_spi(mmc))
+		return NULL;
+	ho = bloblist_find(BLOBLISTT_U_BOOT_MMC, sizeof(*ho));
+	if (!ho || ho->seq != dev_seq(mmc->dev) ||
+	    ho->base != dev_read_addr(mmc->dev))
+		return NULL;
+
+	return ho;
+}
+
+static bool mmc_handoff_pending(struct mmc *mmc)
+{
+	return mmc_handoff_find(mmc);
+}
+
+int mmc_handoff_save(struct mmc *mmc)
+{
+	struct mmc_handoff *ho;
+	int ret;
+
+	/* SPL and U-Boot proper may differ in word size */
+	BUILD_BUG_ON(sizeof(*ho) != 64);
+
+	ret = bloblist_ensure_size(BLOBLISTT_U_BOOT_MMC, sizeof(*ho), 0,
+				   (void **)&ho);
+	if (ret)
+		return log_msg_ret("mho", ret);
+
+	memset(ho, '\0', sizeof(*ho));
+	ho->base = dev_read_addr(mmc->dev);
+	ho->seq = dev_seq(mmc->dev);
+	ho->mode = mmc->selected_mode;
+	ho->bus_width = mmc->bus_width;
+	ho->signal_voltage = mmc->signal_voltage;
+	ho->rca = mmc->rca;
+	ho->version = mmc->version;
+	ho->ocr = mmc->ocr;
+	memcpy(ho->cid, mmc->cid, sizeof(ho->cid));
+	memcpy(ho->csd, mmc->csd, sizeof(ho->csd));
+	ho->clock = mmc->clock;
+#if CONFIG_IS_ENABLED(MMC_SUPPORTS_TUNING)
+	if (!mmc_get_tuning(mmc, &ho->tuning))
+		ho->flags |= MMC_HANDOFF_TUNED;
+#endif
+
+	return 0;
+}
+
+/* Retune the host, or restore the tuning done by SPL */
+static int mmc_handoff_tune(struct mmc *mmc, const struct mmc_handoff *ho)
+{
+#if CONFIG_IS_ENABLED(MMC_SUPPORTS_TUNING)
+	uint opcode;
+
+	if ((ho->flags & MMC_HANDOFF_TUNED) && !mmc_set_tuning(mmc, ho->tuning))
+		return 0;
+
+	switch (ho->mode) {
+	case MMC_HS_200:
+		opcode = MMC_CMD_SEND_TUNING_BLOCK_HS200;
+		break;
+	case UHS_SDR104:
+		opcode = MMC_CMD_SEND_TUNING_BLOCK;
+		break;
+	case MMC_HS_400:
+		/* tuning is done in HS200 mode, so needs a full init */
+		return -ENOTSUPP;
+	default:
+		return 0;
+	}
+
+	return mmc_execute_tuning(mmc, opcode);
+#else
+	return 0;
+#endif
+}
+
+static int mmc_startup_handoff(struct mmc *mmc, const struct mmc_handoff *ho)
+{
+	struct blk_desc *bdesc = mmc_get_blk_desc(mmc);
+	uint status;
+	int err;
+
+	if (ho->mode >= MMC_MODES_END || !(mmc->host_caps & MMC_CAP(ho->mode)))
+		return -ENOTSUPP;
+
+	err = mmc_power_init(mmc);
+	if (!err)
+		err = mmc_power_on(mmc);
+	if (err)
+		return err;
+
+	memcpy(mmc->cid, ho->cid, sizeof(mmc->cid));
+	memcpy(mmc->csd, ho->csd, sizeof(mmc->csd));
+	mmc->rca = ho->rca;
+	mmc->ocr = ho->ocr;
+	mmc->high_capacity = (mmc->ocr & OCR_HCS) == OCR_HCS;
+	mmc->version = ho->version;
+	mmc_decode_csd(mmc);
+
+	/* the card is still in the mode SPL left it in, so match the host */
+	err = mmc_set_signal_voltage(mmc, ho->signal_voltage);
+	if (err)
+		return err;
+	mmc_set_bus_width(mmc, ho->bus_width);
+	mmc_select_mode(mmc, ho->mode);
+	err = mmc_set_clock(mmc, ho->clock, MMC_CLK_ENABLE);
+	if (err)
+		return err;
+#if CONFIG_IS_ENABLED(MMC_HS400_ES_SUPPORT)
+	if (ho->mode == MMC_HS_400_ES) {
+		err = mmc_set_enhanced_strobe(mmc);
+		if (err)
+			return err;
+	}
+#endif
+	err = mmc_handoff_tune(mmc, ho);
+	if (err)
+		return err;
+
+	/* check that the card is really there and selected */
+	err = mmc_send_status(mmc, &status);
+	if (err)
+		return err;
+	if ((status & MMC_STATUS_CURR_STATE) != MMC_STATE_TRANS)
+		return -ESTALE;
+
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+	mmc->erase_grp_size = 1;
+#endif
+	mmc->part_config = MMCPART_NOAVAILABLE;
+	err = mmc_startup_v4(mmc);
+	if (err)
+		return err;
+
+	/* SPL may have left a boot partition selected */
+	bdesc->hwpart = 0;
+	if (mmc->part_config != MMCPART_NOAVAILABLE)
+		bdesc->hwpart = mmc->part_config & PART_ACCESS_MASK;
+	err = mmc_set_capacity(mmc, bdesc->hwpart);
+	if (err)
+		return err;
+
+	if (IS_SD(mmc)) {
+		err = sd_get_capabilities(mmc);
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+		if (!err && sd_read_ssr(mmc))
+			pr_warn("unable to read ssr\n");
+#endif
+	} else {
+		err = mmc_get_capabilities(mmc);
+	}
+	if (err)
+		return err;
+
+	mmc->best_mode = mmc->selected_mode;
+	mmc_setup_blk_desc(mmc);
+
+	return 0;
+}
+
+/*
+ * Take over the card in the state left by SPL. The record is removed whether
+ * or not this works, since it is stale once U-Boot starts using the card.
+ */
+static int mmc_handoff_adopt(struct mmc *mmc)
+{
+	struct mmc_handoff *ho;
+	int err;
+
+	ho = mmc_handoff_find(mmc);
+	if (!ho)
+		return -ENOENT;
+
+	bootstage_start(BOOTSTAGE_ID_ACCUM_MMC_HANDOFF, "mmc_handoff");
+	err = mmc_startup_handoff(mmc, ho);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_MMC_HANDOFF);
+	bloblist_remove(BLOBLISTT_U_BOOT_MMC);
+	if (err) {
+		log_debug("Cannot use SPL state (err=%d), starting again\n",
+			  err);
+		return err;
+	}
+	mmc->handoff = true;
+
+	return 0;
+}
+#else
+static bool mmc_handoff_pending(struct mmc *mmc)
+{
+	return false;
+}
+
+static int mmc_handoff_adopt(struct mmc *mmc)
+{
+	return -ENOENT;
+}
+
+int mmc_handoff_save(struct mmc *mmc)
+{
+	return -ENOSYS;
+}
+#endif
+
 int mmc_get_op_cond(struct mmc *mmc, bool quiet)
 {
 	bool uhs_en = supports_uhs(mmc->cfg->host_caps);
@@ -2886,6 +3203,9 @@ int mmc_get_op_cond(struct mmc *mmc, bool quiet)
 	if (mmc->has_init)
 		return 0;
 
+	/* the card is about to be reset, so hand the bus back first */
+	mmc_cqe_exit(mmc);
+
 	err = mmc_power_init(mmc);
 	if (err)
 		return err;
@@ -3014,7 +3334,15 @@ int mmc_start_init(struct mmc *mmc)
 		return -ENOMEDIUM;
 	}
 
+	/* the card is already set up, so leave it alone until the handoff */
+	if (mmc_handoff_pending(mmc)) {
+		mmc->init_in_progress = 1;
+		return 0;
+	}
+
+	bootstage_start(BOOTSTAGE_ID_ACCUM_MMC_OP_COND, "mmc_op_cond");
 	err = mmc_get_op_cond(mmc, false);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_MMC_OP_COND);
 
 	if (!err)
 		mmc->init_in_progress = 1;
@@ -3027,15 +3355,29 @@ static int mmc_complete_init(struct mmc *mmc)
 	int err = 0;
 
 	mmc->init_in_progress = 0;
-	if (mmc->op_cond_pending)
+	if (mmc_handoff_pending(mmc)) {
+		if (!mmc_handoff_adopt(mmc)) {
+			mmc->has_init = 1;
+			return 0;
+		}
+		err = mmc_get_op_cond(mmc, false);
+	}
+
+	if (!err && mmc->op_cond_pending) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_MMC_OP_COND, "mmc_op_cond");
 		err = mmc_complete_op_cond(mmc);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_MMC_OP_COND);
+	}
 
 	if (!err)
 		err = mmc_startup(mmc);
-	if (err)
+	if (err) {
 		mmc->has_init = 0;
-	else
+	} else {
 		mmc->has_init = 1;
+		if (xpl_phase() == PHASE_SPL)
+			mmc_handoff_save(mmc);
+	}
 	return err;
 }
 
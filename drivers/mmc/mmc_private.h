@@ -17,6 +17,46 @@ int mmc_poll_for_busy(struct mmc *mmc, int timeout);
 
 int mmc_set_blocklen(struct mmc *mmc, int len);
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+/**
+ * mmc_cqe_enter() - Switch to using the command queue, if possible
+ *
+ * Enables command queueing on the card and hands the bus over to the host's
+ * command queue engine. Reads and writes then go through mmc_cqe_rw() until
+ * a legacy command is sent, which calls mmc_cqe_exit() first.
+ *
+ * @mmc: MMC device
+ * Return: 0 if the command queue is in use, -ve if not
+ */
+int mmc_cqe_enter(struct mmc *mmc);
+
+/**
+ * mmc_cqe_exit() - Stop using the command queue, so legacy commands can be sent
+ *
+ * @mmc: MMC device
+ */
+void mmc_cqe_exit(struct mmc *mmc);
+
+static inline bool mmc_cqe_is_on(struct mmc *mmc)
+{
+	return mmc->cqe_on;
+}
+#else
+static inline int mmc_cqe_enter(struct mmc *mmc)
+{
+	return -ENOSYS;
+}
+
+static inline void mmc_cqe_exit(struct mmc *mmc)
+{
+}
+
+static inline bool mmc_cqe_is_on(struct mmc *mmc)
+{
+	return false;
+}
+#endif
+
 #if CONFIG_IS_ENABLED(BLK)
 ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
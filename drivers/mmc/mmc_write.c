@@ -170,6 +170,16 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 	data.blocksize = mmc->write_bl_len;
 	data.flags = MMC_DATA_WRITE;
 
+	/* the command queue engine waits for the card to finish programming */
+	if (mmc_cqe_is_on(mmc)) {
+		if (mmc_cqe_rw(mmc, &data, start)) {
+			printf("mmc write failed\n");
+			mmc_cqe_exit(mmc);
+			return 0;
+		}
+		return blkcnt;
+	}
+
 	if (mmc_send_cmd(mmc, &cmd, &data)) {
 		printf("mmc write failed\n");
 		return 0;
@@ -218,7 +228,7 @@ ulong mmc_bwrite(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 	if (err < 0)
 		return 0;
 
-	if (mmc_set_blocklen(mmc, mmc->write_bl_len))
+	if (mmc_cqe_enter(mmc) && mmc_set_blocklen(mmc, mmc->write_bl_len))
 		return 0;
 
 	do {
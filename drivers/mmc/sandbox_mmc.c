@@ -4,6 +4,7 @@
  * Written by Simon Glass <sjg@chromium.org>
  */
 
+#include <cqhci.h>
 #include <dm.h>
 #include <errno.h>
 #include <fdtdec.h>
@@ -11,12 +12,17 @@
 #include <malloc.h>
 #include <mmc.h>
 #include <os.h>
+#include <asm/io.h>
+#include <asm/state.h>
 #include <asm/test.h>
+#include <asm/unaligned.h>
+#include <linux/bitops.h>
 
 struct sandbox_mmc_plat {
 	struct mmc_config cfg;
 	struct mmc mmc;
 	const char *fname;
+	uint size;
 };
 
 #define MMC_CMULT		8 /* 8 because the card is high-capacity */
@@ -26,12 +32,295 @@ struct sandbox_mmc_plat {
 /* Granularity of priv->csize - this is 1MB */
 #define SIZE_MULTIPLE		((1 << (MMC_CMULT + 2)) * MMC_BL_LEN)
 
+/* Size of the emulated CQHCI register block */
+#define CQHCI_REG_SIZE		0x60
+
+/**
+ * struct sandbox_mmc_priv - private data for the sandbox MMC device
+ *
+ * @buf: Card contents
+ * @csize: CSIZE value to report
+ * @size: Size of @buf in bytes
+ * @cq_host: Command queue engine, if the device has "supports-cqe"
+ * @cq_regs: Emulated CQHCI registers
+ * @cq_max_queued: Largest number of tasks the engine has had queued at once
+ * @cmdq_en: true if command queueing is enabled on the card
+ */
 struct sandbox_mmc_priv {
 	char *buf;
-	int csize;	/* CSIZE value to report */
+	int csize;
 	int size;
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	struct cqhci_host cq_host;
+	u32 cq_regs[CQHCI_REG_SIZE / 4];
+	uint cq_max_queued;
+	bool cmdq_en;
+#endif
 };
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+/* Check that the bus is not owned by the command queue engine */
+static int sandbox_cqe_check_legacy(struct sandbox_mmc_priv *priv,
+				    struct mmc_cmd *cmd)
+{
+	u32 *regs = priv->cq_regs;
+
+	if ((regs[CQHCI_CFG / 4] & CQHCI_ENABLE) &&
+	    !(regs[CQHCI_CTL / 4] & CQHCI_HALT)) {
+		log_err("Command %d sent while the CQE is running\n",
+			cmd->cmdidx);
+		return -EBUSY;
+	}
+	switch (cmd->cmdidx) {
+	case MMC_CMD_READ_SINGLE_BLOCK:
+	case MMC_CMD_READ_MULTIPLE_BLOCK:
+	case MMC_CMD_WRITE_SINGLE_BLOCK:
+	case MMC_CMD_WRITE_MULTIPLE_BLOCK:
+		if (priv->cmdq_en) {
+			log_err("Command %d sent in command-queue mode\n",
+				cmd->cmdidx);
+			return -EILSEQ;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * sandbox_cqe_run_task() - Carry out a task queued on the engine
+ *
+ * @priv: Device private data
+ * @tag: Slot holding the task
+ * Return: 0 if OK, -EINVAL if the descriptors are invalid, -ERANGE if the
+ *	blocks are beyond the end of the card
+ */
+static int sandbox_cqe_run_task(struct sandbox_mmc_priv *priv, int tag)
+{
+	u32 *regs = priv->cq_regs;
+	uint task_len = regs[CQHCI_CFG / 4] & CQHCI_TASK_DESC_SZ ? 16 : 8;
+	u64 base = (u64)regs[CQHCI_TDLBAU / 4] << 32 | regs[CQHCI_TDLBA / 4];
+	u8 *desc, *link, *trans;
+	ulong offset, len;
+	u64 task;
+	bool read;
+
+	/* the emulated host uses 64-bit DMA, so link descriptors are 128-bit */
+	desc = phys_to_virt(base) + tag * (task_len + 16);
+	link = desc + task_len;
+	task = get_unaligned_le64(desc);
+	if (!(task & CQHCI_VALID(1)) ||
+	    (task & CQHCI_ACT(7)) != CQHCI_ACT(CQHCI_ACT_TASK) ||
+	    (get_unaligned_le32(link) & CQHCI_ACT(7)) !=
+	    CQHCI_ACT(CQHCI_ACT_LINK))
+		return -EINVAL;
+
+	read = task & CQHCI_DATA_DIR(1);
+	offset = (task >> 32) * 512;
+	len = ((task >> 16) & 0xffff) * 512;
+	if (offset + len > priv->size)
+		return -ERANGE;
+
+	trans = phys_to_virt(get_unaligned_le64(link + 4));
+	while (len) {
+		u32 attr = get_unaligned_le32(trans);
+		ulong seg = min_t(ulong, attr >> 16 ?: SZ_64K, len);
+		void *ptr = phys_to_virt(get_unaligned_le64(trans + 4));
+
+		if ((attr & CQHCI_ACT(7)) != CQHCI_ACT(CQHCI_ACT_TRAN))
+			return -EINVAL;
+		if (read)
+			memcpy(ptr, priv->buf + offset, seg);
+		else
+			memcpy(priv->buf + offset, ptr, seg);
+		offset += seg;
+		len -= seg;
+		if (attr & CQHCI_END(1))
+			break;
+		trans += 16;
+	}
+
+	return len ? -EINVAL : 0;
+}
+
+/*
+ * Carry out the tasks in the doorbell register, unless the engine is halted
+ * or has reported an error. Each task completes as soon as it is queued.
+ */
+static void sandbox_cqe_run(struct sandbox_mmc_priv *priv)
+{
+	u32 *regs = priv->cq_regs;
+	u32 todo = regs[CQHCI_TDBR / 4], done = 0;
+
+	if (!todo || !(regs[CQHCI_CFG / 4] & CQHCI_ENABLE) ||
+	    (regs[CQHCI_CTL / 4] & CQHCI_HALT) ||
+	    (regs[CQHCI_IS / 4] & CQHCI_IS_ERROR))
+		return;
+	priv->cq_max_queued = max_t(uint, priv->cq_max_queued,
+				    hweight32(todo));
+
+	while (todo) {
+		int tag = ffs(todo) - 1;
+		int ret;
+
+		todo &= ~BIT(tag);
+		ret = priv->cmdq_en ? sandbox_cqe_run_task(priv, tag) : -EPERM;
+		if (ret) {
+			log_debug("Task %d failed (err=%d)\n", tag, ret);
+			regs[CQHCI_TERRI / 4] = BIT(15) | tag << 8;
+			regs[CQHCI_IS / 4] |= CQHCI_IS_RED;
+			break;
+		}
+		done |= BIT(tag);
+	}
+	regs[CQHCI_TDBR / 4] &= ~done;
+	regs[CQHCI_TCN / 4] |= done;
+	if (done)
+		regs[CQHCI_IS / 4] |= CQHCI_IS_TCC;
+}
+
+static long sandbox_cqe_read(void *ctx, const void *addr,
+			     enum sandboxio_size_t size)
+{
+	struct sandbox_mmc_priv *priv = dev_get_priv(ctx);
+
+	return priv->cq_regs[(addr - (void *)priv->cq_regs) / 4];
+}
+
+static void sandbox_cqe_write(void *ctx, void *addr, unsigned int val,
+			      enum sandboxio_size_t size)
+{
+	struct sandbox_mmc_priv *priv = dev_get_priv(ctx);
+	uint reg = addr - (void *)priv->cq_regs;
+	u32 *regs = priv->cq_regs;
+
+	switch (reg) {
+	case CQHCI_VER:
+	case CQHCI_CAP:
+		break;
+	case CQHCI_CTL:
+		/* tasks can only be cleared while halted; this finishes at once */
+		if ((val & CQHCI_CLEAR_ALL_TASKS) &&
+		    (regs[CQHCI_CTL / 4] & CQHCI_HALT))
+			regs[CQHCI_TDBR / 4] = 0;
+		regs[CQHCI_CTL / 4] = val & CQHCI_HALT;
+		break;
+	case CQHCI_IS:
+	case CQHCI_TCN:
+		regs[reg / 4] &= ~val;
+		break;
+	case CQHCI_TDBR:
+		regs[reg / 4] |= val;
+		break;
+	default:
+		regs[reg / 4] = val;
+		break;
+	}
+	sandbox_cqe_run(priv);
+}
+
+static int sandbox_cqe_probe(struct udevice *dev)
+{
+	struct sandbox_mmc_plat *plat = dev_get_plat(dev);
+	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
+	struct cqhci_host *cq_host = &priv->cq_host;
+	int ret;
+
+	if (!(plat->cfg.host_caps & MMC_CAP_CQE))
+		return 0;
+
+	priv->cq_regs[CQHCI_VER / 4] = 0x510;
+	ret = sandbox_mmio_add(priv->cq_regs, CQHCI_REG_SIZE, sandbox_cqe_read,
+			       sandbox_cqe_write, dev);
+	if (ret)
+		return log_msg_ret("cqm", ret);
+	cq_host->mmio = priv->cq_regs;
+	ret = cqhci_init(cq_host, &plat->mmc, true);
+	if (ret) {
+		sandbox_mmio_remove(dev);
+		return log_msg_ret("cqi", ret);
+	}
+
+	return 0;
+}
+
+static void sandbox_cqe_remove(struct udevice *dev)
+{
+	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
+	struct cqhci_host *cq_host = &priv->cq_host;
+
+	if (!cq_host->mmio)
+		return;
+	sandbox_mmio_remove(dev);
+	free(cq_host->desc_base);
+	free(cq_host->trans_desc_base);
+}
+
+static int sandbox_mmc_cqe_enable(struct udevice *dev)
+{
+	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
+
+	if (!priv->cq_host.mmio)
+		return -ENOSYS;
+
+	return cqhci_enable(&priv->cq_host);
+}
+
+static int sandbox_mmc_cqe_disable(struct udevice *dev)
+{
+	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
+
+	if (!priv->cq_host.mmio)
+		return -ENOSYS;
+	cqhci_disable(&priv->cq_host);
+
+	return 0;
+}
+
+static int sandbox_mmc_cqe_rw(struct udevice *dev, struct mmc_data *data,
+			      lbaint_t start)
+{
+	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
+
+	return cqhci_rw(&priv->cq_host, data, start);
+}
+
+struct cqhci_host *sandbox_mmc_get_cqe(struct udevice *dev)
+{
+	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
+
+	return priv->cq_host.mmio ? &priv->cq_host : NULL;
+}
+
+uint sandbox_mmc_get_cqe_queued(struct udevice *dev)
+{
+	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
+
+	return priv->cq_max_queued;
+}
+
+bool sandbox_mmc_get_cmdq_en(struct udevice *dev)
+{
+	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
+
+	return priv->cmdq_en;
+}
+#else
+static int sandbox_cqe_check_legacy(struct sandbox_mmc_priv *priv,
+				    struct mmc_cmd *cmd)
+{
+	return 0;
+}
+
+static int sandbox_cqe_probe(struct udevice *dev)
+{
+	return 0;
+}
+
+static void sandbox_cqe_remove(struct udevice *dev)
+{
+}
+#endif
+
 /**
  * sandbox_mmc_send_cmd() - Emulate SD commands
  *
@@ -43,6 +332,11 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 {
 	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
 	static ulong erase_start, erase_end;
+	int ret;
+
+	ret = sandbox_cqe_check_legacy(priv, cmd);
+	if (ret)
+		return ret;
 
 	switch (cmd->cmdidx) {
 	case MMC_CMD_ALL_SEND_CID:
@@ -56,7 +350,7 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 		cmd->response[0] = 0xaa;
 		break;
 	case MMC_CMD_SEND_STATUS:
-		cmd->response[0] = MMC_STATUS_RDY_FOR_DATA;
+		cmd->response[0] = MMC_STATUS_RDY_FOR_DATA | MMC_STATE_TRANS;
 		break;
 	case MMC_CMD_SELECT_CARD:
 		break;
@@ -68,8 +362,14 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 		cmd->response[3] = 0;
 		break;
 	case SD_CMD_SWITCH_FUNC: {
-		if (!data)
+		if (!data) {
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+			/* MMC_CMD_SWITCH: only command queueing is emulated */
+			if (((cmd->cmdarg >> 16) & 0xff) == EXT_CSD_CMDQ_MODE_EN)
+				priv->cmdq_en = (cmd->cmdarg >> 8) & 1;
+#endif
 			break;
+		}
 		u32 *resp = (u32 *)data->dest;
 		resp[3] = 0;
 		resp[7] = cpu_to_be32(SD_HIGHSPEED_BUSY);
@@ -142,6 +442,11 @@ static const struct dm_mmc_ops sandbox_mmc_ops = {
 	.send_cmd = sandbox_mmc_send_cmd,
 	.set_ios = sandbox_mmc_set_ios,
 	.get_cd = sandbox_mmc_get_cd,
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	.cqe_enable = sandbox_mmc_cqe_enable,
+	.cqe_disable = sandbox_mmc_cqe_disable,
+	.cqe_rw = sandbox_mmc_cqe_rw,
+#endif
 };
 
 static int sandbox_mmc_of_to_plat(struct udevice *dev)
@@ -152,6 +457,7 @@ static int sandbox_mmc_of_to_plat(struct udevice *dev)
 	int ret;
 
 	plat->fname = dev_read_string(dev, "filename");
+	plat->size = dev_read_u32_default(dev, "sandbox,size", SIZE_MULTIPLE);
 
 	ret = mmc_of_parse(dev, cfg);
 	if (ret)
@@ -179,8 +485,8 @@ static int sandbox_mmc_probe(struct udevice *dev)
 		}
 		priv->csize = priv->size / SIZE_MULTIPLE - 1;
 	} else {
-		priv->csize = 0;
-		priv->size = (priv->csize + 1) * SIZE_MULTIPLE; /* 1 MiB */
+		priv->csize = plat->size / SIZE_MULTIPLE - 1;
+		priv->size = (priv->csize + 1) * SIZE_MULTIPLE;
 
 		priv->buf = calloc(1, priv->size);
 		if (!priv->buf) {
@@ -190,6 +496,10 @@ static int sandbox_mmc_probe(struct udevice *dev)
 		}
 	}
 
+	ret = sandbox_cqe_probe(dev);
+	if (ret)
+		return ret;
+
 	return mmc_init(&plat->mmc);
 }
 
@@ -198,6 +508,7 @@ static int sandbox_mmc_remove(struct udevice *dev)
 	struct sandbox_mmc_plat *plat = dev_get_plat(dev);
 	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
 
+	sandbox_cqe_remove(dev);
 	if (plat->fname)
 		os_unmap(priv->buf, priv->size);
 	else
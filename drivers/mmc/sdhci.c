@@ -8,6 +8,7 @@
  */
 
 #include <cpu_func.h>
+#include <cqhci.h>
 #include <dm.h>
 #include <errno.h>
 #include <log.h>
@@ -758,8 +759,26 @@ static int sdhci_init(struct mmc *mmc)
 int sdhci_probe(struct udevice *dev)
 {
 	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	int ret;
+
+	ret = sdhci_init(mmc);
+	if (ret)
+		return ret;
+
+	if (CONFIG_IS_ENABLED(MMC_CQHCI) &&
+	    (mmc->cfg->host_caps & MMC_CAP_CQE)) {
+		void __iomem *mmio = dev_read_addr_name_ptr(dev, "cqhci");
+		struct sdhci_host *host = mmc->priv;
+		u32 caps = 0;
+
+		/* hosts with 64-bit DMA use 128-bit task descriptors */
+		if (host->flags & USE_ADMA64)
+			caps |= CQHCI_TASK_DESC_SZ_128;
+		if (mmio && sdhci_cqe_init(host, mmio, caps))
+			log_warning("Command queue not available\n");
+	}
 
-	return sdhci_init(mmc);
+	return 0;
 }
 
 static int sdhci_deferred_probe(struct udevice *dev)
@@ -838,6 +857,100 @@ static int sdhci_set_enhanced_strobe(struct udevice *dev)
 }
 #endif
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+static int sdhci_cqe_get_error(struct cqhci_host *cq_host)
+{
+	struct sdhci_host *host = cq_host->mmc->priv;
+	u32 stat;
+
+	stat = sdhci_readl(host, SDHCI_INT_STATUS) & SDHCI_INT_ERROR_MASK;
+	if (!stat)
+		return 0;
+	sdhci_writel(host, stat, SDHCI_INT_STATUS);
+	log_debug("Error status %#x\n", stat);
+
+	return stat & (SDHCI_INT_TIMEOUT | SDHCI_INT_DATA_TIMEOUT) ?
+		-ETIMEDOUT : -EILSEQ;
+}
+
+static const struct cqhci_host_ops sdhci_cqhci_ops = {
+	.get_error	= sdhci_cqe_get_error,
+};
+
+int sdhci_cqe_init(struct sdhci_host *host, void __iomem *mmio, u32 caps)
+{
+	struct cqhci_host *cq_host;
+	int ret;
+
+	cq_host = calloc(1, sizeof(*cq_host));
+	if (!cq_host)
+		return -ENOMEM;
+	cq_host->mmio = mmio;
+	cq_host->ops = &sdhci_cqhci_ops;
+	cq_host->caps = caps;
+	ret = cqhci_init(cq_host, host->mmc, host->flags & USE_ADMA64);
+	if (ret) {
+		free(cq_host);
+		return ret;
+	}
+	host->cq_host = cq_host;
+
+	return 0;
+}
+
+static int sdhci_cqe_enable(struct udevice *dev)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+	u8 ctrl;
+
+	if (!host->cq_host || !(host->flags & (USE_ADMA | USE_ADMA64)))
+		return -ENOSYS;
+
+	/* the CQE drives the data transfers itself, using ADMA2 */
+	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
+	ctrl &= ~SDHCI_CTRL_DMA_MASK;
+	if (host->flags & USE_ADMA64)
+		ctrl |= SDHCI_CTRL_ADMA64;
+	else
+		ctrl |= SDHCI_CTRL_ADMA32;
+	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+	sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG, 512),
+		     SDHCI_BLOCK_SIZE);
+	sdhci_writeb(host, 0xe, SDHCI_TIMEOUT_CONTROL);
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+	sdhci_writel(host, SDHCI_INT_CQE | SDHCI_INT_ERROR_MASK,
+		     SDHCI_INT_ENABLE);
+
+	return cqhci_enable(host->cq_host);
+}
+
+static int sdhci_cqe_disable(struct udevice *dev)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	if (!host->cq_host)
+		return -ENOSYS;
+	cqhci_disable(host->cq_host);
+	sdhci_writel(host, SDHCI_INT_DATA_MASK | SDHCI_INT_CMD_MASK,
+		     SDHCI_INT_ENABLE);
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+	sdhci_reset(host, SDHCI_RESET_CMD | SDHCI_RESET_DATA);
+
+	return 0;
+}
+
+static int sdhci_cqe_rw(struct udevice *dev, struct mmc_data *data,
+			lbaint_t start)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	return cqhci_rw(host->cq_host, data, start);
+}
+#endif
+
 const struct dm_mmc_ops sdhci_ops = {
 	.send_cmd	= sdhci_send_command,
 	.set_ios	= sdhci_set_ios,
@@ -850,6 +963,11 @@ const struct dm_mmc_ops sdhci_ops = {
 #if CONFIG_IS_ENABLED(MMC_HS400_ES_SUPPORT)
 	.set_enhanced_strobe = sdhci_set_enhanced_strobe,
 #endif
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	.cqe_enable	= sdhci_cqe_enable,
+	.cqe_disable	= sdhci_cqe_disable,
+	.cqe_rw		= sdhci_cqe_rw,
+#endif
 };
 #else
 static const struct mmc_ops sdhci_ops = {
@@ -1091,7 +1091,28 @@ int nand_read_page_op(struct nand_chip *chip, unsigned int page,
 	if (offset_in_page + len > mtd->writesize + mtd->oobsize)
 		return -EINVAL;
 
-	chip->cmdfunc(mtd, NAND_CMD_READ0, offset_in_page, page);
+	if (chip->cont_read.ongoing && page >= chip->cont_read.first_page &&
+	    page <= chip->cont_read.last_page) {
+		/*
+		 * The first page is fetched into the cache register with a
+		 * normal READ PAGE; from then on each READ CACHE command
+		 * hands over the page in the cache while the array fetches
+		 * the next one.
+		 */
+		if (page == chip->cont_read.first_page) {
+			chip->cmdfunc(mtd, NAND_CMD_READ0, 0, page);
+			chip->cmdfunc(mtd, NAND_CMD_READCACHESEQ, -1, -1);
+		} else if (page < chip->cont_read.last_page) {
+			chip->cmdfunc(mtd, NAND_CMD_READCACHESEQ, -1, -1);
+		} else {
+			chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+			chip->cont_read.ongoing = false;
+		}
+		if (offset_in_page)
+			chip->cmdfunc(mtd, NAND_CMD_RNDOUT, offset_in_page, -1);
+	} else {
+		chip->cmdfunc(mtd, NAND_CMD_READ0, offset_in_page, page);
+	}
 	if (len)
 		chip->read_buf(mtd, buf, len);
 
@@ -2282,6 +2303,56 @@ static int nand_setup_read_retry(struct mtd_info *mtd, int retry_mode)
 	return chip->setup_read_retry(mtd, retry_mode);
 }
 
+/**
+ * nand_cont_read_start - Start a sequential cache read if worthwhile
+ * @mtd: MTD device structure
+ * @page: first page to read, within the current chip
+ * @col: column in @page at which the read starts
+ * @len: number of bytes to read
+ *
+ * Sets up chip->cont_read so that nand_read_page_op() reads the whole pages
+ * covered by the request with READ CACHE SEQUENTIAL, overlapping the array
+ * fetch of each page with the transfer of the one before. The sequence is
+ * kept within one eraseblock, so the caller starts a new one at each block
+ * boundary. It is only used for two or more pages.
+ */
+static void nand_cont_read_start(struct mtd_info *mtd, int page, int col,
+				 u32 len)
+{
+	struct nand_chip *chip = mtd_to_nand(mtd);
+	int ppb = 1 << (chip->phys_erase_shift - chip->page_shift);
+	int last;
+
+	if (!chip->cont_read.supported || col)
+		return;
+
+	last = page + (len >> chip->page_shift) - 1;
+	last = min(last, (page | (ppb - 1)));
+	if (last <= page)
+		return;
+
+	chip->cont_read.first_page = page;
+	chip->cont_read.last_page = last;
+	chip->cont_read.ongoing = true;
+}
+
+/**
+ * nand_cont_read_stop - End a sequential cache read which was cut short
+ * @mtd: MTD device structure
+ *
+ * The chip must be sent READ CACHE END before it accepts other commands.
+ */
+static void nand_cont_read_stop(struct mtd_info *mtd)
+{
+	struct nand_chip *chip = mtd_to_nand(mtd);
+
+	if (!chip->cont_read.ongoing)
+		return;
+
+	chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+	chip->cont_read.ongoing = false;
+}
+
 /**
  * nand_do_read_ops - [INTERN] Read data with ECC
  * @mtd: MTD device structure
@@ -2305,6 +2376,7 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	unsigned int max_bitflips = 0;
 	int retry_mode = 0;
 	bool ecc_fail = false;
+	int ppb = 1 << (chip->phys_erase_shift - chip->page_shift);
 
 	chipnr = (int)(from >> chip->chip_shift);
 	chip->select_chip(mtd, chipnr);
@@ -2318,6 +2390,9 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	oob = ops->oobbuf;
 	oob_required = oob ? 1 : 0;
 
+	if (!oob)
+		nand_cont_read_start(mtd, page, col, readlen);
+
 	while (1) {
 		unsigned int ecc_failures = mtd->ecc_stats.failed;
 
@@ -2333,8 +2408,12 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 		else
 			use_bufpoi = 0;
 
-		/* Is the current page in the buffer? */
-		if (realpage != chip->pagebuf || oob) {
+		/*
+		 * Is the current page in the buffer? A cache read has to fetch
+		 * every page in its sequence, so ignore the buffer then.
+		 */
+		if (realpage != chip->pagebuf || oob ||
+		    chip->cont_read.ongoing) {
 			bufpoi = use_bufpoi ? chip->buffers->databuf : buf;
 
 			if (use_bufpoi && aligned)
@@ -2455,7 +2534,12 @@ read_retry:
 			chip->select_chip(mtd, -1);
 			chip->select_chip(mtd, chipnr);
 		}
+
+		/* A cache read ends with its block, so start another one */
+		if (!oob && !(page & (ppb - 1)))
+			nand_cont_read_start(mtd, page, col, readlen);
 	}
+	nand_cont_read_stop(mtd);
 	chip->select_chip(mtd, -1);
 
 	ops->retlen = ops->len - (size_t) readlen;
@@ -5159,6 +5243,19 @@ int nand_scan_tail(struct mtd_info *mtd)
 		break;
 	}
 
+	/*
+	 * Sequential cache reads need a READ PAGE that is split from the data
+	 * transfer and must not be interrupted by retries or OOB-first reads.
+	 */
+	if (chip->onfi_version && mtd->writesize > 512 &&
+	    (le16_to_cpu(chip->onfi_params.opt_cmd) & ONFI_OPT_CMD_READ_CACHE) &&
+	    (chip->cmdfunc == nand_command_lp ||
+	     chip->options & NAND_CACHEREAD) &&
+	    !(chip->options & NAND_NEED_READRDY) && !chip->read_retries &&
+	    nand_standard_page_accessors(ecc) &&
+	    ecc->mode != NAND_ECC_HW_OOB_FIRST)
+		chip->cont_read.supported = true;
+
 	mtd->flash_node = chip->flash_node;
 	/* Fill in remaining MTD driver data */
 	mtd->type = nand_is_slc(chip) ? MTD_NANDFLASH : MTD_MLCNANDFLASH;
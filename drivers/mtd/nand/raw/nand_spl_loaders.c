@@ -1,7 +1,24 @@
+/*
+ * Read count pages from a block. Drivers which can read them in one go (e.g.
+ * to use the cache reads in nand_base) provide their own nand_read_pages()
+ * and define HAVE_NAND_READ_PAGES before including this file.
+ */
+#ifndef HAVE_NAND_READ_PAGES
+static int nand_read_pages(int block, int page, unsigned int count, void *dst)
+{
+	while (count--) {
+		nand_read_page(block, page++, dst);
+		dst += CONFIG_SYS_NAND_PAGE_SIZE;
+	}
+
+	return 0;
+}
+#endif
+
 int nand_spl_load_image(uint32_t offs, unsigned int size, void *dst)
 {
 	unsigned int block, lastblock;
-	unsigned int page, page_offset;
+	unsigned int page, page_offset, count, len;
 
 	/* offs has to be aligned to a page address! */
 	block = offs / CONFIG_SYS_NAND_BLOCK_SIZE;
@@ -11,27 +28,25 @@ int nand_spl_load_image(uint32_t offs, unsigned int size, void *dst)
 
 	while (block <= lastblock) {
 		if (!nand_is_bad_block(block)) {
-			/* Skip bad blocks */
-			while (size && page < SYS_NAND_BLOCK_PAGES) {
-				nand_read_page(block, page, dst);
-
-				size -= min(size, CONFIG_SYS_NAND_PAGE_SIZE -
-						  page_offset);
-				/*
-				 * When offs is not aligned to page address the
-				 * extra offset is copied to dst as well. Copy
-				 * the image such that its first byte will be
-				 * at the dst.
-				 */
-				if (unlikely(page_offset)) {
-					memmove(dst, dst + page_offset,
-						CONFIG_SYS_NAND_PAGE_SIZE);
-					dst = (void *)(dst - page_offset);
-					page_offset = 0;
-				}
-				dst += CONFIG_SYS_NAND_PAGE_SIZE;
-				page++;
+			/* Read the rest of the image within this block */
+			count = min_t(unsigned int, SYS_NAND_BLOCK_PAGES - page,
+				      DIV_ROUND_UP(size + page_offset,
+						   CONFIG_SYS_NAND_PAGE_SIZE));
+			if (size && count)
+				nand_read_pages(block, page, count, dst);
+
+			len = count * CONFIG_SYS_NAND_PAGE_SIZE - page_offset;
+			/*
+			 * When offs is not aligned to page address the extra
+			 * offset is copied to dst as well. Copy the image such
+			 * that its first byte will be at the dst.
+			 */
+			if (unlikely(page_offset)) {
+				memmove(dst, dst + page_offset, len);
+				page_offset = 0;
 			}
+			dst += len;
+			size -= min(size, len);
 
 			page = 0;
 		} else {
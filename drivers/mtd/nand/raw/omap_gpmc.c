@@ -1289,5 +1289,22 @@ static int nand_read_page(int block, int page, uchar *dst)
 	return ret;
 }
 
+static int nand_read_pages(int block, int page, unsigned int count, void *dst)
+{
+	int page_addr = block * SYS_NAND_BLOCK_PAGES + page;
+	loff_t ofs = (loff_t)page_addr * CONFIG_SYS_NAND_PAGE_SIZE;
+	size_t len = count * CONFIG_SYS_NAND_PAGE_SIZE;
+	struct mtd_info *mtd = nand_to_mtd(nand_chip);
+	int ret;
+
+	/* A single read lets nand_base use sequential cache reads */
+	ret = nand_read(mtd, ofs, &len, dst);
+	if (ret)
+		printf("nand_read failed %d\n", ret);
+
+	return ret;
+}
+#define HAVE_NAND_READ_PAGES
+
 #include "nand_spl_loaders.c"
 #endif /* CONFIG_SPL_NAND_INIT */
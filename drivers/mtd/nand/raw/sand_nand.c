@@ -66,6 +66,8 @@ static const char *const state_name[] = {
  * @page_addr: Page address of the most-recent command
  * @fd: File descriptor for the backing data
  * @fd_page_addr: Page address that @fd is seek'd to
+ * @cache_page: Page which the next READ CACHE command hands over, or -1
+ * @read_page: Page held in @tmp by the last read, or -1
  * @selected: Whether this device is selected
  * @tmp: "Cache" buffer used to store transferred data before committing it
  * @tmp_dirty: Whether @tmp is dirty (modified) or clean (all ones)
@@ -83,7 +85,8 @@ struct sand_nand_chip {
 	u32 err_count, err_step_bits, err_steps, ecc_bits;
 	unsigned int cs;
 	enum sand_nand_state state;
-	int column, page_addr, fd, fd_page_addr;
+	int column, page_addr, fd, fd_page_addr, cache_page,
+	    read_page;
 	bool selected, tmp_dirty;
 	u8 status;
 	u8 id_len;
@@ -274,8 +277,20 @@ static void sand_nand_command(struct mtd_info *mtd, unsigned int command,
 				     chip->pages_per_erase);
 		break;
 	default:
+		if (command == NAND_CMD_RNDOUT) {
+			/* The page is still in tmp; just move the column */
+			new_state = STATE_IDLE;
+			if (chip->read_page >= 0 && column >= 0 &&
+			    column < chip->chunksize) {
+				chip->column = column;
+				new_state = STATE_READ;
+			}
+			break;
+		}
+
 		chip->column = column;
 		chip->page_addr = page_addr;
+		chip->read_page = -1;
 		switch (command) {
 		case NAND_CMD_READOOB:
 			if (column >= 0)
@@ -293,9 +308,32 @@ static void sand_nand_command(struct mtd_info *mtd, unsigned int command,
 				break;
 
 			chip->page_addr = page_addr;
+			chip->cache_page = page_addr;
+			chip->read_page = page_addr;
+			new_state = STATE_READ;
+			break;
+		case NAND_CMD_READCACHESEQ:
+		case NAND_CMD_READCACHEEND:
+			new_state = STATE_IDLE;
+			if (chip->cache_page < 0)
+				break;
+
+			chip->column = 0;
+			chip->page_addr = chip->cache_page;
+			if (sand_nand_read(chip))
+				break;
+
+			/* The array is now busy with the next page */
+			if (command == NAND_CMD_READCACHEEND ||
+			    chip->cache_page + 1 >= chip->pages)
+				chip->cache_page = -1;
+			else
+				chip->cache_page++;
+			chip->read_page = chip->page_addr;
 			new_state = STATE_READ;
 			break;
 		case NAND_CMD_ERASE1:
+			chip->cache_page = -1;
 			new_state = STATE_ERASE;
 			chip->status = ~NAND_STATUS_FAIL;
 			break;
@@ -304,6 +342,7 @@ static void sand_nand_command(struct mtd_info *mtd, unsigned int command,
 			chip->column = 0;
 			break;
 		case NAND_CMD_SEQIN:
+			chip->cache_page = -1;
 			new_state = STATE_PROG;
 			chip->status = ~NAND_STATUS_FAIL;
 			if (page_addr < 0 || page_addr >= chip->pages ||
@@ -333,6 +372,7 @@ reset:
 			new_state = STATE_IDLE;
 			chip->column = -1;
 			chip->page_addr = -1;
+			chip->cache_page = -1;
 			chip->status = ~NAND_STATUS_FAIL;
 			break;
 		default:
@@ -564,6 +604,8 @@ static int sand_nand_probe(struct udevice *dev)
 		}
 
 		chip->cs = cs;
+		chip->cache_page = -1;
+		chip->read_page = -1;
 		chip->id = id;
 		chip->id_len = id_len;
 		chip->chunksize = pagesize + oobsize;
@@ -601,7 +643,9 @@ static int sand_nand_probe(struct udevice *dev)
 		}
 
 		nand = &chip->nand;
-		nand->options = not_xpl() ? 0 : NAND_SKIP_BBTSCAN;
+		nand->options = NAND_CACHEREAD;
+		if (!not_xpl())
+			nand->options |= NAND_SKIP_BBTSCAN;
 		nand->flash_node = np;
 		nand->dev_ready = sand_nand_dev_ready;
 		nand->cmdfunc = sand_nand_command;
@@ -703,5 +747,16 @@ static int nand_read_page(int block, int page, uchar *dst)
 	return nand_read(mtd, ofs, &len, dst);
 }
 
+static int nand_read_pages(int block, int page, unsigned int count, void *dst)
+{
+	struct mtd_info *mtd = nand_to_mtd(nand_chip);
+	loff_t ofs = ((loff_t)block << mtd->erasesize_shift) +
+		     ((loff_t)page << mtd->writesize_shift);
+	size_t len = (size_t)count << mtd->writesize_shift;
+
+	return nand_read(mtd, ofs, &len, dst);
+}
+#define HAVE_NAND_READ_PAGES
+
 #include "nand_spl_loaders.c"
 #endif /* CONFIG_SPL_NAND_INIT */
@@ -11,6 +11,7 @@
 
 #include <display_options.h>
 #include <log.h>
+#include <memalign.h>
 #include <watchdog.h>
 #include <dm.h>
 #include <dm/device_compat.h>
@@ -379,8 +380,8 @@ static int spansion_write_any_reg(struct spi_nor *nor, u32 addr, u8 val)
 }
 #endif
 
-static ssize_t spi_nor_read_data(struct spi_nor *nor, loff_t from, size_t len,
-				 u_char *buf)
+static ssize_t __spi_nor_read_data(struct spi_nor *nor, loff_t from,
+				   size_t len, u_char *buf)
 {
 	struct spi_mem_op op =
 			SPI_MEM_OP(SPI_MEM_OP_CMD(nor->read_opcode, 0),
@@ -431,6 +432,49 @@ static ssize_t spi_nor_read_data(struct spi_nor *nor, loff_t from, size_t len,
 	return len;
 }
 
+/*
+ * In octal DTR mode two bytes are transferred per clock, so the flash can only
+ * be read from an even address and in multiples of two bytes. Bounce any odd
+ * leading or trailing byte through a small buffer so that the bulk of the read
+ * still goes straight to the caller's buffer (and through the direct mapping,
+ * if there is one).
+ */
+static ssize_t spi_nor_read_data(struct spi_nor *nor, loff_t from, size_t len,
+				 u_char *buf)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(u_char, tmp, 2);
+	size_t done = 0, bulk;
+	ssize_t ret;
+
+	if (!spi_nor_protocol_is_dtr(nor->read_proto) || !((from | len) & 1))
+		return __spi_nor_read_data(nor, from, len, buf);
+
+	if (from & 1) {
+		ret = __spi_nor_read_data(nor, from - 1, 2, tmp);
+		if (ret < 0)
+			return ret;
+		buf[0] = tmp[1];
+		done = 1;
+	}
+
+	bulk = (len - done) & ~1;
+	if (bulk) {
+		ret = __spi_nor_read_data(nor, from + done, bulk, buf + done);
+		if (ret < 0)
+			return ret;
+		done += bulk;
+	}
+
+	if (done < len) {
+		ret = __spi_nor_read_data(nor, from + done, 2, tmp);
+		if (ret < 0)
+			return ret;
+		buf[done] = tmp[0];
+	}
+
+	return len;
+}
+
 static ssize_t spi_nor_write_data(struct spi_nor *nor, loff_t to, size_t len,
 				  const u_char *buf)
 {
@@ -25,7 +25,12 @@
 				      ARCH_DMA_MINALIGN)
 #define ADMIN_TIMEOUT		60
 #define IO_TIMEOUT		30
-#define MAX_PRP_POOL		512
+
+/*
+ * Largest transfer to do with one command, as a power of two. This limits the
+ * size of the PRP pool, which must hold the PRP lists for a whole transfer.
+ */
+#define NVME_MAX_TRANSFER_SHIFT	23
 
 static int nvme_wait_csts(struct nvme_dev *dev, u32 mask, u32 val)
 {
@@ -53,7 +58,6 @@ static int nvme_setup_prps(struct nvme_dev *dev, u64 *prp2,
 	int length = total_len;
 	int i, nprps;
 	u32 prps_per_page = page_size >> 3;
-	u32 num_pages;
 
 	length -= (page_size - offset);
 
@@ -70,21 +74,11 @@ static int nvme_setup_prps(struct nvme_dev *dev, u64 *prp2,
 		return 0;
 	}
 
+	/* the pool is big enough for the largest transfer */
 	nprps = DIV_ROUND_UP(length, page_size);
-	num_pages = DIV_ROUND_UP(nprps - 1, prps_per_page - 1);
-
 	if (nprps > dev->prp_entry_num) {
-		free(dev->prp_pool);
-		/*
-		 * Always increase in increments of pages.  It doesn't waste
-		 * much memory and reduces the number of allocations.
-		 */
-		dev->prp_pool = memalign(page_size, num_pages * page_size);
-		if (!dev->prp_pool) {
-			printf("Error: malloc prp_pool fail\n");
-			return -ENOMEM;
-		}
-		dev->prp_entry_num = num_pages * (prps_per_page - 1) + 1;
+		log_debug("Transfer of %x bytes is too large\n", total_len);
+		return -EFBIG;
 	}
 
 	prp_pool = dev->prp_pool;
@@ -94,7 +88,7 @@ static int nvme_setup_prps(struct nvme_dev *dev, u64 *prp2,
 			*(prp_pool + i) = cpu_to_le64((ulong)prp_pool +
 					page_size);
 			i = 0;
-			prp_pool += page_size;
+			prp_pool += prps_per_page;
 		}
 		*(prp_pool + i++) = cpu_to_le64(dma_addr);
 		dma_addr += page_size;
@@ -102,8 +96,67 @@ static int nvme_setup_prps(struct nvme_dev *dev, u64 *prp2,
 	}
 	*prp2 = (ulong)dev->prp_pool;
 
-	flush_dcache_range((ulong)dev->prp_pool, (ulong)dev->prp_pool +
-			   num_pages * page_size);
+	/* only flush the entries which were written */
+	flush_dcache_range((ulong)dev->prp_pool,
+			   ALIGN((ulong)(prp_pool + i), ARCH_DMA_MINALIGN));
+
+	return 0;
+}
+
+/*
+ * Allocate the PRP lists for the largest transfer up front, so that there is
+ * no need to allocate anything when doing I/O
+ */
+static int nvme_alloc_prp_pool(struct nvme_dev *dev)
+{
+	u32 prps_per_page = dev->page_size >> 3;
+	u32 nprps, num_pages;
+
+	/*
+	 * The first page is in PRP1, so the list holds the rest. The last
+	 * entry in each page of the list points to the next page.
+	 */
+	nprps = (1U << dev->max_transfer_shift) / dev->page_size;
+	num_pages = max(DIV_ROUND_UP(nprps - 1, prps_per_page - 1), 1U);
+
+	dev->prp_pool = memalign(dev->page_size, num_pages * dev->page_size);
+	if (!dev->prp_pool)
+		return -ENOMEM;
+	dev->prp_entry_num = num_pages * (prps_per_page - 1) + 1;
+
+	return 0;
+}
+
+/*
+ * nvme_setup_dptr() - Set up the data pointer of a read/write command
+ *
+ * This uses a single SGL descriptor if the controller supports SGLs, since
+ * U-Boot buffers are always contiguous. Otherwise it sets up PRPs, one for each
+ * page of the buffer.
+ */
+static int nvme_setup_dptr(struct nvme_dev *dev, struct nvme_rw_command *rw,
+			   int total_len, u64 dma_addr)
+{
+	u64 prp2;
+	int ret;
+
+	if (dev->sgls && !((dev->sgls & NVME_CTRL_SGLS_DWORD_ALIGN) &&
+			   (dma_addr & 3))) {
+		rw->flags = NVME_CMD_SGL_METABUF;
+		rw->sgl.addr = cpu_to_le64(dma_addr);
+		rw->sgl.length = cpu_to_le32(total_len);
+		memset(rw->sgl.rsvd, '\0', sizeof(rw->sgl.rsvd));
+		rw->sgl.type = NVME_SGL_FMT_DATA_DESC << 4;
+
+		return 0;
+	}
+
+	ret = nvme_setup_prps(dev, &prp2, total_len, dma_addr);
+	if (ret)
+		return ret;
+	rw->flags = 0;
+	rw->prp1 = cpu_to_le64(dma_addr);
+	rw->prp2 = cpu_to_le64(prp2);
 
 	return 0;
 }
@@ -639,29 +692,22 @@ static int nvme_get_info_from_identify(struct nvme_dev *dev)
 	memcpy(dev->serial, ctrl->sn, sizeof(ctrl->sn));
 	memcpy(dev->model, ctrl->mn, sizeof(ctrl->mn));
 	memcpy(dev->firmware_rev, ctrl->fr, sizeof(ctrl->fr));
+	/*
+	 * Maximum Data Transfer Size (MDTS) field indicates the maximum data
+	 * transfer size between the host and the controller. The host should
+	 * not submit a command that exceeds this transfer size. The value is
+	 * in units of the minimum memory page size and is reported as a power
+	 * of two (2^n). A value of 0h indicates no restrictions on transfer
+	 * size.
+	 *
+	 * Transfers are split into commands of this size, up to a limit which
+	 * keeps the PRP pool small.
+	 */
+	dev->max_transfer_shift = NVME_MAX_TRANSFER_SHIFT;
 	if (ctrl->mdts)
-		dev->max_transfer_shift = (ctrl->mdts + shift);
-	else {
-		/*
-		 * Maximum Data Transfer Size (MDTS) field indicates the maximum
-		 * data transfer size between the host and the controller. The
-		 * host should not submit a command that exceeds this transfer
-		 * size. The value is in units of the minimum memory page size
-		 * and is reported as a power of two (2^n).
-		 *
-		 * The spec also says: a value of 0h indicates no restrictions
-		 * on transfer size. But in nvme_blk_read/write() below we have
-		 * the following algorithm for maximum number of logic blocks
-		 * per transfer:
-		 *
-		 * u16 lbas = 1 << (dev->max_transfer_shift - ns->lba_shift);
-		 *
-		 * In order for lbas not to overflow, the maximum number is 15
-		 * which means dev->max_transfer_shift = 15 + 9 (ns->lba_shift).
-		 * Let's use 20 which provides 1MB size.
-		 */
-		dev->max_transfer_shift = 20;
-	}
+		dev->max_transfer_shift = min(ctrl->mdts + shift,
+					      NVME_MAX_TRANSFER_SHIFT);
+	dev->sgls = le32_to_cpu(ctrl->sgls) & NVME_CTRL_SGLS_MASK;
 
 	free(ctrl);
 	return 0;
@@ -749,20 +795,18 @@ static ulong nvme_blk_rw(struct udevice *udev, lbaint_t blknr,
 	struct nvme_command c;
 	struct blk_desc *desc = dev_get_uclass_plat(udev);
 	int status;
-	u64 prp2;
 	u64 total_len = blkcnt << desc->log2blksz;
 	u64 temp_len = total_len;
 	uintptr_t temp_buffer = (uintptr_t)buffer;
 
 	u64 slba = blknr;
-	u16 lbas = 1 << (dev->max_transfer_shift - ns->lba_shift);
+	u32 lbas = 1 << (dev->max_transfer_shift - ns->lba_shift);
 	u64 total_lbas = blkcnt;
 
 	flush_dcache_range((unsigned long)buffer,
 			   (unsigned long)buffer + total_len);
 
 	c.rw.opcode = read ? nvme_cmd_read : nvme_cmd_write;
-	c.rw.flags = 0;
 	c.rw.nsid = cpu_to_le32(ns->ns_id);
 	c.rw.control = 0;
 	c.rw.dsmgmt = 0;
@@ -773,20 +817,18 @@ static ulong nvme_blk_rw(struct udevice *udev, lbaint_t blknr,
 
 	while (total_lbas) {
 		if (total_lbas < lbas) {
-			lbas = (u16)total_lbas;
+			lbas = total_lbas;
 			total_lbas = 0;
 		} else {
 			total_lbas -= lbas;
 		}
 
-		if (nvme_setup_prps(dev, &prp2,
-				    lbas << ns->lba_shift, temp_buffer))
+		if (nvme_setup_dptr(dev, &c.rw, lbas << ns->lba_shift,
+				    temp_buffer))
 			return -EIO;
 		c.rw.slba = cpu_to_le64(slba);
 		slba += lbas;
 		c.rw.length = cpu_to_le16(lbas - 1);
-		c.rw.prp1 = cpu_to_le64(temp_buffer);
-		c.rw.prp2 = cpu_to_le64(prp2);
 		status = nvme_submit_sync_cmd(dev->queues[NVME_IO_Q],
 				&c, NULL, IO_TIMEOUT);
 		if (status)
@@ -860,22 +902,24 @@ int nvme_init(struct udevice *udev)
 		goto free_queue;
 	}
 
-	/* Allocate after the page size is known */
-	ndev->prp_pool = memalign(ndev->page_size, MAX_PRP_POOL);
-	if (!ndev->prp_pool) {
-		ret = -ENOMEM;
-		printf("Error: %s: Out of memory!\n", udev->name);
-		goto free_nvme;
-	}
-	ndev->prp_entry_num = MAX_PRP_POOL >> 3;
-
 	ret = nvme_setup_io_queues(ndev);
 	if (ret) {
 		log_debug("Unable to setup I/O queues(err=%dE)\n", ret);
 		goto free_queue;
 	}
 
-	nvme_get_info_from_identify(ndev);
+	ret = nvme_get_info_from_identify(ndev);
+	if (ret) {
+		log_debug("Unable to identify controller (err=%dE)\n", ret);
+		goto free_queue;
+	}
+
+	/* Allocate after the page size and maximum transfer size are known */
+	ret = nvme_alloc_prp_pool(ndev);
+	if (ret) {
+		printf("Error: %s: Out of memory!\n", udev->name);
+		goto free_queue;
+	}
 
 	/* Create a blk device for each namespace */
 
@@ -235,6 +235,28 @@ struct nvme_common_command {
 	__le32			cdw10[6];
 };
 
+/* SGL descriptor types, in the upper nibble of the type byte */
+enum {
+	NVME_SGL_FMT_DATA_DESC		= 0x00,
+};
+
+/* Descriptor for a contiguous data buffer */
+struct nvme_sgl_desc {
+	__le64			addr;
+	__le32			length;
+	__u8			rsvd[3];
+	__u8			type;
+};
+
+/* Command flags */
+enum {
+	NVME_CMD_SGL_METABUF		= 1 << 6,
+};
+
+/* SGL support reported in the sgls field of struct nvme_id_ctrl */
+#define NVME_CTRL_SGLS_MASK		0x3
+#define NVME_CTRL_SGLS_DWORD_ALIGN	0x2
+
 struct nvme_rw_command {
 	__u8			opcode;
 	__u8			flags;
@@ -242,8 +264,13 @@ struct nvme_rw_command {
 	__le32			nsid;
 	__u64			rsvd2;
 	__le64			metadata;
-	__le64			prp1;
-	__le64			prp2;
+	union {
+		struct {
+			__le64	prp1;
+			__le64	prp2;
+		};
+		struct nvme_sgl_desc	sgl;
+	};
 	__le64			slba;
 	__le16			length;
 	__le16			control;
@@ -618,6 +645,7 @@ struct nvme_dev {
 	u32 stripe_size;
 	u32 page_size;
 	u8 vwc;
+	u32 sgls;
 	u64 *prp_pool;
 	u32 prp_entry_num;
 	u32 nn;
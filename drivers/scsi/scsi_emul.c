@@ -15,6 +15,7 @@
 #include <log.h>
 #include <scsi.h>
 #include <scsi_emul.h>
+#include <asm/unaligned.h>
 
 int sb_scsi_emul_command(struct scsi_emul_info *info,
 			 const struct scsi_cmd *req, int len)
@@ -41,17 +42,41 @@ int sb_scsi_emul_command(struct scsi_emul_info *info,
 		break;
 	case SCSI_RD_CAPAC: {
 		struct scsi_read_capacity_resp *resp = (void *)info->buff;
-		uint blocks;
+		u64 blocks;
 
 		if (info->file_size)
 			blocks = info->file_size / info->block_size - 1;
 		else
 			blocks = 0;
+
+		/* too large: the host must use READ CAPACITY(16) instead */
+		if (blocks > U32_MAX)
+			blocks = U32_MAX;
 		resp->last_block_addr = cpu_to_be32(blocks);
 		resp->block_len = cpu_to_be32(info->block_size);
 		info->buff_used = sizeof(*resp);
 		break;
 	}
+	case SCSI_RD_CAPAC16: {
+		struct scsi_read_capacity16_resp *resp = (void *)info->buff;
+		u64 blocks;
+
+		/* only the READ CAPACITY(16) service action is supported */
+		if ((req->cmd[1] & 0x1f) != 0x10) {
+			ret = -EPROTONOSUPPORT;
+			break;
+		}
+		info->alloc_len = get_unaligned_be32(&req->cmd[10]);
+		if (info->file_size)
+			blocks = info->file_size / info->block_size - 1;
+		else
+			blocks = 0;
+		memset(resp, '\0', sizeof(*resp));
+		resp->last_block_addr = cpu_to_be64(blocks);
+		resp->block_len = cpu_to_be32(info->block_size);
+		info->buff_used = sizeof(*resp);
+		break;
+	}
 	case SCSI_READ10: {
 		const struct scsi_read10_req *read_req = (void *)req;
 
@@ -70,6 +95,24 @@ int sb_scsi_emul_command(struct scsi_emul_info *info,
 		ret = SCSI_EMUL_DO_WRITE;
 		break;
 	}
+	case SCSI_READ16: {
+		const struct scsi_read16_req *read_req = (void *)req;
+
+		info->seek_block = be64_to_cpu(read_req->lba);
+		info->read_len = be32_to_cpu(read_req->xfer_len);
+		info->buff_used = info->read_len * info->block_size;
+		ret = SCSI_EMUL_DO_READ;
+		break;
+	}
+	case SCSI_WRITE16: {
+		const struct scsi_write16_req *write_req = (void *)req;
+
+		info->seek_block = be64_to_cpu(write_req->lba);
+		info->write_len = be32_to_cpu(write_req->xfer_len);
+		info->buff_used = info->write_len * info->block_size;
+		ret = SCSI_EMUL_DO_WRITE;
+		break;
+	}
 	default:
 		debug("Command not supported: %x\n", req->cmd[0]);
 		ret = -EPROTONOSUPPORT;
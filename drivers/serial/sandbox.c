@@ -23,6 +23,7 @@ DECLARE_GLOBAL_DATA_PTR;
 
 static size_t _sandbox_serial_written = 1;
 static bool sandbox_serial_enabled = true;
+static int sandbox_serial_tx_space = -1;
 
 size_t sandbox_serial_written(void)
 {
@@ -34,6 +35,11 @@ void sandbox_serial_endisable(bool enabled)
 	sandbox_serial_enabled = enabled;
 }
 
+void sandbox_serial_set_tx_space(int space)
+{
+	sandbox_serial_tx_space = space;
+}
+
 /**
  * output_ansi_colour() - Output an ANSI colour code
  *
@@ -95,6 +101,11 @@ static int sandbox_serial_putc(struct udevice *dev, const char ch)
 {
 	struct sandbox_serial_priv *priv = dev_get_priv(dev);
 
+	if (!sandbox_serial_tx_space)
+		return -EAGAIN;
+	if (sandbox_serial_tx_space > 0)
+		sandbox_serial_tx_space--;
+
 	if (ch == '\n')
 		priv->start_of_line = true;
 
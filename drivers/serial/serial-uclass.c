@@ -6,6 +6,7 @@
 #define LOG_CATEGORY UCLASS_SERIAL
 
 #include <config.h>
+#include <cyclic.h>
 #include <dm.h>
 #include <env_internal.h>
 #include <errno.h>
@@ -238,10 +239,140 @@ int serial_initialize(void)
 	return serial_init();
 }
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+/**
+ * serial_tx_drain() - Pass buffered output characters to the UART
+ *
+ * @dev: Serial device
+ * @wait: true to wait until the TX buffer is empty, false to stop as soon as
+ *	the UART cannot accept any more characters
+ */
+static void serial_tx_drain(struct udevice *dev, bool wait)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	struct dm_serial_ops *ops = serial_get_ops(dev);
+	uint rd;
+
+	/* Drivers may call schedule() from putc(), so avoid recursion */
+	if (upriv->tx_busy)
+		return;
+	upriv->tx_busy = true;
+	while (upriv->tx_rd_ptr != upriv->tx_wr_ptr) {
+		rd = upriv->tx_rd_ptr % CONFIG_SERIAL_TX_BUFFER_SIZE;
+		if (ops->putc(dev, upriv->tx_buf[rd]) == -EAGAIN) {
+			if (!wait)
+				break;
+			continue;
+		}
+		upriv->tx_rd_ptr++;
+	}
+	upriv->tx_busy = false;
+}
+
+/**
+ * serial_tx_queue() - Add a character to the TX buffer
+ *
+ * If the buffer is full, this waits for the UART to accept enough characters
+ * to make space. That is not possible while the buffer is being drained, e.g.
+ * if the driver's putc() prints something, so the buffer is bypassed then.
+ *
+ * @dev: Serial device
+ * @ch: Character to add
+ * Return: true if added, false if the TX buffer is not active for this device
+ *	or is full while being drained, in which case the caller must send the
+ *	character itself
+ */
+static bool serial_tx_queue(struct udevice *dev, char ch)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	uint wr;
+
+	BUILD_BUG_ON_NOT_POWER_OF_2(CONFIG_SERIAL_TX_BUFFER_SIZE);
+
+	if (!upriv->tx_active)
+		return false;
+	while (upriv->tx_wr_ptr - upriv->tx_rd_ptr ==
+	       CONFIG_SERIAL_TX_BUFFER_SIZE) {
+		if (upriv->tx_busy)
+			return false;
+		serial_tx_drain(dev, false);
+	}
+
+	wr = upriv->tx_wr_ptr++ % CONFIG_SERIAL_TX_BUFFER_SIZE;
+	upriv->tx_buf[wr] = ch;
+
+	return true;
+}
+
+static void serial_tx_cyclic(struct cyclic_info *c)
+{
+	struct serial_dev_priv *upriv;
+
+	upriv = container_of(c, struct serial_dev_priv, tx_cyclic);
+	serial_tx_drain(upriv->dev, false);
+}
+
+static void serial_tx_start(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	/* Pre-relocation cyclic functions are dropped, so wait until after */
+	if (!(gd->flags & GD_FLG_RELOC) || upriv->tx_active)
+		return;
+	upriv->dev = dev;
+	cyclic_register(&upriv->tx_cyclic, serial_tx_cyclic,
+			CONFIG_SERIAL_TX_BUFFER_POLL_US, dev->name);
+	upriv->tx_active = true;
+}
+
+static void serial_tx_stop(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	if (!upriv->tx_active)
+		return;
+	serial_tx_drain(dev, true);
+	cyclic_unregister(&upriv->tx_cyclic);
+	upriv->tx_active = false;
+}
+
+static bool serial_tx_active(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	return upriv->tx_active;
+}
+
+#else /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
+static void serial_tx_drain(struct udevice *dev, bool wait)
+{
+}
+
+static bool serial_tx_queue(struct udevice *dev, char ch)
+{
+	return false;
+}
+
+static void serial_tx_start(struct udevice *dev)
+{
+}
+
+static void serial_tx_stop(struct udevice *dev)
+{
+}
+
+static bool serial_tx_active(struct udevice *dev)
+{
+	return false;
+}
+#endif /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
 static void _serial_flush(struct udevice *dev)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
+	serial_tx_drain(dev, true);
 	if (!ops->pending)
 		return;
 	while (ops->pending(dev, false) > 0)
@@ -256,9 +387,14 @@ static void _serial_putc(struct udevice *dev, char ch)
 	if (ch == '\n')
 		_serial_putc(dev, '\r');
 
-	do {
-		err = ops->putc(dev, ch);
-	} while (err == -EAGAIN);
+	if (serial_tx_queue(dev, ch)) {
+		/* Fill the UART FIFO now, leaving the rest for later */
+		serial_tx_drain(dev, false);
+	} else {
+		do {
+			err = ops->putc(dev, ch);
+		} while (err == -EAGAIN);
+	}
 
 	if (IS_ENABLED(CONFIG_CONSOLE_FLUSH_ON_NEWLINE) && ch == '\n')
 		_serial_flush(dev);
@@ -284,7 +420,8 @@ static void _serial_puts(struct udevice *dev, const char *str)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
-	if (!CONFIG_IS_ENABLED(SERIAL_PUTS) || !ops->puts) {
+	if (!CONFIG_IS_ENABLED(SERIAL_PUTS) || !ops->puts ||
+	    serial_tx_active(dev)) {
 		while (*str)
 			_serial_putc(dev, *str++);
 		return;
@@ -739,6 +876,7 @@ static int serial_post_probe(struct udevice *dev)
 		if (ret)
 			return ret;
 	}
+	serial_tx_start(dev);
 
 #if CONFIG_IS_ENABLED(DM_STDIO)
 	if (!(gd->flags & GD_FLG_RELOC))
@@ -767,6 +905,8 @@ static int serial_pre_remove(struct udevice *dev)
 	if (stdio_deregister_dev(upriv->sdev, true))
 		return -EPERM;
 #endif
+	/* Make sure nothing is lost, e.g. before jumping to the OS */
+	serial_tx_stop(dev);
 
 	return 0;
 }
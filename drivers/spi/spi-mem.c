@@ -14,14 +14,18 @@
 #include "internals.h"
 #else
 #include <dm.h>
+#include <dma.h>
 #include <errno.h>
 #include <malloc.h>
+#include <memalign.h>
 #include <spi.h>
 #include <spi.h>
 #include <spi-mem.h>
+#include <asm/io.h>
 #include <dm/device_compat.h>
 #include <dm/devres.h>
 #include <linux/bug.h>
+#include <linux/sizes.h>
 #endif
 
 #ifndef __UBOOT__
@@ -536,6 +540,24 @@ static ssize_t spi_mem_no_dirmap_write(struct spi_mem_dirmap_desc *desc,
 	return op.data.nbytes;
 }
 
+/* Below this size, setting up a DMA transfer costs more than it saves */
+#define SPI_MEM_DMA_MIN_LEN	SZ_4K
+
+void spi_mem_copy_from_map(void *buf, const void __iomem *src, size_t len)
+{
+	/*
+	 * The DMA engine needs cache-aligned buffers, since the destination is
+	 * invalidated after the transfer
+	 */
+	if (CONFIG_IS_ENABLED(SPI_DIRMAP_DMA) && len >= SPI_MEM_DMA_MIN_LEN &&
+	    IS_ALIGNED((ulong)buf, ARCH_DMA_MINALIGN) &&
+	    IS_ALIGNED(len, ARCH_DMA_MINALIGN) &&
+	    dma_memcpy(buf, (void *)src, len) >= 0)
+		return;
+
+	memcpy_fromio(buf, src, len);
+}
+
 /**
  * spi_mem_dirmap_create() - Create a direct mapping descriptor
  * @mem: SPI mem device this direct mapping should be created for
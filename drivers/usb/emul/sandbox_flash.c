@@ -13,11 +13,15 @@
 #include <scsi.h>
 #include <scsi_emul.h>
 #include <usb.h>
+#include <asm/test.h>
 
 /*
  * This driver emulates a flash stick using the UFI command specification and
  * the BBB (bulk/bulk/bulk) protocol. It supports only a single logical unit
  * number (LUN 0).
+ *
+ * With the "sandbox,usb3" property it instead emulates a USB 3 (SuperSpeed)
+ * stick using the SCSI transparent command set, which allows 16-byte commands.
  */
 
 enum {
@@ -44,6 +48,7 @@ enum {
  * @fd:		File descriptor of backing file
  * @file_size:	Size of file in bytes
  * @status_buff:	Data buffer for outgoing status
+ * @max_blocks:	Largest number of blocks read or written by a single command
  */
 struct sandbox_flash_priv {
 	struct scsi_emul_info eminfo;
@@ -51,6 +56,7 @@ struct sandbox_flash_priv {
 	u32 tag;
 	int fd;
 	struct umass_bbb_csw status;
+	int max_blocks;
 };
 
 struct sandbox_flash_plat {
@@ -76,6 +82,24 @@ static struct usb_device_descriptor flash_device_desc = {
 	.bNumConfigurations =	1,
 };
 
+static struct usb_device_descriptor flash_usb3_device_desc = {
+	.bLength =		sizeof(flash_usb3_device_desc),
+	.bDescriptorType =	USB_DT_DEVICE,
+
+	.bcdUSB =		__constant_cpu_to_le16(0x0300),
+
+	.bDeviceClass =		0,
+	.bDeviceSubClass =	0,
+	.bDeviceProtocol =	0,
+
+	.idVendor =		__constant_cpu_to_le16(0x1234),
+	.idProduct =		__constant_cpu_to_le16(0x5679),
+	.iManufacturer =	STRINGID_MANUFACTURER,
+	.iProduct =		STRINGID_PRODUCT,
+	.iSerialNumber =	STRINGID_SERIAL,
+	.bNumConfigurations =	1,
+};
+
 static struct usb_config_descriptor flash_config0 = {
 	.bLength		= sizeof(flash_config0),
 	.bDescriptorType	= USB_DT_CONFIG,
@@ -101,6 +125,19 @@ static struct usb_interface_descriptor flash_interface0 = {
 	.iInterface		= 0,
 };
 
+static struct usb_interface_descriptor flash_usb3_interface0 = {
+	.bLength		= sizeof(flash_usb3_interface0),
+	.bDescriptorType	= USB_DT_INTERFACE,
+
+	.bInterfaceNumber	= 0,
+	.bAlternateSetting	= 0,
+	.bNumEndpoints		= 2,
+	.bInterfaceClass	= USB_CLASS_MASS_STORAGE,
+	.bInterfaceSubClass	= US_SC_SCSI,
+	.bInterfaceProtocol	= US_PR_BULK,
+	.iInterface		= 0,
+};
+
 static struct usb_endpoint_descriptor flash_endpoint0_out = {
 	.bLength		= USB_DT_ENDPOINT_SIZE,
 	.bDescriptorType	= USB_DT_ENDPOINT,
@@ -130,6 +167,15 @@ static void *flash_desc_list[] = {
 	NULL,
 };
 
+static void *flash_usb3_desc_list[] = {
+	&flash_usb3_device_desc,
+	&flash_config0,
+	&flash_usb3_interface0,
+	&flash_endpoint0_out,
+	&flash_endpoint1_in,
+	NULL,
+};
+
 static int sandbox_flash_control(struct udevice *dev, struct usb_device *udev,
 				 unsigned long pipe, void *buff, int len,
 				 struct devrequest *setup)
@@ -194,6 +240,8 @@ static int handle_ufi_command(struct sandbox_flash_priv *priv, const void *buff,
 		setup_response(priv);
 	} else if ((ret == SCSI_EMUL_DO_READ || ret == SCSI_EMUL_DO_WRITE) &&
 		   priv->fd != -1) {
+		priv->max_blocks = max(priv->max_blocks,
+				       info->read_len + info->write_len);
 		offset = os_lseek(priv->fd, info->seek_block * info->block_size,
 				  OS_SEEK_SET);
 		if (offset < 0)
@@ -230,7 +278,7 @@ static int sandbox_flash_bulk(struct udevice *dev, struct usb_device *udev,
 			if ((cbw->bCBWFlags & CBWFLAGS_SBZ) ||
 			    cbw->bCBWLUN != 0)
 				goto err;
-			if (cbw->bCDBLength < 1 || cbw->bCDBLength >= 0x10)
+			if (cbw->bCDBLength < 1 || cbw->bCDBLength > CBWCDBLENGTH)
 				goto err;
 			info->transfer_len = cbw->dCBWDataTransferLength;
 			priv->tag = cbw->dCBWTag;
@@ -331,7 +379,9 @@ static int sandbox_flash_bind(struct udevice *dev)
 	fs[2].id = STRINGID_SERIAL;
 	fs[2].s = dev->name;
 
-	return usb_emul_setup_device(dev, plat->flash_strings, flash_desc_list);
+	return usb_emul_setup_device(dev, plat->flash_strings,
+				     dev_read_bool(dev, "sandbox,usb3") ?
+				     flash_usb3_desc_list : flash_desc_list);
 }
 
 static int sandbox_flash_probe(struct udevice *dev)
@@ -367,6 +417,13 @@ static int sandbox_flash_remove(struct udevice *dev)
 	return 0;
 }
 
+int sandbox_flash_get_max_blocks(struct udevice *dev)
+{
+	struct sandbox_flash_priv *priv = dev_get_priv(dev);
+
+	return priv->max_blocks;
+}
+
 static const struct dm_usb_ops sandbox_usb_flash_ops = {
 	.control	= sandbox_flash_control,
 	.bulk		= sandbox_flash_bulk,
@@ -187,6 +187,9 @@ int usb_stop(void)
 
 	uc_priv = uclass_get_priv(uc);
 
+	/* forget any ports left by usb_init_start(), since the hubs go away */
+	usb_hub_drop_pending();
+
 	uclass_foreach_dev(bus, uc) {
 		ret = device_remove(bus, DM_REMOVE_NORMAL);
 		if (ret && !err)
@@ -233,7 +236,13 @@ static void usb_scan_bus(struct udevice *bus, bool recurse)
 
 	printf("scanning bus %s for devices... ", bus->name);
 	debug("\n");
-	ret = usb_scan_device(bus, 0, USB_SPEED_FULL, &dev);
+	if (priv->scan_pending) {
+		/* the root hub was set up by usb_init_start() */
+		priv->scan_pending = false;
+		ret = usb_hub_scan_pending();
+	} else {
+		ret = usb_scan_device(bus, 0, USB_SPEED_FULL, &dev);
+	}
 	if (ret)
 		printf("failed, error %d\n", ret);
 	else if (priv->next_addr == 0)
@@ -287,26 +296,30 @@ static int usb_probe_companion(struct udevice *bus)
 	return 0;
 }
 
-int usb_init(void)
+/*
+ * Probe all the controllers, returning the number which were initialised. If
+ * @show is false, nothing is printed, since the buses are not going to be
+ * scanned yet. Any controller which fails is tried again by usb_init(), which
+ * reports the error.
+ */
+static int usb_probe_controllers(struct uclass *uc, bool show)
 {
 	int controllers_initialized = 0;
-	struct usb_uclass_priv *uc_priv;
-	struct usb_bus_priv *priv;
 	struct udevice *bus;
-	struct uclass *uc;
 	int ret;
 
-	asynch_allowed = 1;
-
-	ret = uclass_get(UCLASS_USB, &uc);
-	if (ret)
-		return ret;
+	uclass_foreach_dev(bus, uc) {
+		if (show)
+			printf("Bus %s: ", bus->name);
 
-	uc_priv = uclass_get_priv(uc);
+		/* already started by usb_init_start() */
+		if (device_active(bus)) {
+			controllers_initialized++;
+			usb_started = true;
+			continue;
+		}
 
-	uclass_foreach_dev(bus, uc) {
 		/* init low_level USB */
-		printf("Bus %s: ", bus->name);
 
 		/*
 		 * For Sandbox, we need scan the device tree each time when we
@@ -321,20 +334,24 @@ int usb_init(void)
 		    IS_ENABLED(CONFIG_USB_ONBOARD_HUB)) {
 			ret = dm_scan_fdt_dev(bus);
 			if (ret) {
-				printf("USB device scan from fdt failed (%d)", ret);
+				if (show)
+					printf("USB device scan from fdt failed (%d)",
+					       ret);
 				continue;
 			}
 		}
 
 		ret = device_probe(bus);
 		if (ret == -ENODEV) {	/* No such device. */
-			puts("Port not available.\n");
+			if (show)
+				puts("Port not available.\n");
 			controllers_initialized++;
 			continue;
 		}
 
 		if (ret) {		/* Other error. */
-			printf("probe failed, error %d\n", ret);
+			if (show)
+				printf("probe failed, error %d\n", ret);
 			continue;
 		}
 
@@ -346,6 +363,83 @@ int usb_init(void)
 		usb_started = true;
 	}
 
+	return controllers_initialized;
+}
+
+int usb_init_start(void)
+{
+	struct usb_bus_priv *priv;
+	struct udevice *bus, *dev;
+	struct uclass *uc;
+	int ret;
+
+	if (usb_started)
+		return 0;
+
+	ret = uclass_get(UCLASS_USB, &uc);
+	if (ret)
+		return ret;
+
+	asynch_allowed = 1;
+	usb_probe_controllers(uc, false);
+
+	/* the buses are not scanned yet, so let usb_init() do that */
+	usb_started = false;
+
+	/*
+	 * A primary controller hands devices over to its companion while its
+	 * ports are scanned, so leave the whole scan to usb_init() in that case
+	 */
+	uclass_foreach_dev(bus, uc) {
+		if (!device_active(bus))
+			continue;
+		priv = dev_get_uclass_priv(bus);
+		if (priv->companion)
+			return 0;
+	}
+
+	/*
+	 * Set up each root hub, which powers up its ports, so that the
+	 * power-on and connect delays pass before usb_init() scans them
+	 */
+	usb_hub_set_defer(true);
+	uclass_foreach_dev(bus, uc) {
+		if (!device_active(bus))
+			continue;
+		priv = dev_get_uclass_priv(bus);
+		if (priv->scan_pending)
+			continue;
+		ret = usb_scan_device(bus, 0, USB_SPEED_FULL, &dev);
+		if (ret)
+			log_debug("Cannot start bus %s (err=%d)\n", bus->name,
+				  ret);
+		else
+			priv->scan_pending = true;
+	}
+	usb_hub_set_defer(false);
+
+	return 0;
+}
+
+int usb_init(void)
+{
+	int controllers_initialized;
+	struct usb_uclass_priv *uc_priv;
+	struct usb_bus_priv *priv;
+	struct udevice *bus;
+	struct uclass *uc;
+	int ret;
+
+	asynch_allowed = 1;
+
+	ret = uclass_get(UCLASS_USB, &uc);
+	if (ret)
+		return ret;
+
+	uc_priv = uclass_get_priv(uc);
+
+	controllers_initialized = usb_probe_controllers(uc, true);
+
 	/*
 	 * lowlevel init done, now scan the bus for devices i.e. search HUBs
 	 * and configure them, first scan primary controllers.
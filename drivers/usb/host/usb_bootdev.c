@@ -27,6 +27,14 @@ static int usb_bootdev_hunt(struct bootdev_hunter *info, bool show)
 	return usb_init();
 }
 
+static int usb_bootdev_start(struct bootdev_hunter *info, bool show)
+{
+	if (!CONFIG_IS_ENABLED(DM_USB) || usb_started)
+		return 0;
+
+	return usb_init_start();
+}
+
 struct bootdev_ops usb_bootdev_ops = {
 };
 
@@ -46,6 +54,7 @@ U_BOOT_DRIVER(usb_bootdev) = {
 BOOTDEV_HUNTER(usb_bootdev_hunter) = {
 	.prio		= BOOTDEVP_5_SCAN_SLOW,
 	.uclass		= UCLASS_USB,
+	.start		= usb_bootdev_start,
 	.hunt		= usb_bootdev_hunt,
 	.drv		= DM_DRIVER_REF(usb_bootdev),
 };
@@ -42,25 +42,6 @@ int check_bpix_support(int bpix)
 		return -ENOSYS;
 }
 
-inline void fill_pixel_and_goto_next(void **dstp, u32 value, int pbytes, int step)
-{
-	u8 *dst_byte = *dstp;
-
-	if (pbytes == 4) {
-		u32 *dst = *dstp;
-		*dst = value;
-	}
-	if (pbytes == 2) {
-		u16 *dst = *dstp;
-		*dst = value;
-	}
-	if (pbytes == 1) {
-		u8 *dst = *dstp;
-		*dst = value;
-	}
-	*dstp = dst_byte + step;
-}
-
 inline u32 swap_pixel_and_goto_next(void **dstp, u32 value, int pbytes, int step)
 {
 	u8 *dst_byte = *dstp;
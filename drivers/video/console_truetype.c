@@ -14,6 +14,7 @@
 #include <video.h>
 #include <video_console.h>
 #include <video_font.h>
+#include <linux/list.h>
 #include "vidconsole_internal.h"
 
 /* Functions needed by stb_truetype.h */
@@ -164,6 +165,36 @@ struct console_tt_metrics {
 	double scale;
 };
 
+/**
+ * struct console_tt_glyph - A rendered glyph held in the glyph cache
+ *
+ * Rendering a glyph is by far the slowest part of drawing a character, so the
+ * images are kept and reused while the same font / size / character / sub-pixel
+ * position keeps being drawn, e.g. when a menu is redrawn.
+ *
+ * @sibling:	Node in the glyph cache, most recently used first
+ * @met:	Font / size combination which the glyph was rendered with
+ * @cp:		Unicode code point of the character
+ * @x_shift:	Fraction of a pixel by which the glyph is shifted to the right
+ * @width:	Width of @data in pixels
+ * @height:	Height of @data in pixels
+ * @xoff:	X offset of @data from the cursor position in pixels
+ * @yoff:	Y offset of @data from the baseline in pixels
+ * @data:	8-bit-per-pixel alpha image, or NULL if the glyph is empty (e.g.
+ *		a space)
+ */
+struct console_tt_glyph {
+	struct list_head sibling;
+	struct console_tt_metrics *met;
+	int cp;
+	double x_shift;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	u8 *data;
+};
+
 /**
  * struct console_tt_priv - Private data for this driver
  *
@@ -180,6 +211,12 @@ struct console_tt_metrics {
  * @pos_start:	Value of pos_ptr when the cursor is at the start of the text
  *	being entered by the user
  * @pos_count:	Maximum value reached by pos_ptr (initially zero)
+ * @glyphs:	Cache of rendered glyphs (struct console_tt_glyph), most recently
+ *	used first
+ * @num_glyphs:	Number of glyphs in the cache, at most
+ *	CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE
+ * @glyph_hits:	Number of glyphs found in the cache
+ * @glyph_misses:	Number of glyphs which had to be rendered
  */
 struct console_tt_priv {
 	struct console_tt_metrics *cur_met;
@@ -190,6 +227,10 @@ struct console_tt_priv {
 	struct video_fontdata *cur_fontdata;
 	int pos_start;
 	int pos_count;
+	struct list_head glyphs;
+	int num_glyphs;
+	ulong glyph_hits;
+	ulong glyph_misses;
 };
 
 /**
@@ -210,6 +251,7 @@ static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	void *end, *line;
 	int font_height;
+	bool fill;
 
 	/* Get font height from current font type */
 	if (priv->cur_fontdata)
@@ -221,36 +263,21 @@ static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 	end = line + font_height * vid_priv->line_length;
 
 	switch (vid_priv->bpix) {
-	case VIDEO_BPP8: {
-		u8 *dst;
-
-		if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-			for (dst = line; dst < (u8 *)end; ++dst)
-				*dst = clr;
-		}
+	case VIDEO_BPP8:
+		fill = IS_ENABLED(CONFIG_VIDEO_BPP8);
 		break;
-	}
-	case VIDEO_BPP16: {
-		u16 *dst = line;
-
-		if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-			for (dst = line; dst < (u16 *)end; ++dst)
-				*dst = clr;
-		}
+	case VIDEO_BPP16:
+		fill = IS_ENABLED(CONFIG_VIDEO_BPP16);
 		break;
-	}
-	case VIDEO_BPP32: {
-		u32 *dst = line;
-
-		if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-			for (dst = line; dst < (u32 *)end; ++dst)
-				*dst = clr;
-		}
+	case VIDEO_BPP32:
+		fill = IS_ENABLED(CONFIG_VIDEO_BPP32);
 		break;
-	}
 	default:
 		return -ENOSYS;
 	}
+	if (fill)
+		video_fill_pixels(line, clr, vid_priv->bpix,
+				  (end - line) / VNBYTES(vid_priv->bpix));
 
 	video_damage(dev->parent,
 		     0,
@@ -347,6 +374,66 @@ static void clear_from(struct udevice *dev, int index)
 	}
 }
 
+/**
+ * get_glyph() - Get the image of a character, rendering it if needed
+ *
+ * If the glyph is not in the cache it is rendered and added, evicting the
+ * least recently used glyph if the cache is full. If it cannot be cached, it is
+ * rendered into @tmp instead and the caller must free @tmp->data when done
+ *
+ * @dev:	Console device
+ * @met:	Font / size to use
+ * @cp:		Unicode code point of the character
+ * @x_shift:	Fraction of a pixel by which to shift the glyph to the right
+ * @tmp:	Used to hold the glyph if it is not cached
+ * Return: glyph, which is @tmp if it was not cached
+ */
+static struct console_tt_glyph *get_glyph(struct udevice *dev,
+					  struct console_tt_metrics *met,
+					  int cp, double x_shift,
+					  struct console_tt_glyph *tmp)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	struct console_tt_glyph *glyph;
+
+	list_for_each_entry(glyph, &priv->glyphs, sibling) {
+		if (glyph->met == met && glyph->cp == cp &&
+		    glyph->x_shift == x_shift) {
+			list_move(&glyph->sibling, &priv->glyphs);
+			priv->glyph_hits++;
+			return glyph;
+		}
+	}
+	priv->glyph_misses++;
+
+	tmp->met = met;
+	tmp->cp = cp;
+	tmp->x_shift = x_shift;
+	tmp->data = stbtt_GetCodepointBitmapSubpixel(&met->font, met->scale,
+						     met->scale, x_shift, 0, cp,
+						     &tmp->width, &tmp->height,
+						     &tmp->xoff, &tmp->yoff);
+	if (!CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE)
+		return tmp;
+
+	if (priv->num_glyphs == CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE) {
+		glyph = list_last_entry(&priv->glyphs, struct console_tt_glyph,
+					sibling);
+		list_del(&glyph->sibling);
+		free(glyph->data);
+	} else {
+		/* Failing to cache a glyph just means drawing it is slower */
+		glyph = malloc(sizeof(*glyph));
+		if (!glyph)
+			return tmp;
+		priv->num_glyphs++;
+	}
+	*glyph = *tmp;
+	list_add(&glyph->sibling, &priv->glyphs);
+
+	return glyph;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    int cp)
 {
@@ -355,13 +442,14 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	struct console_tt_metrics *met = priv->cur_met;
+	struct console_tt_glyph *glyph, tmp;
 	stbtt_fontinfo *font;
 	int width, height, xoff, yoff;
 	double xpos, x_shift;
 	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
+	const u8 *bits;
 	int advance;
 	void *start, *end, *line;
 	int row, kern;
@@ -436,19 +524,20 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	}
 
 	/*
-	 * Figure out how much past the start of a pixel we are, and pass this
-	 * information into the render, which will return a 8-bit-per-pixel
-	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
+	 * Figure out how much past the start of a pixel we are, and use this
+	 * to get an 8-bit-per-pixel image of the character. For empty
+	 * characters, like ' ', there is no image
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, met->scale, met->scale,
-						x_shift, 0, cp, &width, &height,
-						&xoff, &yoff);
-	if (!data)
+	glyph = get_glyph(dev, met, cp, x_shift, &tmp);
+	if (!glyph->data)
 		return width_frac;
+	width = glyph->width;
+	height = glyph->height;
+	xoff = glyph->xoff;
+	yoff = glyph->yoff;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
+	bits = glyph->data;
 	start = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
 	linenum = met->baseline + yoff;
@@ -534,7 +623,8 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 			break;
 		}
 		default:
-			free(data);
+			if (glyph == &tmp)
+				free(tmp.data);
 			return -ENOSYS;
 		}
 
@@ -547,7 +637,8 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 		     width,
 		     height);
 
-	free(data);
+	if (glyph == &tmp)
+		free(tmp.data);
 
 	return width_frac;
 }
@@ -1156,6 +1247,7 @@ static int console_truetype_probe(struct udevice *dev)
 	int ret;
 
 	debug("%s: start\n", __func__);
+	INIT_LIST_HEAD(&priv->glyphs);
 	if (vid_priv->font_size)
 		font_size = vid_priv->font_size;
 	else
@@ -1182,6 +1274,33 @@ static int console_truetype_probe(struct udevice *dev)
 	return 0;
 }
 
+void console_truetype_glyph_stats(struct udevice *dev, ulong *hitsp,
+				  ulong *missesp, int *countp)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+
+	*hitsp = priv->glyph_hits;
+	*missesp = priv->glyph_misses;
+	*countp = priv->num_glyphs;
+}
+
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	struct console_tt_glyph *glyph, *next;
+
+	log_debug("glyph cache: %lu hits, %lu misses\n", priv->glyph_hits,
+		  priv->glyph_misses);
+	list_for_each_entry_safe(glyph, next, &priv->glyphs, sibling) {
+		list_del(&glyph->sibling);
+		free(glyph->data);
+		free(glyph);
+	}
+	priv->num_glyphs = 0;
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -1204,5 +1323,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto	= sizeof(struct console_tt_priv),
 };
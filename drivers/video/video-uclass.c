@@ -190,49 +190,96 @@ ulong video_get_fb(void)
 	return 0;
 }
 
+void fill_pixel_and_goto_next(void **dstp, u32 value, int pbytes, int step)
+{
+	u8 *dst_byte = *dstp;
+
+	if (pbytes == 4) {
+		u32 *dst = *dstp;
+		*dst = value;
+	}
+	if (pbytes == 2) {
+		u16 *dst = *dstp;
+		*dst = value;
+	}
+	if (pbytes == 1) {
+		u8 *dst = *dstp;
+		*dst = value;
+	}
+	*dstp = dst_byte + step;
+}
+
+void video_fill_pixels(void *dst, u32 colour, enum video_log2_bpp bpix,
+		       int count)
+{
+	int pbytes = VNBYTES(bpix);
+	void *end = dst + count * pbytes;
+	ulong pattern, *wdst, *wend;
+
+	/* Repeat the pixel to fill a word */
+	switch (bpix) {
+	case VIDEO_BPP8:
+		pattern = (u8)colour * (~0UL / 0xff);
+		break;
+	case VIDEO_BPP16:
+		pattern = (u16)colour * (~0UL / 0xffff);
+		break;
+	default:
+		pattern = colour * (~0UL / 0xffffffff);
+		break;
+	}
+
+	/* Write single pixels up to the first word boundary... */
+	while (dst < end && ((ulong)dst & (sizeof(ulong) - 1)))
+		fill_pixel_and_goto_next(&dst, colour, pbytes, pbytes);
+
+	/* ...then whole words... */
+	wdst = dst;
+	wend = (ulong *)ALIGN_DOWN((ulong)end, sizeof(ulong));
+	while (wdst + 4 <= wend) {
+		wdst[0] = pattern;
+		wdst[1] = pattern;
+		wdst[2] = pattern;
+		wdst[3] = pattern;
+		wdst += 4;
+	}
+	while (wdst < wend)
+		*wdst++ = pattern;
+
+	/* ...and whatever is left over */
+	dst = wdst;
+	while (dst < end)
+		fill_pixel_and_goto_next(&dst, colour, pbytes, pbytes);
+}
+
 int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 		    int yend, u32 colour)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 	void *start, *line;
 	int pixels = xend - xstart;
-	int row, i;
+	bool fill;
+	int row;
+
+	switch (priv->bpix) {
+	case VIDEO_BPP8:
+		fill = IS_ENABLED(CONFIG_VIDEO_BPP8);
+		break;
+	case VIDEO_BPP16:
+		fill = IS_ENABLED(CONFIG_VIDEO_BPP16);
+		break;
+	case VIDEO_BPP32:
+		fill = IS_ENABLED(CONFIG_VIDEO_BPP32);
+		break;
+	default:
+		return -ENOSYS;
+	}
 
 	start = priv->fb + ystart * priv->line_length;
 	start += xstart * VNBYTES(priv->bpix);
 	line = start;
-	for (row = ystart; row < yend; row++) {
-		switch (priv->bpix) {
-		case VIDEO_BPP8: {
-			u8 *dst = line;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-				for (i = 0; i < pixels; i++)
-					*dst++ = colour;
-			}
-			break;
-		}
-		case VIDEO_BPP16: {
-			u16 *dst = line;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-				for (i = 0; i < pixels; i++)
-					*dst++ = colour;
-			}
-			break;
-		}
-		case VIDEO_BPP32: {
-			u32 *dst = line;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-				for (i = 0; i < pixels; i++)
-					*dst++ = colour;
-			}
-			break;
-		}
-		default:
-			return -ENOSYS;
-		}
+	for (row = ystart; fill && row < yend; row++) {
+		video_fill_pixels(line, colour, priv->bpix, pixels);
 		line += priv->line_length;
 	}
 
@@ -302,20 +349,14 @@ int video_fill(struct udevice *dev, u32 colour)
 	switch (priv->bpix) {
 	case VIDEO_BPP16:
 		if (CONFIG_IS_ENABLED(VIDEO_BPP16)) {
-			u16 *ppix = priv->fb;
-			u16 *end = priv->fb + priv->fb_size;
-
-			while (ppix < end)
-				*ppix++ = colour;
+			video_fill_pixels(priv->fb, colour, priv->bpix,
+					  priv->fb_size / 2);
 			break;
 		}
 	case VIDEO_BPP32:
 		if (CONFIG_IS_ENABLED(VIDEO_BPP32)) {
-			u32 *ppix = priv->fb;
-			u32 *end = priv->fb + priv->fb_size;
-
-			while (ppix < end)
-				*ppix++ = colour;
+			video_fill_pixels(priv->fb, colour, priv->bpix,
+					  priv->fb_size / 4);
 			break;
 		}
 	default:
@@ -430,8 +471,84 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = video_index_to_colour(priv, back);
 }
 
-/* Notify about changes in the frame buffer */
 #ifdef CONFIG_VIDEO_DAMAGE
+static int bbox_area(const struct vid_bbox *bbox)
+{
+	return (bbox->x1 - bbox->x0) * (bbox->y1 - bbox->y0);
+}
+
+static void bbox_join(struct vid_bbox *dst, const struct vid_bbox *src)
+{
+	dst->x0 = min(dst->x0, src->x0);
+	dst->y0 = min(dst->y0, src->y0);
+	dst->x1 = max(dst->x1, src->x1);
+	dst->y1 = max(dst->y1, src->y1);
+}
+
+/* Get the number of extra pixels covered if @a and @b are joined */
+static int bbox_join_cost(const struct vid_bbox *a, const struct vid_bbox *b)
+{
+	struct vid_bbox join = *a;
+
+	bbox_join(&join, b);
+
+	return bbox_area(&join) - bbox_area(a) - bbox_area(b);
+}
+
+/**
+ * damage_add() - Add a rectangle to the list of damaged regions
+ *
+ * The rectangle is joined with any region it overlaps or sits close beside,
+ * such as the previous character on a line of text, so long as that adds no
+ * more than a quarter to the area covered. This is repeated while the joined
+ * region can absorb others. If there is no space for a new region, it is
+ * joined with the one which grows least as a result.
+ *
+ * @priv:	Video device's uclass-private data
+ * @x0:		X start position of the damage
+ * @y0:		Y start position of the damage
+ * @x1:		X end position of the damage
+ * @y1:		Y end position of the damage
+ */
+static void damage_add(struct video_priv *priv, int x0, int y0, int x1,
+		       int y1)
+{
+	struct vid_bbox new = { max(x0, 0), max(y0, 0), x1, y1 };
+	int i, best, cost, best_cost;
+
+	if (x1 <= new.x0 || y1 <= new.y0)
+		return;
+
+	for (i = 0; i < priv->damage_count; i++) {
+		struct vid_bbox *rect = &priv->damage_rect[i];
+
+		if (bbox_join_cost(rect, &new) * 4 <=
+		    bbox_area(rect) + bbox_area(&new)) {
+			/* Take it out of the list and start again */
+			bbox_join(&new, rect);
+			*rect = priv->damage_rect[--priv->damage_count];
+			i = -1;
+		}
+	}
+
+	if (priv->damage_count < VIDEO_DAMAGE_RECTS) {
+		priv->damage_rect[priv->damage_count++] = new;
+		return;
+	}
+
+	best = 0;
+	best_cost = INT_MAX;
+	for (i = 0; i < priv->damage_count; i++) {
+		cost = bbox_join_cost(&priv->damage_rect[i], &new);
+		if (cost < best_cost) {
+			best = i;
+			best_cost = cost;
+		}
+	}
+	bbox_join(&priv->damage_rect[best], &new);
+}
+
+/* Notify about changes in the frame buffer */
 void video_damage(struct udevice *vid, int x, int y, int width, int height)
 {
 	struct video_priv *priv = dev_get_uclass_priv(vid);
@@ -456,6 +573,8 @@ void video_damage(struct udevice *vid, int x, int y, int width, int height)
 	damage->y0 = min(y, damage->y0);
 	damage->x1 = max(xend, damage->x1);
 	damage->y1 = max(yend, damage->y1);
+
+	damage_add(priv, x, y, xend, yend);
 }
 #endif
 
@@ -464,6 +583,7 @@ static void video_flush_dcache(struct udevice *vid, bool use_copy)
 	struct video_priv *priv = dev_get_uclass_priv(vid);
 	ulong fb = use_copy ? (ulong)priv->copy_fb : (ulong)priv->fb;
 	uint cacheline_size = 32;
+	int i;
 
 #ifdef CONFIG_SYS_CACHELINE_SIZE
 	cacheline_size = CONFIG_SYS_CACHELINE_SIZE;
@@ -482,12 +602,13 @@ static void video_flush_dcache(struct udevice *vid, bool use_copy)
 		return;
 	}
 
-	if (priv->damage.x1 && priv->damage.y1) {
-		int lstart = priv->damage.x0 * VNBYTES(priv->bpix);
-		int lend = priv->damage.x1 * VNBYTES(priv->bpix);
+	for (i = 0; i < priv->damage_count; i++) {
+		const struct vid_bbox *rect = &priv->damage_rect[i];
+		int lstart = rect->x0 * VNBYTES(priv->bpix);
+		int lend = rect->x1 * VNBYTES(priv->bpix);
 		int y;
 
-		for (y = priv->damage.y0; y < priv->damage.y1; y++) {
+		for (y = rect->y0; y < rect->y1; y++) {
 			ulong start = fb + (y * priv->line_length) + lstart;
 			ulong end = start + lend - lstart;
 
@@ -502,22 +623,32 @@ static void video_flush_dcache(struct udevice *vid, bool use_copy)
 static void video_flush_copy(struct udevice *vid)
 {
 	struct video_priv *priv = dev_get_uclass_priv(vid);
-	struct vid_bbox *damage = &priv->damage;
+	int i;
 
 	if (!priv->copy_fb)
 		return;
 
-	if (damage->x1 && damage->y1) {
-		int lstart = damage->x0 * VNBYTES(priv->bpix);
-		int lend = damage->x1 * VNBYTES(priv->bpix);
+	priv->copy_bytes = 0;
+	for (i = 0; i < priv->damage_count; i++) {
+		const struct vid_bbox *rect = &priv->damage_rect[i];
+		int lstart = rect->x0 * VNBYTES(priv->bpix);
+		ulong len = (rect->x1 - rect->x0) * VNBYTES(priv->bpix);
+		ulong offset = rect->y0 * priv->line_length + lstart;
 		int y;
 
-		for (y = damage->y0; y < damage->y1; y++) {
-			ulong offset = (y * priv->line_length) + lstart;
-			ulong len = lend - lstart;
+		/* Full-width lines with no padding can be copied in one go */
+		if (len == priv->line_length) {
+			len *= rect->y1 - rect->y0;
+			memcpy(priv->copy_fb + offset, priv->fb + offset, len);
+			priv->copy_bytes += len;
+			continue;
+		}
 
+		for (y = rect->y0; y < rect->y1; y++) {
 			memcpy(priv->copy_fb + offset, priv->fb + offset, len);
+			offset += priv->line_length;
 		}
+		priv->copy_bytes += len * (rect->y1 - rect->y0);
 	}
 }
 
@@ -548,6 +679,7 @@ int video_manual_sync(struct udevice *vid, uint flags)
 		damage->y0 = priv->ysize;
 		damage->x1 = 0;
 		damage->y1 = 0;
+		priv->damage_count = 0;
 	}
 
 	return 0;
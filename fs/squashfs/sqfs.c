@@ -99,26 +99,16 @@ static int sqfs_calc_n_blks(__le64 start, __le64 end, u64 *offset)
 }
 
 /*
- * Retrieves fragment block entry and returns true if the fragment block is
- * compressed
+ * Reads the fragment index table, which holds the on-disk offset of each
+ * metadata block containing fragment block entries. This is kept for as long
+ * as the filesystem is mounted.
  */
-static int sqfs_frag_lookup(u32 inode_fragment_index,
-			    struct squashfs_fragment_block_entry *e)
+static int sqfs_read_frag_index(void)
 {
-	u64 start, end, exp_tbl, n_blks, src_len, table_offset, start_block;
-	unsigned char *metadata_buffer, *metadata, *table;
-	struct squashfs_fragment_block_entry *entries;
+	u64 start, end, exp_tbl, n_blks, table_offset;
 	struct squashfs_super_block *sblk = ctxt.sblk;
-	unsigned long dest_len;
-	int block, offset, ret;
-	u16 header;
-
-	metadata_buffer = NULL;
-	entries = NULL;
-	table = NULL;
-
-	if (inode_fragment_index >= get_unaligned_le32(&sblk->fragments))
-		return -EINVAL;
+	unsigned char *table;
+	int i, count;
 
 	start = get_unaligned_le64(&sblk->fragment_table_start);
 	end = get_unaligned_le64(&sblk->id_table_start);
@@ -127,6 +117,11 @@ static int sqfs_frag_lookup(u32 inode_fragment_index,
 	if (exp_tbl > start && exp_tbl < end)
 		end = exp_tbl;
 
+	count = DIV_ROUND_UP(get_unaligned_le32(&sblk->fragments),
+			     SQFS_MAX_ENTRIES);
+	if (count * sizeof(u64) > end - start)
+		return -EINVAL;
+
 	n_blks = sqfs_calc_n_blks(sblk->fragment_table_start,
 				  cpu_to_le64(end), &table_offset);
 
@@ -134,14 +129,51 @@ static int sqfs_frag_lookup(u32 inode_fragment_index,
 
 	/* Allocate a proper sized buffer to store the fragment index table */
 	table = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
-	if (!table) {
-		ret = -ENOMEM;
-		goto out;
-	}
+	if (!table)
+		return -ENOMEM;
 
 	if (sqfs_disk_read(start, n_blks, table) < 0) {
-		ret = -EINVAL;
-		goto out;
+		free(table);
+		return -EINVAL;
+	}
+
+	ctxt.frag_index = malloc(count * sizeof(u64));
+	if (!ctxt.frag_index) {
+		free(table);
+		return -ENOMEM;
+	}
+	for (i = 0; i < count; i++)
+		ctxt.frag_index[i] = get_unaligned_le64(table + table_offset +
+							i * sizeof(u64));
+	free(table);
+
+	return 0;
+}
+
+/*
+ * Retrieves fragment block entry and returns true if the fragment block is
+ * compressed
+ */
+static int sqfs_frag_lookup(u32 inode_fragment_index,
+			    struct squashfs_fragment_block_entry *e)
+{
+	u64 n_blks, src_len, table_offset, start, start_block, end;
+	struct squashfs_fragment_block_entry *entries;
+	struct squashfs_super_block *sblk = ctxt.sblk;
+	unsigned char *metadata_buffer, *metadata;
+	unsigned long dest_len;
+	int block, offset, ret;
+	u16 header;
+
+	metadata_buffer = NULL;
+
+	if (inode_fragment_index >= get_unaligned_le32(&sblk->fragments))
+		return -EINVAL;
+
+	if (!ctxt.frag_index) {
+		ret = sqfs_read_frag_index();
+		if (ret)
+			return ret;
 	}
 
 	block = SQFS_FRAGMENT_INDEX(inode_fragment_index);
@@ -151,12 +183,25 @@ static int sqfs_frag_lookup(u32 inode_fragment_index,
 	 * Get the start offset of the metadata block that contains the right
 	 * fragment block entry
 	 */
-	start_block = get_unaligned_le64(table + table_offset + block *
-					 sizeof(u64));
+	start_block = ctxt.frag_index[block];
+
+	entries = sqfs_cache_get(&ctxt.meta_cache, start_block, &dest_len);
+	if (entries) {
+		if ((offset + 1) * sizeof(*e) > dest_len)
+			return -EINVAL;
+		*e = entries[offset];
+		return SQFS_COMPRESSED_BLOCK(e->size);
+	}
 
+	/* Read just the metadata block, which cannot extend past the index */
+	end = min_t(u64, start_block + SQFS_HEADER_SIZE +
+		    SQFS_METADATA_BLOCK_SIZE,
+		    get_unaligned_le64(&sblk->fragment_table_start));
+	if (end <= start_block + SQFS_HEADER_SIZE)
+		return -EINVAL;
 	start = start_block / ctxt.cur_dev->blksz;
-	n_blks = sqfs_calc_n_blks(cpu_to_le64(start_block),
-				  sblk->fragment_table_start, &table_offset);
+	n_blks = sqfs_calc_n_blks(cpu_to_le64(start_block), cpu_to_le64(end),
+				  &table_offset);
 
 	metadata_buffer = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
 	if (!metadata_buffer) {
@@ -184,6 +229,11 @@ static int sqfs_frag_lookup(u32 inode_fragment_index,
 		goto out;
 	}
 
+	if (SQFS_METADATA_SIZE(header) > end - start_block - SQFS_HEADER_SIZE) {
+		ret = -EINVAL;
+		goto out;
+	}
+
 	if (SQFS_COMPRESSED_METADATA(header)) {
 		src_len = SQFS_METADATA_SIZE(header);
 		dest_len = SQFS_METADATA_BLOCK_SIZE;
@@ -194,16 +244,21 @@ static int sqfs_frag_lookup(u32 inode_fragment_index,
 			goto out;
 		}
 	} else {
-		memcpy(entries, metadata, SQFS_METADATA_SIZE(header));
+		dest_len = SQFS_METADATA_SIZE(header);
+		memcpy(entries, metadata, dest_len);
 	}
+	sqfs_cache_add(&ctxt.meta_cache, start_block, entries, dest_len);
 
+	if ((offset + 1) * sizeof(*e) > dest_len) {
+		ret = -EINVAL;
+		goto out;
+	}
 	*e = entries[offset];
 	ret = SQFS_COMPRESSED_BLOCK(e->size);
 
 out:
 	free(entries);
 	free(metadata_buffer);
-	free(table);
 
 	return ret;
 }
@@ -897,13 +952,48 @@ out:
 	return metablks_count;
 }
 
+/*
+ * Reads and decompresses the inode and directory tables. Every path lookup
+ * needs both of them, so they are kept for as long as the filesystem is
+ * mounted.
+ */
+static int sqfs_read_tables(void)
+{
+	int ret;
+
+	if (ctxt.inode_table)
+		return 0;
+
+	ret = sqfs_read_inode_table(&ctxt.inode_table);
+	if (ret)
+		return ret;
+
+	ret = sqfs_read_directory_table(&ctxt.dir_table, &ctxt.dir_pos_list);
+	if (ret < 1) {
+		free(ctxt.inode_table);
+		ctxt.inode_table = NULL;
+		return -EINVAL;
+	}
+	ctxt.dir_metablks = ret;
+
+	return 0;
+}
+
+static void sqfs_free_tables(void)
+{
+	free(ctxt.inode_table);
+	ctxt.inode_table = NULL;
+	free(ctxt.dir_table);
+	ctxt.dir_table = NULL;
+	free(ctxt.dir_pos_list);
+	ctxt.dir_pos_list = NULL;
+}
+
 static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 {
-	unsigned char *inode_table = NULL, *dir_table = NULL;
-	int j, token_count = 0, ret = 0, metablks_count;
+	int j, token_count = 0, ret = 0;
 	struct squashfs_dir_stream *dirs;
 	char **token_list = NULL, *path = NULL;
-	u32 *pos_list = NULL;
 
 	dirs = calloc(1, sizeof(*dirs));
 	if (!dirs)
@@ -916,18 +1006,12 @@ static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 	dirs->inode_table = NULL;
 	dirs->dir_table = NULL;
 
-	ret = sqfs_read_inode_table(&inode_table);
+	ret = sqfs_read_tables();
 	if (ret) {
 		ret = -EINVAL;
 		goto out;
 	}
 
-	metablks_count = sqfs_read_directory_table(&dir_table, &pos_list);
-	if (metablks_count < 1) {
-		ret = -EINVAL;
-		goto out;
-	}
-
 	/* Tokenize filename */
 	token_count = sqfs_count_tokens(filename);
 	if (token_count < 0) {
@@ -955,10 +1039,10 @@ static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 	 * ldir's (extended directory) size is greater than dir, so it works as
 	 * a general solution for the malloc size, since 'i' is a union.
 	 */
-	dirs->inode_table = inode_table;
-	dirs->dir_table = dir_table;
-	ret = sqfs_search_dir(dirs, token_list, token_count, pos_list,
-			      metablks_count);
+	dirs->inode_table = ctxt.inode_table;
+	dirs->dir_table = ctxt.dir_table;
+	ret = sqfs_search_dir(dirs, token_list, token_count, ctxt.dir_pos_list,
+			      ctxt.dir_metablks);
 	if (ret)
 		goto out;
 
@@ -982,12 +1066,9 @@ out:
 	for (j = 0; j < token_count; j++)
 		free(token_list[j]);
 	free(token_list);
-	free(pos_list);
 	free(path);
-	if (ret) {
-		free(inode_table);
+	if (ret)
 		free(dirs);
-	}
 
 	return ret;
 }
@@ -1141,6 +1222,14 @@ int sqfs_probe(struct blk_desc *fs_dev_desc, struct disk_partition *fs_partition
 	}
 
 	ctxt.sblk = sblk;
+	ctxt.frag_index = NULL;
+	ctxt.inode_table = NULL;
+	ctxt.dir_table = NULL;
+	ctxt.dir_pos_list = NULL;
+	sqfs_cache_init(&ctxt.meta_cache, "metadata",
+			CONFIG_VAL(SQUASHFS_METADATA_CACHE));
+	sqfs_cache_init(&ctxt.frag_cache, "fragment",
+			CONFIG_VAL(SQUASHFS_FRAGMENT_CACHE));
 
 	ret = sqfs_decompressor_init(&ctxt);
 	if (ret) {
@@ -1568,6 +1657,23 @@ static int sqfs_read_nest(const char *filename, void *buf, loff_t offset,
 		goto out;
 	}
 
+	/* Fragment blocks are often shared by many small files */
+	if (finfo.comp) {
+		fragment_block = sqfs_cache_get(&ctxt.frag_cache,
+						frag_entry.start, &dest_len);
+		if (fragment_block) {
+			if (finfo.offset + finfo.size - *actread > dest_len) {
+				ret = -EINVAL;
+				goto out;
+			}
+			memcpy(buf + *actread, &fragment_block[finfo.offset],
+			       finfo.size - *actread);
+			*actread = finfo.size;
+			ret = 0;
+			goto out;
+		}
+	}
+
 	start = lldiv(frag_entry.start, ctxt.cur_dev->blksz);
 	table_size = SQFS_BLOCK_SIZE(frag_entry.size);
 	table_offset = frag_entry.start - (start * ctxt.cur_dev->blksz);
@@ -1600,10 +1706,17 @@ static int sqfs_read_nest(const char *filename, void *buf, loff_t offset,
 			free(fragment_block);
 			goto out;
 		}
+		if (finfo.offset + finfo.size - *actread > dest_len) {
+			free(fragment_block);
+			ret = -EINVAL;
+			goto out;
+		}
 
 		memcpy(buf + *actread, &fragment_block[finfo.offset], finfo.size - *actread);
 		*actread = finfo.size;
 
+		sqfs_cache_add(&ctxt.frag_cache, frag_entry.start,
+			       fragment_block, dest_len);
 		free(fragment_block);
 
 	} else if (finfo.frag && !finfo.comp) {
@@ -1779,6 +1892,11 @@ int sqfs_size(const char *filename, loff_t *size)
 
 void sqfs_close(void)
 {
+	sqfs_cache_free(&ctxt.meta_cache);
+	sqfs_cache_free(&ctxt.frag_cache);
+	free(ctxt.frag_index);
+	ctxt.frag_index = NULL;
+	sqfs_free_tables();
 	sqfs_decompressor_cleanup(&ctxt);
 	free(ctxt.sblk);
 	ctxt.sblk = NULL;
@@ -1793,8 +1911,7 @@ void sqfs_closedir(struct fs_dir_stream *dirs)
 		return;
 
 	sqfs_dirs = (struct squashfs_dir_stream *)dirs;
-	free(sqfs_dirs->inode_table);
-	free(sqfs_dirs->dir_table);
+	/* the inode and directory tables belong to ctxt */
 	free(sqfs_dirs->dir_header);
 	free(sqfs_dirs);
 }
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Cache of decompressed SquashFS metadata and fragment blocks
+ *
+ * Entries are kept in most-recently-used order and keyed by the on-disk
+ * offset of the compressed block, so the same block is only decompressed once
+ * while the filesystem is mounted.
+ */
+
+#include <log.h>
+#include <malloc.h>
+#include <string.h>
+#include <linux/list.h>
+
+#include "sqfs_filesystem.h"
+
+/**
+ * struct sqfs_cache_entry - a decompressed block held in the cache
+ *
+ * @sibling: Node in the cache's list, most recently used first
+ * @key: On-disk offset of the (compressed) block
+ * @size: Number of bytes in @data
+ * @data: Decompressed contents
+ */
+struct sqfs_cache_entry {
+	struct list_head sibling;
+	u64 key;
+	unsigned long size;
+	unsigned char data[];
+};
+
+void sqfs_cache_init(struct sqfs_cache *cache, const char *name, int max)
+{
+	memset(cache, '\0', sizeof(*cache));
+	INIT_LIST_HEAD(&cache->entries);
+	cache->name = name;
+	cache->max = max;
+}
+
+void *sqfs_cache_get(struct sqfs_cache *cache, u64 key, unsigned long *sizep)
+{
+	struct sqfs_cache_entry *entry;
+
+	list_for_each_entry(entry, &cache->entries, sibling) {
+		if (entry->key == key) {
+			list_move(&entry->sibling, &cache->entries);
+			cache->hits++;
+			*sizep = entry->size;
+			return entry->data;
+		}
+	}
+	cache->misses++;
+
+	return NULL;
+}
+
+void *sqfs_cache_add(struct sqfs_cache *cache, u64 key, const void *data,
+		     unsigned long size)
+{
+	struct sqfs_cache_entry *entry;
+
+	if (!cache->max)
+		return NULL;
+
+	if (cache->count == cache->max) {
+		entry = list_last_entry(&cache->entries,
+					struct sqfs_cache_entry, sibling);
+		list_del(&entry->sibling);
+		free(entry);
+		cache->count--;
+		cache->evictions++;
+	}
+
+	/* Failing to cache a block is not an error; it is just slower */
+	entry = malloc(sizeof(*entry) + size);
+	if (!entry)
+		return NULL;
+	entry->key = key;
+	entry->size = size;
+	memcpy(entry->data, data, size);
+	list_add(&entry->sibling, &cache->entries);
+	cache->count++;
+
+	return entry->data;
+}
+
+void sqfs_cache_free(struct sqfs_cache *cache)
+{
+	struct sqfs_cache_entry *entry, *next;
+
+	if (!cache->entries.next)
+		return;
+
+	log_debug("%s cache: %lu hits, %lu misses, %lu evictions\n",
+		  cache->name, cache->hits, cache->misses, cache->evictions);
+	list_for_each_entry_safe(entry, next, &cache->entries, sibling) {
+		list_del(&entry->sibling);
+		free(entry);
+	}
+	cache->count = 0;
+}
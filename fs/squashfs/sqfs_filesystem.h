@@ -11,6 +11,7 @@
 #include <asm/unaligned.h>
 #include <fs_legacy.h>
 #include <part.h>
+#include <linux/list.h>
 #include <stdint.h>
 
 #define SQFS_MAGIC_NUMBER 0x73717368
@@ -71,10 +72,55 @@ struct squashfs_super_block {
 	__le64 export_table_start;
 };
 
+/**
+ * struct sqfs_cache - LRU cache of decompressed blocks
+ *
+ * @entries: List of struct sqfs_cache_entry, most recently used first
+ * @name: Name of the cache, for debugging
+ * @count: Number of entries in the cache
+ * @max: Maximum number of entries, 0 to disable the cache
+ * @hits: Number of lookups which found the block
+ * @misses: Number of lookups which did not find the block
+ * @evictions: Number of blocks dropped to make space for another
+ */
+struct sqfs_cache {
+	struct list_head entries;
+	const char *name;
+	int count;
+	int max;
+	unsigned long hits;
+	unsigned long misses;
+	unsigned long evictions;
+};
+
+/**
+ * struct squashfs_ctxt - state of the mounted filesystem
+ *
+ * @cur_part_info: Partition containing the filesystem
+ * @cur_dev: Block device containing the filesystem
+ * @sblk: Superblock
+ * @meta_cache: Decompressed fragment-table metadata blocks, keyed by on-disk
+ *	offset
+ * @frag_cache: Decompressed fragment blocks, keyed by on-disk offset
+ * @frag_index: Fragment index table, i.e. the on-disk offset of each metadata
+ *	block holding fragment entries, or NULL if not read yet
+ * @inode_table: Decompressed inode table, or NULL if not read yet
+ * @dir_table: Decompressed directory table, or NULL if not read yet
+ * @dir_pos_list: On-disk offset of each directory-table metadata block,
+ *	relative to the start of the table
+ * @dir_metablks: Number of metadata blocks in the directory table
+ */
 struct squashfs_ctxt {
 	struct disk_partition cur_part_info;
 	struct blk_desc *cur_dev;
 	struct squashfs_super_block *sblk;
+	struct sqfs_cache meta_cache;
+	struct sqfs_cache frag_cache;
+	u64 *frag_index;
+	unsigned char *inode_table;
+	unsigned char *dir_table;
+	u32 *dir_pos_list;
+	int dir_metablks;
 #if IS_ENABLED(CONFIG_ZSTD)
 	void *zstd_workspace;
 #endif
@@ -305,4 +351,46 @@ bool sqfs_is_empty_dir(void *dir_i);
 
 bool sqfs_is_dir(u16 type);
 
+/**
+ * sqfs_cache_init() - Set up an empty cache
+ *
+ * @cache: Cache to set up
+ * @name: Name of the cache, for debugging
+ * @max: Maximum number of blocks to hold, 0 to disable the cache
+ */
+void sqfs_cache_init(struct sqfs_cache *cache, const char *name, int max);
+
+/**
+ * sqfs_cache_get() - Look up a block in the cache
+ *
+ * On success the block becomes the most recently used one.
+ *
+ * @cache: Cache to search
+ * @key: On-disk offset of the block
+ * @sizep: Returns the number of bytes in the block
+ * Return: pointer to the decompressed block, or NULL if not cached
+ */
+void *sqfs_cache_get(struct sqfs_cache *cache, u64 key, unsigned long *sizep);
+
+/**
+ * sqfs_cache_add() - Add a copy of a block to the cache
+ *
+ * If the cache is full, the least recently used block is dropped.
+ *
+ * @cache: Cache to update
+ * @key: On-disk offset of the block
+ * @data: Decompressed block
+ * @size: Number of bytes in @data
+ * Return: pointer to the cached copy, or NULL if it could not be cached
+ */
+void *sqfs_cache_add(struct sqfs_cache *cache, u64 key, const void *data,
+		     unsigned long size);
+
+/**
+ * sqfs_cache_free() - Drop all blocks from a cache
+ *
+ * @cache: Cache to empty
+ */
+void sqfs_cache_free(struct sqfs_cache *cache);
+
 #endif /* SQFS_FILESYSTEM_H */
@@ -2290,6 +2290,9 @@ static int ubifs_fill_super(struct super_block *sb, void *data, int silent)
 		goto out_bdi;
 
 	sb->s_bdi = &c->bdi;
+#else
+	/* There are no mount options, so bulk-read is chosen at build time */
+	c->bulk_read = IS_ENABLED(CONFIG_UBIFS_BULK_READ);
 #endif
 	sb->s_fs_info = c;
 	sb->s_magic = UBIFS_SUPER_MAGIC;
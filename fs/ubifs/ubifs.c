@@ -15,6 +15,7 @@
 #include <gzip.h>
 #include <log.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <memalign.h>
 #include <asm/global_data.h>
 #include "ubifs.h"
@@ -721,23 +722,13 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+static int decompress_block(struct ubifs_info *c, struct inode *inode,
+			    void *addr, unsigned int block,
+			    struct ubifs_data_node *dn)
 {
-	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -768,6 +759,71 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decompress_block(c, inode, addr, block, dn);
+}
+
+/*
+ * Read a run of whole blocks using bulk-read: look up the data nodes which
+ * follow each other in the same LEB in one TNC walk, read them with a single
+ * LEB read and decompress each straight into place. Holes are zeroed.
+ *
+ * Returns the number of blocks read, which may be less than @count, or 0 if
+ * bulk-read cannot be used for @block, in which case the caller should read
+ * it on its own.
+ */
+static int read_blocks_bulk(struct ubifs_info *c, struct inode *inode,
+			    void *addr, unsigned int block, unsigned int count)
+{
+	struct bu_info *bu = &c->bu;
+	unsigned int blk, last;
+	int err, i;
+
+	data_key_init(c, &bu->key, inode->i_ino, block);
+	bu->buf_len = c->max_bu_buf_len;
+	if (ubifs_tnc_get_bu_keys(c, bu) || !bu->cnt ||
+	    ubifs_tnc_bulk_read(c, bu))
+		return 0;
+
+	/* After the last data node of the file there can only be holes */
+	if (bu->eof)
+		last = block + count;
+	else
+		last = min(key_block(c, &bu->zbranch[bu->cnt - 1].key) + 1,
+			   block + count);
+
+	for (blk = block, i = 0; blk < last; blk++, addr += UBIFS_BLOCK_SIZE) {
+		struct ubifs_zbranch *zbr = &bu->zbranch[i];
+
+		if (i == bu->cnt || key_block(c, &zbr->key) != blk) {
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+			continue;
+		}
+		err = decompress_block(c, inode, addr, blk, bu->buf +
+				       zbr->offs - bu->zbranch[0].offs);
+		if (err)
+			return err;
+		i++;
+	}
+
+	return last - block;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -888,8 +944,10 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	unsigned long inum;
 	struct inode *inode;
 	struct page page;
+	unsigned int leb_reads = 0;
+	bool bulk = c->bulk_read;
 	int err = 0;
-	int i;
+	int i, n;
 	int count;
 	int last_block_size = 0;
 
@@ -950,13 +1008,41 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 		if (((i + 1) == count) && (size < inode->i_size))
 			last_block_size = size - (i * PAGE_SIZE);
 
+		/*
+		 * Use bulk-read for whole pages, leaving the last one, which
+		 * may be partial, to do_readpage()
+		 */
+		if (UBIFS_BLOCKS_PER_PAGE == 1 && bulk && i + 1 < count) {
+			n = read_blocks_bulk(c, inode, page.addr, page.index,
+					     count - 1 - i);
+			if (n < 0) {
+				err = n;
+				break;
+			}
+			if (n) {
+				leb_reads++;
+				i += n - 1;
+				page.addr += n * PAGE_SIZE;
+				page.index += n;
+				continue;
+			}
+			/*
+			 * Bulk-read found no data nodes or failed, e.g. on a
+			 * bad node. Retrying it for each following block would
+			 * only repeat that, so read the rest one by one
+			 */
+			bulk = false;
+		}
+
 		err = do_readpage(c, inode, &page, last_block_size);
 		if (err)
 			break;
 
+		leb_reads++;
 		page.addr += PAGE_SIZE;
 		page.index++;
 	}
+	dbg_gen("%s: %d blocks in %u LEB reads", filename, count, leb_reads);
 
 	if (err) {
 		printf("Error reading file '%s'\n", filename);
@@ -980,11 +1066,14 @@ void ubifs_close(void)
 int ubifs_load(char *filename, unsigned long addr, u32 size)
 {
 	loff_t actread;
+	void *buf;
 	int err;
 
 	printf("Loading file '%s' to addr 0x%08lx...\n", filename, addr);
 
-	err = ubifs_read(filename, (void *)(uintptr_t)addr, 0, size, &actread);
+	buf = map_sysmem(addr, size);
+	err = ubifs_read(filename, buf, 0, size, &actread);
+	unmap_sysmem(buf);
 	if (err == 0) {
 		env_set_hex("filesize", actread);
 		printf("Done\n");
@@ -154,6 +154,7 @@ enum bloblist_tag_t {
 	BLOBLISTT_VBE			= 0xfff001, /* VBE per-phase state */
 	BLOBLISTT_U_BOOT_VIDEO		= 0xfff002, /* Video info from SPL */
 	BLOBLISTT_EFI_LOG		= 0xfff003, /* Log of EFI calls */
+	BLOBLISTT_U_BOOT_MMC		= 0xfff004, /* MMC card state from SPL */
 };
 
 /**
@@ -76,6 +76,8 @@ typedef int (*bootdev_hunter_func)(struct bootdev_hunter *info, bool show);
  * @prio: Scanning priority of this hunter
  * @uclass: Uclass ID for the media associated with this bootdev
  * @drv: bootdev driver for the things found by this hunter
+ * @start: Function to call to start hunting, without waiting for slow hardware
+ *	to settle (NULL if none). See bootdev_hunt_start()
  * @hunt: Function to call to hunt for bootdevs of this type (NULL if none)
  *
  * Some bootdevs are not visible until other devices are enumerated. For
@@ -92,6 +94,7 @@ struct bootdev_hunter {
 	enum bootdev_prio_t prio;
 	enum uclass_id uclass;
 	struct driver *drv;
+	bootdev_hunter_func start;
 	bootdev_hunter_func hunt;
 };
 
@@ -294,6 +297,20 @@ int bootdev_hunt(const char *spec, bool show);
  */
 int bootdev_hunt_prio(enum bootdev_prio_t prio, bool show);
 
+/**
+ * bootdev_hunt_start() - Start all hunters which have not been used yet
+ *
+ * Some hunters must wait for hardware to settle, e.g. for USB devices to
+ * appear after the bus is powered. Such hunters can provide a start() method
+ * to get things going early, so that the waiting overlaps with other work,
+ * such as hunting and scanning the higher-priority bootdevs. The hunt()
+ * method is still called in priority order, as usual, to finish the job.
+ *
+ * @show: true to show each hunter as it is started
+ * Returns: 0 if OK, -ve on error
+ */
+int bootdev_hunt_start(bool show);
+
 /**
  * bootdev_unhunt() - Mark a device as needing to be hunted again
  *
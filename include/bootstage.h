@@ -20,6 +20,7 @@
 enum bootstage_flags {
 	BOOTSTAGEF_ERROR	= 1 << 0,	/* Error record */
 	BOOTSTAGEF_ALLOC	= 1 << 1,	/* Allocate an id */
+	BOOTSTAGEF_COUNT	= 1 << 2,	/* Counter, not a time */
 };
 
 /* bootstate sub-IDs used for kernel and ramdisk ranges */
@@ -214,6 +215,12 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_MMC_OP_COND,
+	BOOTSTAGE_ID_ACCUM_MMC_IDENT,
+	BOOTSTAGE_ID_ACCUM_MMC_MODE,
+	BOOTSTAGE_ID_ACCUM_MMC_HANDOFF,
+
+	BOOTSTAGE_ID_COUNT_COPY,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -354,6 +361,20 @@ uint32_t bootstage_start(enum bootstage_id id, const char *name);
  */
 uint32_t bootstage_accum(enum bootstage_id id);
 
+/**
+ * bootstage_count() - Add to a bootstage counter
+ *
+ * Counters record an amount, such as the number of bytes copied while
+ * loading images, rather than a time. They are shown separately in the
+ * report and are passed on in the device tree as a 'count' property.
+ *
+ * @id: Bootstage id of the counter
+ * @name: Textual name to display for this id in the report (maybe NULL)
+ * @count: Amount to add to the counter
+ * Return: new value of the counter
+ */
+ulong bootstage_count(enum bootstage_id id, const char *name, ulong count);
+
 /**
  * bootstage_get_rec_count() - Get the number of bootstage records
  *
@@ -486,6 +507,12 @@ static inline uint32_t bootstage_accum(enum bootstage_id id)
 	return 0;
 }
 
+static inline ulong bootstage_count(enum bootstage_id id, const char *name,
+				    ulong count)
+{
+	return 0;
+}
+
 static inline ulong bootstage_get_time(enum bootstage_id id)
 {
 	return 0;
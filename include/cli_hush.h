@@ -17,6 +17,16 @@ extern int u_boot_hush_start(void);
 extern int parse_string_outer(const char *str, int flag);
 extern int parse_file_outer(void);
 int set_local_var(const char *s, int flg_export);
+
+/**
+ * hush_cache_stats() - Get the number of lookups in the parse cache
+ *
+ * Only scripts which may be cached are counted (see CONFIG_HUSH_CACHE)
+ *
+ * @hitsp: Returns the number of scripts which were found in the cache
+ * @missesp: Returns the number of scripts which had to be parsed
+ */
+void hush_cache_stats(unsigned long *hitsp, unsigned long *missesp);
 #else
 static inline int u_boot_hush_start(void)
 {
@@ -37,6 +47,13 @@ static inline int set_local_var(const char *s, int flg_export)
 {
 	return 0;
 }
+
+static inline void hush_cache_stats(unsigned long *hitsp,
+				    unsigned long *missesp)
+{
+	*hitsp = 0;
+	*missesp = 0;
+}
 #endif
 #if CONFIG_IS_ENABLED(HUSH_MODERN_PARSER)
 extern int u_boot_hush_start_modern(void);
@@ -0,0 +1,190 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * eMMC Command Queue Host Controller Interface (CQHCI)
+ *
+ * Register and descriptor layout follow JESD84-B51, Annex B.
+ */
+
+#ifndef __CQHCI_H
+#define __CQHCI_H
+
+#include <blk.h>
+#include <linux/bitops.h>
+#include <linux/sizes.h>
+#include <linux/types.h>
+
+struct mmc;
+struct mmc_data;
+
+/* registers */
+#define CQHCI_VER		0x00
+#define CQHCI_CAP		0x04
+
+#define CQHCI_CFG		0x08
+#define  CQHCI_DCMD		BIT(12)
+#define  CQHCI_TASK_DESC_SZ	BIT(8)
+#define  CQHCI_ENABLE		BIT(0)
+
+#define CQHCI_CTL		0x0c
+#define  CQHCI_CLEAR_ALL_TASKS	BIT(8)
+#define  CQHCI_HALT		BIT(0)
+
+/* interrupt status, status enable and signal enable */
+#define CQHCI_IS		0x10
+#define CQHCI_ISTE		0x14
+#define CQHCI_ISGE		0x18
+#define  CQHCI_IS_HAC		BIT(0)
+#define  CQHCI_IS_TCC		BIT(1)
+#define  CQHCI_IS_RED		BIT(2)
+#define  CQHCI_IS_TCL		BIT(3)
+#define  CQHCI_IS_GCE		BIT(4)
+#define  CQHCI_IS_ICCE		BIT(5)
+#define  CQHCI_IS_MASK		(CQHCI_IS_TCC | CQHCI_IS_RED | \
+				 CQHCI_IS_GCE | CQHCI_IS_ICCE)
+#define  CQHCI_IS_ERROR		(CQHCI_IS_RED | CQHCI_IS_GCE | CQHCI_IS_ICCE)
+
+#define CQHCI_IC		0x1c
+#define CQHCI_TDLBA		0x20
+#define CQHCI_TDLBAU		0x24
+#define CQHCI_TDBR		0x28
+#define CQHCI_TCN		0x2c
+#define CQHCI_DQS		0x30
+#define CQHCI_DPT		0x34
+#define CQHCI_TCLR		0x38
+#define CQHCI_SSC1		0x40
+#define CQHCI_SSC2		0x44
+#define CQHCI_CRDCT		0x48
+#define CQHCI_RMEM		0x50
+#define CQHCI_TERRI		0x54
+#define CQHCI_CRI		0x58
+#define CQHCI_CRA		0x5c
+
+/* descriptor fields, common to task, link and transfer descriptors */
+#define CQHCI_VALID(x)		(((x) & 1) << 0)
+#define CQHCI_END(x)		(((x) & 1) << 1)
+#define CQHCI_INT(x)		(((x) & 1) << 2)
+#define CQHCI_ACT(x)		(((x) & 0x7) << 3)
+
+/* task descriptor fields */
+#define CQHCI_FORCED_PROG(x)	((u64)((x) & 1) << 6)
+#define CQHCI_CONTEXT(x)	((u64)((x) & 0xf) << 7)
+#define CQHCI_DATA_TAG(x)	((u64)((x) & 1) << 11)
+#define CQHCI_DATA_DIR(x)	((u64)((x) & 1) << 12)
+#define CQHCI_PRIORITY(x)	((u64)((x) & 1) << 13)
+#define CQHCI_QBAR(x)		((u64)((x) & 1) << 14)
+#define CQHCI_REL_WRITE(x)	((u64)((x) & 1) << 15)
+#define CQHCI_BLK_COUNT(x)	((u64)((x) & 0xffff) << 16)
+#define CQHCI_BLK_ADDR(x)	((u64)((x) & 0xffffffff) << 32)
+
+/* transfer descriptor fields */
+#define CQHCI_DAT_LENGTH(x)	(((x) & 0xffff) << 16)
+
+#define CQHCI_ACT_TASK		0x5
+#define CQHCI_ACT_LINK		0x6
+#define CQHCI_ACT_TRAN		0x4
+
+#define CQHCI_NUM_SLOTS		32
+
+/* Each task is described by up to this many transfer descriptors */
+#define CQHCI_MAX_SEGS		32
+#define CQHCI_SEG_LEN		SZ_32K
+
+/* cqhci_host->caps */
+#define CQHCI_TASK_DESC_SZ_128	BIT(0)	/* host wants 128-bit task descriptors */
+
+struct cqhci_host;
+
+/**
+ * struct cqhci_host_ops - hooks into the host controller driver
+ *
+ * @get_error: Check the host controller for an error (e.g. a CRC or timeout
+ *	on the bus) which the CQE itself does not report. Returns 0 if none, else
+ *	-ve error, clearing the error condition
+ */
+struct cqhci_host_ops {
+	int (*get_error)(struct cqhci_host *cq_host);
+};
+
+/**
+ * struct cqhci_host - state of a command queue engine
+ *
+ * @mmio: Base address of the CQHCI register block
+ * @mmc: MMC device this engine belongs to
+ * @ops: Host controller hooks, may be NULL
+ * @caps: Host capabilities (CQHCI_TASK_DESC_SZ_128)
+ * @dma64: true to use 64-bit DMA addresses in descriptors
+ * @enabled: true if the engine is currently enabled
+ * @task_desc_len: Size of a task descriptor in bytes
+ * @link_desc_len: Size of a link descriptor in bytes
+ * @trans_desc_len: Size of a transfer descriptor in bytes
+ * @slot_sz: Size of one task-descriptor-list slot (task + link descriptor)
+ * @desc_base: Task descriptor list, CQHCI_NUM_SLOTS slots
+ * @trans_desc_base: Transfer descriptors, CQHCI_MAX_SEGS per slot
+ * @slot_blocks: Number of blocks queued in each slot
+ */
+struct cqhci_host {
+	void __iomem *mmio;
+	struct mmc *mmc;
+	const struct cqhci_host_ops *ops;
+	u32 caps;
+	bool dma64;
+	bool enabled;
+	uint task_desc_len;
+	uint link_desc_len;
+	uint trans_desc_len;
+	uint slot_sz;
+	u8 *desc_base;
+	u8 *trans_desc_base;
+	u16 slot_blocks[CQHCI_NUM_SLOTS];
+};
+
+/**
+ * cqhci_init() - Set up a command queue engine
+ *
+ * Allocates the descriptor memory. The engine is not enabled until
+ * cqhci_enable() is called.
+ *
+ * @cq_host: Engine to set up; @mmio, @ops and @caps must be filled in
+ * @mmc: MMC device the engine belongs to
+ * @dma64: true if the host uses 64-bit DMA addresses
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+int cqhci_init(struct cqhci_host *cq_host, struct mmc *mmc, bool dma64);
+
+/**
+ * cqhci_enable() - Hand the bus over to the command queue engine
+ *
+ * The card must already have command queueing enabled in its EXT_CSD and be
+ * in the transfer state.
+ *
+ * @cq_host: Engine to enable
+ * Return: 0 if OK, -ve on error
+ */
+int cqhci_enable(struct cqhci_host *cq_host);
+
+/**
+ * cqhci_disable() - Halt the command queue engine and disable it
+ *
+ * Any queued tasks are discarded. Legacy commands can be sent once this
+ * returns.
+ *
+ * @cq_host: Engine to disable
+ */
+void cqhci_disable(struct cqhci_host *cq_host);
+
+/**
+ * cqhci_rw() - Read or write blocks using the command queue
+ *
+ * The transfer is split into tasks which are queued on the card together, up
+ * to the card's queue depth, so that the card can work on one while data for
+ * another is being transferred.
+ *
+ * @cq_host: Engine to use, which must be enabled
+ * @data: Buffer, direction and number of blocks to transfer
+ * @start: First block on the card
+ * Return: 0 if OK, -ve on error
+ */
+int cqhci_rw(struct cqhci_host *cq_host, struct mmc_data *data,
+	     lbaint_t start);
+
+#endif /* __CQHCI_H */
@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Decompressing data in chunks, as it arrives
+ *
+ * All the compression types supported by image_decomp() can be handled this
+ * way. The output always goes into a single buffer, so no window or output
+ * copies are needed. Input can be fed in pieces of any size: headers and
+ * blocks which span two pieces are collected in a small staging buffer.
+ */
+
+#ifndef __DECOMP_H
+#define __DECOMP_H
+
+#include <linux/errno.h>
+#include <linux/types.h>
+
+/**
+ * struct decomp_ctx - State for decompressing a stream
+ *
+ * This is set up by decomp_init() and must be released by decomp_finish()
+ *
+ * @comp: Compression type (IH_COMP_...)
+ * @out: Output buffer
+ * @out_size: Size of @out in bytes
+ * @out_len: Number of bytes written to @out so far
+ * @err: First error seen (sticky), or 0
+ * @done: true once the end of the compressed stream has been seen; any input
+ *	after that is ignored
+ * @step: Algorithm-specific position in the headers / blocks of the stream
+ * @need: Number of bytes needed to complete the current header field or block
+ * @flags: Algorithm-specific header flags
+ * @priv: Algorithm-specific decoder state, or NULL
+ * @buf: Staging buffer, used when a header field or block spans two pieces of
+ *	input
+ * @buf_len: Number of bytes currently in @buf
+ * @buf_size: Allocated size of @buf
+ */
+struct decomp_ctx {
+	int comp;
+	void *out;
+	size_t out_size;
+	size_t out_len;
+	int err;
+	bool done;
+	int step;
+	size_t need;
+	uint flags;
+	void *priv;
+	void *buf;
+	size_t buf_len;
+	size_t buf_size;
+};
+
+#if CONFIG_IS_ENABLED(BZIP2) || CONFIG_IS_ENABLED(GZIP) || \
+	CONFIG_IS_ENABLED(LZ4) || CONFIG_IS_ENABLED(LZMA) || \
+	CONFIG_IS_ENABLED(LZO) || CONFIG_IS_ENABLED(ZSTD)
+/**
+ * decomp_init() - Start decompressing a stream
+ *
+ * @ctx: Context to set up
+ * @comp: Compression type (IH_COMP_...); IH_COMP_NONE just copies the data
+ * @out: Buffer to hold the decompressed data
+ * @out_size: Size of @out in bytes
+ * Return: 0 if OK, -ENOSYS if @comp is not supported, -ENOMEM if out of memory
+ */
+int decomp_init(struct decomp_ctx *ctx, int comp, void *out, size_t out_size);
+
+/**
+ * decomp_feed() - Decompress the next piece of a stream
+ *
+ * Data is written to the output buffer as soon as it can be decoded
+ *
+ * @ctx: Context
+ * @in: Next piece of compressed data
+ * @len: Length of @in in bytes
+ * Return: 0 if OK (including when the end of the stream has already been
+ *	seen), -ENOSPC if the output buffer is too small, -EPROTONOSUPPORT if
+ *	the format is not supported, -ENOMEM if out of memory, -EINVAL if the
+ *	data is corrupt. Once an error is returned, it is returned for all
+ *	further calls
+ */
+int decomp_feed(struct decomp_ctx *ctx, const void *in, size_t len);
+
+/**
+ * decomp_finish() - Finish decompressing a stream and free the context
+ *
+ * This must be called after decomp_init() succeeds, even if decomp_feed()
+ * fails
+ *
+ * @ctx: Context
+ * @out_lenp: Returns the number of bytes written to the output buffer, even
+ *	on error (may be NULL)
+ * Return: 0 if the whole stream was decompressed, -EINVAL if it was
+ *	truncated, or the error from decomp_feed()
+ */
+int decomp_finish(struct decomp_ctx *ctx, size_t *out_lenp);
+#else
+static inline int decomp_init(struct decomp_ctx *ctx, int comp, void *out,
+			      size_t out_size)
+{
+	return -ENOSYS;
+}
+
+static inline int decomp_feed(struct decomp_ctx *ctx, const void *in,
+			      size_t len)
+{
+	return -ENOSYS;
+}
+
+static inline int decomp_finish(struct decomp_ctx *ctx, size_t *out_lenp)
+{
+	if (out_lenp)
+		*out_lenp = 0;
+
+	return -ENOSYS;
+}
+#endif
+
+#endif
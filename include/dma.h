@@ -342,4 +342,30 @@ static inline int dma_memcpy(void *dst, void *src, size_t len)
 	return -ENOSYS;
 }
 #endif /* CONFIG_DMA */
+
+#if CONFIG_IS_ENABLED(DMA_BULK_COPY)
+/**
+ * dma_bulk_copy() - Copy a large region of memory using DMA, if possible
+ *
+ * The cache-aligned middle of the region is copied by the first DMA device
+ * supporting DMA_SUPPORTS_MEM_TO_MEM; the CPU copies the ends, so that no
+ * cache line is shared with the transfer. This panics if the transfer times
+ * out, since the device may then still be writing to @dst.
+ *
+ * @dst: Destination
+ * @src: Source
+ * @len: Number of bytes to copy
+ * Return: 0 if the data was copied, else -ve error, in which case the caller
+ *	should copy the data itself: -E2BIG if it is too small to be worth using
+ *	DMA, -EINVAL if the regions overlap, -ENOENT if there is no
+ *	memory-to-memory DMA device, or other -ve error from the device
+ */
+int dma_bulk_copy(void *dst, const void *src, size_t len);
+#else
+static inline int dma_bulk_copy(void *dst, const void *src, size_t len)
+{
+	return -ENOSYS;
+}
+#endif /* DMA_BULK_COPY */
+
 #endif	/* _DMA_H_ */
@@ -430,6 +430,111 @@ int fdt_add_fb_mem_rsv(void *blob);
 
 int fdt_overlay_apply_verbose(void *fdt, void *fdto);
 
+/**
+ * struct fdt_index_phandle - Path of a node with a phandle
+ *
+ * @phandle: Phandle of the node
+ * @path: Full path to the node (allocated)
+ */
+struct fdt_index_phandle {
+	u32 phandle;
+	char *path;
+};
+
+/**
+ * struct fdt_index_label - Phandle of a node with a label
+ *
+ * @label: Label, as listed in /__symbols__ (allocated)
+ * @phandle: Phandle of the node, or 0 if it has none
+ */
+struct fdt_index_label {
+	char *label;
+	u32 phandle;
+};
+
+/**
+ * struct fdt_overlay_index - Index of a base tree, for applying overlays
+ *
+ * This records the phandles and labels of the base tree, so that a batch of
+ * overlays can be resolved without searching the tree for each one. Both
+ * arrays are sorted by their key.
+ *
+ * @max_phandle: Largest phandle in the tree
+ * @phandles: Nodes with a phandle, sorted by phandle
+ * @phandle_count: Number of entries in @phandles
+ * @phandle_size: Number of entries allocated for @phandles
+ * @labels: Labels from /__symbols__, sorted by name
+ * @label_count: Number of entries in @labels
+ * @label_size: Number of entries allocated for @labels
+ */
+struct fdt_overlay_index {
+	u32 max_phandle;
+	struct fdt_index_phandle *phandles;
+	int phandle_count;
+	int phandle_size;
+	struct fdt_index_label *labels;
+	int label_count;
+	int label_size;
+};
+
+/**
+ * fdt_overlay_index_init() - Index a base tree for applying overlays
+ *
+ * While the index is in use, the base tree must only be changed by
+ * fdt_overlay_index_apply(). It may be moved or resized, e.g. with
+ * fdt_open_into() or fdt_shrink_to_minimum(), since the index does not hold
+ * offsets or pointers into it.
+ *
+ * On error the index is left empty, so it is safe to pass it to
+ * fdt_overlay_index_uninit()
+ *
+ * @idx: Index to set up
+ * @fdt: Base device tree blob
+ * Return: 0 if OK, -FDT_ERR_NOSPACE if out of memory, other -FDT_ERR_... value
+ *	if the tree is invalid
+ */
+int fdt_overlay_index_init(struct fdt_overlay_index *idx, const void *fdt);
+
+/**
+ * fdt_overlay_index_apply() - Apply an overlay using an index of the base tree
+ *
+ * This gives the same result as fdt_overlay_apply(), then adds the nodes and
+ * labels from the overlay to the index, ready for the next overlay. Unlike
+ * fdt_overlay_apply(), the overlay is not changed.
+ *
+ * If fdt_overlay_apply() fails, the base tree might have been damaged, so its
+ * magic is erased and the index should be dropped.
+ *
+ * @idx: Index of @fdt, from fdt_overlay_index_init()
+ * @fdt: Base device tree blob
+ * @fdto: Device tree overlay blob
+ * Return: 0 if OK, -FDT_ERR_... value on error
+ */
+int fdt_overlay_index_apply(struct fdt_overlay_index *idx, void *fdt,
+			    const void *fdto);
+
+/**
+ * fdt_overlay_index_uninit() - Free the memory used by an index
+ *
+ * @idx: Index to free
+ */
+void fdt_overlay_index_uninit(struct fdt_overlay_index *idx);
+
+/**
+ * fdt_overlay_index_apply_verbose() - Apply an overlay using an index
+ *
+ * This is like fdt_overlay_apply_verbose() but uses an index of the base
+ * tree, from fdt_overlay_index_init(), so that a batch of overlays can be
+ * applied without searching the base tree each time
+ *
+ * @idx: Index of @fdt, or NULL to apply the overlay without an index
+ * @fdt: Base device tree blob
+ * @fdto: Device tree overlay blob; this is changed only if @idx is NULL
+ * Return: 0 if OK, -ve FDT_ERR_... value on error
+ */
+int fdt_overlay_index_apply_verbose(struct fdt_overlay_index *idx, void *fdt,
+				    void *fdto);
+
 int fdt_valid(struct fdt_header **blobp);
 
 /**
@@ -492,6 +492,9 @@ static inline void images_set_arch(struct bootm_headers *images, int os_arch)
 #define CHUNKSZ_SHA1 (64 * 1024)
 #endif
 
+/* Size of each piece of an image read by image_decomp_read() */
+#define IMAGE_READ_CHUNK	(256 * 1024)
+
 #define uimage_to_cpu(x)		be32_to_cpu(x)
 #define cpu_to_uimage(x)		cpu_to_be32(x)
 
@@ -1088,12 +1091,52 @@ int image_decomp_type(const unsigned char *buf, ulong len);
  * @image_buf:	Address to decompress from
  * @image_len:	Number of bytes in @image_buf to decompress
  * @unc_len:	Available space for decompression
- * Return: 0 if OK, -ve on error (BOOTM_ERR_...)
+ * @load_end:	Returns the end address of the data loaded, even on error
+ * Return: 0 if OK, -ENOSPC if there is not enough space, -ENOSYS if the
+ *	compression type is not supported, other -ve value on error
  */
 int image_decomp(int comp, ulong load, ulong image_start, int type,
 		 void *load_buf, void *image_buf, ulong image_len,
 		 uint unc_len, ulong *load_end);
 
+/**
+ * typedef image_read_func - Read part of an image which is not in memory
+ *
+ * @priv:	Private data passed to image_decomp_read()
+ * @offset:	Offset within the image to read from
+ * @buf:	Buffer to read into
+ * @size:	Number of bytes to read
+ * Return: number of bytes read (0 at end of file), or -ve on error
+ */
+typedef long (*image_read_func)(void *priv, ulong offset, void *buf,
+				ulong size);
+
+/**
+ * image_decomp_read() - decompress an image as it is read
+ *
+ * This works like image_decomp() but obtains the image with @read, in pieces
+ * of IMAGE_READ_CHUNK bytes, rather than needing it all in memory. Each piece
+ * is decompressed as soon as it is read. An uncompressed image is read
+ * straight into @load_buf
+ *
+ * @comp:	Compression algorithm that is used (IH_COMP_...)
+ * @load:	Destination load address in U-Boot memory
+ * @type:	OS type (IH_OS_...)
+ * @load_buf:	Place to decompress to
+ * @read:	Function to read the image
+ * @priv:	Private data for @read
+ * @image_len:	Number of bytes in the image
+ * @unc_len:	Available space for decompression
+ * @load_end:	Returns the end address of the data loaded, even on error
+ * Return: 0 if OK, -ENOSPC if there is not enough space, -ENOSYS if the
+ *	compression type is not supported, -EIO if the image is shorter than
+ *	@image_len and not compressed, error from @read, other -ve value on
+ *	error
+ */
+int image_decomp_read(int comp, ulong load, int type, void *load_buf,
+		      image_read_func read, void *priv, ulong image_len,
+		      uint unc_len, ulong *load_end);
+
 /**
  * Set up properties in the FDT
  *
@@ -1372,9 +1415,28 @@ int fit_set_timestamp(void *fit, int noffset, time_t timestamp);
  */
 int fit_pre_load_data(const char *keydir, void *keydest, void *fit);
 
+/**
+ * fit_cipher_data() - encrypt the data of FIT image nodes
+ *
+ * @keydir:	Directory containing keys
+ * @keydest:	FDT blob to write key information to (NULL if none)
+ * @fit:	Pointer to the FIT format image header
+ * @comment:	Comment to add to cipher nodes
+ * @require_keys: Mark all keys as 'required'
+ * @engine_id:	Engine to use for encryption
+ * @cmdname:	Command name used when reporting errors
+ * @threads:	Number of threads to use for encryption (0 or 1 for none)
+ *
+ * The images are encrypted in parallel and then written back to the FIT in
+ * node order, so the output does not depend on @threads
+ *
+ * returns:
+ *	0, on success
+ *	< 0, on failure
+ */
 int fit_cipher_data(const char *keydir, void *keydest, void *fit,
 		    const char *comment, int require_keys,
-		    const char *engine_id, const char *cmdname);
+		    const char *engine_id, const char *cmdname, int threads);
 
 #define NODE_MAX_NAME_LEN	80
 
@@ -1406,13 +1468,18 @@ struct image_summary {
  * @engine_id:	Engine to use for signing
  * @cmdname:	Command name used when reporting errors
  * @algo_name:	Algorithm name, or NULL if to be read from FIT
+ * @threads:	Number of threads to use for image hashes and signatures (0 or
+ *		1 for none)
  * @summary:	Returns information about what data was written
  *
  * Adds hash values for all component images in the FIT blob.
  * Hashes are calculated for all component images which have hash subnodes
  * with algorithm property set to one of the supported hash algorithms.
  *
- * Also add signatures if signature nodes are present.
+ * Also add signatures if signature nodes are present. Image hashes and
+ * signatures are calculated using up to @threads threads and written in node
+ * order, so the output is the same whatever the thread count. Configuration
+ * signatures are always added afterwards, in a single thread.
  *
  * returns
  *     0, on success
@@ -1422,7 +1489,7 @@ int fit_add_verification_data(const char *keydir, const char *keyfile,
 			      void *keydest, void *fit, const char *comment,
 			      int require_keys, const char *engine_id,
 			      const char *cmdname, const char *algo_name,
-			      struct image_summary *summary);
+			      int threads, struct image_summary *summary);
 
 /**
  * fit_image_verify_with_data() - Verify an image with given data
@@ -33,6 +33,7 @@
  * @cache:      log-based polynomial representation buffer
  * @elp:        error locator polynomial
  * @poly_2t:    temporary polynomials of degree 2t
+ * @syn_tab:    syndrome lookup tables (CONFIG_BCH_FAST_DECODE), or NULL
  */
 struct bch_control {
 	unsigned int    m;
@@ -51,6 +52,7 @@ struct bch_control {
 	int            *cache;
 	struct gf_poly *elp;
 	struct gf_poly *poly_2t[4];
+	uint16_t       *syn_tab;
 };
 
 struct bch_control *init_bch(int m, int t, unsigned int prim_poly);
@@ -100,6 +100,8 @@ void nand_wait_ready(struct mtd_info *mtd);
 #define NAND_CMD_READSTART	0x30
 #define NAND_CMD_RNDOUTSTART	0xE0
 #define NAND_CMD_CACHEDPROG	0x15
+#define NAND_CMD_READCACHESEQ	0x31
+#define NAND_CMD_READCACHEEND	0x3f
 
 /* Extended commands for AG-AND device */
 /*
@@ -189,6 +191,11 @@ enum nand_ecc_algo {
 #define NAND_CACHEPRG		0x00000008
 /* Chip has copy back function */
 #define NAND_COPYBACK		0x00000010
+/*
+ * Controller passes the READ CACHE SEQUENTIAL / END commands through its
+ * cmdfunc. Only needed by drivers which replace nand_command_lp().
+ */
+#define NAND_CACHEREAD		0x00000020
 /*
  * Chip requires ready check on read (for auto-incremented sequential read).
  * True only for small page devices; large page devices do not support
@@ -293,6 +300,9 @@ enum nand_ecc_algo {
 /* ONFI subfeature parameters length */
 #define ONFI_SUBFEATURE_PARAM_LEN	4
 
+/* ONFI optional commands READ CACHE supported? */
+#define ONFI_OPT_CMD_READ_CACHE		(1 << 1)
+
 /* ONFI optional commands SET/GET FEATURES supported? */
 #define ONFI_OPT_CMD_SET_GET_FEATURES	(1 << 2)
 
@@ -880,6 +890,10 @@ struct nand_manufacturer_ops {
  * @jedec_params:	[INTERN] holds the JEDEC parameter page when JEDEC is
  *			supported, 0 otherwise.
  * @read_retries:	[INTERN] the number of read retry modes supported
+ * @cont_read:		[INTERN] sequential cache read state. @supported is
+ *			set if the chip and controller can use READ CACHE
+ *			commands; while @ongoing, pages @first_page to
+ *			@last_page are being read as a single sequence.
  * @onfi_set_features:	[REPLACEABLE] set the features for ONFI nand
  * @onfi_get_features:	[REPLACEABLE] get the features for ONFI nand
  * @setup_data_interface: [OPTIONAL] setup the data interface and timing. If
@@ -965,6 +979,13 @@ struct nand_chip {
 
 	int read_retries;
 
+	struct {
+		bool supported;
+		bool ongoing;
+		unsigned int first_page;
+		unsigned int last_page;
+	} cont_read;
+
 	flstate_t state;
 
 	uint8_t *oob_poi;
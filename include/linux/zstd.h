@@ -455,4 +455,80 @@ struct abuf;
  */
 int zstd_decompress(struct abuf *in, struct abuf *out);
 
+/**
+ * struct zstd_seek_frame - Information about a frame in seekable zstd data
+ *
+ * @comp_offset: Offset of the frame in the compressed data
+ * @offset: Offset of the frame's data in the decompressed data
+ * @comp_size: Size of the compressed frame in bytes
+ * @size: Size of the frame's decompressed data in bytes
+ */
+struct zstd_seek_frame {
+	ulong comp_offset;
+	ulong offset;
+	u32 comp_size;
+	u32 size;
+};
+
+/**
+ * struct zstd_seek_table - Seek table for zstd data in the seekable format
+ *
+ * @frames: Information about each frame
+ * @count: Number of frames
+ * @size: Total size of the decompressed data in bytes
+ */
+struct zstd_seek_table {
+	struct zstd_seek_frame *frames;
+	int count;
+	ulong size;
+};
+
+/**
+ * zstd_seek_table_read() - Read the seek table from the end of zstd data
+ *
+ * The table must be freed with zstd_seek_table_free() when no longer needed
+ *
+ * @in: Compressed data, in the seekable format
+ * @tab: Returns the seek table
+ * Return: 0 if OK, -ENOENT if there is no seek table, -EINVAL if it is
+ *	corrupt, -ENOMEM if out of memory
+ */
+int zstd_seek_table_read(struct abuf *in, struct zstd_seek_table *tab);
+
+/**
+ * zstd_seek_table_free() - Free a seek table
+ *
+ * @tab: Seek table to free
+ */
+void zstd_seek_table_free(struct zstd_seek_table *tab);
+
+/**
+ * zstd_seekable_read() - Decompress part of zstd data in the seekable format
+ *
+ * Only the frames which hold the requested range are decompressed, spread
+ * across the available CPUs (see worker_run())
+ *
+ * @in: Compressed data
+ * @tab: Seek table for @in, from zstd_seek_table_read()
+ * @offset: Offset of the range within the decompressed data
+ * @out: Output buffer; its size sets the size of the range, which is clipped
+ *	to the end of the decompressed data
+ * Return: number of bytes written to @out, -EINVAL if @offset is beyond the
+ *	end of the data or the data is corrupt, -ENOMEM if out of memory
+ */
+int zstd_seekable_read(struct abuf *in, const struct zstd_seek_table *tab,
+		       ulong offset, struct abuf *out);
+
+/**
+ * zstd_decompress_seekable() - Decompress zstd data in the seekable format
+ *
+ * This is like zstd_decompress() but decompresses all frames, in parallel
+ *
+ * @in: Input buffer to decompress
+ * @out: Output buffer to hold the results
+ * Return: size of the decompressed data, -ENOENT if @in has no seek table,
+ *	-ENOSPC if @out is too small, or other -ve on error
+ */
+int zstd_decompress_seekable(struct abuf *in, struct abuf *out);
+
 #endif  /* LINUX_ZSTD_H */
@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Fast memory test
+ *
+ * The region is tested one window at a time. Within a window, each pass
+ * checks the pattern written by the previous pass and writes the next one,
+ * so that N patterns take N + 1 passes rather than 2N. Each pass is split
+ * into chunks which are run on the worker pool, if there is one. Windows
+ * are much larger than the caches and the caches are flushed after each
+ * pass, so the data is read back from DRAM.
+ */
+
+#ifndef __MEMTEST_H
+#define __MEMTEST_H
+
+#include <linux/bitops.h>
+#include <linux/types.h>
+
+/**
+ * enum memtest_flags - Options for memtest_run()
+ *
+ * @MEMTEST_F_DMA: Add a pass where the data is written by a DMA engine, if
+ *	there is one, and checked by the CPU
+ */
+enum memtest_flags {
+	MEMTEST_F_DMA		= BIT(0),
+};
+
+/**
+ * struct memtest_opts - Options for memtest_run()
+ *
+ * @flags: Options (enum memtest_flags)
+ * @seed: Value to mix into the address-based patterns, so that different runs
+ *	write different data
+ * @window: Number of bytes to test at once (0 for the default). This should be
+ *	much larger than the caches. Testing stops at a window boundary when
+ *	@limit_ms is reached or @progress asks to stop
+ * @limit_ms: Stop after this many milliseconds (0 for no limit)
+ * @progress: Function to call after each pass, or NULL. It is passed the
+ *	number of bytes done and the total, counting each pass separately, and
+ *	may return -EINTR to stop testing
+ * @priv: Private data for @progress
+ */
+struct memtest_opts {
+	uint flags;
+	ulong seed;
+	ulong window;
+	ulong limit_ms;
+	int (*progress)(void *priv, u64 done, u64 total);
+	void *priv;
+};
+
+/**
+ * struct memtest_result - Result of memtest_run()
+ *
+ * @errors: Number of words which did not have the expected value
+ * @addr: Address of the first word which did not have the expected value
+ * @found: Value read from @addr
+ * @expected: Value which should have been read from @addr
+ * @tested: Number of bytes which were tested with all patterns
+ * @passes: Number of passes over each window
+ * @time_ms: Time taken in milliseconds
+ */
+struct memtest_result {
+	ulong errors;
+	ulong addr;
+	ulong found;
+	ulong expected;
+	ulong tested;
+	int passes;
+	ulong time_ms;
+};
+
+/**
+ * memtest_run() - Test a region of memory
+ *
+ * The region's contents are destroyed
+ *
+ * @buf: Pointer to the start of the region, aligned to sizeof(ulong)
+ * @addr: Address of the start of the region, used to report errors
+ * @size: Size of the region in bytes; any partial word at the end is not
+ *	tested
+ * @opts: Options
+ * @res: Returns the result
+ * Return: 0 if the whole region was tested without errors, -EIO if errors
+ *	were found, else -ETIMEDOUT if @limit_ms was reached, -EINTR if
+ *	@progress stopped the test, or -ENOMEM if out of memory
+ */
+int memtest_run(void *buf, ulong addr, ulong size,
+		const struct memtest_opts *opts, struct memtest_result *res);
+
+#endif
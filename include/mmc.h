@@ -68,6 +68,7 @@ struct bd_info;
 #define MMC_CAP_NONREMOVABLE	BIT(14)
 #define MMC_CAP_NEEDS_POLL	BIT(15)
 #define MMC_CAP_CD_ACTIVE_HIGH  BIT(16)
+#define MMC_CAP_CQE		BIT(17)	/* host has a command queue engine */
 
 #define MMC_MODE_8BIT		BIT(30)
 #define MMC_MODE_4BIT		BIT(29)
@@ -205,6 +206,7 @@ static inline bool mmc_is_tuning_cmd(uint cmdidx)
 /*
  * EXT_CSD fields
  */
+#define EXT_CSD_CMDQ_MODE_EN		15	/* R/W */
 #define EXT_CSD_ENH_START_ADDR		136	/* R/W */
 #define EXT_CSD_ENH_SIZE_MULT		140	/* R/W */
 #define EXT_CSD_GP_SIZE_MULT		143	/* R/W */
@@ -235,6 +237,8 @@ static inline bool mmc_is_tuning_cmd(uint cmdidx)
 #define EXT_CSD_BOOT_MULT		226	/* RO */
 #define EXT_CSD_SEC_FEATURE		231	/* RO */
 #define EXT_CSD_GENERIC_CMD6_TIME       248     /* RO */
+#define EXT_CSD_CMDQ_DEPTH		307	/* RO */
+#define EXT_CSD_CMDQ_SUPPORT		308	/* RO */
 #define EXT_CSD_BKOPS_SUPPORT		502	/* RO */
 
 /*
@@ -512,6 +516,28 @@ struct dm_mmc_ops {
 	 * @return 0 if OK, -ve on error
 	 */
 	int (*execute_tuning)(struct udevice *dev, uint opcode);
+
+	/**
+	 * get_tuning() - Read back the result of the last tuning
+	 *
+	 * This is used to pass the tuning from SPL to U-Boot proper, so that
+	 * it does not need to be done again. The value is only interpreted by
+	 * set_tuning().
+	 *
+	 * @dev:	Device to check
+	 * @tuningp:	Returns the host-specific tuning result
+	 * @return 0 if OK, -ENOSYS if not supported, other -ve on error
+	 */
+	int (*get_tuning)(struct udevice *dev, u32 *tuningp);
+
+	/**
+	 * set_tuning() - Restore a tuning result, instead of tuning again
+	 *
+	 * @dev:	Device to update
+	 * @tuning:	Tuning result, as returned by get_tuning()
+	 * @return 0 if OK, -ENOSYS if not supported, other -ve on error
+	 */
+	int (*set_tuning)(struct udevice *dev, u32 tuning);
 #endif
 
 	/**
@@ -560,6 +586,40 @@ struct dm_mmc_ops {
 	 * @return 0 if success, -ve on error
 	 */
 	int (*hs400_prepare_ddr)(struct udevice *dev);
+
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	/**
+	 * cqe_enable() - Hand the bus over to the command queue engine
+	 *
+	 * Called once the card has command queueing enabled. Until
+	 * cqe_disable() is called, only cqe_rw() is used.
+	 *
+	 * @dev:	Device to update
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*cqe_enable)(struct udevice *dev);
+
+	/**
+	 * cqe_disable() - Stop the command queue engine
+	 *
+	 * Called before any legacy command is sent to the card
+	 *
+	 * @dev:	Device to update
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*cqe_disable)(struct udevice *dev);
+
+	/**
+	 * cqe_rw() - Transfer blocks using the command queue engine
+	 *
+	 * @dev:	Device to use
+	 * @data:	Buffer, direction and number of blocks to transfer
+	 * @start:	First block on the card
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*cqe_rw)(struct udevice *dev, struct mmc_data *data,
+		      lbaint_t start);
+#endif
 };
 
 #define mmc_get_ops(dev)        ((struct dm_mmc_ops *)(dev)->driver->ops)
@@ -569,6 +629,8 @@ int mmc_set_ios(struct mmc *mmc);
 int mmc_getcd(struct mmc *mmc);
 int mmc_getwp(struct mmc *mmc);
 int mmc_execute_tuning(struct mmc *mmc, uint opcode);
+int mmc_get_tuning(struct mmc *mmc, u32 *tuningp);
+int mmc_set_tuning(struct mmc *mmc, u32 tuning);
 int mmc_wait_dat0(struct mmc *mmc, int state, int timeout_us);
 int mmc_set_enhanced_strobe(struct mmc *mmc);
 int mmc_host_power_cycle(struct mmc *mmc);
@@ -577,6 +639,9 @@ int mmc_reinit(struct mmc *mmc);
 int mmc_get_b_max(struct mmc *mmc, void *dst, lbaint_t blkcnt);
 int mmc_hs400_prepare_ddr(struct mmc *mmc);
 int mmc_send_stop_transmission(struct mmc *mmc, bool write);
+int mmc_cqe_enable(struct mmc *mmc);
+int mmc_cqe_disable(struct mmc *mmc);
+int mmc_cqe_rw(struct mmc *mmc, struct mmc_data *data, lbaint_t start);
 
 #else
 struct mmc_ops {
@@ -756,12 +821,61 @@ struct mmc {
 	u32 quirks;
 	bool tuning:1;
 	bool hs400_tuning:1;
+	bool handoff:1;		/* card state was taken over from SPL */
 
 	enum bus_mode user_speed_mode; /* input speed mode from user */
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	u8 cmdq_depth;		/* card's command queue depth, 0 if none */
+	bool cqe_on;		/* command queue is in use */
+#endif
 
 	CONFIG_IS_ENABLED(CYCLIC, (struct cyclic_info cyclic));
 };
 
+/* mmc_handoff->flags */
+#define MMC_HANDOFF_TUNED	BIT(0)	/* @tuning is valid */
+
+/**
+ * struct mmc_handoff - MMC card state passed from SPL to U-Boot proper
+ *
+ * SPL records the card it has set up, so that U-Boot proper can carry on
+ * using it without identifying it, switching modes and tuning again. This is
+ * stored in the bloblist as BLOBLISTT_U_BOOT_MMC. Only one card is recorded.
+ * The fields have fixed sizes with no implicit padding, so that a 32-bit SPL
+ * and a 64-bit U-Boot proper agree on the layout.
+ *
+ * @base: Base address of the host controller, FDT_ADDR_T_NONE if none
+ * @seq: Sequence number of the MMC device
+ * @flags: MMC_HANDOFF_... flags
+ * @mode: Bus mode in use (enum bus_mode)
+ * @bus_width: Bus width in use (1, 4 or 8)
+ * @signal_voltage: I/O signalling voltage (enum mmc_voltage)
+ * @spare: Unused, keeps @rca aligned
+ * @rca: Relative card address
+ * @version: Card version (SD_VERSION_... or MMC_VERSION_...)
+ * @ocr: Operating conditions register
+ * @cid: Card identification register
+ * @csd: Card-specific data register
+ * @clock: Bus clock in Hz
+ * @tuning: Host-specific tuning result, if MMC_HANDOFF_TUNED is set
+ */
+struct mmc_handoff {
+	u64 base;
+	u8 seq;
+	u8 flags;
+	u8 mode;
+	u8 bus_width;
+	u8 signal_voltage;
+	u8 spare;
+	u16 rca;
+	u32 version;
+	u32 ocr;
+	u32 cid[4];
+	u32 csd[4];
+	u32 clock;
+	u32 tuning;
+};
+
 #if CONFIG_IS_ENABLED(DM_MMC)
 #define mmc_to_dev(_mmc)	_mmc->dev
 #else
@@ -820,6 +934,19 @@ int mmc_send_tuning(struct mmc *mmc, u32 opcode);
 int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd, struct mmc_data *data);
 int mmc_deinit(struct mmc *mmc);
 
+/**
+ * mmc_handoff_save() - Record the state of a card for U-Boot proper
+ *
+ * This is called by SPL once a card is initialised. U-Boot proper then takes
+ * over the card in that state, if it is still there, instead of starting
+ * again from scratch. See struct mmc_handoff
+ *
+ * @mmc:	MMC device, which must be initialised
+ * Return: 0 if OK, -ENOSYS if CONFIG_MMC_HANDOFF is not enabled, other -ve on
+ *	error
+ */
+int mmc_handoff_save(struct mmc *mmc);
+
 /**
  * mmc_of_parse() - Parse the device tree to get the capabilities of the host
  *
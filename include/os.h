@@ -242,6 +242,28 @@ void *os_realloc(void *ptr, size_t length);
  */
 void os_usleep(unsigned long usec);
 
+/**
+ * os_thread_start() - start a host thread
+ *
+ * The thread shares all memory with U-Boot, so must not use U-Boot functions
+ * which are not thread-safe, such as malloc()
+ *
+ * @func:	function to run in the thread
+ * @arg:	argument to pass to @func
+ * @threadp:	returns a handle for the thread, for os_thread_join()
+ * Return:	0 if OK, -ve on error
+ */
+int os_thread_start(void *(*func)(void *arg), void *arg,
+		    unsigned long *threadp);
+
+/**
+ * os_thread_join() - wait for a host thread to exit
+ *
+ * @thread:	handle of the thread, from os_thread_start()
+ * Return:	0 if OK, -ve on error
+ */
+int os_thread_join(unsigned long thread);
+
 /**
  * os_get_nsec() - get monotonically increasing number of nano seconds from OS
  *
@@ -576,6 +598,35 @@ int os_setup_signal_handlers(void);
  */
 void os_signal_action(int sig, unsigned long pc);
 
+/**
+ * os_profile_start() - start sampling the call stack periodically
+ *
+ * This sets up a SIGPROF timer which fires @hz times each second of CPU time
+ * used by sandbox. Each time, os_profile_action() is called with the
+ * interrupted call stack.
+ *
+ * @hz:		number of samples to take each second
+ * Return:	0 for success, -ENOSYS if CONFIG_TRACE_SAMPLE is not enabled,
+ *		other -ve on error
+ */
+int os_profile_start(unsigned int hz);
+
+/**
+ * os_profile_stop() - stop sampling the call stack
+ */
+void os_profile_stop(void);
+
+/**
+ * os_profile_action() - handle a profiling sample
+ *
+ * This is called from the SIGPROF handler so must be async-signal-safe.
+ *
+ * @pcs:	list of code addresses, starting with the interrupted program
+ *		counter and followed by return addresses, innermost first
+ * @count:	number of entries in @pcs
+ */
+void os_profile_action(const unsigned long *pcs, int count);
+
 /**
  * os_get_time_offset() - get time offset
  *
@@ -160,7 +160,7 @@ struct scsi_cmd {
 #define SCSI_MED_REMOVL	0x1E		/* Prevent/Allow medium Removal (O) */
 #define SCSI_READ6		0x08		/* Read 6-byte (MANDATORY) */
 #define SCSI_READ10		0x28		/* Read 10-byte (MANDATORY) */
-#define SCSI_READ16	0x48
+#define SCSI_READ16	0x88		/* Read 16-byte (O) */
 #define SCSI_RD_CAPAC	0x25		/* Read Capacity (MANDATORY) */
 #define SCSI_RD_CAPAC10	SCSI_RD_CAPAC	/* Read Capacity (10) */
 #define SCSI_RD_CAPAC16	0x9e		/* Read Capacity (16) */
@@ -182,6 +182,7 @@ struct scsi_cmd {
 #define SCSI_VERIFY		0x2F		/* Verify (O) */
 #define SCSI_WRITE6		0x0A		/* Write 6-Byte (MANDATORY) */
 #define SCSI_WRITE10	0x2A		/* Write 10-Byte (MANDATORY) */
+#define SCSI_WRITE16	0x8A		/* Write 16-Byte (O) */
 #define SCSI_WRT_VERIFY	0x2E		/* Write and Verify (O) */
 #define SCSI_WRITE_LONG	0x3F		/* Write Long (O) */
 #define SCSI_WRITE_SAME	0x41		/* Write Same (O) */
@@ -247,6 +248,19 @@ struct scsi_read_capacity_resp {
 	u32 block_len;
 };
 
+/**
+ * struct scsi_read_capacity16_resp - holds the response to READ CAPACITY(16)
+ *
+ * @last_block_addr: Logical block address of last block
+ * @block_len: Length of each block in bytes
+ * @spare: spare bytes
+ */
+struct __packed scsi_read_capacity16_resp {
+	u64 last_block_addr;
+	u32 block_len;
+	u8 spare[20];
+};
+
 /**
  * struct scsi_read10_req - holds a SCSI READ10 request
  *
@@ -276,6 +290,32 @@ struct __packed scsi_write10_req {
 	u8 spare2[3];
 };
 
+/**
+ * struct scsi_read16_req - holds a SCSI READ16 request
+ *
+ * @cmd; command type
+ * @flags; flags
+ * @lba; Logical block address to start reading from
+ * @xfer_len: number of blocks to read
+ * @spare; spare bytes
+ */
+struct __packed scsi_read16_req {
+	u8 cmd;
+	u8 flags;
+	u64 lba;
+	u32 xfer_len;
+	u8 spare[2];
+};
+
+/** struct scsi_write16_req - data for the write16 command */
+struct __packed scsi_write16_req {
+	u8 cmd;
+	u8 flags;
+	u64 lba;
+	u32 xfer_len;
+	u8 spare[2];
+};
+
 /**
  * struct scsi_plat - stores information about SCSI controller
  *
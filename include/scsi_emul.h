@@ -35,7 +35,7 @@ struct scsi_emul_info {
 	const char *product;
 	int block_size;
 	loff_t file_size;
-	int seek_block;
+	u64 seek_block;
 
 	/* state maintained by the emulator: */
 	enum scsi_cmd_phase phase;
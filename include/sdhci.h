@@ -125,6 +125,7 @@
 #define  SDHCI_INT_CARD_INSERT	BIT(6)
 #define  SDHCI_INT_CARD_REMOVE	BIT(7)
 #define  SDHCI_INT_CARD_INT	BIT(8)
+#define  SDHCI_INT_CQE		BIT(14)
 #define  SDHCI_INT_ERROR	BIT(15)
 #define  SDHCI_INT_TIMEOUT	BIT(16)
 #define  SDHCI_INT_CRC		BIT(17)
@@ -255,6 +256,7 @@
 #define SDHCI_QUIRK_CAPS_BIT63_FOR_HS400	BIT(11)
 
 /* to make gcc happy */
+struct cqhci_host;
 struct sdhci_host;
 
 /*
@@ -362,6 +364,9 @@ struct sdhci_host {
 #if CONFIG_IS_ENABLED(MMC_SDHCI_ADMA)
 	struct sdhci_adma_desc *adma_desc_table;
 #endif
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	struct cqhci_host *cq_host;
+#endif
 };
 
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
@@ -528,6 +533,20 @@ int sdhci_set_clock(struct mmc *mmc, unsigned int clock);
  * @host: SDHCI host structure
  */
 void sdhci_set_control_reg(struct sdhci_host *host);
+
+/**
+ * sdhci_cqe_init() - Set up the command queue engine of a host controller
+ *
+ * sdhci_probe() calls this when the device tree has "supports-cqe" and a
+ * "cqhci" register region. Drivers whose CQE registers are found some other
+ * way can call it from their own probe() method, after sdhci_probe().
+ *
+ * @host: SDHCI host structure
+ * @mmio: Base address of the CQHCI registers
+ * @caps: Engine capabilities (CQHCI_TASK_DESC_SZ_128)
+ * Return: 0 if OK, -ve on error
+ */
+int sdhci_cqe_init(struct sdhci_host *host, void __iomem *mmio, u32 caps);
 extern const struct dm_mmc_ops sdhci_ops;
 #else
 #endif
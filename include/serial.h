@@ -1,6 +1,7 @@
 #ifndef __SERIAL_H__
 #define __SERIAL_H__
 
+#include <cyclic.h>
 #include <post.h>
 #ifdef CONFIG_SANDBOX
 #include <asm/state.h>
@@ -313,6 +314,14 @@ struct serial_priv {
  * @buf:	Pointer to the RX buffer
  * @rd_ptr:	Read pointer in the RX buffer
  * @wr_ptr:	Write pointer in the RX buffer
+ *
+ * @tx_buf:	TX buffer, drained into the UART as it has space
+ * @tx_rd_ptr:	Read pointer in the TX buffer
+ * @tx_wr_ptr:	Write pointer in the TX buffer
+ * @tx_cyclic:	Cyclic function which drains the TX buffer
+ * @dev:	Serial device (used by the cyclic function)
+ * @tx_active:	true if the TX buffer is in use (i.e. after relocation)
+ * @tx_busy:	true while the TX buffer is being drained
  */
 struct serial_dev_priv {
 	struct stdio_dev *sdev;
@@ -322,6 +331,15 @@ struct serial_dev_priv {
 	uint rd_ptr;
 	uint wr_ptr;
 #endif
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	char tx_buf[CONFIG_SERIAL_TX_BUFFER_SIZE];
+	uint tx_rd_ptr;
+	uint tx_wr_ptr;
+	struct cyclic_info tx_cyclic;
+	struct udevice *dev;
+	bool tx_active;
+	bool tx_busy;
+#endif
 };
 
 /* Access the serial operations for a device */
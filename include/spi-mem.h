@@ -336,6 +336,19 @@ struct spi_mem_dirmap_desc *
 spi_mem_dirmap_create(struct spi_slave *mem,
 		      const struct spi_mem_dirmap_info *info);
 void spi_mem_dirmap_destroy(struct spi_mem_dirmap_desc *desc);
+
+/**
+ * spi_mem_copy_from_map() - Copy data out of a memory-mapped flash window
+ * @buf: destination buffer
+ * @src: address within the window to read from
+ * @len: number of bytes to copy
+ *
+ * For use by controllers which map SPI memory into the CPU address space. With
+ * CONFIG_SPI_DIRMAP_DMA, larger copies into a cache-aligned buffer are done by
+ * a memory-to-memory DMA engine, falling back to memcpy_fromio() if there is
+ * none or the transfer fails.
+ */
+void spi_mem_copy_from_map(void *buf, const void __iomem *src, size_t len);
 ssize_t spi_mem_dirmap_read(struct spi_mem_dirmap_desc *desc,
 			    u64 offs, size_t len, void *buf);
 ssize_t spi_mem_dirmap_write(struct spi_mem_dirmap_desc *desc,
@@ -29,11 +29,15 @@ enum {
 	FUNC_SITE_SIZE	= 16,	/* distance between function sites */
 
 	TRACE_VERSION	= 1,
+
+	/* Maximum number of stack frames recorded in each sample */
+	TRACE_SAMPLE_DEPTH	= 8,
 };
 
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_SAMPLES,
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -47,7 +51,7 @@ struct trace_output_hdr {
 	enum trace_chunk_type type;	/* Record type */
 	uint32_t version;		/* Version (TRACE_VERSION) */
 	uint32_t rec_count;		/* Number of records */
-	uint32_t spare;			/* 0 */
+	uint32_t spare;			/* 0, or sample period in us (samples) */
 	uint64_t text_base;		/* Value of CONFIG_TEXT_BASE */
 	uint64_t spare2;		/* 0 */
 };
@@ -89,6 +93,61 @@ struct trace_call {
 
 int trace_list_calls(void *buff, size_t buff_size, size_t *needed);
 
+/*
+ * A single statistical sample, as written to the profile output file
+ *
+ * The offsets are measured from the text base, like those in trace_call, but
+ * are not rounded to FUNC_SITE_SIZE, since they generally point into the
+ * middle of a function
+ */
+struct trace_sample {
+	uint32_t timestamp;	/* Time of the sample in microseconds */
+	uint32_t depth;		/* Number of valid entries in @pc */
+	uint32_t pc[TRACE_SAMPLE_DEPTH];	/* Code offsets, innermost first */
+};
+
+/**
+ * trace_list_samples() - Dump the list of statistical samples into a buffer
+ *
+ * The information is written into the supplied buffer - a header of type
+ * TRACE_CHUNK_SAMPLES followed by a list of struct trace_sample records.
+ *
+ * @buff:	Buffer in which to place data, or NULL to count size
+ * @buff_size:	Size of buffer
+ * @needed:	Returns number of bytes used / needed
+ * Return: 0 if ok, -ENOSPC if space was exhausted
+ */
+int trace_list_samples(void *buff, size_t buff_size, size_t *needed);
+
+/**
+ * trace_add_sample() - Record a statistical sample
+ *
+ * This is called by the architecture's sampling timer, typically from signal
+ * or interrupt context. Addresses which are outside the U-Boot image are
+ * dropped.
+ *
+ * @pcs:	List of code addresses making up the call stack, innermost first
+ * @count:	Number of addresses in @pcs
+ */
+void trace_add_sample(const unsigned long *pcs, int count);
+
+/**
+ * arch_trace_sample_start() - Start the sampling timer
+ *
+ * Each time the timer fires, the architecture should call trace_add_sample()
+ * with the interrupted program counter and as much of the call stack as it
+ * can find.
+ *
+ * @hz:		Number of samples to take each second
+ * Return: 0 if OK, -ENOSYS if not supported by this architecture
+ */
+int arch_trace_sample_start(unsigned int hz);
+
+/**
+ * arch_trace_sample_stop() - Stop the sampling timer
+ */
+void arch_trace_sample_stop(void);
+
 /**
  * Turn function tracing on and off
  *
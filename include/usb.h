@@ -264,6 +264,18 @@ int usb_host_eth_scan(int mode);
  */
 int usb_init(void);
 
+/*
+ * usb_init_start() - start up the USB controllers without scanning the buses
+ *
+ * This allows USB to be powered up early, so that devices have time to settle
+ * while other things are going on. The controllers are probed and the ports of
+ * their root hubs are powered up. The ports are scanned by the next call to
+ * usb_init()
+ *
+ * Returns: 0 if OK, -ve on error
+ */
+int usb_init_start(void);
+
 int usb_stop(void); /* stop the USB Controller */
 int usb_detect_change(void); /* detect if a USB device has been (un)plugged */
 
@@ -659,11 +671,14 @@ struct usb_dev_plat {
  *		so this will be false.
  * @companion:  True if this is a companion controller to another USB
  *		controller
+ * @scan_pending: True if usb_init_start() has set up the root hub, leaving
+ *		its ports to be scanned by usb_init()
  */
 struct usb_bus_priv {
 	int next_addr;
 	bool desc_before_addr;
 	bool companion;
+	bool scan_pending;
 };
 
 /**
@@ -844,6 +859,34 @@ bool usb_hub_is_root_hub(struct udevice *hub);
  */
 int usb_hub_scan(struct udevice *hub);
 
+/**
+ * usb_hub_set_defer() - Select whether new hubs have their ports scanned
+ *
+ * While this is enabled, configuring a hub powers up its ports and adds them
+ * to the scan list, but does not scan them. Use usb_hub_scan_pending() to do
+ * that later, once the power-on and connect delays have had time to pass.
+ *
+ * @defer:	true to leave the ports on the list, false to scan them as usual
+ */
+void usb_hub_set_defer(bool defer);
+
+/**
+ * usb_hub_scan_pending() - Scan the ports left by usb_hub_set_defer()
+ *
+ * This waits for each port to settle, if needed, and probes any device found
+ * on it, including the ports of any further hubs
+ *
+ * Return: 0 if OK, -ve on error
+ */
+int usb_hub_scan_pending(void);
+
+/**
+ * usb_hub_drop_pending() - Drop any ports left by usb_hub_set_defer()
+ *
+ * This must be called before the hubs are removed without being scanned
+ */
+void usb_hub_drop_pending(void);
+
 /**
  * usb_scan_device() - Scan a device on a bus
  *
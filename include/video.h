@@ -88,6 +88,9 @@ enum video_sync_flags {
 	VIDSYNC_COPY = BIT(2),
 };
 
+/* Maximum number of separate damaged regions tracked between syncs */
+#define VIDEO_DAMAGE_RECTS	8
+
 /**
  * struct video_priv - Device information used by the video uclass
  *
@@ -105,6 +108,11 @@ enum video_sync_flags {
  * @copy_fb:	Copy of the frame buffer to keep up to date; see struct
  *		video_uc_plat
  * @damage:	Bounding box of framebuffer regions updated since last sync
+ * @damage_rect:	Framebuffer regions updated since last sync. These are
+ *		kept apart, so that updates at opposite corners of the display do
+ *		not cause everything in between to be copied / flushed
+ * @damage_count:	Number of valid entries in @damage_rect
+ * @copy_bytes:	Number of bytes copied to @copy_fb by the last sync
  * @line_length:	Length of each frame buffer line, in bytes. This can be
  *		set by the driver, but if not, the uclass will set it after
  *		probing
@@ -135,6 +143,9 @@ struct video_priv {
 	int fb_size;
 	void *copy_fb;
 	struct vid_bbox damage;
+	struct vid_bbox damage_rect[VIDEO_DAMAGE_RECTS];
+	int damage_count;
+	ulong copy_bytes;
 	int line_length;
 	u32 colour_fg;
 	u32 colour_bg;
@@ -309,6 +320,20 @@ int video_clear(struct udevice *dev);
  */
 int video_fill(struct udevice *dev, u32 colour);
 
+/**
+ * video_fill_pixels() - Fill a run of pixels with a colour
+ *
+ * This writes a machine word at a time where possible, so is much faster than
+ * writing each pixel separately
+ *
+ * @dst:	First pixel to write, which must be aligned to the pixel size
+ * @colour:	Colour to use, in the frame buffer's format
+ * @bpix:	Pixel depth (VIDEO_BPP8, VIDEO_BPP16 or VIDEO_BPP32)
+ * @count:	Number of pixels to write
+ */
+void video_fill_pixels(void *dst, u32 colour, enum video_log2_bpp bpix,
+		       int count);
+
 /**
  * video_fill_part() - Erase a region
  *
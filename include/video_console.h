@@ -726,4 +726,15 @@ void vidconsole_set_bitmap_font(struct udevice *dev,
  */
 void vidconsole_idle(struct udevice *dev);
 
+/**
+ * console_truetype_glyph_stats() - Get information about the glyph cache
+ *
+ * @dev: TrueType console device
+ * @hitsp: Returns the number of glyphs found in the cache
+ * @missesp: Returns the number of glyphs which had to be rendered
+ * @countp: Returns the number of glyphs currently in the cache
+ */
+void console_truetype_glyph_stats(struct udevice *dev, ulong *hitsp,
+				  ulong *missesp, int *countp);
+
 #endif
@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Running independent jobs on secondary CPUs
+ *
+ * U-Boot normally runs on a single CPU while the others wait to be handed to
+ * the OS. The worker pool brings those CPUs into a loop which takes jobs from
+ * a shared batch, so that work such as hashing several images, decompressing
+ * independent frames or filling / checking memory regions scales with the
+ * number of cores. The boot CPU takes jobs too, so a batch always completes,
+ * even when there are no workers.
+ *
+ * Jobs run with no locking around U-Boot's own state, so they must only work
+ * on memory: they must not call malloc(), printf(), schedule() or driver
+ * model. Anything they need must be allocated before the batch is run.
+ */
+
+#ifndef __WORKER_H
+#define __WORKER_H
+
+/**
+ * struct worker_job - A piece of work which can run on any CPU
+ *
+ * @func: Function to run
+ * @arg: Argument to pass to @func
+ * @ret: Returns the value returned by @func: 0 if OK, -ve on error
+ */
+struct worker_job {
+	int (*func)(void *arg);
+	void *arg;
+	int ret;
+};
+
+#if CONFIG_IS_ENABLED(WORKER)
+/**
+ * worker_start() - Start the worker pool, if not already running
+ *
+ * This is called by worker_run() so is only needed to start the workers
+ * ahead of time
+ *
+ * Return: number of workers running (0 if there are no secondary CPUs)
+ */
+int worker_start(void);
+
+/**
+ * worker_run() - Run a batch of jobs and wait for them all to finish
+ *
+ * The jobs are shared between the workers and the boot CPU, in no particular
+ * order. This must only be called from the boot CPU, not from a job.
+ *
+ * @jobs: Jobs to run
+ * @count: Number of jobs
+ * Return: 0 if all jobs succeeded, else the error from the first job (in
+ *	array order) which failed
+ */
+int worker_run(struct worker_job *jobs, int count);
+
+/**
+ * worker_park() - Stop all workers
+ *
+ * This returns the secondary CPUs to the state they were in before
+ * worker_start(), ready to be handed to the OS. It is called automatically
+ * by bootm_final(). The pool is restarted by the next worker_run()
+ *
+ * If a worker does not stop in time, an error is shown and the CPUs are left
+ * as they are. The pool stays marked as started, so jobs still run (on the
+ * boot CPU if need be) and a later call can try again.
+ */
+void worker_park(void);
+#else
+static inline int worker_start(void)
+{
+	return 0;
+}
+
+static inline int worker_run(struct worker_job *jobs, int count)
+{
+	int i, ret = 0;
+
+	for (i = 0; i < count; i++) {
+		jobs[i].ret = jobs[i].func(jobs[i].arg);
+		if (jobs[i].ret && !ret)
+			ret = jobs[i].ret;
+	}
+
+	return ret;
+}
+
+static inline void worker_park(void)
+{
+}
+#endif
+
+/**
+ * worker_main() - Loop taking jobs, on a secondary CPU
+ *
+ * This is called by the architecture code on each CPU it starts. It returns
+ * when worker_park() is called.
+ */
+void worker_main(void);
+
+/**
+ * arch_worker_start() - Start secondary CPUs running worker_main()
+ *
+ * Return: number of CPUs started, 0 if none, or -ve on error
+ */
+int arch_worker_start(void);
+
+/**
+ * arch_worker_park() - Finish stopping the workers
+ *
+ * This is called once all workers have returned from worker_main(). It waits
+ * until the CPUs are back in the state the OS expects
+ */
+void arch_worker_park(void);
+
+/**
+ * arch_worker_idle() - Wait a little while a worker has nothing to do
+ */
+void arch_worker_idle(void);
+
+#endif
@@ -104,6 +104,9 @@
 #define BCH_ECC_WORDS(_p)      DIV_ROUND_UP(GF_M(_p)*GF_T(_p), 32)
 #define BCH_ECC_BYTES(_p)      DIV_ROUND_UP(GF_M(_p)*GF_T(_p), 8)
 
+/* entries per odd syndrome in bch->syn_tab: byte values, low and high bytes */
+#define BCH_SYN_TAB_SIZE       (3*256)
+
 #ifndef dbg
 #define dbg(_fmt, args...)     do {} while (0)
 #endif
@@ -380,6 +383,37 @@ static inline int a_ilog(struct bch_control *bch, unsigned int x)
 	return mod_s(bch, GF_N(bch)-bch->a_log_tab[x]);
 }
 
+#if CONFIG_IS_ENABLED(BCH_FAST_DECODE)
+/*
+ * compute odd syndromes v(a^j) for j=1,3,..,2t-1 one ecc byte at a time, using
+ * Horner's rule: s = s*a^(8j) + T_j[byte], most significant byte first.
+ * Multiplying by the constant a^(8j) is linear over GF(2), so it is done with
+ * two table lookups on the low and high bytes of s. The ecc bits are left
+ * aligned in their words, so the result is finally divided by a^(j*pad) where
+ * pad is the number of unused bits in the last word.
+ */
+static void compute_syndromes_sliced(struct bch_control *bch, uint32_t *ecc,
+				     unsigned int *syn)
+{
+	const unsigned int words = BCH_ECC_WORDS(bch);
+	const unsigned int pad = words*32-bch->ecc_bits;
+	const uint16_t *tab = bch->syn_tab;
+	unsigned int i, j, e, v;
+	int k;
+
+	for (j = 0; j < GF_T(bch); j++, tab += BCH_SYN_TAB_SIZE) {
+		for (i = 0, v = 0; i < words; i++)
+			for (k = 24; k >= 0; k -= 8)
+				v = tab[256+(v & 0xff)]^tab[512+(v >> 8)]^
+					tab[(ecc[i] >> k) & 0xff];
+
+		e = 2*j+1;
+		syn[2*j] = v ? a_pow(bch, a_log(bch, v)+GF_N(bch)-
+				     modulo(bch, e*pad)) : 0;
+	}
+}
+#endif
+
 /*
  * compute 2t syndromes of ecc polynomial, i.e. ecc(a^j) for j=1..2t
  */
@@ -399,6 +433,13 @@ static void compute_syndromes(struct bch_control *bch, uint32_t *ecc,
 		ecc[s/32] &= ~((1u << (32-m))-1);
 	memset(syn, 0, 2*t*sizeof(*syn));
 
+#if CONFIG_IS_ENABLED(BCH_FAST_DECODE)
+	if (bch->syn_tab) {
+		compute_syndromes_sliced(bch, ecc, syn);
+		goto square;
+	}
+#endif
+
 	/* compute v(a^j) for j=1 .. 2t-1 */
 	do {
 		poly = *ecc++;
@@ -412,6 +453,10 @@ static void compute_syndromes(struct bch_control *bch, uint32_t *ecc,
 		}
 	} while (s > 0);
 
+#if CONFIG_IS_ENABLED(BCH_FAST_DECODE)
+square:
+#endif
+
 	/* v(a^(2j)) = v(a^j)^2 */
 	for (j = 0; j < t; j++)
 		syn[2*j+1] = gf_sqr(bch, syn[j]);
@@ -1121,6 +1166,33 @@ static int build_gf_tables(struct bch_control *bch, unsigned int poly)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(BCH_FAST_DECODE)
+/*
+ * build lookup tables for compute_syndromes_sliced(); for each odd syndrome
+ * a^j these hold the contribution of each possible byte value, and the
+ * product of each possible low and high byte of a field element by a^(8j)
+ */
+static void build_syn_tables(struct bch_control *bch)
+{
+	unsigned int b, k, j, e, v;
+	uint16_t *tab = bch->syn_tab;
+
+	for (j = 0; j < GF_T(bch); j++, tab += BCH_SYN_TAB_SIZE) {
+		e = 2*j+1;
+		for (b = 0; b < 256; b++) {
+			for (k = 0, v = 0; k < 8; k++)
+				if (b & (1 << k))
+					v ^= a_pow(bch, e*k);
+			tab[b] = v;
+			tab[256+b] = (b <= GF_N(bch)) ? gf_mul(bch, b,
+						a_pow(bch, 8*e)) : 0;
+			tab[512+b] = ((b << 8) <= GF_N(bch)) ?
+				gf_mul(bch, b << 8, a_pow(bch, 8*e)) : 0;
+		}
+	}
+}
+#endif
+
 /*
  * compute generator polynomial remainder tables for fast encoding
  */
@@ -1376,6 +1448,14 @@ struct bch_control *init_bch(int m, int t, unsigned int prim_poly)
 	if (err)
 		goto fail;
 
+#if CONFIG_IS_ENABLED(BCH_FAST_DECODE)
+	/* syndrome tables are optional; decoding is just slower without */
+	bch->syn_tab = kmalloc(t*BCH_SYN_TAB_SIZE*sizeof(*bch->syn_tab),
+			       GFP_KERNEL);
+	if (bch->syn_tab)
+		build_syn_tables(bch);
+#endif
+
 	return bch;
 
 fail:
@@ -1401,6 +1481,7 @@ void free_bch(struct bch_control *bch)
 		kfree(bch->syn);
 		kfree(bch->cache);
 		kfree(bch->elp);
+		kfree(bch->syn_tab);
 
 		for (i = 0; i < ARRAY_SIZE(bch->poly_2t); i++)
 			kfree(bch->poly_2t[i]);
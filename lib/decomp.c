@@ -0,0 +1,900 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Decompressing data in chunks, as it arrives
+ *
+ * Each algorithm has a feed() function which consumes as much of the input as
+ * it can, writing straight into the output buffer. Headers and blocks (gzip,
+ * lzma and lzop headers, lz4 and lzop blocks) are obtained with
+ * decomp_gather(), which points directly into the input when the whole piece
+ * is there. So feeding a complete image in one go costs no extra copies and
+ * only pieces which straddle two chunks are staged.
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <bzlib.h>
+#include <decomp.h>
+#include <gzip.h>
+#include <image.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/unaligned.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/lzo.h>
+#include <linux/sizes.h>
+#include <linux/string.h>
+#include <linux/zstd.h>
+#include <lzma/LzmaTypes.h>
+#include <lzma/LzmaDec.h>
+#include <u-boot/lz4.h>
+#include <u-boot/zlib.h>
+
+/**
+ * struct decomp_ops - Operations for a compression algorithm
+ *
+ * @comp: Compression type (IH_COMP_...)
+ * @init: Set up the context, or NULL if nothing is needed
+ * @feed: Decompress some input. This is not called once @ctx->done is set
+ * @finish: Check that the stream is complete and free any state, or NULL if
+ *	the stream is always complete
+ */
+struct decomp_ops {
+	int comp;
+	int (*init)(struct decomp_ctx *ctx);
+	int (*feed)(struct decomp_ctx *ctx, const u8 *in, size_t len);
+	int (*finish)(struct decomp_ctx *ctx);
+};
+
+/**
+ * decomp_gather() - Get the next @ctx->need bytes of input in one place
+ *
+ * @ctx: Context
+ * @inp: Input pointer, updated to skip the bytes used
+ * @lenp: Input length, updated to match
+ * Return: pointer to the bytes, or NULL if more input is needed (the input has
+ *	all been staged) or on error (@ctx->err is set)
+ */
+static const u8 *decomp_gather(struct decomp_ctx *ctx, const u8 **inp,
+			       size_t *lenp)
+{
+	size_t need = ctx->need, copy;
+	const u8 *ptr;
+
+	if (!ctx->buf_len && *lenp >= need) {
+		ptr = *inp;
+		*inp += need;
+		*lenp -= need;
+		return ptr;
+	}
+	if (need > ctx->buf_size) {
+		void *buf = realloc(ctx->buf, need);
+
+		if (!buf) {
+			ctx->err = -ENOMEM;
+			return NULL;
+		}
+		ctx->buf = buf;
+		ctx->buf_size = need;
+	}
+	copy = min(need - ctx->buf_len, *lenp);
+	memcpy(ctx->buf + ctx->buf_len, *inp, copy);
+	ctx->buf_len += copy;
+	*inp += copy;
+	*lenp -= copy;
+	if (ctx->buf_len < need)
+		return NULL;
+	ctx->buf_len = 0;
+
+	return ctx->buf;
+}
+
+/* Space left in the output buffer */
+static size_t decomp_space(struct decomp_ctx *ctx)
+{
+	return ctx->out_size - ctx->out_len;
+}
+
+/* Copy data to the output buffer, if it fits */
+static int decomp_copy(struct decomp_ctx *ctx, const u8 *in, size_t len)
+{
+	if (len > decomp_space(ctx)) {
+		len = decomp_space(ctx);
+		memcpy(ctx->out + ctx->out_len, in, len);
+		ctx->out_len += len;
+		return -ENOSPC;
+	}
+	memcpy(ctx->out + ctx->out_len, in, len);
+	ctx->out_len += len;
+
+	return 0;
+}
+
+static int decomp_none_feed(struct decomp_ctx *ctx, const u8 *in, size_t len)
+{
+	return decomp_copy(ctx, in, len);
+}
+
+#if CONFIG_IS_ENABLED(GZIP)
+#define GZIP_DEFLATED		8
+#define GZIP_HEAD_CRC		BIT(1)
+#define GZIP_EXTRA_FIELD	BIT(2)
+#define GZIP_ORIG_NAME		BIT(3)
+#define GZIP_COMMENT		BIT(4)
+#define GZIP_RESERVED		0xe0
+
+enum {
+	GZIP_HEADER,
+	GZIP_EXTRA_LEN,
+	GZIP_EXTRA,
+	GZIP_NAME,
+	GZIP_COMMENT_STR,
+	GZIP_HCRC,
+	GZIP_DATA,
+};
+
+/* Move to the next optional header field which is present */
+static int decomp_gzip_next(struct decomp_ctx *ctx)
+{
+	z_stream *s;
+	int ret;
+
+	if (ctx->flags & GZIP_EXTRA_FIELD) {
+		ctx->flags &= ~GZIP_EXTRA_FIELD;
+		ctx->step = GZIP_EXTRA_LEN;
+		ctx->need = 2;
+	} else if (ctx->flags & GZIP_ORIG_NAME) {
+		ctx->flags &= ~GZIP_ORIG_NAME;
+		ctx->step = GZIP_NAME;
+	} else if (ctx->flags & GZIP_COMMENT) {
+		ctx->flags &= ~GZIP_COMMENT;
+		ctx->step = GZIP_COMMENT_STR;
+	} else if (ctx->flags & GZIP_HEAD_CRC) {
+		ctx->flags &= ~GZIP_HEAD_CRC;
+		ctx->step = GZIP_HCRC;
+		ctx->need = 2;
+	} else {
+		s = calloc(1, sizeof(*s));
+		if (!s)
+			return -ENOMEM;
+		s->zalloc = gzalloc;
+		s->zfree = gzfree;
+		ret = inflateInit2(s, -MAX_WBITS);
+		if (ret != Z_OK) {
+			free(s);
+			log_debug("inflateInit2() returned %d\n", ret);
+			return -ENOMEM;
+		}
+		ctx->priv = s;
+		ctx->step = GZIP_DATA;
+	}
+
+	return 0;
+}
+
+static int decomp_gzip_init(struct decomp_ctx *ctx)
+{
+	ctx->step = GZIP_HEADER;
+	ctx->need = 10;
+
+	return 0;
+}
+
+static int decomp_gzip_feed(struct decomp_ctx *ctx, const u8 *in, size_t len)
+{
+	z_stream *s;
+	const u8 *p;
+	int ret;
+
+	while (ctx->step != GZIP_DATA) {
+		if (ctx->step == GZIP_NAME || ctx->step == GZIP_COMMENT_STR) {
+			p = memchr(in, '\0', len);
+			if (!p)
+				return 0;
+			len -= p + 1 - in;
+			in = p + 1;
+		} else {
+			p = decomp_gather(ctx, &in, &len);
+			if (!p)
+				return ctx->err;
+			switch (ctx->step) {
+			case GZIP_HEADER:
+				if (p[2] != GZIP_DEFLATED ||
+				    (p[3] & GZIP_RESERVED)) {
+					log_debug("Bad gzipped data\n");
+					return -EINVAL;
+				}
+				ctx->flags = p[3];
+				break;
+			case GZIP_EXTRA_LEN:
+				ctx->step = GZIP_EXTRA;
+				ctx->need = get_unaligned_le16(p);
+				continue;
+			}
+		}
+		ret = decomp_gzip_next(ctx);
+		if (ret)
+			return ret;
+	}
+
+	s = ctx->priv;
+	s->next_in = (u8 *)in;
+	s->avail_in = len;
+	while (s->avail_in) {
+		s->next_out = ctx->out + ctx->out_len;
+		s->avail_out = min_t(size_t, decomp_space(ctx), UINT_MAX);
+		ret = inflate(s, Z_NO_FLUSH);
+		ctx->out_len = s->next_out - (u8 *)ctx->out;
+		if (ret == Z_STREAM_END) {
+			ctx->done = true;
+			break;
+		}
+		if (ret == Z_BUF_ERROR && !s->avail_out)
+			return -ENOSPC;
+		if (ret != Z_OK) {
+			log_debug("inflate() returned %d\n", ret);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static int decomp_gzip_finish(struct decomp_ctx *ctx)
+{
+	z_stream *s = ctx->priv;
+
+	if (s) {
+		inflateEnd(s);
+		free(s);
+	}
+
+	return ctx->done ? 0 : -EINVAL;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(BZIP2)
+/* Use the slower decompressor, which needs at most 2300 KB, if short of RAM */
+#define BZIP2_SMALL	(CONFIG_SYS_MALLOC_LEN < SZ_4M)
+
+static int decomp_bzip2_init(struct decomp_ctx *ctx)
+{
+	bz_stream *s;
+	int ret;
+
+	s = calloc(1, sizeof(*s));
+	if (!s)
+		return -ENOMEM;
+	ret = BZ2_bzDecompressInit(s, 0, BZIP2_SMALL);
+	if (ret != BZ_OK) {
+		free(s);
+		return -ENOMEM;
+	}
+	ctx->priv = s;
+
+	return 0;
+}
+
+static int decomp_bzip2_run(struct decomp_ctx *ctx, const u8 *in, size_t len)
+{
+	bz_stream *s = ctx->priv;
+	uint avail_in, avail_out;
+	int ret;
+
+	s->next_in = (char *)in;
+	s->avail_in = len;
+	do {
+		s->next_out = ctx->out + ctx->out_len;
+		s->avail_out = min_t(size_t, decomp_space(ctx), UINT_MAX);
+		avail_in = s->avail_in;
+		avail_out = s->avail_out;
+		ret = BZ2_bzDecompress(s);
+		ctx->out_len += avail_out - s->avail_out;
+		if (ret == BZ_STREAM_END) {
+			ctx->done = true;
+			break;
+		}
+		if (ret != BZ_OK) {
+			log_debug("BZ2_bzDecompress() returned %d\n", ret);
+			return -EINVAL;
+		}
+		if (s->avail_in == avail_in && s->avail_out == avail_out)
+			return s->avail_out ? 0 : -ENOSPC;
+	} while (s->avail_in);
+
+	return 0;
+}
+
+static int decomp_bzip2_feed(struct decomp_ctx *ctx, const u8 *in, size_t len)
+{
+	return decomp_bzip2_run(ctx, in, len);
+}
+
+static int decomp_bzip2_finish(struct decomp_ctx *ctx)
+{
+	int ret = 0;
+
+	/* the end of the stream may still be waiting for output space */
+	if (!ctx->done && !ctx->err)
+		ret = decomp_bzip2_run(ctx, NULL, 0);
+	BZ2_bzDecompressEnd(ctx->priv);
+	free(ctx->priv);
+	if (ret)
+		return ret;
+
+	return ctx->done ? 0 : -EINVAL;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(LZMA)
+/* LZMA_Alone header: properties, then 64-bit uncompressed size */
+#define LZMA_HEADER_SIZE	(LZMA_PROPS_SIZE + sizeof(u64))
+
+/**
+ * struct decomp_lzma - State for decompressing lzma
+ *
+ * @dec: Decoder, whose dictionary is the output buffer
+ * @limit: Number of bytes to decompress: the size from the header, or the
+ *	size of the output buffer if the header does not say
+ * @status: Last status from the decoder
+ */
+struct decomp_lzma {
+	CLzmaDec dec;
+	SizeT limit;
+	ELzmaStatus status;
+};
+
+static void *decomp_lzma_alloc(void *p, size_t size)
+{
+	return malloc(size);
+}
+
+static void decomp_lzma_free(void *p, void *address)
+{
+	free(address);
+}
+
+static ISzAlloc decomp_lzma_allocator = {
+	.Alloc	= decomp_lzma_alloc,
+	.Free	= decomp_lzma_free,
+};
+
+static int decomp_lzma_init(struct decomp_ctx *ctx)
+{
+	ctx->need = LZMA_HEADER_SIZE;
+
+	return 0;
+}
+
+static int decomp_lzma_start(struct decomp_ctx *ctx, const u8 *hdr)
+{
+	struct decomp_lzma *st;
+	u64 size;
+
+	size = get_unaligned_le64(hdr + LZMA_PROPS_SIZE);
+	if (size != U64_MAX && size > ctx->out_size)
+		return -ENOSPC;
+
+	st = calloc(1, sizeof(*st));
+	if (!st)
+		return -ENOMEM;
+	LzmaDec_Construct(&st->dec);
+	if (LzmaDec_AllocateProbs(&st->dec, hdr, LZMA_PROPS_SIZE,
+				  &decomp_lzma_allocator)) {
+		free(st);
+		return -EINVAL;
+	}
+	st->dec.dic = ctx->out;
+	st->dec.dicBufSize = ctx->out_size;
+	st->limit = size == U64_MAX ? ctx->out_size : size;
+	LzmaDec_Init(&st->dec);
+	ctx->priv = st;
+
+	return 0;
+}
+
+static int decomp_lzma_feed(struct decomp_ctx *ctx, const u8 *in, size_t len)
+{
+	struct decomp_lzma *st = ctx->priv;
+	SizeT in_len;
+	int ret;
+
+	if (!st) {
+		const u8 *hdr = decomp_gather(ctx, &in, &len);
+
+		if (!hdr)
+			return ctx->err;
+		ret = decomp_lzma_start(ctx, hdr);
+		if (ret)
+			return ret;
+		st = ctx->priv;
+	}
+
+	/*
+	 * LZMA_FINISH_END makes the decoder check for an end marker when the
+	 * output is full, so a stream which fills the buffer exactly is OK
+	 */
+	in_len = len;
+	ret = LzmaDec_DecodeToDic(&st->dec, st->limit, in, &in_len,
+				  LZMA_FINISH_END, &st->status);
+	ctx->out_len = st->dec.dicPos;
+	if (ret != SZ_OK)
+		return ctx->out_len == ctx->out_size ? -ENOSPC : -EINVAL;
+	if (st->status == LZMA_STATUS_FINISHED_WITH_MARK ||
+	    (ctx->out_len == st->limit &&
+	     st->status != LZMA_STATUS_NEEDS_MORE_INPUT))
+		ctx->done = true;
+
+	return 0;
+}
+
+static int decomp_lzma_finish(struct decomp_ctx *ctx)
+{
+	struct decomp_lzma *st = ctx->priv;
+
+	if (st) {
+		LzmaDec_FreeProbs(&st->dec, &decomp_lzma_allocator);
+		free(st);
+	}
+
+	return ctx->done ? 0 : -EINVAL;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(LZO)
+#define LZOP_MAGIC_LEN		9
+#define LZOP_HAS_FILTER		0x800
+#define LZOP_VERSION_LEVEL	0x940	/* versions with level and mtime_high */
+
+enum {
+	LZOP_HEADER,	/* magic, versions and method */
+	LZOP_FLAGS,	/* level and flags */
+	LZOP_FIELDS,	/* filter, mode, mtime and name length */
+	LZOP_NAME,	/* name and header checksum */
+	LZOP_BLOCK_DLEN,
+	LZOP_BLOCK_SLEN,
+	LZOP_BLOCK,
+};
+
+static int decomp_lzo_init(struct decomp_ctx *ctx)
+{
+	ctx->step = LZOP_HEADER;
+	ctx->need = LZOP_MAGIC_LEN + 7;
+
+	return 0;
+}
+
+static int decomp_lzo_feed(struct decomp_ctx *ctx, const u8 *in, size_t len)
+{
+	bool new_format;
+	size_t dlen;
+	const u8 *p;
+	int ret;
+
+	while (len) {
+		p = decomp_gather(ctx, &in, &len);
+		if (!p)
+			return ctx->err;
+
+		/* ctx->flags holds the version in the header, then dlen */
+		new_format = ctx->flags >= LZOP_VERSION_LEVEL;
+		switch (ctx->step) {
+		case LZOP_HEADER:
+			if (!lzop_is_valid_header(p))
+				return -EPROTONOSUPPORT;
+			ctx->flags = get_unaligned_be16(p + LZOP_MAGIC_LEN);
+			ctx->need = (ctx->flags >= LZOP_VERSION_LEVEL) + 4;
+			break;
+		case LZOP_FLAGS:
+			ctx->need = 8 + 1;
+			if (new_format)
+				ctx->need += 4;
+			if (get_unaligned_be32(p + new_format) &
+			    LZOP_HAS_FILTER)
+				ctx->need += 4;
+			break;
+		case LZOP_FIELDS:
+			/* skip the name and checksum */
+			ctx->need = p[ctx->need - 1] + 4;
+			break;
+		case LZOP_NAME:
+			break;
+		case LZOP_BLOCK_DLEN:
+			ctx->flags = get_unaligned_be32(p);
+			if (!ctx->flags) {
+				ctx->done = true;
+				return 0;
+			}
+			/* compressed size and checksum */
+			ctx->need = 8;
+			break;
+		case LZOP_BLOCK_SLEN:
+			ctx->need = get_unaligned_be32(p);
+			if (!ctx->need || ctx->need > ctx->flags)
+				return -EINVAL;
+			break;
+		case LZOP_BLOCK:
+			dlen = ctx->flags;
+			if (dlen > decomp_space(ctx))
+				return -ENOSPC;
+			if (dlen == ctx->need) {
+				memcpy(ctx->out + ctx->out_len, p, dlen);
+			} else {
+				ret = lzo1x_decompress_safe(p, ctx->need,
+							    ctx->out +
+							    ctx->out_len,
+							    &dlen);
+				if (ret != LZO_E_OK || dlen != ctx->flags)
+					return -EINVAL;
+			}
+			ctx->out_len += dlen;
+			break;
+		}
+		if (ctx->step == LZOP_NAME || ctx->step == LZOP_BLOCK) {
+			ctx->step = LZOP_BLOCK_DLEN;
+			ctx->need = 4;
+		} else {
+			ctx->step++;
+		}
+	}
+
+	return 0;
+}
+
+static int decomp_lzo_finish(struct decomp_ctx *ctx)
+{
+	return ctx->done ? 0 : -EINVAL;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(LZ4)
+#define LZ4F_BLOCKUNCOMPRESSED_FLAG	0x80000000U
+#define LZ4F_FLG_VERSION(flg)		(((flg) >> 6) & 3)
+#define LZ4F_FLG_INDEPENDENT		BIT(5)
+#define LZ4F_FLG_BLOCK_CHECKSUM		BIT(4)
+#define LZ4F_FLG_CONTENT_SIZE		BIT(3)
+#define LZ4F_BD_MAX_SIZE(bd)		(SZ_64K << (2 * ((((bd) >> 4) & 7) - 4)))
+#define LZ4_FLAG_UNCOMPRESSED		BIT(16)
+
+enum {
+	LZ4_HEADER,		/* magic, FLG and BD */
+	LZ4_HEADER_END,		/* content size and header checksum */
+	LZ4_BLOCK_SIZE,
+	LZ4_BLOCK,
+};
+
+static int decomp_lz4_init(struct decomp_ctx *ctx)
+{
+	ctx->step = LZ4_HEADER;
+	ctx->need = sizeof(u32) + 2;
+
+	return 0;
+}
+
+static int decomp_lz4_block(struct decomp_ctx *ctx, const u8 *p)
+{
+	size_t size = ctx->need;
+	int ret;
+
+	if (ctx->flags & LZ4F_FLG_BLOCK_CHECKSUM)
+		size -= sizeof(u32);
+	if (ctx->flags & LZ4_FLAG_UNCOMPRESSED)
+		return decomp_copy(ctx, p, size);
+
+	ret = LZ4_decompress_safe((const char *)p, ctx->out + ctx->out_len,
+				  size, min_t(size_t, decomp_space(ctx),
+					      INT_MAX));
+	if (ret < 0) {
+		/* a full-sized block may simply not fit */
+		if (decomp_space(ctx) < LZ4F_BD_MAX_SIZE(ctx->flags >> 8))
+			return -ENOSPC;
+		return -EINVAL;
+	}
+	ctx->out_len += ret;
+
+	return 0;
+}
+
+static int decomp_lz4_feed(struct decomp_ctx *ctx, const u8 *in, size_t len)
+{
+	u32 header, size;
+	const u8 *p;
+	int ret;
+
+	while (len) {
+		p = decomp_gather(ctx, &in, &len);
+		if (!p)
+			return ctx->err;
+
+		/*
+		 * ctx->flags holds FLG and BD from the header, plus whether the
+		 * current block is uncompressed
+		 */
+		switch (ctx->step) {
+		case LZ4_HEADER:
+			if (get_unaligned_le32(p) != LZ4F_MAGIC ||
+			    LZ4F_FLG_VERSION(p[4]) != 1)
+				return -EPROTONOSUPPORT;
+			if ((p[4] & 3) || (p[5] & 0x8f) || (p[5] >> 4) < 4)
+				return -EINVAL;
+			if (!(p[4] & LZ4F_FLG_INDEPENDENT))
+				return -EPROTONOSUPPORT;
+			ctx->flags = p[4] | p[5] << 8;
+			ctx->need = 1;
+			if (p[4] & LZ4F_FLG_CONTENT_SIZE)
+				ctx->need += sizeof(u64);
+			ctx->step = LZ4_HEADER_END;
+			break;
+		case LZ4_BLOCK:
+			ret = decomp_lz4_block(ctx, p);
+			if (ret)
+				return ret;
+			fallthrough;
+		case LZ4_HEADER_END:
+			ctx->need = sizeof(u32);
+			ctx->step = LZ4_BLOCK_SIZE;
+			break;
+		case LZ4_BLOCK_SIZE:
+			header = get_unaligned_le32(p);
+			size = header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
+			if (!size) {
+				ctx->done = true;
+				return 0;
+			}
+			if (size > LZ4F_BD_MAX_SIZE(ctx->flags >> 8))
+				return -EINVAL;
+			ctx->need = size;
+			if (ctx->flags & LZ4F_FLG_BLOCK_CHECKSUM)
+				ctx->need += sizeof(u32);
+			ctx->flags &= ~LZ4_FLAG_UNCOMPRESSED;
+			if (header & LZ4F_BLOCKUNCOMPRESSED_FLAG)
+				ctx->flags |= LZ4_FLAG_UNCOMPRESSED;
+			ctx->step = LZ4_BLOCK;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static int decomp_lz4_finish(struct decomp_ctx *ctx)
+{
+	return ctx->done ? 0 : -EINVAL;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(ZSTD)
+enum {
+	ZSTD_FRAME,		/* in a frame */
+	ZSTD_MAGIC,		/* between frames, checking for another */
+};
+
+/**
+ * struct decomp_zstd - State for decompressing zstd
+ *
+ * @dctx: Decompression context
+ * @out: Output buffer, which must not change between calls since the
+ *	decoder is told that it is stable and uses it as the window
+ */
+struct decomp_zstd {
+	ZSTD_DCtx *dctx;
+	zstd_out_buffer out;
+};
+
+static void *decomp_zstd_alloc(void *opaque, size_t size)
+{
+	return malloc(size);
+}
+
+static void decomp_zstd_free(void *opaque, void *address)
+{
+	free(address);
+}
+
+static int decomp_zstd_init(struct decomp_ctx *ctx)
+{
+	const ZSTD_customMem mem = {
+		.customAlloc	= decomp_zstd_alloc,
+		.customFree	= decomp_zstd_free,
+	};
+	struct decomp_zstd *st;
+	size_t ret;
+
+	st = calloc(1, sizeof(*st));
+	if (!st)
+		return -ENOMEM;
+	st->dctx = ZSTD_createDCtx_advanced(mem);
+	if (!st->dctx) {
+		free(st);
+		return -ENOMEM;
+	}
+
+	/* the output is never moved, so zstd can decode straight into it */
+	ret = ZSTD_DCtx_setParameter(st->dctx, ZSTD_d_stableOutBuffer, 1);
+	if (zstd_is_error(ret)) {
+		log_debug("zstd error %d\n", zstd_get_error_code(ret));
+		ZSTD_freeDCtx(st->dctx);
+		free(st);
+		return -EINVAL;
+	}
+	st->out.dst = ctx->out;
+	st->out.size = ctx->out_size;
+	ctx->priv = st;
+
+	return 0;
+}
+
+/**
+ * decomp_zstd_frame() - Decompress input within a frame
+ *
+ * @ctx: Context
+ * @in: Input
+ * @len: Length of input
+ * @usedp: Returns the number of bytes used, which is less than @len if the
+ *	frame ends first
+ * Return: 0 if OK, -ve on error
+ */
+static int decomp_zstd_frame(struct decomp_ctx *ctx, const u8 *in, size_t len,
+			     size_t *usedp)
+{
+	struct decomp_zstd *st = ctx->priv;
+	zstd_in_buffer inb = { .src = in, .size = len };
+	size_t ret, in_pos, out_pos;
+
+	while (inb.pos < inb.size) {
+		in_pos = inb.pos;
+		out_pos = st->out.pos;
+		ret = zstd_decompress_stream(st->dctx, &st->out, &inb);
+		ctx->out_len = st->out.pos;
+		if (zstd_is_error(ret)) {
+			log_debug("zstd error %d\n", zstd_get_error_code(ret));
+			if (zstd_get_error_code(ret) ==
+			    ZSTD_error_dstSize_tooSmall)
+				return -ENOSPC;
+			return -EINVAL;
+		}
+		if (!ret) {
+			ctx->step = ZSTD_MAGIC;
+			ctx->need = sizeof(u32);
+			break;
+		}
+		if (inb.pos == in_pos && st->out.pos == out_pos)
+			return decomp_space(ctx) ? -EINVAL : -ENOSPC;
+	}
+	*usedp = inb.pos;
+
+	return 0;
+}
+
+static int decomp_zstd_feed(struct decomp_ctx *ctx, const u8 *in, size_t len)
+{
+	size_t used;
+	int ret;
+
+	/*
+	 * Frames (including skippable ones, such as a seek table) are decoded
+	 * one after the other. Anything after the last frame is ignored.
+	 */
+	while (len) {
+		if (ctx->step == ZSTD_MAGIC) {
+			const u8 *magic = decomp_gather(ctx, &in, &len);
+			u32 val;
+
+			if (!magic)
+				return ctx->err;
+			val = get_unaligned_le32(magic);
+			if (val != ZSTD_MAGICNUMBER &&
+			    (val & ZSTD_MAGIC_SKIPPABLE_MASK) !=
+			    ZSTD_MAGIC_SKIPPABLE_START) {
+				ctx->done = true;
+				return 0;
+			}
+			ctx->step = ZSTD_FRAME;
+			ret = decomp_zstd_frame(ctx, magic, sizeof(u32), &used);
+		} else {
+			ret = decomp_zstd_frame(ctx, in, len, &used);
+			in += used;
+			len -= used;
+		}
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int decomp_zstd_finish(struct decomp_ctx *ctx)
+{
+	struct decomp_zstd *st = ctx->priv;
+
+	ZSTD_freeDCtx(st->dctx);
+	free(st);
+
+	return ctx->done || ctx->step == ZSTD_MAGIC ? 0 : -EINVAL;
+}
+#endif
+
+static const struct decomp_ops decomp_ops[] = {
+	{ IH_COMP_NONE, NULL, decomp_none_feed, NULL },
+#if CONFIG_IS_ENABLED(GZIP)
+	{ IH_COMP_GZIP, decomp_gzip_init, decomp_gzip_feed,
+	  decomp_gzip_finish },
+#endif
+#if CONFIG_IS_ENABLED(BZIP2)
+	{ IH_COMP_BZIP2, decomp_bzip2_init, decomp_bzip2_feed,
+	  decomp_bzip2_finish },
+#endif
+#if CONFIG_IS_ENABLED(LZMA)
+	{ IH_COMP_LZMA, decomp_lzma_init, decomp_lzma_feed,
+	  decomp_lzma_finish },
+#endif
+#if CONFIG_IS_ENABLED(LZO)
+	{ IH_COMP_LZO, decomp_lzo_init, decomp_lzo_feed, decomp_lzo_finish },
+#endif
+#if CONFIG_IS_ENABLED(LZ4)
+	{ IH_COMP_LZ4, decomp_lz4_init, decomp_lz4_feed, decomp_lz4_finish },
+#endif
+#if CONFIG_IS_ENABLED(ZSTD)
+	{ IH_COMP_ZSTD, decomp_zstd_init, decomp_zstd_feed,
+	  decomp_zstd_finish },
+#endif
+};
+
+static const struct decomp_ops *decomp_get_ops(int comp)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(decomp_ops); i++) {
+		if (decomp_ops[i].comp == comp)
+			return &decomp_ops[i];
+	}
+
+	return NULL;
+}
+
+int decomp_init(struct decomp_ctx *ctx, int comp, void *out, size_t out_size)
+{
+	const struct decomp_ops *ops = decomp_get_ops(comp);
+	int ret;
+
+	if (!ops)
+		return -ENOSYS;
+	memset(ctx, '\0', sizeof(*ctx));
+	ctx->comp = comp;
+	ctx->out = out;
+	ctx->out_size = out_size;
+	if (ops->init) {
+		ret = ops->init(ctx);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+int decomp_feed(struct decomp_ctx *ctx, const void *in, size_t len)
+{
+	const struct decomp_ops *ops = decomp_get_ops(ctx->comp);
+
+	if (ctx->err || ctx->done)
+		return ctx->err;
+	ctx->err = ops->feed(ctx, in, len);
+
+	return ctx->err;
+}
+
+int decomp_finish(struct decomp_ctx *ctx, size_t *out_lenp)
+{
+	const struct decomp_ops *ops = decomp_get_ops(ctx->comp);
+	int ret = 0;
+
+	if (ops->finish)
+		ret = ops->finish(ctx);
+	free(ctx->buf);
+	ctx->buf = NULL;
+	ctx->priv = NULL;
+	if (out_lenp)
+		*out_lenp = ctx->out_len;
+
+	return ctx->err ?: ret;
+}
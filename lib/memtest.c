@@ -0,0 +1,368 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Fast memory test
+ *
+ * Every pattern is a simple function of the word index, so each chunk of a
+ * pass can be checked and rewritten independently, on any CPU, with a loop
+ * which the compiler can unroll and vectorise. The patterns are the word
+ * index mixed with a seed, which finds address-decoding faults and stuck
+ * bits, then a checkerboard for coupling between adjacent bits, each followed
+ * by its inverse so that every bit is written with both 0 and 1.
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <cpu_func.h>
+#include <dma.h>
+#include <log.h>
+#include <malloc.h>
+#include <memtest.h>
+#include <time.h>
+#include <worker.h>
+#include <asm/cache.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/sizes.h>
+#include <u-boot/schedule.h>
+
+enum {
+	/* bytes handled by one job */
+	MEMTEST_CHUNK		= SZ_1M,
+
+	/* default bytes tested at once, much larger than any cache */
+	MEMTEST_WINDOW		= SZ_256M,
+};
+
+#define MEMTEST_MIX	((ulong)0x9e3779b97f4a7c15ULL)
+#define MEMTEST_CHECKER	((ulong)0x5555555555555555ULL)
+
+/**
+ * struct memtest_pat - A pattern, as a function of the word index
+ *
+ * The value of word @i is (@i * @mul) ^ -(@i & @alt) ^ @xor, so that
+ * address-based patterns and checkerboards need no branch in the inner loop
+ *
+ * @mul: Multiplier for the word index
+ * @alt: 1 to invert alternate words, else 0
+ * @xor: Value to XOR with the result
+ */
+struct memtest_pat {
+	ulong mul;
+	ulong alt;
+	ulong xor;
+};
+
+/**
+ * struct memtest_chunk - A chunk of a pass, run as a job
+ *
+ * @buf: Start of the chunk
+ * @count: Number of words in the chunk
+ * @base: Word index of @buf[0], used to work out the patterns
+ * @check: Pattern expected in the chunk, or NULL to skip checking
+ * @write: Pattern to write to the chunk, or NULL to skip writing
+ * @errors: Returns the number of words which did not match @check
+ * @err_idx: Returns the index in @buf of the first word which did not match
+ * @found: Returns the value of that word
+ * @expected: Returns the value which was expected
+ */
+struct memtest_chunk {
+	ulong *buf;
+	ulong count;
+	ulong base;
+	const struct memtest_pat *check;
+	const struct memtest_pat *write;
+	ulong errors;
+	ulong err_idx;
+	ulong found;
+	ulong expected;
+};
+
+static inline ulong memtest_val(const struct memtest_pat *pat, ulong idx)
+{
+	return idx * pat->mul ^ -(idx & pat->alt) ^ pat->xor;
+}
+
+static noinline void memtest_error(struct memtest_chunk *chunk, ulong i,
+				   ulong found, ulong expected)
+{
+	if (!chunk->errors++) {
+		chunk->err_idx = i;
+		chunk->found = found;
+		chunk->expected = expected;
+	}
+}
+
+/*
+ * The buffer is not volatile, so that the loops can be vectorised. Each word
+ * is read once and written once per pass, which the compiler cannot elide
+ * since the chunk is only reached through a pointer.
+ */
+static int memtest_chunk(void *arg)
+{
+	struct memtest_chunk *chunk = arg;
+	const struct memtest_pat *check = chunk->check;
+	const struct memtest_pat *write = chunk->write;
+	ulong *buf = chunk->buf;
+	ulong base = chunk->base;
+	ulong i, val, want;
+
+	chunk->errors = 0;
+	if (check && write) {
+		for (i = 0; i < chunk->count; i++) {
+			val = buf[i];
+			want = memtest_val(check, base + i);
+			if (unlikely(val != want))
+				memtest_error(chunk, i, val, want);
+			buf[i] = memtest_val(write, base + i);
+		}
+	} else if (check) {
+		for (i = 0; i < chunk->count; i++) {
+			val = buf[i];
+			want = memtest_val(check, base + i);
+			if (unlikely(val != want))
+				memtest_error(chunk, i, val, want);
+		}
+	} else if (write) {
+		for (i = 0; i < chunk->count; i++)
+			buf[i] = memtest_val(write, base + i);
+	}
+
+	return 0;
+}
+
+/**
+ * struct memtest_ctx - State of a test
+ *
+ * @opts: Options
+ * @res: Result
+ * @addr: Address of the start of the region
+ * @region: Start of the region
+ * @chunks: Chunks of the current window
+ * @jobs: Job for each chunk
+ * @num_chunks: Number of chunks in the current window
+ * @done: Bytes done so far, counting each pass separately
+ * @total: Total bytes to do, counting each pass separately
+ */
+struct memtest_ctx {
+	const struct memtest_opts *opts;
+	struct memtest_result *res;
+	ulong addr;
+	ulong *region;
+	struct memtest_chunk *chunks;
+	struct worker_job *jobs;
+	int num_chunks;
+	u64 done;
+	u64 total;
+};
+
+/**
+ * memtest_flush() - Flush the window from the cache
+ *
+ * This makes sure that the next pass reads from DRAM, not the cache
+ *
+ * @ctx: Test context
+ * @bytes: Size of the window in bytes
+ */
+static void memtest_flush(struct memtest_ctx *ctx, ulong bytes)
+{
+	ulong start = (ulong)ctx->chunks[0].buf;
+
+	flush_dcache_range(ALIGN_DOWN(start, ARCH_DMA_MINALIGN),
+			   ALIGN(start + bytes, ARCH_DMA_MINALIGN));
+}
+
+/**
+ * memtest_pass() - Check and / or write every chunk of the window
+ *
+ * @ctx: Test context
+ * @check: Pattern to check, or NULL
+ * @write: Pattern to write, or NULL
+ * @per_chunk: true if the patterns start again in each chunk, false if they
+ *	follow the word index in the region
+ * Return: 0 if OK, -EINTR if the progress function asked to stop
+ */
+static int memtest_pass(struct memtest_ctx *ctx,
+			const struct memtest_pat *check,
+			const struct memtest_pat *write, bool per_chunk)
+{
+	struct memtest_result *res = ctx->res;
+	ulong bytes = 0;
+	int i;
+
+	for (i = 0; i < ctx->num_chunks; i++) {
+		struct memtest_chunk *chunk = &ctx->chunks[i];
+
+		chunk->check = check;
+		chunk->write = write;
+		chunk->base = per_chunk ? 0 : chunk->buf - ctx->region;
+		bytes += chunk->count * sizeof(ulong);
+	}
+	worker_run(ctx->jobs, ctx->num_chunks);
+
+	for (i = 0; i < ctx->num_chunks; i++) {
+		struct memtest_chunk *chunk = &ctx->chunks[i];
+
+		if (!chunk->errors)
+			continue;
+		if (!res->errors) {
+			res->addr = ctx->addr + (chunk->buf + chunk->err_idx -
+						 ctx->region) * sizeof(ulong);
+			res->found = chunk->found;
+			res->expected = chunk->expected;
+		}
+		res->errors += chunk->errors;
+	}
+
+	if (write)
+		memtest_flush(ctx, bytes);
+
+	schedule();
+	ctx->done += bytes;
+	if (ctx->opts->progress)
+		return ctx->opts->progress(ctx->opts->priv, ctx->done,
+					   ctx->total);
+
+	return 0;
+}
+
+/**
+ * memtest_dma() - Write the window with a DMA engine and check it
+ *
+ * The first chunk is written by the CPU and copied to the others, using DMA
+ * where possible
+ *
+ * @ctx: Test context
+ * @pat: Pattern to use
+ * Return: 0 if OK, -EINTR if the progress function asked to stop
+ */
+static int memtest_dma(struct memtest_ctx *ctx, const struct memtest_pat *pat)
+{
+	struct memtest_chunk *first = &ctx->chunks[0];
+	ulong bytes = first->count * sizeof(ulong);
+	int i;
+
+	first->check = NULL;
+	first->write = pat;
+	first->base = 0;
+	memtest_chunk(first);
+	for (i = 1; i < ctx->num_chunks; i++) {
+		struct memtest_chunk *chunk = &ctx->chunks[i];
+		ulong len = chunk->count * sizeof(ulong);
+
+		if (dma_bulk_copy(chunk->buf, first->buf, len))
+			memcpy(chunk->buf, first->buf, len);
+		bytes += len;
+	}
+	memtest_flush(ctx, bytes);
+	ctx->done += bytes;
+
+	return memtest_pass(ctx, pat, NULL, true);
+}
+
+/**
+ * memtest_window() - Run all the passes over a window
+ *
+ * @ctx: Test context
+ * @buf: Start of the window
+ * @count: Number of words in the window
+ * Return: 0 if OK, -EINTR if the progress function asked to stop
+ */
+static int memtest_window(struct memtest_ctx *ctx, ulong *buf, ulong count)
+{
+	const struct memtest_opts *opts = ctx->opts;
+	const ulong words = MEMTEST_CHUNK / sizeof(ulong);
+	struct memtest_pat pats[] = {
+		{ MEMTEST_MIX, 0, opts->seed },
+		{ MEMTEST_MIX, 0, ~opts->seed },
+		{ 0, 1, MEMTEST_CHECKER },
+		{ 0, 1, ~MEMTEST_CHECKER },
+	};
+	struct memtest_pat dma_pat = {
+		MEMTEST_MIX, 0, opts->seed ^ MEMTEST_CHECKER
+	};
+	int i, ret;
+
+	for (i = 0; count; i++) {
+		struct memtest_chunk *chunk = &ctx->chunks[i];
+
+		chunk->buf = buf;
+		chunk->count = min(count, words);
+		buf += chunk->count;
+		count -= chunk->count;
+	}
+	ctx->num_chunks = i;
+
+	/* each pass checks the previous pattern and writes the next one */
+	for (i = 0; i <= ARRAY_SIZE(pats); i++) {
+		ret = memtest_pass(ctx, i ? &pats[i - 1] : NULL,
+				   i < ARRAY_SIZE(pats) ? &pats[i] : NULL,
+				   false);
+		if (ret)
+			return ret;
+	}
+	if (opts->flags & MEMTEST_F_DMA) {
+		ret = memtest_dma(ctx, &dma_pat);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+int memtest_run(void *buf, ulong addr, ulong size,
+		const struct memtest_opts *opts, struct memtest_result *res)
+{
+	ulong window = opts->window ?: MEMTEST_WINDOW;
+	ulong start = get_timer(0), pos;
+	struct memtest_ctx ctx;
+	int i, max_chunks;
+	int ret = 0;
+
+	memset(res, '\0', sizeof(*res));
+	res->passes = 5 + (opts->flags & MEMTEST_F_DMA ? 2 : 0);
+	size = ALIGN_DOWN(size, sizeof(ulong));
+	window = max(ALIGN_DOWN(min(window, size), sizeof(ulong)),
+		     sizeof(ulong));
+	max_chunks = DIV_ROUND_UP(window, MEMTEST_CHUNK);
+
+	memset(&ctx, '\0', sizeof(ctx));
+	ctx.opts = opts;
+	ctx.res = res;
+	ctx.addr = addr;
+	ctx.region = buf;
+	ctx.total = (u64)size * res->passes;
+	ctx.chunks = calloc(max_chunks, sizeof(*ctx.chunks));
+	ctx.jobs = calloc(max_chunks, sizeof(*ctx.jobs));
+	if (!ctx.chunks || !ctx.jobs) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	for (i = 0; i < max_chunks; i++) {
+		ctx.jobs[i].func = memtest_chunk;
+		ctx.jobs[i].arg = &ctx.chunks[i];
+	}
+
+	for (pos = 0; pos < size; pos += window) {
+		ulong len = min(window, size - pos);
+
+		if (pos && opts->limit_ms && get_timer(start) >= opts->limit_ms) {
+			ret = -ETIMEDOUT;
+			break;
+		}
+		ret = memtest_window(&ctx, buf + pos, len / sizeof(ulong));
+		if (ret)
+			break;
+		res->tested += len;
+	}
+	res->time_ms = get_timer(start);
+	log_debug("tested %lx bytes in %ld ms, %ld errors\n", res->tested,
+		  res->time_ms, res->errors);
+
+out:
+	free(ctx.jobs);
+	free(ctx.chunks);
+	if (res->errors)
+		return -EIO;
+
+	return ret;
+}
@@ -25,6 +25,8 @@ static void panic_finish(void)
 {
 	putc('\n');
 #if defined(CONFIG_PANIC_HANG)
+	flush();  /* flush the panic message before hanging */
+
 	hang();
 #elif defined(CONFIG_PANIC_POWEROFF)
 	flush();  /* flush the panic message before power off */
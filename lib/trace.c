@@ -13,6 +13,13 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Sampling frequency, or 0 if the sampling profiler is not enabled */
+#ifdef CONFIG_TRACE_SAMPLE
+#define TRACE_SAMPLE_HZ		CONFIG_TRACE_SAMPLE_HZ
+#else
+#define TRACE_SAMPLE_HZ		0
+#endif
+
 static char trace_enabled __section(".data");
 static char trace_inited __section(".data");
 
@@ -40,15 +47,21 @@ struct trace_hdr {
 	int max_depth;		/* Maximum depth seen so far */
 	int min_depth;		/* Minimum depth seen so far */
 	bool trace_locked;	/* Used to detect recursive tracing */
+
+	/* Statistical samples */
+	struct trace_sample *samples;	/* The sample records */
+	ulong sample_size;	/* Num. of sample records we have space for */
+	ulong sample_count;	/* Num. of samples taken */
+	ulong sample_untracked_count;	/* Samples entirely outside U-Boot */
 };
 
 /* Pointer to start of trace buffer */
 static struct trace_hdr *hdr __section(".data");
 
 static inline uintptr_t __attribute__((no_instrument_function))
-		func_ptr_to_num(void *func_ptr)
+		code_offset(uintptr_t addr)
 {
-	uintptr_t offset = (uintptr_t)func_ptr;
+	uintptr_t offset = addr;
 
 #ifdef CONFIG_SANDBOX
 	offset -= (uintptr_t)_init;
@@ -58,7 +71,13 @@ static inline uintptr_t __attribute__((no_instrument_function))
 	else
 		offset -= CONFIG_TEXT_BASE;
 #endif
-	return offset / FUNC_SITE_SIZE;
+	return offset;
+}
+
+static inline uintptr_t __attribute__((no_instrument_function))
+		func_ptr_to_num(void *func_ptr)
+{
+	return code_offset((uintptr_t)func_ptr) / FUNC_SITE_SIZE;
 }
 
 #if defined(CONFIG_EFI_LOADER) && (defined(CONFIG_ARM) || defined(CONFIG_RISCV))
@@ -177,6 +196,76 @@ void notrace __cyg_profile_func_exit(void *func_ptr, void *caller)
 	}
 }
 
+/**
+ * trace_add_sample() - record a statistical sample
+ *
+ * This is called from the sampling timer, so must not use anything that is
+ * itself traced. Addresses outside the U-Boot image (e.g. in the host C
+ * library on sandbox) are skipped, so the innermost recorded frame is the
+ * innermost U-Boot function.
+ *
+ * @pcs:	code addresses making up the call stack, innermost first
+ * @count:	number of addresses in @pcs
+ */
+void notrace trace_add_sample(const ulong *pcs, int count)
+{
+	struct trace_sample *rec;
+	int i, depth;
+
+	if (!trace_enabled || !hdr->sample_size)
+		return;
+	if (hdr->sample_count >= hdr->sample_size) {
+		hdr->sample_count++;
+		return;
+	}
+
+	trace_swap_gd();
+	rec = &hdr->samples[hdr->sample_count];
+	for (i = depth = 0; i < count && depth < TRACE_SAMPLE_DEPTH; i++) {
+		uintptr_t offset = code_offset(pcs[i]);
+
+		if (offset < gd->mon_len)
+			rec->pc[depth++] = offset;
+	}
+	if (depth) {
+		rec->depth = depth;
+		rec->timestamp = timer_get_us();
+		hdr->sample_count++;
+	} else {
+		hdr->sample_untracked_count++;
+	}
+	trace_swap_gd();
+}
+
+int __weak notrace arch_trace_sample_start(uint hz)
+{
+	return -ENOSYS;
+}
+
+void __weak notrace arch_trace_sample_stop(void)
+{
+}
+
+/**
+ * trace_sample_enable() - start or stop the sampling timer
+ *
+ * @enable:	true to start sampling, false to stop
+ */
+static void notrace trace_sample_enable(bool enable)
+{
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_TRACE_SAMPLE) || !trace_inited)
+		return;
+	if (!enable) {
+		arch_trace_sample_stop();
+		return;
+	}
+	ret = arch_trace_sample_start(TRACE_SAMPLE_HZ);
+	if (ret)
+		printf("trace: cannot start sampling (err=%d)\n", ret);
+}
+
 /**
  * trace_list_functions() - produce a list of called functions
  *
@@ -294,6 +383,61 @@ int trace_list_calls(void *buff, size_t buff_size, size_t *needed)
 	return 0;
 }
 
+/**
+ * trace_list_samples() - produce a list of statistical samples
+ *
+ * The information is written into the supplied buffer - a header followed
+ * by a list of sample records.
+ *
+ * @buff:	buffer to place list into
+ * @buff_size:	size of buffer
+ * @needed:	returns size of buffer needed, which may be
+ *		greater than buff_size if we ran out of space.
+ * Return:	0 if ok, -ENOSPC if space was exhausted
+ */
+int trace_list_samples(void *buff, size_t buff_size, size_t *needed)
+{
+	struct trace_output_hdr *output_hdr = NULL;
+	void *end, *ptr = buff;
+	size_t rec, upto;
+	size_t count;
+
+	end = buff ? buff + buff_size : NULL;
+
+	/* Place some header information */
+	if (ptr + sizeof(struct trace_output_hdr) < end)
+		output_hdr = ptr;
+	ptr += sizeof(struct trace_output_hdr);
+
+	/* Add each sample */
+	count = min(hdr->sample_count, hdr->sample_size);
+	for (rec = upto = 0; rec < count; rec++) {
+		if (ptr + sizeof(struct trace_sample) < end) {
+			memcpy(ptr, &hdr->samples[rec],
+			       sizeof(struct trace_sample));
+			upto++;
+		}
+		ptr += sizeof(struct trace_sample);
+	}
+
+	/* Update the header */
+	if (output_hdr) {
+		memset(output_hdr, '\0', sizeof(*output_hdr));
+		output_hdr->rec_count = upto;
+		output_hdr->type = TRACE_CHUNK_SAMPLES;
+		output_hdr->version = TRACE_VERSION;
+		output_hdr->spare = TRACE_SAMPLE_HZ ? 1000000 / TRACE_SAMPLE_HZ : 0;
+		output_hdr->text_base = CONFIG_TEXT_BASE;
+	}
+
+	/* Work out how must of the buffer we used */
+	*needed = ptr - buff;
+	if (ptr > end)
+		return -ENOSPC;
+
+	return 0;
+}
+
 /**
  * trace_print_stats() - print basic information about tracing
  */
@@ -302,8 +446,10 @@ void trace_print_stats(void)
 	ulong count;
 
 #ifndef FTRACE
-	puts("Warning: make U-Boot with FTRACE to enable function instrumenting.\n");
-	puts("You will likely get zeroed data here\n");
+	if (!IS_ENABLED(CONFIG_TRACE_SAMPLE)) {
+		puts("Warning: make U-Boot with FTRACE to enable function instrumenting.\n");
+		puts("You will likely get zeroed data here\n");
+	}
 #endif
 	if (!trace_inited) {
 		printf("Trace is disabled\n");
@@ -331,6 +477,18 @@ void trace_print_stats(void)
 	puts(" calls not traced due to depth\n");
 	print_grouped_ull(hdr->ftrace_size, 10);
 	puts(" max function calls\n");
+	if (IS_ENABLED(CONFIG_TRACE_SAMPLE)) {
+		count = min(hdr->sample_count, hdr->sample_size);
+		print_grouped_ull(count, 10);
+		puts(" samples taken");
+		if (hdr->sample_count > hdr->sample_size) {
+			printf(" (%lu dropped due to overflow)",
+			       hdr->sample_count - hdr->sample_size);
+		}
+		puts("\n");
+		print_grouped_ull(hdr->sample_untracked_count, 10);
+		puts(" samples outside U-Boot\n");
+	}
 	printf("\ntrace buffer %lx call records %lx\n",
 	       (ulong)map_to_sysmem(hdr), (ulong)map_to_sysmem(hdr->ftrace));
 }
@@ -338,6 +496,26 @@ void trace_print_stats(void)
 void notrace trace_set_enabled(int enabled)
 {
 	trace_enabled = enabled != 0;
+	trace_sample_enable(trace_enabled);
+}
+
+/**
+ * sample_space() - work out how much of the trace buffer to use for samples
+ *
+ * @avail:	bytes available after the function-call counts
+ * Return:	number of bytes to use for samples
+ */
+static size_t notrace sample_space(size_t avail)
+{
+	if (!IS_ENABLED(CONFIG_TRACE_SAMPLE))
+		return 0;
+#ifdef FTRACE
+	/* Share the space with the function-call records */
+	return avail / 2;
+#else
+	/* Without instrumentation there are no call records */
+	return avail;
+#endif
 }
 
 static int get_func_count(void)
@@ -355,7 +533,7 @@ static int notrace trace_init_(void *buff, size_t buff_size, bool copy_early,
 			       bool enable)
 {
 	int func_count = get_func_count();
-	size_t needed;
+	size_t needed, sample_bytes;
 	int was_disabled = !trace_enabled;
 
 	if (func_count < 0)
@@ -405,14 +583,22 @@ static int notrace trace_init_(void *buff, size_t buff_size, bool copy_early,
 	hdr->func_count = func_count;
 	hdr->call_accum = (uintptr_t *)(hdr + 1);
 
-	/* Use any remaining space for the timed function trace */
+	/* Use any remaining space for samples and the timed function trace */
+	sample_bytes = sample_space(buff_size - needed);
+	hdr->samples = (struct trace_sample *)(buff + buff_size -
+					       sample_bytes);
+	hdr->sample_size = sample_bytes / sizeof(*hdr->samples);
+	hdr->sample_count = 0;
+	hdr->sample_untracked_count = 0;
 	hdr->ftrace = (struct trace_call *)(buff + needed);
-	hdr->ftrace_size = (buff_size - needed) / sizeof(*hdr->ftrace);
+	hdr->ftrace_size = (buff_size - needed - sample_bytes) /
+		sizeof(*hdr->ftrace);
 	hdr->depth_limit = CONFIG_TRACE_CALL_DEPTH_LIMIT;
 
 	printf("trace: initialized, %senabled\n", enable ? "" : "not ");
 	trace_enabled = enable;
 	trace_inited = 1;
+	trace_sample_enable(enable);
 
 	return 0;
 }
@@ -440,7 +626,7 @@ int notrace trace_wipe(void)
 	bool was_enabled = trace_enabled;
 
 	if (trace_enabled)
-		trace_enabled = 0;
+		trace_set_enabled(0);
 	return trace_init_(gd->trace_buff, CONFIG_TRACE_BUFFER_SIZE,
 			   false, was_enabled);
 }
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Running independent jobs on secondary CPUs
+ *
+ * Only the boot CPU submits work, one batch at a time. Each batch has a
+ * generation number; workers spin until it changes, then claim jobs under a
+ * small lock until none are left. The lock is only held to claim a job, so
+ * it is not contended for any useful job size.
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <event.h>
+#include <log.h>
+#include <time.h>
+#include <worker.h>
+#include <u-boot/schedule.h>
+#include <linux/errno.h>
+
+enum {
+	/* ms to wait for the workers to check in / park */
+	WORKER_TIMEOUT_MS	= 1000,
+};
+
+/**
+ * struct worker_pool - State of the worker pool
+ *
+ * @lock: Protects @jobs, @count, @next and @gen
+ * @jobs: Current batch of jobs
+ * @count: Number of jobs in @jobs
+ * @next: Next job to be claimed
+ * @done: Number of jobs in the batch which have finished
+ * @gen: Generation number of the batch, incremented for each batch
+ * @park: true to ask the workers to return from worker_main()
+ * @running: Number of workers in worker_main()
+ * @started: Number of CPUs started by arch_worker_start(), or 0 if the pool
+ *	is not running
+ */
+struct worker_pool {
+	int lock;
+	struct worker_job *jobs;
+	int count;
+	int next;
+	int done;
+	uint gen;
+	bool park;
+	int running;
+	int started;
+};
+
+static struct worker_pool pool;
+
+__weak int arch_worker_start(void)
+{
+	return 0;
+}
+
+__weak void arch_worker_park(void)
+{
+}
+
+__weak void arch_worker_idle(void)
+{
+}
+
+static void worker_lock(void)
+{
+	while (__atomic_exchange_n(&pool.lock, 1, __ATOMIC_ACQUIRE))
+		arch_worker_idle();
+}
+
+static void worker_unlock(void)
+{
+	__atomic_store_n(&pool.lock, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * worker_take_jobs() - Run jobs from a batch until there are none left
+ *
+ * @gen: Generation number of the batch; nothing is claimed once the batch
+ *	changes
+ */
+static void worker_take_jobs(uint gen)
+{
+	while (true) {
+		struct worker_job *job = NULL;
+
+		worker_lock();
+		if (pool.gen == gen && pool.next < pool.count)
+			job = &pool.jobs[pool.next++];
+		worker_unlock();
+		if (!job)
+			break;
+
+		job->ret = job->func(job->arg);
+		__atomic_fetch_add(&pool.done, 1, __ATOMIC_RELEASE);
+	}
+}
+
+void worker_main(void)
+{
+	uint gen;
+
+	__atomic_fetch_add(&pool.running, 1, __ATOMIC_ACQ_REL);
+	gen = __atomic_load_n(&pool.gen, __ATOMIC_ACQUIRE);
+	while (!__atomic_load_n(&pool.park, __ATOMIC_ACQUIRE)) {
+		uint latest = __atomic_load_n(&pool.gen, __ATOMIC_ACQUIRE);
+
+		if (latest == gen) {
+			arch_worker_idle();
+			continue;
+		}
+		gen = latest;
+		worker_take_jobs(gen);
+	}
+	__atomic_fetch_sub(&pool.running, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * worker_wait_running() - Wait for the number of running workers to settle
+ *
+ * @want: Number of workers wanted
+ * Return: true if @want was reached, false on timeout
+ */
+static bool worker_wait_running(int want)
+{
+	ulong start = get_timer(0);
+
+	while (__atomic_load_n(&pool.running, __ATOMIC_ACQUIRE) != want) {
+		if (get_timer(start) > WORKER_TIMEOUT_MS)
+			return false;
+		schedule();
+	}
+
+	return true;
+}
+
+int worker_start(void)
+{
+	int ret;
+
+	if (pool.started)
+		return __atomic_load_n(&pool.running, __ATOMIC_ACQUIRE);
+
+	__atomic_store_n(&pool.park, false, __ATOMIC_RELEASE);
+	ret = arch_worker_start();
+	if (ret <= 0) {
+		if (ret)
+			log_warning("Cannot start workers (err=%dE)\n", ret);
+		return 0;
+	}
+	pool.started = ret;
+	if (!worker_wait_running(ret))
+		log_warning("Only %d of %d workers started\n",
+			    __atomic_load_n(&pool.running, __ATOMIC_ACQUIRE),
+			    ret);
+	log_debug("%d workers\n", ret);
+
+	return __atomic_load_n(&pool.running, __ATOMIC_ACQUIRE);
+}
+
+int worker_run(struct worker_job *jobs, int count)
+{
+	uint gen;
+	int i;
+
+	worker_start();
+
+	worker_lock();
+	pool.jobs = jobs;
+	pool.count = count;
+	pool.next = 0;
+	__atomic_store_n(&pool.done, 0, __ATOMIC_RELAXED);
+	gen = pool.gen + 1;
+	__atomic_store_n(&pool.gen, gen, __ATOMIC_RELEASE);
+	worker_unlock();
+
+	/* do our share, then wait for the jobs still running elsewhere */
+	worker_take_jobs(gen);
+	while (__atomic_load_n(&pool.done, __ATOMIC_ACQUIRE) < count)
+		schedule();
+
+	for (i = 0; i < count; i++) {
+		if (jobs[i].ret)
+			return jobs[i].ret;
+	}
+
+	return 0;
+}
+
+void worker_park(void)
+{
+	if (!pool.started)
+		return;
+
+	__atomic_store_n(&pool.park, true, __ATOMIC_RELEASE);
+
+	/*
+	 * Leave the pool marked as started, since finishing the park would
+	 * wait for a worker which is still running, e.g. joining its thread
+	 */
+	if (!worker_wait_running(0)) {
+		log_err("Workers did not stop\n");
+		return;
+	}
+	arch_worker_park();
+	pool.started = 0;
+}
+
+static int worker_bootm_final(void)
+{
+	worker_park();
+
+	return 0;
+}
+EVENT_SPY_SIMPLE(EVT_BOOTM_FINAL, worker_bootm_final);
@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Decompressing zstd data in the seekable format
+ *
+ * The seekable format is a series of independent zstd frames followed by a
+ * skippable frame holding a seek table: the compressed and decompressed size
+ * of each frame, then a footer. Any range of the data can be decompressed
+ * without starting from the beginning, and the frames can be decompressed in
+ * parallel, each on its own CPU. A normal zstd decoder just decodes the
+ * frames one after the other and skips the table.
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <abuf.h>
+#include <log.h>
+#include <malloc.h>
+#include <worker.h>
+#include <asm/unaligned.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/zstd.h>
+
+/* Seek table: skippable-frame header, entries, then the footer */
+#define SEEK_TABLE_MAGIC	(ZSTD_MAGIC_SKIPPABLE_START | 0xe)
+#define SEEK_FOOTER_MAGIC	0x8f92eab1
+#define SEEK_HEADER_SIZE	8
+#define SEEK_FOOTER_SIZE	9
+#define SEEK_DESC_CHECKSUM	BIT(7)
+#define SEEK_DESC_RESERVED	0x7c
+
+int zstd_seek_table_read(struct abuf *in, struct zstd_seek_table *tab)
+{
+	const u8 *buf = abuf_data(in), *footer, *entry;
+	size_t size = abuf_size(in);
+	ulong comp_offset, offset;
+	uint entry_size, count;
+	size_t table_size;
+	int i;
+
+	memset(tab, '\0', sizeof(*tab));
+	if (size < SEEK_HEADER_SIZE + SEEK_FOOTER_SIZE)
+		return -ENOENT;
+	footer = buf + size - SEEK_FOOTER_SIZE;
+	if (get_unaligned_le32(footer + 5) != SEEK_FOOTER_MAGIC)
+		return -ENOENT;
+	if (footer[4] & SEEK_DESC_RESERVED)
+		return log_msg_ret("desc", -EINVAL);
+
+	count = get_unaligned_le32(footer);
+	entry_size = footer[4] & SEEK_DESC_CHECKSUM ? 12 : 8;
+	table_size = SEEK_HEADER_SIZE + (size_t)count * entry_size +
+		SEEK_FOOTER_SIZE;
+	if (!count || table_size > size)
+		return log_msg_ret("cnt", -EINVAL);
+	entry = buf + size - table_size;
+	if (get_unaligned_le32(entry) != SEEK_TABLE_MAGIC ||
+	    get_unaligned_le32(entry + 4) != table_size - SEEK_HEADER_SIZE)
+		return log_msg_ret("hdr", -EINVAL);
+	entry += SEEK_HEADER_SIZE;
+
+	tab->frames = calloc(count, sizeof(struct zstd_seek_frame));
+	if (!tab->frames)
+		return log_msg_ret("tab", -ENOMEM);
+	comp_offset = 0;
+	offset = 0;
+	for (i = 0; i < count; i++, entry += entry_size) {
+		struct zstd_seek_frame *frame = &tab->frames[i];
+
+		frame->comp_offset = comp_offset;
+		frame->comp_size = get_unaligned_le32(entry);
+		frame->offset = offset;
+		frame->size = get_unaligned_le32(entry + 4);
+		comp_offset += frame->comp_size;
+		offset += frame->size;
+	}
+
+	/* the frames must exactly fill the space before the table */
+	if (comp_offset != size - table_size) {
+		zstd_seek_table_free(tab);
+		return log_msg_ret("siz", -EINVAL);
+	}
+	tab->count = count;
+	tab->size = offset;
+
+	return 0;
+}
+
+void zstd_seek_table_free(struct zstd_seek_table *tab)
+{
+	free(tab->frames);
+	tab->frames = NULL;
+	tab->count = 0;
+}
+
+/**
+ * struct zstd_seek_state - Shared state while decompressing a range
+ *
+ * @in: Compressed data
+ * @tab: Seek table
+ * @start: Offset of the start of the range in the decompressed data
+ * @end: Offset of the end of the range in the decompressed data
+ * @out: Output buffer, which holds the range
+ * @next: Next frame to decompress, claimed atomically by the jobs
+ * @first: First frame in the range
+ * @last: Last frame in the range
+ * @bounce: Buffers for the first and last frames, if they are only partly in
+ *	the range, else NULL
+ */
+struct zstd_seek_state {
+	const u8 *in;
+	const struct zstd_seek_table *tab;
+	ulong start;
+	ulong end;
+	u8 *out;
+	int next;
+	int first;
+	int last;
+	u8 *bounce[2];
+};
+
+/**
+ * struct zstd_seek_job - A job which decompresses frames, one at a time
+ *
+ * @state: Shared state
+ * @workspace: Workspace for @dctx
+ * @dctx: Decompression context, used only by this job
+ */
+struct zstd_seek_job {
+	struct zstd_seek_state *state;
+	void *workspace;
+	zstd_dctx *dctx;
+};
+
+static int zstd_seek_frame(struct zstd_seek_job *job, int i)
+{
+	struct zstd_seek_state *st = job->state;
+	const struct zstd_seek_frame *frame = &st->tab->frames[i];
+	ulong start = max(frame->offset, st->start);
+	ulong end = min(frame->offset + frame->size, st->end);
+	u8 *dst = st->out + frame->offset - st->start;
+	size_t len;
+
+	if (i == st->first && st->bounce[0])
+		dst = st->bounce[0];
+	else if (i == st->last && st->bounce[1])
+		dst = st->bounce[1];
+
+	len = zstd_decompress_dctx(job->dctx, dst, frame->size,
+				   st->in + frame->comp_offset,
+				   frame->comp_size);
+	if (zstd_is_error(len) || len != frame->size)
+		return -EINVAL;
+	if (dst == st->bounce[0] || dst == st->bounce[1])
+		memcpy(st->out + start - st->start,
+		       dst + start - frame->offset, end - start);
+
+	return 0;
+}
+
+static int zstd_seek_job(void *arg)
+{
+	struct zstd_seek_job *job = arg;
+	struct zstd_seek_state *st = job->state;
+	int i, ret;
+
+	while (true) {
+		i = __atomic_fetch_add(&st->next, 1, __ATOMIC_RELAXED);
+		if (i > st->last)
+			return 0;
+		ret = zstd_seek_frame(job, i);
+		if (ret)
+			return ret;
+	}
+}
+
+/**
+ * zstd_seek_bounce() - Allocate a bounce buffer if a frame is partly in range
+ *
+ * @st: State
+ * @i: Frame number
+ * @bouncep: Returns the buffer, or NULL if not needed
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+static int zstd_seek_bounce(struct zstd_seek_state *st, int i, u8 **bouncep)
+{
+	const struct zstd_seek_frame *frame = &st->tab->frames[i];
+
+	*bouncep = NULL;
+	if (frame->offset >= st->start &&
+	    frame->offset + frame->size <= st->end)
+		return 0;
+	*bouncep = malloc(frame->size);
+
+	return *bouncep ? 0 : -ENOMEM;
+}
+
+int zstd_seekable_read(struct abuf *in, const struct zstd_seek_table *tab,
+		       ulong offset, struct abuf *out)
+{
+	struct zstd_seek_state st = {};
+	struct zstd_seek_job *jobs;
+	struct worker_job *wjobs;
+	size_t wsize;
+	int i, count, ret;
+
+	if (offset > tab->size)
+		return -EINVAL;
+	st.in = abuf_data(in);
+	st.tab = tab;
+	st.start = offset;
+	st.end = offset + min(abuf_size(out), tab->size - offset);
+	st.out = abuf_data(out);
+	if (st.end == st.start)
+		return 0;
+
+	/* find the frames holding the range, skipping empty ones */
+	for (st.first = 0; st.first < tab->count; st.first++) {
+		const struct zstd_seek_frame *frame = &tab->frames[st.first];
+
+		if (frame->offset + frame->size > st.start)
+			break;
+	}
+	for (st.last = st.first; st.last < tab->count - 1; st.last++) {
+		if (tab->frames[st.last + 1].offset >= st.end)
+			break;
+	}
+	st.next = st.first;
+
+	ret = zstd_seek_bounce(&st, st.first, &st.bounce[0]);
+	if (!ret && st.last != st.first)
+		ret = zstd_seek_bounce(&st, st.last, &st.bounce[1]);
+	if (ret)
+		goto err_bounce;
+
+	/* one job per CPU, each with its own context, as jobs cannot malloc() */
+	count = min(worker_start() + 1, st.last - st.first + 1);
+	jobs = calloc(count, sizeof(*jobs));
+	wjobs = calloc(count, sizeof(*wjobs));
+	if (!jobs || !wjobs) {
+		ret = -ENOMEM;
+		goto err_jobs;
+	}
+	wsize = zstd_dctx_workspace_bound();
+	for (i = 0; i < count; i++) {
+		jobs[i].state = &st;
+		jobs[i].workspace = malloc(wsize);
+		if (jobs[i].workspace)
+			jobs[i].dctx = zstd_init_dctx(jobs[i].workspace, wsize);
+		if (!jobs[i].dctx) {
+			/* fewer jobs is fine, but at least one is needed */
+			free(jobs[i].workspace);
+			if (!i) {
+				ret = -ENOMEM;
+				goto err_jobs;
+			}
+			count = i;
+			break;
+		}
+		wjobs[i].func = zstd_seek_job;
+		wjobs[i].arg = &jobs[i];
+	}
+	log_debug("frames %d-%d, %d jobs\n", st.first, st.last, count);
+
+	ret = worker_run(wjobs, count);
+	for (i = 0; i < count; i++)
+		free(jobs[i].workspace);
+	if (!ret)
+		ret = st.end - st.start;
+
+err_jobs:
+	free(wjobs);
+	free(jobs);
+err_bounce:
+	free(st.bounce[1]);
+	free(st.bounce[0]);
+
+	return ret;
+}
+
+int zstd_decompress_seekable(struct abuf *in, struct abuf *out)
+{
+	struct zstd_seek_table tab;
+	int ret;
+
+	ret = zstd_seek_table_read(in, &tab);
+	if (ret)
+		return ret;
+	if (tab.size > abuf_size(out))
+		ret = -ENOSPC;
+	else
+		ret = zstd_seekable_read(in, &tab, 0, out);
+	zstd_seek_table_free(&tab);
+
+	return ret;
+}
@@ -12,6 +12,7 @@
 #include <bootflow.h>
 #include <mapmem.h>
 #include <os.h>
+#include <usb.h>
 #include <test/ut.h>
 #include "bootstd_common.h"
 
@@ -572,6 +573,53 @@ static int bootdev_test_hunt_prio(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootdev_test_hunt_prio, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
 
+/* Check starting the hunters before they are used */
+static int bootdev_test_hunt_start(struct unit_test_state *uts)
+{
+	struct bootstd_priv *std;
+	struct usb_bus_priv *priv;
+	struct udevice *bus, *hub;
+
+	bootstd_reset_usb();
+	test_set_skip_delays(true);
+	ut_assertok(bootstd_get_priv(&std));
+
+	/*
+	 * this brings up the USB controller and powers up the ports of its
+	 * root hub, but does not scan them
+	 */
+	ut_assertok(bootdev_hunt_start(true));
+	ut_assert_nextline("Starting hunter: usb");
+	ut_assert_console_end();
+	ut_assertok(uclass_first_device_err(UCLASS_USB, &bus));
+	ut_assert(device_active(bus));
+	ut_assertok(device_find_first_child(bus, &hub));
+	ut_assertnonnull(hub);
+	ut_assert(device_active(hub));
+	priv = dev_get_uclass_priv(bus);
+	ut_assert(priv->scan_pending);
+	ut_asserteq(1, priv->next_addr);
+	ut_assert(!usb_started);
+	ut_asserteq(0, std->hunters_used);
+
+	/* hunting finishes the job */
+	ut_assertok(bootdev_hunt("usb", true));
+	ut_assert_nextline("Hunting with: usb");
+	ut_assert_nextline(
+		"Bus usb@1: scanning bus usb@1 for devices... 6 USB Device(s) found");
+	ut_assert_console_end();
+	ut_assert(usb_started);
+	ut_assert(!priv->scan_pending);
+	ut_asserteq(BIT(HUNTER_USB), std->hunters_used);
+
+	/* the USB hunter has been used, so there is nothing to start now */
+	ut_assertok(bootdev_hunt_start(true));
+	ut_assert_console_end();
+
+	return 0;
+}
+BOOTSTD_TEST(bootdev_test_hunt_start, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
+
 /* Check hunting for bootdevs with a particular label */
 static int bootdev_test_hunt_label(struct unit_test_state *uts)
 {
@@ -6,7 +6,15 @@
  */
 
 #include <bootm.h>
+#include <bootstage.h>
+#include <env.h>
+#include <event.h>
+#include <image.h>
+#include <lmb.h>
+#include <mapmem.h>
 #include <asm/global_data.h>
+#include <dm/ofnode.h>
+#include <linux/sizes.h>
 #include <test/test.h>
 #include <test/ut.h>
 
@@ -255,3 +263,118 @@ static int bootm_test_subst_both(struct unit_test_state *uts)
 	return 0;
 }
 BOOTM_TEST(bootm_test_subst_both, 0);
+
+/* Test that a suitably placed ramdisk is used in place, not copied */
+static int bootm_test_ramdisk_in_place(struct unit_test_state *uts)
+{
+	const ulong rd_addr = SZ_16M, rd_len = SZ_64K + 12;
+	ulong start, end, copied;
+	struct lmb store;
+	u8 *buf;
+	int i;
+
+	ut_assertok(lmb_push(&store));
+	ut_assertok(lmb_add(0, SZ_256M));
+	ut_assertok(env_set("initrd_high", NULL));
+	buf = map_sysmem(rd_addr, rd_len);
+	for (i = 0; i < rd_len; i++)
+		buf[i] = i;
+	copied = bootstage_get_time(BOOTSTAGE_ID_COUNT_COPY);
+
+	ut_assertok(boot_ramdisk_high(rd_addr, rd_len, &start, &end));
+	ut_assert_nextline("   Using Ramdisk in place at 01000000, end 0101000c");
+	ut_assert_console_end();
+	ut_asserteq(rd_addr, start);
+	ut_asserteq(rd_addr + rd_len, end);
+	ut_asserteq(copied, bootstage_get_time(BOOTSTAGE_ID_COUNT_COPY));
+
+	/* now that it is reserved, a second ramdisk there must be copied */
+	ut_assertok(boot_ramdisk_high(rd_addr, rd_len, &start, &end));
+	ut_assert_nextlinen("   Loading Ramdisk to ");
+	ut_assert_console_end();
+	ut_assert(start != rd_addr);
+	ut_asserteq_mem(buf, map_sysmem(start, rd_len), rd_len);
+	copied += rd_len;
+	ut_asserteq(copied, bootstage_get_time(BOOTSTAGE_ID_COUNT_COPY));
+
+	/* so must one which is not page-aligned... */
+	ut_assertok(boot_ramdisk_high(rd_addr + SZ_1M + 8, rd_len, &start,
+				      &end));
+	ut_assert_nextlinen("   Loading Ramdisk to ");
+	ut_assert_console_end();
+	copied += rd_len;
+	ut_asserteq(copied, bootstage_get_time(BOOTSTAGE_ID_COUNT_COPY));
+
+	/* ...or extends above initrd_high */
+	ut_assertok(env_set_hex("initrd_high", rd_addr + SZ_2M + SZ_32K));
+	ut_assertok(boot_ramdisk_high(rd_addr + SZ_2M, rd_len, &start, &end));
+	ut_assert_nextlinen("   Loading Ramdisk to ");
+	ut_assert_console_end();
+	ut_assert(end <= rd_addr + SZ_2M + SZ_32K);
+	copied += rd_len;
+	ut_asserteq(copied, bootstage_get_time(BOOTSTAGE_ID_COUNT_COPY));
+
+	env_set("initrd_high", NULL);
+	unmap_sysmem(buf);
+	lmb_pop(&store);
+
+	return 0;
+}
+BOOTM_TEST(bootm_test_ramdisk_in_place, UTF_CONSOLE);
+
+/* Add a node and property to the FDT, as an ofnode-based fixup would */
+static int h_test_fixup(void *ctx, struct event *event)
+{
+	struct event_ft_fixup *fixup = &event->data.ft_fixup;
+	ofnode chosen, node;
+	int ret;
+
+	chosen = oftree_path(fixup->tree, "/chosen");
+	if (!ofnode_valid(chosen))
+		return -ENOENT;
+	ret = ofnode_add_subnode(chosen, "test-fixup", &node);
+	if (ret)
+		return ret;
+
+	return ofnode_write_string(node, "compatible", "u-boot,test-fixup");
+}
+
+/* Test that image_setup_libfdt() sends the fixup event with the OS FDT */
+static int bootm_test_fixup_event(struct unit_test_state *uts)
+{
+	struct bootm_headers images;
+	char fdt_buf[0x1000];
+	const char *compat;
+	u64 addr, size;
+	int node;
+
+	if (of_live_active() && !IS_ENABLED(CONFIG_OF_LIVE_FIXUP))
+		return -EAGAIN;
+
+	ut_assertok(event_register("test-fixup", EVT_FT_FIXUP, h_test_fixup,
+				   NULL));
+
+	ut_assertok(fdt_create_empty_tree(fdt_buf, sizeof(fdt_buf)));
+	ut_assertok(fdt_add_mem_rsv(fdt_buf, 0x1000, 0x200));
+	memset(&images, '\0', sizeof(images));
+	ut_assertok(image_setup_libfdt(&images, fdt_buf, false));
+
+	/* the libfdt fixups have created /chosen, then the event adds to it */
+	node = fdt_path_offset(fdt_buf, "/chosen/test-fixup");
+	ut_assert(node > 0);
+	compat = fdt_getprop(fdt_buf, node, "compatible", NULL);
+	ut_assertnonnull(compat);
+	ut_asserteq_str("u-boot,test-fixup", compat);
+
+	/*
+	 * The reserve map must survive, even with a live tree. There is also
+	 * an entry for the FDT itself, added by fdt_shrink_to_minimum()
+	 */
+	ut_asserteq(2, fdt_num_mem_rsv(fdt_buf));
+	ut_assertok(fdt_get_mem_rsv(fdt_buf, 0, &addr, &size));
+	ut_asserteq(0x1000, addr);
+	ut_asserteq(0x200, size);
+
+	return 0;
+}
+BOOTM_TEST(bootm_test_fixup_event, UTF_DM);
@@ -54,15 +54,7 @@ static int vbe_simple_test_base(struct unit_test_state *uts)
 		fixup.tree = oftree_from_fdt(fdt_buf);
 	}
 
-	/*
-	 * It would be better to call image_setup_libfdt() here, but that
-	 * function does not allow passing an ofnode. We can pass fdt_buf but
-	 * when it comes to send the event, it creates an ofnode that uses the
-	 * control FDT, since it has no way of accessing the live tree created
-	 * here.
-	 *
-	 * Two fix this we need image_setup_libfdt() is updated to use ofnode
-	 */
+	/* bootm_test_fixup_event() checks image_setup_libfdt() sends this */
 	fixup.images = NULL;
 	ut_assertok(event_notify(EVT_FT_FIXUP, &fixup, sizeof(fixup)));
 
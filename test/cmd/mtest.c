@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the 'mtest' command
+ */
+
+#include <command.h>
+#include <console.h>
+#include <mapmem.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+/* Declare a new mem test */
+#define MEM_TEST(_name, _flags)	UNIT_TEST(_name, _flags, mem)
+
+/* Test 'mtest -f' */
+static int mem_test_mtest_fast(struct unit_test_state *uts)
+{
+	ut_assertok(run_command("mtest -f -d 100000 300000 5 2", 0));
+	ut_assert_nextline("Testing 00100000 ... 00300000:");
+	ut_assert_nextlinen("Iteration:      1\r\rSeed %0*X  Testing...",
+			    2 * (int)sizeof(ulong), 5);
+	ut_assert_nextlinen("Tested 2 MiB in ");
+	ut_assert_nextlinen("Iteration:      2\r\rSeed %0*X  Testing...",
+			    2 * (int)sizeof(ulong), 6);
+	ut_assert_nextlinen("Tested 2 MiB in ");
+	ut_assert_nextline("%s", "");
+	ut_assert_nextline("Tested 2 iteration(s) with 0 errors.");
+	ut_assert_console_end();
+
+	/* -d and -t are only valid with -f */
+	ut_asserteq(1, run_command("mtest -t 10 100000 300000", 0));
+	ut_assert_nextline("mtest - simple RAM read/write test");
+	ut_assert_skip_to_line("  -t  - stop after this many milliseconds");
+	ut_assert_console_end();
+
+	return 0;
+}
+MEM_TEST(mem_test_mtest_fast, UTF_CONSOLE);
@@ -120,6 +120,40 @@ static int test_bootstage_accum(struct unit_test_state *uts)
 }
 COMMON_TEST(test_bootstage_accum, 0);
 
+/* Test bootstage_count() */
+static int test_bootstage_count(struct unit_test_state *uts)
+{
+	enum bootstage_id id = BOOTSTAGE_ID_USER + 54;
+	const struct bootstage_record *rec;
+	int count;
+
+	count = bootstage_get_rec_count();
+
+	/* Counters accumulate an amount, not a time */
+	ut_asserteq(100, bootstage_count(id, "test_counter", 100));
+	ut_asserteq(123, bootstage_count(id, "test_counter", 23));
+	ut_asserteq(count + 1, bootstage_get_rec_count());
+
+	rec = bootstage_get_rec(count);
+	ut_assertnonnull(rec);
+	ut_asserteq(id, rec->id);
+	ut_asserteq_str("test_counter", rec->name);
+	ut_asserteq(BOOTSTAGEF_COUNT, rec->flags);
+	ut_asserteq(0, rec->start_us);
+	ut_asserteq(123, bootstage_get_time(id));
+
+	/* Counters are listed separately in the report */
+	bootstage_report();
+	ut_assert_skip_to_line("Counters:");
+	ut_assert_skip_to_line("                   123  test_counter");
+	ut_assert_console_end();
+
+	bootstage_set_rec_count(count);
+
+	return 0;
+}
+COMMON_TEST(test_bootstage_count, UTF_CONSOLE);
+
 /* Test bootstage_mark_code() */
 static int test_bootstage_mark_code(struct unit_test_state *uts)
 {
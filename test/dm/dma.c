@@ -10,6 +10,10 @@
 #include <malloc.h>
 #include <dm/test.h>
 #include <dma.h>
+#include <image.h>
+#include <asm/cache.h>
+#include <asm/test.h>
+#include <linux/sizes.h>
 #include <test/test.h>
 #include <test/ut.h>
 
@@ -122,3 +126,66 @@ static int dm_test_dma_rx(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_dma_rx, UTF_SCAN_FDT);
+
+/* Test large copies being done with DMA, with the CPU used as a fallback */
+static int dm_test_dma_bulk_copy(struct unit_test_state *uts)
+{
+	const size_t size = SZ_256K, len = SZ_128K + 77;
+	struct udevice *dev;
+	ulong copied;
+	u8 *src, *dst;
+	int i;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_DMA, "dma", &dev));
+	src = memalign(ARCH_DMA_MINALIGN, size);
+	dst = memalign(ARCH_DMA_MINALIGN, size);
+	ut_assertnonnull(src);
+	ut_assertnonnull(dst);
+	for (i = 0; i < size; i++)
+		src[i] = i * 7 + (i >> 8);
+
+	/* unaligned ends are copied by the CPU, the rest by DMA */
+	memset(dst, '\xaa', size);
+	copied = sandbox_dma_get_copied(dev);
+	ut_assertok(dma_bulk_copy(dst + 5, src + 3, len));
+	ut_asserteq_mem(src + 3, dst + 5, len);
+	ut_asserteq(0xaa, dst[4]);
+	ut_asserteq(0xaa, dst[5 + len]);
+	copied = sandbox_dma_get_copied(dev) - copied;
+	ut_assert(copied > len - 2 * ARCH_DMA_MINALIGN);
+	ut_assert(copied <= len);
+
+	/* small and overlapping copies are left to the caller */
+	copied = sandbox_dma_get_copied(dev);
+	ut_asserteq(-E2BIG, dma_bulk_copy(dst, src, 100));
+	ut_asserteq(-EINVAL, dma_bulk_copy(src + SZ_4K, src, SZ_128K));
+	ut_asserteq(copied, sandbox_dma_get_copied(dev));
+
+	/* a failed transfer is left to the caller, as is the rest of the copy */
+	memset(dst, '\0', size);
+	sandbox_dma_set_fail(dev, true);
+	ut_asserteq(-EIO, dma_bulk_copy(dst + 5, src + 3, len));
+	ut_asserteq(0, dst[5]);
+	ut_asserteq(0, dst[4 + len]);
+	memmove_wd(dst, src, size, CHUNKSZ);
+	sandbox_dma_set_fail(dev, false);
+	ut_asserteq_mem(src, dst, size);
+	ut_asserteq(copied, sandbox_dma_get_copied(dev));
+
+	/* image loading uses DMA where it can, and the CPU otherwise */
+	memset(dst, '\0', size);
+	memmove_wd(dst, src, size, CHUNKSZ);
+	ut_asserteq_mem(src, dst, size);
+	ut_asserteq(copied + size, sandbox_dma_get_copied(dev));
+
+	memmove_wd(src + 1, src, size - 1, CHUNKSZ);
+	ut_asserteq(dst[0], src[1]);
+	ut_asserteq_mem(dst, src + 1, size - 1);
+	ut_asserteq(copied + size, sandbox_dma_get_copied(dev));
+
+	free(dst);
+	free(src);
+
+	return 0;
+}
+DM_TEST(dm_test_dma_bulk_copy, UTF_SCAN_FDT);
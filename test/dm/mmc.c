@@ -3,12 +3,19 @@
  * Copyright (C) 2015 Google, Inc
  */
 
+#include <bloblist.h>
+#include <cqhci.h>
 #include <dm.h>
+#include <malloc.h>
 #include <mmc.h>
 #include <part.h>
+#include <asm/io.h>
+#include <asm/test.h>
+#include <asm/unaligned.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
+#include "../../drivers/mmc/mmc_private.h"
 
 /*
  * Basic test of the mmc uclass. We could expand this by implementing an MMC
@@ -51,3 +58,188 @@ static int dm_test_mmc_blk(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_mmc_blk, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test taking over a card in the state left by SPL */
+static int dm_test_mmc_handoff(struct unit_test_state *uts)
+{
+	struct blk_desc *dev_desc;
+	struct udevice *dev;
+	struct mmc *mmc;
+	char buf[512];
+	u64 capacity;
+
+	if (!IS_ENABLED(CONFIG_MMC_HANDOFF))
+		return -EAGAIN;
+
+	ut_assertok(uclass_get_device(UCLASS_MMC, 0, &dev));
+	mmc = mmc_get_mmc_dev(dev);
+	ut_assertok(mmc_init(mmc));
+	ut_assert(!mmc->handoff);
+	capacity = mmc->capacity;
+
+	/* pretend that SPL set up the card, then U-Boot proper started */
+	ut_assertok(mmc_handoff_save(mmc));
+	ut_assertnonnull(bloblist_find(BLOBLISTT_U_BOOT_MMC,
+				       sizeof(struct mmc_handoff)));
+	mmc->has_init = 0;
+	ut_assertok(mmc_init(mmc));
+	ut_assert(mmc->handoff);
+	ut_asserteq(capacity, mmc->capacity);
+
+	/* the record is stale once it has been used */
+	ut_assertnull(bloblist_find(BLOBLISTT_U_BOOT_MMC,
+				    sizeof(struct mmc_handoff)));
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+	ut_asserteq(1, blk_dread(dev_desc, 0, 1, buf));
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_handoff, UTF_SCAN_FDT);
+
+/* Test laying out the descriptor memory of a command queue engine */
+static int dm_test_mmc_cqhci_init(struct unit_test_state *uts)
+{
+	struct cqhci_host cq_host;
+	struct udevice *dev;
+	struct mmc *mmc;
+	u32 regs[0x20];
+	u8 *link;
+
+	if (!IS_ENABLED(CONFIG_MMC_CQHCI))
+		return -EAGAIN;
+
+	ut_assertok(uclass_get_device(UCLASS_MMC, 0, &dev));
+	mmc = mmc_get_mmc_dev(dev);
+	memset(regs, '\0', sizeof(regs));
+
+	/* 32-bit DMA with 64-bit task descriptors */
+	memset(&cq_host, '\0', sizeof(cq_host));
+	cq_host.mmio = regs;
+	ut_assertok(cqhci_init(&cq_host, mmc, false));
+	ut_asserteq(8, cq_host.task_desc_len);
+	ut_asserteq(8, cq_host.link_desc_len);
+	ut_asserteq(8, cq_host.trans_desc_len);
+	ut_asserteq(16, cq_host.slot_sz);
+	link = cq_host.desc_base + 5 * cq_host.slot_sz + cq_host.task_desc_len;
+	ut_asserteq(CQHCI_VALID(1) | CQHCI_ACT(CQHCI_ACT_LINK),
+		    get_unaligned_le32(link));
+	ut_asserteq(virt_to_phys(cq_host.trans_desc_base +
+				 5 * CQHCI_MAX_SEGS * 8),
+		    get_unaligned_le32(link + 4));
+	free(cq_host.trans_desc_base);
+	free(cq_host.desc_base);
+
+	/* 64-bit DMA with 128-bit task descriptors */
+	memset(&cq_host, '\0', sizeof(cq_host));
+	cq_host.mmio = regs;
+	cq_host.caps = CQHCI_TASK_DESC_SZ_128;
+	ut_assertok(cqhci_init(&cq_host, mmc, true));
+	ut_asserteq(16, cq_host.task_desc_len);
+	ut_asserteq(16, cq_host.link_desc_len);
+	ut_asserteq(16, cq_host.trans_desc_len);
+	ut_asserteq(32, cq_host.slot_sz);
+	link = cq_host.desc_base + 5 * cq_host.slot_sz + cq_host.task_desc_len;
+	ut_asserteq(CQHCI_VALID(1) | CQHCI_ACT(CQHCI_ACT_LINK),
+		    get_unaligned_le32(link));
+	ut_asserteq_64(virt_to_phys(cq_host.trans_desc_base +
+				    5 * CQHCI_MAX_SEGS * 16),
+		       get_unaligned_le64(link + 4));
+	free(cq_host.trans_desc_base);
+	free(cq_host.desc_base);
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_cqhci_init, UTF_SCAN_FDT);
+
+/* Test transfers through the command queue engine emulated by sandbox */
+static int dm_test_mmc_cqe(struct unit_test_state *uts)
+{
+	struct cqhci_host *cq_host;
+	struct blk_desc *dev_desc;
+	struct mmc_data data;
+	struct udevice *dev;
+	char *write, *read;
+	struct mmc *mmc;
+	uint status;
+	ulong size;
+	int i;
+
+	if (!IS_ENABLED(CONFIG_MMC_CQHCI))
+		return -EAGAIN;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_MMC, "mmc2", &dev));
+	mmc = mmc_get_mmc_dev(dev);
+	cq_host = sandbox_mmc_get_cqe(dev);
+	ut_assertnonnull(cq_host);
+	ut_asserteq(2, blk_get_device_by_str("mmc", "2", &dev_desc));
+
+	/* the emulated card is SD, so pretend it supports command queueing */
+	ut_asserteq(0, mmc->cmdq_depth);
+	mmc->cmdq_depth = 4;
+
+	/* use the whole card, which needs eight tasks */
+	ut_asserteq(8 * CQHCI_MAX_SEGS * CQHCI_SEG_LEN / 512, dev_desc->lba);
+	size = dev_desc->lba * 512;
+	write = malloc(size);
+	ut_assertnonnull(write);
+	read = malloc(size);
+	ut_assertnonnull(read);
+	for (i = 0; i < size; i++)
+		write[i] = i + (i >> 9);
+
+	ut_asserteq(dev_desc->lba, blk_dwrite(dev_desc, 0, dev_desc->lba,
+					      write));
+	ut_assert(mmc_cqe_is_on(mmc));
+	ut_assert(sandbox_mmc_get_cmdq_en(dev));
+	ut_asserteq(4, sandbox_mmc_get_cqe_queued(dev));
+
+	memset(read, '\0', size);
+	ut_asserteq(dev_desc->lba, blk_dread(dev_desc, 0, dev_desc->lba, read));
+	ut_asserteq_mem(write, read, size);
+
+	/* a short transfer in the middle of the card */
+	memset(read, '\0', size);
+	ut_asserteq(3, blk_dread(dev_desc, 0x1235, 3, read));
+	ut_asserteq_mem(write + 0x1235 * 512, read, 3 * 512);
+
+	/* a task beyond the end of the card fails, then the engine recovers */
+	memset(&data, '\0', sizeof(data));
+	data.dest = read;
+	data.blocks = 2;
+	data.blocksize = 512;
+	data.flags = MMC_DATA_READ;
+	ut_asserteq(-EIO, cqhci_rw(cq_host, &data, dev_desc->lba - 1));
+	ut_asserteq(0, readl(cq_host->mmio + CQHCI_TDBR));
+	ut_asserteq(0, readl(cq_host->mmio + CQHCI_CTL));
+	ut_asserteq(0, readl(cq_host->mmio + CQHCI_IS) & CQHCI_IS_ERROR);
+	ut_assertok(cqhci_rw(cq_host, &data, dev_desc->lba - 2));
+	ut_asserteq_mem(write + size - 2 * 512, read, 2 * 512);
+
+	/* leaving the queue halts and disables the engine, then the card */
+	mmc_cqe_exit(mmc);
+	ut_assert(!mmc_cqe_is_on(mmc));
+	ut_assert(!sandbox_mmc_get_cmdq_en(dev));
+	ut_asserteq(CQHCI_HALT, readl(cq_host->mmio + CQHCI_CTL));
+	ut_asserteq(0, readl(cq_host->mmio + CQHCI_CFG) & CQHCI_ENABLE);
+	ut_asserteq(-EPERM, cqhci_rw(cq_host, &data, 0));
+
+	/* going back in, a legacy command makes it leave again */
+	ut_assertok(mmc_cqe_enter(mmc));
+	ut_assert(sandbox_mmc_get_cmdq_en(dev));
+	ut_assertok(mmc_send_status(mmc, &status));
+	ut_assert(!mmc_cqe_is_on(mmc));
+	ut_assert(!sandbox_mmc_get_cmdq_en(dev));
+
+	/* without queueing, the data is read with legacy commands */
+	mmc->cmdq_depth = 0;
+	memset(read, '\0', size);
+	ut_asserteq(8, blk_dread(dev_desc, 0x100, 8, read));
+	ut_assert(!mmc_cqe_is_on(mmc));
+	ut_asserteq_mem(write + 0x100 * 512, read, 8 * 512);
+	free(read);
+	free(write);
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_cqe, UTF_SCAN_FDT);
@@ -119,3 +119,82 @@ static int dm_test_nand1_end(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_nand1_end, UTF_SCAN_FDT);
+
+static void (*cache_read_cmdfunc)(struct mtd_info *mtd, unsigned int command,
+				  int column, int page_addr);
+static int cache_read_starts, cache_read_ends;
+
+/* Count the READ PAGE and READ CACHE END commands sent to the chip */
+static void cache_read_count(struct mtd_info *mtd, unsigned int command,
+			     int column, int page_addr)
+{
+	if (command == NAND_CMD_READ0)
+		cache_read_starts++;
+	else if (command == NAND_CMD_READCACHEEND)
+		cache_read_ends++;
+	cache_read_cmdfunc(mtd, command, column, page_addr);
+}
+
+static int dm_test_nand_cache_read(struct unit_test_state *uts)
+{
+	nand_erase_options_t opts = { };
+	struct nand_chip *chip;
+	struct mtd_info *mtd;
+	size_t length, retlen;
+	loff_t off, from;
+	char *buf, *gold;
+	int i, ret;
+
+	/* Only the ONFI chip advertises READ CACHE */
+	mtd = get_nand_dev_by_index(0);
+	ut_assertnonnull(mtd);
+	ut_assert(!mtd_to_nand(mtd)->cont_read.supported);
+
+	mtd = get_nand_dev_by_index(1);
+	ut_assertnonnull(mtd);
+	chip = mtd_to_nand(mtd);
+	ut_assert(chip->cont_read.supported);
+
+	srand(1);
+	off = mtd->erasesize * 8;
+	length = mtd->erasesize * 2;
+	buf = malloc(length);
+	ut_assertnonnull(buf);
+	gold = malloc(length);
+	ut_assertnonnull(gold);
+
+	opts.offset = off;
+	opts.length = length;
+	ut_assertok(nand_erase_opts(mtd, &opts));
+	for (i = 0; i < length; i++)
+		gold[i] = rand();
+	ut_assertok(nand_write_skip_bad(mtd, off, &length, NULL, U64_MAX,
+					(void *)gold, 0));
+
+	/*
+	 * Start part-way through the first block and end part-way through a
+	 * page in the second. This needs one sequence for the rest of the
+	 * first block, a second one for the two whole pages in the next block
+	 * and a normal read of the last page.
+	 */
+	from = off + 3 * mtd->writesize;
+	length = mtd->erasesize + 2 * mtd->writesize + 100;
+	cache_read_starts = 0;
+	cache_read_ends = 0;
+	cache_read_cmdfunc = chip->cmdfunc;
+	chip->cmdfunc = cache_read_count;
+	ret = mtd_read(mtd, from, length, &retlen, buf);
+	chip->cmdfunc = cache_read_cmdfunc;
+	ut_assert(!ret || ret == -EUCLEAN);
+	ut_asserteq(3, cache_read_starts);
+	ut_asserteq(2, cache_read_ends);
+	ut_asserteq(length, retlen);
+	ut_asserteq_mem(gold + 3 * mtd->writesize, buf, length);
+	ut_assert(!chip->cont_read.ongoing);
+
+	free(gold);
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_nand_cache_read, UTF_SCAN_FDT);
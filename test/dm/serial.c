@@ -6,11 +6,15 @@
 #include <log.h>
 #include <serial.h>
 #include <dm.h>
+#include <time.h>
+#include <asm/global_data.h>
 #include <asm/serial.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 static const char test_message[] =
 	"This is a test message\n"
 	"consisting of multiple lines\n";
@@ -88,3 +92,81 @@ static int dm_test_serial(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_serial, UTF_SCAN_FDT);
+
+#if IS_ENABLED(CONFIG_SERIAL_TX_BUFFER)
+/* Test that output is buffered when the UART is busy */
+static int dm_test_serial_tx_buffer(struct unit_test_state *uts)
+{
+	struct serial_dev_priv *upriv;
+	struct udevice *dev, *old;
+	size_t start, queued, sent, sent_cyclic;
+	int i;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_SERIAL, "serial", &dev));
+	upriv = dev_get_uclass_priv(dev);
+	ut_assert(upriv->tx_active);
+
+	/*
+	 * Nothing reaches the UART, but the caller does not wait. Avoid
+	 * asserting anything until the UART is accepting characters again,
+	 * since a failure message would sit in the buffer.
+	 */
+	old = gd->cur_serial_dev;
+	gd->cur_serial_dev = dev;
+	sandbox_serial_endisable(false);
+	start = sandbox_serial_written();
+	sandbox_serial_set_tx_space(0);
+	serial_puts("abc\n");
+	queued = upriv->tx_wr_ptr - upriv->tx_rd_ptr;
+	sent = sandbox_serial_written() - start;
+
+	/* The cyclic function sends what the UART can accept */
+	sandbox_serial_set_tx_space(2);
+	timer_test_add_offset(CONFIG_SERIAL_TX_BUFFER_POLL_US / 1000 + 1);
+	schedule();
+	sent_cyclic = sandbox_serial_written() - start;
+
+	/* Flushing sends the rest */
+	sandbox_serial_set_tx_space(-1);
+	serial_flush();
+	sandbox_serial_endisable(true);
+	gd->cur_serial_dev = old;
+
+	ut_asserteq(0, sent);
+	ut_asserteq(5, queued);
+	ut_asserteq(2, sent_cyclic);
+	ut_asserteq(5, sandbox_serial_written() - start);
+	ut_asserteq(upriv->tx_wr_ptr, upriv->tx_rd_ptr);
+
+	/*
+	 * Output from within the driver's putc() cannot wait for the buffer to
+	 * drain, so once it is full, characters go straight to the UART
+	 */
+	gd->cur_serial_dev = dev;
+	sandbox_serial_endisable(false);
+	start = sandbox_serial_written();
+	sandbox_serial_set_tx_space(0);
+	upriv->tx_busy = true;
+	for (i = 0; i < CONFIG_SERIAL_TX_BUFFER_SIZE; i++)
+		serial_putc('x');
+	queued = upriv->tx_wr_ptr - upriv->tx_rd_ptr;
+	sandbox_serial_set_tx_space(1);
+	serial_putc('y');
+	sent = sandbox_serial_written() - start;
+	upriv->tx_busy = false;
+
+	sandbox_serial_set_tx_space(-1);
+	serial_flush();
+	sandbox_serial_endisable(true);
+	gd->cur_serial_dev = old;
+
+	ut_asserteq(CONFIG_SERIAL_TX_BUFFER_SIZE, queued);
+	ut_asserteq(1, sent);
+	ut_asserteq(CONFIG_SERIAL_TX_BUFFER_SIZE + 1,
+		    sandbox_serial_written() - start);
+	ut_asserteq(upriv->tx_wr_ptr, upriv->tx_rd_ptr);
+
+	return 0;
+}
+DM_TEST(dm_test_serial_tx_buffer, UTF_SCAN_FDT);
+#endif
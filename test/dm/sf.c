@@ -91,7 +91,8 @@ static int dm_test_spi_flash_func(struct unit_test_state *uts)
 	ut_asserteq(0, run_command_list(
 		"host save hostfs - 0 spi.bin 200000;"
 		"sf probe;"
-		"sf test 0 10000", -1,  0));
+		"sf test 0 10000;"
+		"sf bench 1 fff 2", -1,  0));
 	/*
 	 * Since we are about to destroy all devices, we must tell sandbox
 	 * to forget the emulation device
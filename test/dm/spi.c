@@ -5,6 +5,9 @@
 
 #include <dm.h>
 #include <fdtdec.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <spi-mem.h>
 #include <spi.h>
 #include <spi_flash.h>
 #include <asm/state.h>
@@ -13,6 +16,7 @@
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
+#include <linux/sizes.h>
 #include <test/test.h>
 #include <test/ut.h>
 
@@ -200,3 +204,32 @@ static int dm_test_spi_xfer(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_spi_xfer, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test copying a large read out of a direct mapping using DMA */
+static int dm_test_spi_mem_copy_from_map(struct unit_test_state *uts)
+{
+	const size_t len = SZ_8K;
+	u8 *src, *dst;
+	int i;
+
+	src = memalign(ARCH_DMA_MINALIGN, len);
+	dst = memalign(ARCH_DMA_MINALIGN, len);
+	ut_assertnonnull(src);
+	ut_assertnonnull(dst);
+	for (i = 0; i < len; i++)
+		src[i] = i * 7;
+	memset(dst, '\0', len);
+
+	/*
+	 * memcpy_fromio() does nothing on sandbox, so the data only arrives if
+	 * the copy went through the DMA engine
+	 */
+	spi_mem_copy_from_map(dst, src, len);
+	ut_asserteq_mem(src, dst, len);
+
+	free(dst);
+	free(src);
+
+	return 0;
+}
+DM_TEST(dm_test_spi_mem_copy_from_map, UTF_SCAN_FDT);
@@ -5,6 +5,8 @@
 
 #include <console.h>
 #include <dm.h>
+#include <malloc.h>
+#include <os.h>
 #include <part.h>
 #include <usb.h>
 #include <asm/io.h>
@@ -84,6 +86,105 @@ static int dm_test_usb_flash(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_usb_flash, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* flash-stick@2 in test.dts: a USB 3 stick with a little over 2^32 blocks */
+#define USB3_FLASH_FNAME	"testflash2.bin"
+#define USB3_FLASH_BLOCKS	(BIT_ULL(32) + 0x1000)
+#define USB3_XFER_BLOCKS	3000
+
+static int check_usb_flash_usb3(struct unit_test_state *uts)
+{
+	struct udevice *dev, *emul, *blk;
+	struct blk_desc *desc;
+	struct usb_device *udev;
+	lbaint_t start;
+	char *buf, *cmp;
+	int fd, i;
+
+	state_set_skip_delays(true);
+	ut_assertok(usb_init());
+	ut_assertok(uclass_get_device_by_name(UCLASS_USB_EMUL, "flash-stick@2",
+					      &emul));
+
+	/* Find the mass-storage device attached at SuperSpeed */
+	uclass_foreach_dev_probe(UCLASS_MASS_STORAGE, dev) {
+		udev = dev_get_parent_priv(dev);
+		if (udev->speed == USB_SPEED_SUPER)
+			break;
+	}
+	ut_assertnonnull(dev);
+	ut_assertok(device_find_first_child_by_uclass(dev, UCLASS_BLK, &blk));
+	desc = dev_get_uclass_plat(blk);
+
+	/* READ CAPACITY(16) reports the full size */
+	ut_asserteq(512, desc->blksz);
+	ut_asserteq_64(USB3_FLASH_BLOCKS, desc->lba);
+
+	/* Write and read back, beyond 2^32 blocks and across several commands */
+	buf = malloc(USB3_XFER_BLOCKS * 512);
+	cmp = malloc(USB3_XFER_BLOCKS * 512);
+	ut_assertnonnull(buf);
+	ut_assertnonnull(cmp);
+	for (i = 0; i < USB3_XFER_BLOCKS * 512; i++)
+		buf[i] = i / 512 + i;
+
+	start = USB3_FLASH_BLOCKS - USB3_XFER_BLOCKS - 1;
+	ut_asserteq(USB3_XFER_BLOCKS,
+		    blk_write(blk, start, USB3_XFER_BLOCKS, buf));
+	memset(cmp, '\0', USB3_XFER_BLOCKS * 512);
+	ut_asserteq(USB3_XFER_BLOCKS,
+		    blk_read(blk, start, USB3_XFER_BLOCKS, cmp));
+	ut_asserteq_mem(buf, cmp, USB3_XFER_BLOCKS * 512);
+
+	/* Each command moved more than the 240 blocks allowed at USB 2 */
+	ut_asserteq(CONFIG_USB_STORAGE_SUPERSPEED_MAX_BLK,
+		    sandbox_flash_get_max_blocks(emul));
+
+	/* The data is in the right place in the file, not 2^32 blocks back */
+	fd = os_open(USB3_FLASH_FNAME, OS_O_RDONLY);
+	ut_assert(fd >= 0);
+	ut_asserteq_64(start * 512, os_lseek(fd, start * 512, OS_SEEK_SET));
+	ut_asserteq(512, os_read(fd, cmp, 512));
+	ut_asserteq_mem(buf, cmp, 512);
+	ut_asserteq_64((start & U32_MAX) * 512,
+		       os_lseek(fd, (start & U32_MAX) * 512, OS_SEEK_SET));
+	ut_asserteq(512, os_read(fd, cmp, 512));
+	memset(buf, '\0', 512);
+	ut_asserteq_mem(buf, cmp, 512);
+	os_close(fd);
+
+	free(cmp);
+	free(buf);
+	ut_assertok(usb_stop());
+
+	return 0;
+}
+
+/*
+ * Test a USB 3 flash stick with more than 2^32 blocks, which needs READ(16)
+ * and WRITE(16), using transfers larger than those allowed for USB 2 sticks
+ */
+static int dm_test_usb_flash_usb3(struct unit_test_state *uts)
+{
+	loff_t size = USB3_FLASH_BLOCKS * 512;
+	int fd, ret;
+
+	if (!IS_ENABLED(CONFIG_SYS_64BIT_LBA))
+		return -EAGAIN;
+
+	/* Create a sparse backing file, so it takes up almost no space */
+	fd = os_open(USB3_FLASH_FNAME, OS_O_RDWR | OS_O_CREAT | OS_O_TRUNC);
+	ut_assert(fd >= 0);
+	ut_asserteq_64(size - 1, os_lseek(fd, size - 1, OS_SEEK_SET));
+	ut_asserteq(1, os_write(fd, "", 1));
+	os_close(fd);
+
+	ret = check_usb_flash_usb3(uts);
+	os_unlink(USB3_FLASH_FNAME);
+
+	return ret;
+}
+DM_TEST(dm_test_usb_flash_usb3, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
 /* test that we can handle multiple storage devices */
 static int dm_test_usb_multi(struct unit_test_state *uts)
 {
@@ -833,6 +833,69 @@ static int dm_test_video_truetype_bs(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_truetype_bs, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* Test that redrawing TrueType text from the glyph cache gives the same image */
+static int dm_test_video_truetype_cache(struct unit_test_state *uts)
+{
+	struct udevice *dev, *con;
+	const char *test_string = "Criticism may not be agreeable, but it "
+		"is necessary. It fulfils the same function as pain in the "
+		"human body.";
+	ulong start, cold, warm, hits, misses, old_hits, old_misses;
+	int i, count, chars, distinct;
+
+	if (!CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE)
+		return -EAGAIN;
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+
+	/* the first time, every glyph is rendered, although some repeat */
+	start = timer_get_us();
+	vidconsole_put_string(con, test_string);
+	cold = timer_get_us() - start;
+	ut_asserteq(4118, video_compress_fb(uts, dev, false));
+	console_truetype_glyph_stats(con, &hits, &misses, &count);
+	ut_assert(misses > 0);
+	ut_asserteq(misses, count);
+	chars = hits + misses;
+	distinct = misses;
+
+	/* draw it again in the same place, this time all from the cache */
+	ut_assertok(video_clear(dev));
+	vidconsole_set_cursor_pos(con, 0, 0);
+	start = timer_get_us();
+	vidconsole_put_string(con, test_string);
+	warm = timer_get_us() - start;
+	ut_asserteq(4118, video_compress_fb(uts, dev, false));
+	ut_assertok(video_check_copy_fb(uts, dev));
+	console_truetype_glyph_stats(con, &hits, &misses, &count);
+	ut_asserteq(chars * 2, hits + misses);
+	ut_asserteq(distinct, misses);
+	log_debug("cold %lu us, warm %lu us\n", cold, warm);
+
+	/* fill the cache with other characters, evicting the ones above */
+	for (i = 0; i < CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE; i++)
+		vidconsole_putc_xy(con, 0, 0, 0x4e00 + i);
+	console_truetype_glyph_stats(con, &hits, &misses, &count);
+	ut_asserteq(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE, count);
+	ut_asserteq(distinct + CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE, misses);
+
+	/* so the string must be rendered again, giving the same result */
+	ut_assertok(video_clear(dev));
+	vidconsole_set_cursor_pos(con, 0, 0);
+	old_hits = hits;
+	old_misses = misses;
+	vidconsole_put_string(con, test_string);
+	ut_asserteq(4118, video_compress_fb(uts, dev, false));
+	console_truetype_glyph_stats(con, &hits, &misses, &count);
+	ut_asserteq(old_misses + distinct, misses);
+	ut_asserteq(old_hits + chars - distinct, hits);
+	ut_asserteq(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE, count);
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_cache, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
 /* Test partial rendering onto hardware frame buffer */
 static int dm_test_video_copy(struct unit_test_state *uts)
 {
@@ -892,7 +955,7 @@ static int dm_test_video_copy(struct unit_test_state *uts)
 	vidconsole_put_string(con, test_string);
 	video_sync(dev, true);
 	ut_asserteq(7621, video_compress_fb(uts, dev, false));
-	ut_asserteq(7741, video_compress_fb(uts, dev, true));
+	ut_asserteq(7689, video_compress_fb(uts, dev, true));
 
 	return 0;
 }
@@ -958,6 +1021,70 @@ static int dm_test_video_damage(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_damage, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* Test that separate damaged regions are synced without what is between them */
+static int dm_test_video_damage_rects(struct unit_test_state *uts)
+{
+	struct sandbox_sdl_plat *plat;
+	struct udevice *dev, *con;
+	struct video_priv *priv;
+	ulong expect;
+	int i;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_COPY))
+		return -EAGAIN;
+
+	ut_assertok(uclass_find_device(UCLASS_VIDEO, 0, &dev));
+	ut_assert(!device_active(dev));
+	plat = dev_get_plat(dev);
+	plat->font_size = 32;
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+	video_sync(dev, true);
+
+	/* a line of text is a single region */
+	vidconsole_position_cursor(con, 0, 0);
+	vidconsole_put_string(con, "12:34");
+	ut_asserteq(1, priv->damage_count);
+
+	/* text in the opposite corner is kept apart */
+	vidconsole_position_cursor(con, 30, 22);
+	vidconsole_put_string(con, "_");
+	ut_asserteq(2, priv->damage_count);
+
+	expect = 0;
+	for (i = 0; i < priv->damage_count; i++) {
+		const struct vid_bbox *rect = &priv->damage_rect[i];
+
+		expect += (rect->x1 - rect->x0) * (rect->y1 - rect->y0) *
+			VNBYTES(priv->bpix);
+	}
+	video_sync(dev, true);
+	ut_asserteq(expect, priv->copy_bytes);
+	ut_assert(priv->copy_bytes < priv->fb_size / 50);
+	ut_asserteq(0, priv->damage_count);
+	ut_assertok(video_check_copy_fb(uts, dev));
+
+	/* scattered updates are joined once there are too many */
+	for (i = 0; i < VIDEO_DAMAGE_RECTS + 4; i++)
+		video_fill_part(dev, i * 100, i * 50, i * 100 + 10, i * 50 + 10,
+				priv->colour_fg);
+	ut_asserteq(VIDEO_DAMAGE_RECTS, priv->damage_count);
+	video_sync(dev, true);
+	ut_assert(priv->copy_bytes < priv->fb_size / 10);
+	ut_assertok(video_check_copy_fb(uts, dev));
+
+	/* full-width updates are copied in one go */
+	ut_assertok(video_fill(dev, priv->colour_bg));
+	video_sync(dev, true);
+	ut_asserteq(priv->fb_size, priv->copy_bytes);
+	ut_assertok(video_check_copy_fb(uts, dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage_rects, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
 /* Test font measurement */
 static int dm_test_font_measure(struct unit_test_state *uts)
 {
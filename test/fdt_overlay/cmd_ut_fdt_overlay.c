@@ -11,6 +11,7 @@
 #include <image.h>
 #include <log.h>
 #include <malloc.h>
+#include <time.h>
 
 #include <linux/sizes.h>
 
@@ -235,3 +236,252 @@ static int fdt_overlay_test_stacked(struct unit_test_state *uts)
 	return CMD_RET_SUCCESS;
 }
 FDT_OVERLAY_TEST(fdt_overlay_test_stacked, 0);
+
+/* Test that applying overlays with an index gives the same tree */
+static int fdt_overlay_test_index(struct unit_test_state *uts)
+{
+	void *fdt_base = &__dtb_test_fdt_base_begin;
+	void *fdt_overlay = &__dtbo_test_fdt_overlay_begin;
+	void *fdt_overlay_stacked = &__dtbo_test_fdt_overlay_stacked_begin;
+	struct fdt_overlay_index idx;
+	void *blob;
+
+	blob = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(blob);
+	ut_assertok(fdt_open_into(fdt_base, blob, FDT_COPY_SIZE));
+
+	ut_assertok(fdt_overlay_index_init(&idx, blob));
+	ut_assertok(fdt_overlay_index_apply(&idx, blob, fdt_overlay));
+	ut_assertok(fdt_overlay_index_apply(&idx, blob, fdt_overlay_stacked));
+	fdt_overlay_index_uninit(&idx);
+
+	/* the overlays are left intact */
+	ut_assertok(fdt_check_header(fdt_overlay));
+	ut_assertok(fdt_check_header(fdt_overlay_stacked));
+
+	/* compare everything but the free space at the end */
+	ut_asserteq(fdt_off_dt_strings(fdt), fdt_off_dt_strings(blob));
+	ut_asserteq(fdt_size_dt_strings(fdt), fdt_size_dt_strings(blob));
+	ut_asserteq_mem(fdt, blob,
+			fdt_off_dt_strings(fdt) + fdt_size_dt_strings(fdt));
+	free(blob);
+
+	return 0;
+}
+FDT_OVERLAY_TEST(fdt_overlay_test_index, 0);
+
+#define BENCH_BUSES		25
+#define BENCH_DEVS		40
+#define BENCH_NODES		(BENCH_BUSES * BENCH_DEVS)
+#define BENCH_OVERLAYS		12
+#define BENCH_FRAGMENTS		4
+#define BENCH_BASE_SIZE		SZ_256K
+
+/* Get the path of base node @dev */
+static void bench_path(char *path, int size, int dev)
+{
+	snprintf(path, size, "/bus@%x/dev@%x", dev / BENCH_DEVS,
+		 dev % BENCH_DEVS);
+}
+
+/*
+ * Create a base tree with BENCH_NODES labelled nodes across BENCH_BUSES
+ * buses, each with a phandle, as dtc -@ would
+ */
+static int make_bench_base(struct unit_test_state *uts, void *buf)
+{
+	char name[20], label[20], path[30];
+	int bus, sym, node, i;
+
+	ut_assertok(fdt_create_empty_tree(buf, BENCH_BASE_SIZE));
+	for (i = BENCH_NODES - 1; i >= 0; i--) {
+		if (i % BENCH_DEVS == BENCH_DEVS - 1) {
+			snprintf(name, sizeof(name), "bus@%x", i / BENCH_DEVS);
+			bus = fdt_add_subnode(buf, 0, name);
+			ut_assert(bus >= 0);
+		}
+		snprintf(name, sizeof(name), "dev@%x", i % BENCH_DEVS);
+		node = fdt_add_subnode(buf, bus, name);
+		ut_assert(node >= 0);
+		ut_assertok(fdt_setprop_u32(buf, node, "phandle", i + 1));
+		ut_assertok(fdt_setprop_u32(buf, node, "reg", i));
+	}
+
+	sym = fdt_add_subnode(buf, 0, "__symbols__");
+	ut_assert(sym >= 0);
+	for (i = 0; i < BENCH_NODES; i++) {
+		snprintf(label, sizeof(label), "dev%d", i);
+		bench_path(path, sizeof(path), i);
+		ut_assertok(fdt_setprop_string(buf, sym, label, path));
+	}
+
+	return 0;
+}
+
+/* Get the base node targeted by fragment @frag of overlay @num */
+static int bench_target(int num, int frag)
+{
+	return (num * 97 + frag * 251) % BENCH_NODES;
+}
+
+/*
+ * Create overlay @num, with BENCH_FRAGMENTS fragments each adding a node to
+ * a different base node. Each new node refers to itself, to its target and
+ * (after the first overlay) to the node added by the previous overlay.
+ */
+static int make_bench_overlay(struct unit_test_state *uts, void *buf, int num)
+{
+	char frag_name[20], node_name[20], label[20], path[60], fixup[120];
+	int node, len, i;
+
+	ut_assertok(fdt_create_empty_tree(buf, SZ_16K));
+
+	/* subnodes are added first in the list, so go backwards */
+	ut_assert(fdt_add_subnode(buf, 0, "__symbols__") >= 0);
+	ut_assert(fdt_add_subnode(buf, 0, "__local_fixups__") >= 0);
+	ut_assert(fdt_add_subnode(buf, 0, "__fixups__") >= 0);
+	for (i = BENCH_FRAGMENTS - 1; i >= 0; i--) {
+		snprintf(frag_name, sizeof(frag_name), "fragment@%d", i);
+		snprintf(node_name, sizeof(node_name), "ov%d-%d", num, i);
+
+		node = fdt_add_subnode(buf, 0, frag_name);
+		ut_assert(node >= 0);
+		ut_assertok(fdt_setprop_u32(buf, node, "target", -1));
+		node = fdt_add_subnode(buf, node, "__overlay__");
+		ut_assert(node >= 0);
+		node = fdt_add_subnode(buf, node, node_name);
+		ut_assert(node >= 0);
+		ut_assertok(fdt_setprop_u32(buf, node, "phandle", i + 1));
+		ut_assertok(fdt_setprop_u32(buf, node, "self", i + 1));
+		ut_assertok(fdt_setprop_u32(buf, node, "base", -1));
+		if (num)
+			ut_assertok(fdt_setprop_u32(buf, node, "prev", -1));
+
+		node = fdt_path_offset(buf, "/__local_fixups__");
+		node = fdt_add_subnode(buf, node, frag_name);
+		ut_assert(node >= 0);
+		node = fdt_add_subnode(buf, node, "__overlay__");
+		ut_assert(node >= 0);
+		node = fdt_add_subnode(buf, node, node_name);
+		ut_assert(node >= 0);
+		ut_assertok(fdt_setprop_u32(buf, node, "self", 0));
+
+		/* the target and 'base' both refer to the same base node */
+		snprintf(label, sizeof(label), "dev%d", bench_target(num, i));
+		len = snprintf(fixup, sizeof(fixup), "/%s:target:0", frag_name);
+		len += 1 + snprintf(fixup + len + 1, sizeof(fixup) - len - 1,
+				    "/%s/__overlay__/%s:base:0", frag_name,
+				    node_name);
+		node = fdt_path_offset(buf, "/__fixups__");
+		ut_assertok(fdt_setprop(buf, node, label, fixup, len + 1));
+
+		if (num) {
+			snprintf(label, sizeof(label), "ov%d_%d", num - 1, i);
+			snprintf(fixup, sizeof(fixup),
+				 "/%s/__overlay__/%s:prev:0", frag_name,
+				 node_name);
+			node = fdt_path_offset(buf, "/__fixups__");
+			ut_assertok(fdt_setprop_string(buf, node, label,
+						       fixup));
+		}
+
+		snprintf(label, sizeof(label), "ov%d_%d", num, i);
+		snprintf(path, sizeof(path), "/%s/__overlay__/%s", frag_name,
+			 node_name);
+		node = fdt_path_offset(buf, "/__symbols__");
+		ut_assertok(fdt_setprop_string(buf, node, label, path));
+	}
+	ut_assertok(fdt_pack(buf));
+
+	return 0;
+}
+
+/* Get the phandle of the node added by fragment @frag of overlay @num */
+static uint32_t bench_phandle(void *blob, int num, int frag)
+{
+	char path[40];
+	int len;
+
+	bench_path(path, sizeof(path), bench_target(num, frag));
+	len = strlen(path);
+	snprintf(path + len, sizeof(path) - len, "/ov%d-%d", num, frag);
+
+	return fdt_get_phandle(blob, fdt_path_offset(blob, path));
+}
+
+/*
+ * Compare applying a batch of overlays to a large tree with and without index.
+ * The timings vary from run to run, so this is only run by hand, with:
+ *
+ *   ut -f fdt_overlay fdt_overlay_test_index_bench_norun
+ */
+static int fdt_overlay_test_index_bench_norun(struct unit_test_state *uts)
+{
+	void *overlays[BENCH_OVERLAYS];
+	struct fdt_overlay_index idx;
+	ulong start, plain, indexed;
+	void *base, *expect, *copy;
+	uint32_t phandle, prev;
+	char path[30];
+	int node, i;
+
+	base = malloc(BENCH_BASE_SIZE);
+	expect = malloc(BENCH_BASE_SIZE);
+	copy = malloc(SZ_16K);
+	ut_assertnonnull(base);
+	ut_assertnonnull(expect);
+	ut_assertnonnull(copy);
+	ut_assertok(make_bench_base(uts, base));
+	memcpy(expect, base, BENCH_BASE_SIZE);
+	for (i = 0; i < BENCH_OVERLAYS; i++) {
+		overlays[i] = malloc(SZ_16K);
+		ut_assertnonnull(overlays[i]);
+		ut_assertok(make_bench_overlay(uts, overlays[i], i));
+	}
+
+	/* fdt_overlay_apply() damages each overlay, so apply a copy */
+	start = timer_get_us();
+	for (i = 0; i < BENCH_OVERLAYS; i++) {
+		ut_assertok(fdt_open_into(overlays[i], copy, SZ_16K));
+		ut_assertok(fdt_overlay_apply(expect, copy));
+	}
+	plain = max(timer_get_us() - start, 1UL);
+
+	start = timer_get_us();
+	ut_assertok(fdt_overlay_index_init(&idx, base));
+	for (i = 0; i < BENCH_OVERLAYS; i++)
+		ut_assertok(fdt_overlay_index_apply(&idx, base, overlays[i]));
+	indexed = max(timer_get_us() - start, 1UL);
+	fdt_overlay_index_uninit(&idx);
+
+	printf("%d overlays on %d nodes: %lu us plain, %lu us indexed\n",
+	       BENCH_OVERLAYS, BENCH_NODES, plain, indexed);
+
+	ut_asserteq_mem(expect, base,
+			fdt_off_dt_strings(base) + fdt_size_dt_strings(base));
+
+	/* check the references in the last overlay */
+	i = BENCH_OVERLAYS - 1;
+	phandle = bench_phandle(base, i, 1);
+	prev = bench_phandle(base, i - 1, 1);
+	ut_assert(phandle > BENCH_NODES);
+	ut_assert(prev > BENCH_NODES);
+	bench_path(path, sizeof(path), bench_target(i, 1));
+	node = fdt_path_offset(base, path);
+	ut_assert(node >= 0);
+	node = fdt_first_subnode(base, node);
+	ut_assert(node >= 0);
+	ut_asserteq(phandle, fdtdec_get_uint(base, node, "self", 0));
+	ut_asserteq(prev, fdtdec_get_uint(base, node, "prev", 0));
+	ut_asserteq(bench_target(i, 1) + 1,
+		    fdtdec_get_uint(base, node, "base", 0));
+
+	for (i = 0; i < BENCH_OVERLAYS; i++)
+		free(overlays[i]);
+	free(copy);
+	free(expect);
+	free(base);
+
+	return 0;
+}
+FDT_OVERLAY_TEST(fdt_overlay_test_index_bench_norun, UTF_MANUAL);
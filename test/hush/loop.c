@@ -4,6 +4,7 @@
  * Francis Laniel, Amarula Solutions, francis.laniel@amarulasolutions.com
  */
 
+#include <cli_hush.h>
 #include <command.h>
 #include <env_attr.h>
 #include <test/hush.h>
@@ -83,3 +84,83 @@ static int hush_test_until(struct unit_test_state *uts)
 	return 0;
 }
 HUSH_TEST(hush_test_until, UTF_CONSOLE);
+
+static int hush_test_run_loop(struct unit_test_state *uts)
+{
+	unsigned long hits, misses, prev_hits, prev_misses;
+	bool cached;
+	int i;
+
+	/* Only the old parser has a parse cache */
+	cached = IS_ENABLED(CONFIG_HUSH_OLD_PARSER) &&
+		 CONFIG_IF_ENABLED_INT(HUSH_OLD_PARSER, HUSH_CACHE) &&
+		 (gd->flags & GD_FLG_HUSH_OLD_PARSER);
+
+	/* Running the same script again must give the same result each time */
+	env_set("loop_pfx", "x");
+	env_set("loop_cmd",
+		"for loop_j in foo bar; do echo ${loop_pfx}$loop_j; done");
+	for (i = 0; i < 3; i++) {
+		hush_cache_stats(&prev_hits, &prev_misses);
+		ut_assertok(run_command("run loop_cmd", 0));
+		ut_assert_nextline("xfoo");
+		ut_assert_nextline("xbar");
+		ut_assert_console_end();
+
+		/* after the first time, the command and script are cached */
+		hush_cache_stats(&hits, &misses);
+		if (cached && !i) {
+			ut_assert(misses > prev_misses);
+		} else if (cached) {
+			ut_asserteq(prev_hits + 2, hits);
+			ut_asserteq(prev_misses, misses);
+		}
+	}
+
+	/* Variables are expanded when the script runs, not when it is parsed */
+	env_set("loop_pfx", "y");
+	hush_cache_stats(&prev_hits, &prev_misses);
+	ut_assertok(run_command("run loop_cmd", 0));
+	ut_assert_nextline("yfoo");
+	ut_assert_nextline("ybar");
+	ut_assert_console_end();
+	hush_cache_stats(&hits, &misses);
+	if (cached) {
+		ut_asserteq(prev_hits + 2, hits);
+		ut_asserteq(prev_misses, misses);
+	}
+
+	/* A changed script must be parsed again */
+	env_set("loop_cmd", "for loop_j in quux; do echo $loop_j; done");
+	hush_cache_stats(&prev_hits, &prev_misses);
+	ut_assertok(run_command("run loop_cmd", 0));
+	ut_assert_nextline("quux");
+	ut_assert_console_end();
+	hush_cache_stats(&hits, &misses);
+	if (cached) {
+		ut_asserteq(prev_hits + 1, hits);
+		ut_asserteq(prev_misses + 1, misses);
+	}
+
+	/*
+	 * Leaving a loop early must not stop the cached script running again,
+	 * so run it in full first, then with an exit part-way through
+	 */
+	env_set("loop_cmd", "for loop_j in foo bar baz; do echo $loop_j; "
+		"if test \"$loop_j\" = \"$loop_stop\"; then exit; fi; done");
+	for (i = 0; i < 4; i++) {
+		env_set("loop_stop", i == 1 || i == 2 ? "bar" : NULL);
+		run_command("run loop_cmd", 0);
+		ut_assert_nextline("foo");
+		ut_assert_nextline("bar");
+		if (i == 0 || i == 3)
+			ut_assert_nextline("baz");
+		ut_assert_console_end();
+	}
+
+	env_set("loop_cmd", NULL);
+	env_set("loop_pfx", NULL);
+
+	return 0;
+}
+HUSH_TEST(hush_test_run_loop, UTF_CONSOLE);
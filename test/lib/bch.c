@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests and benchmark for the software BCH decoder
+ */
+
+#include <malloc.h>
+#include <rand.h>
+#include <time.h>
+#include <linux/bch.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+/* Correction strengths to check, for 512- and 1024-byte ECC steps */
+static const struct {
+	int m;
+	int t;
+	int len;
+} bch_params[] = {
+	{ 13, 4, 512 },
+	{ 13, 8, 512 },
+	{ 13, 16, 512 },
+	{ 14, 24, 1024 },
+	{ 14, 40, 1024 },
+};
+
+/**
+ * flip_bits() - Flip a number of distinct, random bits in a buffer
+ *
+ * @buf: Buffer to corrupt
+ * @len: Length of @buf in bytes
+ * @count: Number of bits to flip, at most 64
+ */
+static void flip_bits(u8 *buf, int len, int count)
+{
+	uint pos[64];
+	int i, j;
+
+	for (i = 0; i < count; i++) {
+		do {
+			pos[i] = rand() % (len * 8);
+			for (j = 0; j < i && pos[j] != pos[i]; j++)
+				;
+		} while (j < i);
+		buf[pos[i] / 8] ^= 1 << (pos[i] % 8);
+	}
+}
+
+/**
+ * bch_decode() - Decode a step, with or without the syndrome tables
+ *
+ * @bch: BCH control structure
+ * @len: Number of data bytes in the step
+ * @recv_ecc: ECC read back with the data
+ * @calc_ecc: ECC calculated from the data read back
+ * @errloc: Returns the error locations
+ * @tables: true to use the syndrome tables (if present), false to compute
+ *	the syndromes a bit at a time
+ * Return: number of errors found, or -ve on error
+ */
+static int bch_decode(struct bch_control *bch, int len, const u8 *recv_ecc,
+		      const u8 *calc_ecc, uint *errloc, bool tables)
+{
+	u16 *syn_tab = bch->syn_tab;
+	int ret;
+
+	if (!tables)
+		bch->syn_tab = NULL;
+	ret = decode_bch(bch, NULL, len, recv_ecc, calc_ecc, NULL, errloc);
+	bch->syn_tab = syn_tab;
+
+	return ret;
+}
+
+static int lib_test_bch_decode(struct unit_test_state *uts)
+{
+	uint errloc[64], errloc2[64];
+	u8 recv_ecc[128], calc_ecc[128];
+	int i, j, count, nerr;
+	u8 *gold, *buf;
+
+	srand(1);
+	gold = malloc(1024);
+	ut_assertnonnull(gold);
+	buf = malloc(1024);
+	ut_assertnonnull(buf);
+
+	for (i = 0; i < ARRAY_SIZE(bch_params); i++) {
+		int len = bch_params[i].len, t = bch_params[i].t;
+		struct bch_control *bch;
+
+		bch = init_bch(bch_params[i].m, t, 0);
+		ut_assertnonnull(bch);
+		ut_assert(bch->ecc_bytes <= sizeof(recv_ecc));
+		if (CONFIG_IS_ENABLED(BCH_FAST_DECODE))
+			ut_assertnonnull(bch->syn_tab);
+
+		for (j = 0; j < len; j++)
+			gold[j] = rand();
+		memset(recv_ecc, '\0', sizeof(recv_ecc));
+		encode_bch(bch, gold, len, recv_ecc);
+
+		for (nerr = 0; nerr <= t; nerr += nerr < 2 ? 1 : t / 4) {
+			memcpy(buf, gold, len);
+			flip_bits(buf, len, nerr);
+			memset(calc_ecc, '\0', sizeof(calc_ecc));
+			encode_bch(bch, buf, len, calc_ecc);
+
+			count = bch_decode(bch, len, recv_ecc, calc_ecc, errloc,
+					   true);
+			ut_asserteq(nerr, count);
+			ut_asserteq(nerr, bch_decode(bch, len, recv_ecc,
+						     calc_ecc, errloc2, false));
+			ut_asserteq_mem(errloc2, errloc,
+					nerr * sizeof(*errloc));
+
+			for (j = 0; j < count; j++) {
+				ut_assert(errloc[j] < len * 8);
+				buf[errloc[j] / 8] ^= 1 << (errloc[j] % 8);
+			}
+			ut_asserteq_mem(gold, buf, len);
+		}
+
+		/* Too many errors, which both methods must handle alike */
+		memcpy(buf, gold, len);
+		flip_bits(buf, len, t + 1);
+		memset(calc_ecc, '\0', sizeof(calc_ecc));
+		encode_bch(bch, buf, len, calc_ecc);
+		ut_asserteq(bch_decode(bch, len, recv_ecc, calc_ecc, errloc2,
+				       false),
+			    bch_decode(bch, len, recv_ecc, calc_ecc, errloc,
+				       true));
+
+		free_bch(bch);
+	}
+	free(buf);
+	free(gold);
+
+	return 0;
+}
+LIB_TEST(lib_test_bch_decode, 0);
+
+/*
+ * Time decoding steps with a couple of bitflips, as is typical when reading
+ * NAND, and with the maximum number that can be corrected. The timings vary
+ * from run to run, so this is only run by hand, with:
+ *
+ *   ut -f lib lib_test_bch_bench_norun
+ */
+static int lib_test_bch_bench_norun(struct unit_test_state *uts)
+{
+	const int loops = 200;
+	u8 recv_ecc[128], calc_ecc[128];
+	uint errloc[64];
+	ulong start, delta[2];
+	int i, j, nerr, pass;
+	u8 *gold, *buf;
+
+	srand(2);
+	gold = malloc(1024);
+	ut_assertnonnull(gold);
+	buf = malloc(1024);
+	ut_assertnonnull(buf);
+
+	for (i = 0; i < ARRAY_SIZE(bch_params); i++) {
+		int len = bch_params[i].len, t = bch_params[i].t;
+		struct bch_control *bch;
+
+		bch = init_bch(bch_params[i].m, t, 0);
+		ut_assertnonnull(bch);
+		for (j = 0; j < len; j++)
+			gold[j] = rand();
+		memset(recv_ecc, '\0', sizeof(recv_ecc));
+		encode_bch(bch, gold, len, recv_ecc);
+
+		for (nerr = 2; nerr <= t; nerr = nerr < t ? t : t + 1) {
+			memcpy(buf, gold, len);
+			flip_bits(buf, len, nerr);
+			memset(calc_ecc, '\0', sizeof(calc_ecc));
+			encode_bch(bch, buf, len, calc_ecc);
+
+			for (pass = 0; pass < 2; pass++) {
+				start = timer_get_us();
+				for (j = 0; j < loops; j++)
+					ut_asserteq(nerr,
+						    bch_decode(bch, len,
+							       recv_ecc,
+							       calc_ecc,
+							       errloc, !pass));
+				delta[pass] = max(timer_get_us() - start, 1UL);
+			}
+			printf("m=%d t=%-2d errors=%-2d: %6lu KiB/s with tables, %6lu KiB/s without\n",
+			       bch_params[i].m, t, nerr,
+			       len * loops / 1024 * 1000000UL / delta[0],
+			       len * loops / 1024 * 1000000UL / delta[1]);
+		}
+		free_bch(bch);
+	}
+	free(buf);
+	free(gold);
+
+	return 0;
+}
+LIB_TEST(lib_test_bch_bench_norun, UTF_MANUAL);
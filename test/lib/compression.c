@@ -6,12 +6,14 @@
 #include <abuf.h>
 #include <bootm.h>
 #include <command.h>
+#include <decomp.h>
 #include <gzip.h>
 #include <image.h>
 #include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 
 #include <u-boot/lz4.h>
 #include <u-boot/zlib.h>
@@ -606,3 +608,269 @@ static int compression_test_bootm_none(struct unit_test_state *uts)
 	return run_bootm_test(uts, IH_COMP_NONE, compress_using_none);
 }
 LIB_TEST(compression_test_bootm_none, 0);
+
+/* Reads an image held in an abuf, returning at most 7 bytes each time */
+static long read_in_pieces(void *priv, ulong offset, void *buf, ulong size)
+{
+	struct abuf *in = priv;
+
+	size = min(size, 7UL);
+	memcpy(buf, abuf_data(in) + offset, size);
+
+	return size;
+}
+
+/**
+ * run_stream_test() - Run tests on the streaming decompression functions
+ *
+ * @comp_type:	Compression type to test
+ * @compress:	Our function to compress data
+ * Return: 0 if OK, non-zero on failure
+ */
+static int run_stream_test(struct unit_test_state *uts, int comp_type,
+			   mutate_func compress)
+{
+	static const int chunk_sizes[] = {1, 3, 64, 0};
+	char compress_buff[1024], out[TEST_BUFFER_SIZE];
+	ulong compress_size = sizeof(compress_buff);
+	const ulong load_addr = 0x1000;
+	struct decomp_ctx ctx;
+	ulong pos, load_end;
+	struct abuf in;
+	size_t len;
+	int unc_len;
+	int i;
+
+	unc_len = strlen(plain);
+	ut_assertok(compress(uts, (void *)plain, unc_len, compress_buff,
+			     compress_size, &compress_size));
+
+	/* feed the data in pieces of various sizes, 0 meaning all at once */
+	for (i = 0; i < ARRAY_SIZE(chunk_sizes); i++) {
+		memset(out, '\0', sizeof(out));
+		ut_assertok(decomp_init(&ctx, comp_type, out, sizeof(out)));
+		for (pos = 0; pos < compress_size; pos += len) {
+			len = min_t(ulong, chunk_sizes[i] ?: compress_size,
+				    compress_size - pos);
+			ut_assertok(decomp_feed(&ctx, compress_buff + pos,
+						len));
+		}
+
+		/* anything after the end of the stream is ignored */
+		if (comp_type != IH_COMP_NONE)
+			ut_assertok(decomp_feed(&ctx, plain, 10));
+		ut_assertok(decomp_finish(&ctx, &len));
+		ut_asserteq(unc_len, len);
+		ut_asserteq_mem(plain, out, unc_len);
+	}
+
+	/* not enough space */
+	ut_assertok(decomp_init(&ctx, comp_type, out, unc_len - 1));
+	decomp_feed(&ctx, compress_buff, compress_size);
+	ut_asserteq(-ENOSPC, decomp_finish(&ctx, NULL));
+
+	/* truncated data, which can't be detected when not decompressing */
+	if (comp_type != IH_COMP_NONE) {
+		ut_assertok(decomp_init(&ctx, comp_type, out, sizeof(out)));
+		ut_assertok(decomp_feed(&ctx, compress_buff,
+					compress_size / 2));
+		ut_assert(decomp_finish(&ctx, NULL));
+	}
+
+	/* read the image in pieces */
+	memset(out, '\0', sizeof(out));
+	abuf_init_set(&in, compress_buff, compress_size);
+	ut_assertok(image_decomp_read(comp_type, load_addr, IH_TYPE_KERNEL,
+				      out, read_in_pieces, &in, compress_size,
+				      sizeof(out), &load_end));
+	ut_asserteq(load_addr + unc_len, load_end);
+	ut_asserteq_mem(plain, out, unc_len);
+
+	return 0;
+}
+
+static int compression_test_stream_gzip(struct unit_test_state *uts)
+{
+	return run_stream_test(uts, IH_COMP_GZIP, compress_using_gzip);
+}
+LIB_TEST(compression_test_stream_gzip, 0);
+
+static int compression_test_stream_bzip2(struct unit_test_state *uts)
+{
+	return run_stream_test(uts, IH_COMP_BZIP2, compress_using_bzip2);
+}
+LIB_TEST(compression_test_stream_bzip2, 0);
+
+static int compression_test_stream_lzma(struct unit_test_state *uts)
+{
+	return run_stream_test(uts, IH_COMP_LZMA, compress_using_lzma);
+}
+LIB_TEST(compression_test_stream_lzma, 0);
+
+static int compression_test_stream_lzo(struct unit_test_state *uts)
+{
+	return run_stream_test(uts, IH_COMP_LZO, compress_using_lzo);
+}
+LIB_TEST(compression_test_stream_lzo, 0);
+
+static int compression_test_stream_lz4(struct unit_test_state *uts)
+{
+	return run_stream_test(uts, IH_COMP_LZ4, compress_using_lz4);
+}
+LIB_TEST(compression_test_stream_lz4, 0);
+
+static int compression_test_stream_zstd(struct unit_test_state *uts)
+{
+	return run_stream_test(uts, IH_COMP_ZSTD, compress_using_zstd);
+}
+LIB_TEST(compression_test_stream_zstd, 0);
+
+static int compression_test_stream_none(struct unit_test_state *uts)
+{
+	return run_stream_test(uts, IH_COMP_NONE, compress_using_none);
+}
+LIB_TEST(compression_test_stream_none, 0);
+
+/* zstd frames, each holding data stored without compression */
+static const char zstd_rle_frame[] =
+	"\x28\xb5\x2f\xfd\x20\x64\x23\x03\x00\x78";	/* 'x' x 100 */
+static const char zstd_raw_frame[] =
+	"\x28\xb5\x2f\xfd\x20\x0c\x61\x00\x00hello world\n";
+static const char zstd_skip_frame[] = "\x50\x2a\x4d\x18\x04\x00\x00\x00skip";
+
+/**
+ * make_seekable() - Build zstd data in the seekable format
+ *
+ * This has five frames: @plain, 100 'x' characters, "hello world\n", a
+ * skippable frame and then @plain again, followed by the seek table
+ *
+ * @buf: Buffer to hold the data
+ * @expect: Returns the expected decompressed data
+ * Return: size of the data in @buf
+ */
+static int make_seekable(char *buf, char *expect)
+{
+	const struct {
+		const char *data;
+		int comp_size;
+		int size;
+	} frames[] = {
+		{ zstd_compressed, zstd_compressed_size, strlen(plain) },
+		{ zstd_rle_frame, sizeof(zstd_rle_frame) - 1, 100 },
+		{ zstd_raw_frame, sizeof(zstd_raw_frame) - 1, 12 },
+		{ zstd_skip_frame, sizeof(zstd_skip_frame) - 1, 0 },
+		{ zstd_compressed, zstd_compressed_size, strlen(plain) },
+	};
+	const int count = ARRAY_SIZE(frames);
+	char *ptr = buf;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		memcpy(ptr, frames[i].data, frames[i].comp_size);
+		ptr += frames[i].comp_size;
+	}
+	put_unaligned_le32(0x184d2a5e, ptr);
+	put_unaligned_le32(count * 8 + 9, ptr + 4);
+	ptr += 8;
+	for (i = 0; i < count; i++, ptr += 8) {
+		put_unaligned_le32(frames[i].comp_size, ptr);
+		put_unaligned_le32(frames[i].size, ptr + 4);
+	}
+	put_unaligned_le32(count, ptr);
+	ptr[4] = 0;
+	put_unaligned_le32(0x8f92eab1, ptr + 5);
+	ptr += 9;
+
+	strcpy(expect, plain);
+	memset(expect + strlen(expect), 'x', 100);
+	strcpy(expect + strlen(plain) + 100, "hello world\n");
+	strcat(expect, plain);
+
+	return ptr - buf;
+}
+
+/* Test decompressing zstd data in the seekable format */
+static int compression_test_zstd_seekable(struct unit_test_state *uts)
+{
+	char comp[1024], expect[1024], out[1024];
+	const ulong load_addr = 0x1000;
+	struct zstd_seek_table tab;
+	struct decomp_ctx ctx;
+	struct abuf in, buf;
+	int comp_size, size;
+	ulong load_end;
+	size_t len;
+
+	comp_size = make_seekable(comp, expect);
+	size = strlen(expect);
+	abuf_init_set(&in, comp, comp_size);
+
+	ut_assertok(zstd_seek_table_read(&in, &tab));
+	ut_asserteq(5, tab.count);
+	ut_asserteq(size, tab.size);
+	ut_asserteq(zstd_compressed_size + 10 + 21 + 12,
+		    tab.frames[4].comp_offset);
+	ut_asserteq(strlen(plain) + 112, tab.frames[4].offset);
+
+	/* the whole thing, in parallel */
+	memset(out, '\0', sizeof(out));
+	abuf_init_set(&buf, out, sizeof(out));
+	ut_asserteq(size, zstd_decompress_seekable(&in, &buf));
+	ut_asserteq_mem(expect, out, size);
+
+	/* ranges covering the end of one frame and the start of the next */
+	memset(out, '\0', sizeof(out));
+	abuf_init_set(&buf, out, 30);
+	ut_asserteq(30, zstd_seekable_read(&in, &tab, strlen(plain) - 10,
+					   &buf));
+	ut_asserteq_mem(expect + strlen(plain) - 10, out, 30);
+
+	abuf_init_set(&buf, out, 20);
+	ut_asserteq(20, zstd_seekable_read(&in, &tab, strlen(plain) + 105,
+					   &buf));
+	ut_asserteq_mem(expect + strlen(plain) + 105, out, 20);
+
+	/* a range within a single frame, and one past the end */
+	abuf_init_set(&buf, out, 5);
+	ut_asserteq(5, zstd_seekable_read(&in, &tab, 3, &buf));
+	ut_asserteq_mem(expect + 3, out, 5);
+
+	abuf_init_set(&buf, out, sizeof(out));
+	ut_asserteq(size - 100, zstd_seekable_read(&in, &tab, 100, &buf));
+	ut_asserteq_mem(expect + 100, out, size - 100);
+	ut_asserteq(-EINVAL, zstd_seekable_read(&in, &tab, size + 1, &buf));
+	zstd_seek_table_free(&tab);
+
+	/* not enough space */
+	abuf_init_set(&buf, out, size - 1);
+	ut_asserteq(-ENOSPC, zstd_decompress_seekable(&in, &buf));
+
+	/* image_decomp() uses the seek table; streaming decodes each frame */
+	memset(out, '\0', sizeof(out));
+	ut_assertok(image_decomp(IH_COMP_ZSTD, load_addr, 0, IH_TYPE_KERNEL,
+				 out, comp, comp_size, sizeof(out),
+				 &load_end));
+	ut_asserteq(load_addr + size, load_end);
+	ut_asserteq_mem(expect, out, size);
+
+	memset(out, '\0', sizeof(out));
+	ut_assertok(decomp_init(&ctx, IH_COMP_ZSTD, out, sizeof(out)));
+	for (len = 0; len < comp_size; len += 5)
+		ut_assertok(decomp_feed(&ctx, comp + len,
+					min(5, comp_size - (int)len)));
+	ut_assertok(decomp_finish(&ctx, &len));
+	ut_asserteq(size, len);
+	ut_asserteq_mem(expect, out, size);
+
+	/* a single frame has no seek table */
+	abuf_init_set(&in, (void *)zstd_compressed, zstd_compressed_size);
+	ut_asserteq(-ENOENT, zstd_seek_table_read(&in, &tab));
+
+	/* the frame sizes must add up */
+	abuf_init_set(&in, comp, comp_size);
+	comp[comp_size - 9 - 8 * 5]++;
+	ut_asserteq(-EINVAL, zstd_seek_table_read(&in, &tab));
+
+	return 0;
+}
+LIB_TEST(compression_test_zstd_seekable, 0);
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the fast memory test
+ */
+
+#include <malloc.h>
+#include <memtest.h>
+#include <time.h>
+#include <asm/cache.h>
+#include <linux/errno.h>
+#include <linux/sizes.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+/* two windows, the second one partial, with a partial chunk at the end */
+#define TEST_WINDOW	SZ_4M
+#define TEST_SIZE	(SZ_4M + SZ_2M + 40)
+#define TEST_ADDR	0x10000000
+
+/**
+ * struct test_priv - Information for the progress function
+ *
+ * @calls: Number of calls so far
+ * @done: Value of @done in the last call
+ * @total: Value of @total in the last call
+ * @buf: Buffer being tested
+ * @corrupt_at: Value of @done at which to flip a bit in @buf, or 0
+ * @stop_at: Value of @done at which to stop the test, or 0
+ * @skip_ms: Milliseconds to advance the timer on each call
+ */
+struct test_priv {
+	int calls;
+	u64 done;
+	u64 total;
+	ulong *buf;
+	u64 corrupt_at;
+	u64 stop_at;
+	int skip_ms;
+};
+
+static int test_progress(void *priv, u64 done, u64 total)
+{
+	struct test_priv *tp = priv;
+
+	tp->calls++;
+	tp->done = done;
+	tp->total = total;
+	if (done == tp->corrupt_at)
+		tp->buf[12345] ^= 1UL << 7;
+	timer_test_add_offset(tp->skip_ms);
+
+	return done == tp->stop_at ? -EINTR : 0;
+}
+
+static int run_test(struct unit_test_state *uts, struct test_priv *tp,
+		    uint flags, ulong limit_ms, struct memtest_result *res)
+{
+	struct memtest_opts opts = {
+		.flags		= flags,
+		.seed		= 0x1234,
+		.window		= TEST_WINDOW,
+		.limit_ms	= limit_ms,
+		.progress	= test_progress,
+		.priv		= tp,
+	};
+
+	return memtest_run(tp->buf, TEST_ADDR, TEST_SIZE, &opts, res);
+}
+
+/* Test a region with no errors, with and without the DMA pass */
+static int lib_test_memtest_run(struct unit_test_state *uts)
+{
+	struct memtest_result res;
+	struct test_priv tp = {};
+
+	tp.buf = memalign(ARCH_DMA_MINALIGN, TEST_SIZE);
+	ut_assertnonnull(tp.buf);
+
+	ut_assertok(run_test(uts, &tp, 0, 0, &res));
+	ut_asserteq(0, res.errors);
+	ut_asserteq(ALIGN_DOWN(TEST_SIZE, sizeof(ulong)), res.tested);
+	ut_asserteq(5, res.passes);
+	ut_asserteq(2 * 5, tp.calls);
+	ut_asserteq_64((u64)res.tested * 5, tp.total);
+	ut_asserteq_64(tp.total, tp.done);
+
+	tp = (struct test_priv){ .buf = tp.buf };
+	ut_assertok(run_test(uts, &tp, MEMTEST_F_DMA, 0, &res));
+	ut_asserteq(0, res.errors);
+	ut_asserteq(ALIGN_DOWN(TEST_SIZE, sizeof(ulong)), res.tested);
+	ut_asserteq(7, res.passes);
+	ut_asserteq(2 * 6, tp.calls);
+	ut_asserteq_64(tp.total, tp.done);
+
+	free(tp.buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_memtest_run, 0);
+
+/* Test that a fault is found and reported */
+static int lib_test_memtest_error(struct unit_test_state *uts)
+{
+	struct memtest_result res;
+	struct test_priv tp = {};
+
+	tp.buf = memalign(ARCH_DMA_MINALIGN, TEST_SIZE);
+	ut_assertnonnull(tp.buf);
+
+	/* flip a bit after the second pass of the first window */
+	tp.corrupt_at = 2 * TEST_WINDOW;
+	ut_asserteq(-EIO, run_test(uts, &tp, 0, 0, &res));
+	ut_asserteq(1, res.errors);
+	ut_asserteq(TEST_ADDR + 12345 * sizeof(ulong), res.addr);
+	ut_asserteq(1UL << 7, res.found ^ res.expected);
+
+	/* the whole region is still tested */
+	ut_asserteq(ALIGN_DOWN(TEST_SIZE, sizeof(ulong)), res.tested);
+	ut_asserteq_64(tp.total, tp.done);
+
+	free(tp.buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_memtest_error, 0);
+
+/* Test stopping early, on request or when the time limit is reached */
+static int lib_test_memtest_stop(struct unit_test_state *uts)
+{
+	struct memtest_result res;
+	struct test_priv tp = {};
+
+	tp.buf = memalign(ARCH_DMA_MINALIGN, TEST_SIZE);
+	ut_assertnonnull(tp.buf);
+
+	/* stopping in the second window leaves only the first one tested */
+	tp.stop_at = 5 * TEST_WINDOW + TEST_SIZE - TEST_WINDOW;
+	ut_asserteq(-EINTR, run_test(uts, &tp, 0, 0, &res));
+	ut_asserteq(TEST_WINDOW, res.tested);
+	ut_asserteq(6, tp.calls);
+
+	/* the time limit is checked between windows */
+	tp = (struct test_priv){ .buf = tp.buf };
+	tp.skip_ms = 100;
+	ut_asserteq(-ETIMEDOUT, run_test(uts, &tp, 0, 400, &res));
+	ut_asserteq(TEST_WINDOW, res.tested);
+	ut_asserteq(5, tp.calls);
+
+	/* a fault takes precedence over the time limit */
+	tp = (struct test_priv){ .buf = tp.buf };
+	tp.skip_ms = 100;
+	tp.corrupt_at = TEST_WINDOW;
+	ut_asserteq(-EIO, run_test(uts, &tp, 0, 400, &res));
+	ut_asserteq(1, res.errors);
+
+	free(tp.buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_memtest_stop, 0);
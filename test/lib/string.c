@@ -11,10 +11,12 @@
 
 #include <command.h>
 #include <log.h>
+#include <malloc.h>
 #include <string.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
+#include <time.h>
 
 /* Xor mask used for marking memory regions */
 #define MASK 0xA5
@@ -193,6 +195,183 @@ static int lib_memmove(struct unit_test_state *uts)
 }
 LIB_TEST(lib_memmove, 0);
 
+/**
+ * lib_memcmp() - unit test for memcmp()
+ *
+ * Test memcmp() with varied alignment and length, with the first difference
+ * at each position and in each direction.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_memcmp(struct unit_test_state *uts)
+{
+	u8 buf1[BUFLEN];
+	u8 buf2[BUFLEN];
+	int offset, len, pos;
+
+	init_buffer(buf1, MASK);
+	init_buffer(buf2, MASK);
+
+	for (offset = 0; offset <= SWEEP; ++offset) {
+		for (len = 0; len < BUFLEN - SWEEP; ++len) {
+			ut_assertok(memcmp(buf1 + offset, buf2 + offset, len));
+			for (pos = 0; pos < len; pos++) {
+				buf2[offset + pos] ^= 0x80;
+				ut_assert(memcmp(buf1 + offset, buf2 + offset,
+						 len) * (buf1[offset + pos] -
+						 buf2[offset + pos]) > 0);
+				buf2[offset + pos] ^= 0x80;
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_memcmp, 0);
+
+/* Sizes for the large-buffer tests, either side of any size thresholds */
+static const int mem_sizes[] = {
+	63, 64, 65, 127, 256, 1000, 4095, 4096, 4097, 65536 + 7,
+};
+
+/**
+ * lib_mem_large() - test memory functions on larger buffers
+ *
+ * Architecture-specific implementations may use a different method (e.g. a
+ * vector unit) above a certain size, so check these too, including
+ * overlapping moves in each direction
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_mem_large(struct unit_test_state *uts)
+{
+	const int max = 65536 + 64;
+	int i, len, offset;
+	u8 *src, *dst, *buf;
+
+	src = malloc(max);
+	dst = malloc(max);
+	buf = malloc(max);
+	ut_assertnonnull(src);
+	ut_assertnonnull(dst);
+	ut_assertnonnull(buf);
+	for (i = 0; i < max; i++)
+		src[i] = i * 7 + (i >> 8);
+
+	for (i = 0; i < ARRAY_SIZE(mem_sizes); i++) {
+		len = mem_sizes[i];
+		for (offset = 0; offset < 8; offset += 3) {
+			memset(dst, '\0', max);
+			ut_asserteq_ptr(dst + offset,
+					memcpy(dst + offset, src + 5, len));
+			ut_asserteq_mem(src + 5, dst + offset, len);
+			ut_asserteq(0, dst[offset + len]);
+			ut_assertok(memcmp(src + 5, dst + offset, len));
+			dst[offset + len - 1] ^= 1;
+			ut_assert(memcmp(src + 5, dst + offset, len));
+
+			ut_asserteq_ptr(dst + offset,
+					memset(dst + offset, 0x5a, len));
+			ut_asserteq(0x5a, dst[offset]);
+			ut_asserteq(0x5a, dst[offset + len - 1]);
+			ut_asserteq(0, dst[offset + len]);
+
+			/* overlapping, in each direction */
+			memcpy(buf, src, max);
+			memmove(buf + offset + 1, buf, len);
+			ut_asserteq_mem(src, buf + offset + 1, len);
+			memcpy(buf, src, max);
+			memmove(buf, buf + offset + 1, len);
+			ut_asserteq_mem(src + offset + 1, buf, len);
+		}
+	}
+	free(buf);
+	free(dst);
+	free(src);
+
+	return 0;
+}
+LIB_TEST(lib_mem_large, 0);
+
+/* Bytes to process for each measurement in lib_mem_bench_norun() */
+#define BENCH_BYTES	(4 << 20)
+
+/**
+ * lib_mem_bench_norun() - benchmark the memory functions
+ *
+ * This reports the throughput of memcpy(), memmove(), memset() and memcmp()
+ * for a range of sizes, so that architecture-specific versions can be
+ * compared with the generic ones. The timings vary from run to run, so this
+ * is only run by hand, with:
+ *
+ *   ut -f lib lib_mem_bench_norun
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_mem_bench_norun(struct unit_test_state *uts)
+{
+	static const int sizes[] = { 16, 64, 256, 4096, 65536, 1 << 20 };
+	static const char *const names[] = {
+		"memcpy", "memmove", "memset", "memcmp",
+	};
+	ulong start, delta[ARRAY_SIZE(names)];
+	int i, j, func, size, loops;
+	u8 *src, *dst;
+
+	src = malloc(sizes[ARRAY_SIZE(sizes) - 1] + 64);
+	dst = malloc(sizes[ARRAY_SIZE(sizes) - 1] + 64);
+	ut_assertnonnull(src);
+	ut_assertnonnull(dst);
+	memset(src, 0xaa, sizes[ARRAY_SIZE(sizes) - 1] + 64);
+	memset(dst, 0xaa, sizes[ARRAY_SIZE(sizes) - 1] + 64);
+
+	printf("%8s", "size");
+	for (func = 0; func < ARRAY_SIZE(names); func++)
+		printf(" %9s", names[func]);
+	printf("  (MiB/s)\n");
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		size = sizes[i];
+		loops = BENCH_BYTES / size;
+		for (func = 0; func < ARRAY_SIZE(names); func++) {
+			start = timer_get_us();
+			for (j = 0; j < loops; j++) {
+				switch (func) {
+				case 0:
+					memcpy(dst, src, size);
+					break;
+				case 1:
+					memmove(dst + 1, dst, size);
+					break;
+				case 2:
+					memset(dst, j, size);
+					break;
+				case 3:
+					ut_assertok(memcmp(dst, src, size));
+					break;
+				}
+			}
+			delta[func] = max(timer_get_us() - start, 1UL);
+
+			/* put dst back, for memcmp() */
+			if (func == 2)
+				memset(dst, 0xaa, size);
+		}
+		printf("%8d", size);
+		for (func = 0; func < ARRAY_SIZE(names); func++)
+			printf(" %9lu", (ulong)((u64)BENCH_BYTES * 1000000 /
+					       delta[func] >> 20));
+		printf("\n");
+	}
+	free(dst);
+	free(src);
+
+	return 0;
+}
+LIB_TEST(lib_mem_bench_norun, UTF_MANUAL);
+
 /** lib_memdup() - unit test for memdup() */
 static int lib_memdup(struct unit_test_state *uts)
 {
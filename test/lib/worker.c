@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the worker pool
+ */
+
+#include <worker.h>
+#include <linux/errno.h>
+#include <test/lib.h>
+#include <test/ut.h>
+#include <u-boot/sha256.h>
+
+#define NUM_JOBS	40
+#define JOB_SIZE	4096
+
+/**
+ * struct region - A region of memory for a job to work on
+ *
+ * @buf: Start of region
+ * @size: Size of region in bytes
+ * @val: Value to fill / check
+ * @digest: Hash of the region
+ */
+struct region {
+	u8 *buf;
+	int size;
+	u8 val;
+	u8 digest[SHA256_SUM_LEN];
+};
+
+static u8 test_buf[NUM_JOBS * JOB_SIZE];
+static int arrived;
+
+static int hash_job(void *arg)
+{
+	struct region *reg = arg;
+	sha256_context ctx;
+
+	sha256_starts(&ctx);
+	sha256_update(&ctx, reg->buf, reg->size);
+	sha256_finish(&ctx, reg->digest);
+
+	return 0;
+}
+
+static int fill_job(void *arg)
+{
+	struct region *reg = arg;
+
+	memset(reg->buf, reg->val, reg->size);
+
+	return 0;
+}
+
+static int verify_job(void *arg)
+{
+	struct region *reg = arg;
+	int i;
+
+	for (i = 0; i < reg->size; i++) {
+		if (reg->buf[i] != reg->val)
+			return -EIO;
+	}
+
+	return 0;
+}
+
+/* Wait until the given number of these jobs are all running at once */
+static int rendezvous_job(void *arg)
+{
+	int count = *(int *)arg;
+	long i;
+
+	__atomic_fetch_add(&arrived, 1, __ATOMIC_ACQ_REL);
+	for (i = 0; i < 1000000000L; i++) {
+		if (__atomic_load_n(&arrived, __ATOMIC_ACQUIRE) >= count)
+			return 0;
+	}
+
+	return -ETIMEDOUT;
+}
+
+static void setup_jobs(struct worker_job *jobs, struct region *regs,
+		       int (*func)(void *arg))
+{
+	int i;
+
+	for (i = 0; i < NUM_JOBS; i++) {
+		regs[i].buf = test_buf + i * JOB_SIZE;
+		regs[i].size = JOB_SIZE;
+		regs[i].val = i + 1;
+		jobs[i].func = func;
+		jobs[i].arg = &regs[i];
+		jobs[i].ret = -EINPROGRESS;
+	}
+}
+
+/* Test running jobs in parallel, on memory regions */
+static int lib_test_worker_run(struct unit_test_state *uts)
+{
+	struct worker_job jobs[NUM_JOBS];
+	struct region regs[NUM_JOBS];
+	int i, cpus;
+
+	/* check that the jobs really do run in parallel, one per CPU */
+	cpus = worker_start() + 1;
+	ut_assert(cpus > 1);
+	arrived = 0;
+	for (i = 0; i < cpus; i++) {
+		jobs[i].func = rendezvous_job;
+		jobs[i].arg = &cpus;
+	}
+	ut_assertok(worker_run(jobs, cpus));
+
+	setup_jobs(jobs, regs, fill_job);
+	ut_assertok(worker_run(jobs, NUM_JOBS));
+	for (i = 0; i < NUM_JOBS; i++) {
+		ut_assertok(jobs[i].ret);
+		ut_asserteq(i + 1, test_buf[i * JOB_SIZE]);
+		ut_asserteq(i + 1, test_buf[(i + 1) * JOB_SIZE - 1]);
+	}
+
+	setup_jobs(jobs, regs, verify_job);
+	ut_assertok(worker_run(jobs, NUM_JOBS));
+
+	/* each hash must match the one calculated here */
+	setup_jobs(jobs, regs, hash_job);
+	ut_assertok(worker_run(jobs, NUM_JOBS));
+	for (i = 0; i < NUM_JOBS; i++) {
+		struct region reg = regs[i];
+
+		hash_job(&reg);
+		ut_asserteq_mem(reg.digest, regs[i].digest, SHA256_SUM_LEN);
+	}
+
+	/* an empty batch does nothing */
+	ut_assertok(worker_run(jobs, 0));
+
+	worker_park();
+
+	return 0;
+}
+LIB_TEST(lib_test_worker_run, 0);
+
+/* Test that errors are reported and the pool can be parked and restarted */
+static int lib_test_worker_error(struct unit_test_state *uts)
+{
+	struct worker_job jobs[NUM_JOBS];
+	struct region regs[NUM_JOBS];
+
+	setup_jobs(jobs, regs, fill_job);
+	ut_assertok(worker_run(jobs, NUM_JOBS));
+	worker_park();
+
+	/* the first failure in the array is reported, not the first to finish */
+	setup_jobs(jobs, regs, verify_job);
+	regs[7].val = 0;
+	regs[20].val = 0;
+	regs[3].buf[JOB_SIZE / 2] = 0;
+	ut_asserteq(-EIO, worker_run(jobs, NUM_JOBS));
+	ut_asserteq(-EIO, jobs[3].ret);
+	ut_asserteq(-EIO, jobs[7].ret);
+	ut_asserteq(-EIO, jobs[20].ret);
+	ut_assertok(jobs[4].ret);
+	ut_assertok(jobs[NUM_JOBS - 1].ret);
+
+	worker_park();
+	worker_park();
+
+	return 0;
+}
+LIB_TEST(lib_test_worker_error, 0);
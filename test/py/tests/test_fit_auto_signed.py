@@ -193,3 +193,29 @@ def test_fit_auto_signed(ubman):
         raise ValueError('FIT-3 has no "/image" nor "/configuration" nodes')
 
     fit.check_fit_signed_confgs(key_name, sign_algo)
+
+    # 4 - Sign images using several threads, and check that the FIT matches
+    # the one created with a single thread
+    b_args = ' -d' + kernel_file
+    for i in range(16):
+        dtb_file = f'{tempdir}/dt-{i + 3}.dtb'
+        with open(dtb_file, 'wb') as fd:
+            fd.write(os.urandom(0x10000))
+        b_args += ' -b' + dtb_file
+
+    env = dict(os.environ, SOURCE_DATE_EPOCH='0')
+    utils.run_and_log(ubman, mkimage + ' -fauto' + b_args + s_args + ' -j1 ' +
+                      fit_file, env=env)
+    with open(fit_file, 'rb') as fd:
+        single = fd.read()
+
+    utils.run_and_log(ubman, mkimage + ' -fauto' + b_args + s_args + ' -j4 ' +
+                      fit_file, env=env)
+    with open(fit_file, 'rb') as fd:
+        assert fd.read() == single, 'FIT differs when signed using threads'
+
+    fit = SignedFitHelper(ubman, fit_file)
+    if fit.build_nodes_sets() == 0:
+        raise ValueError('FIT-4 has no "/image" nor "/configuration" nodes')
+
+    fit.check_fit_signed_images(key_name, sign_algo, verifier)
@@ -0,0 +1,99 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+"""Check that mkimage adds a seek table to multi-frame zstd images
+
+This test doesn't run the sandbox. It only checks the host tool 'mkimage'
+"""
+
+import os
+import struct
+
+import pytest
+
+import fit_util
+import utils
+
+ZSTD_SEEK_MAGIC = 0x184d2a5e
+ZSTD_SEEK_FOOTER_MAGIC = 0x8f92eab1
+
+BASE_ITS = '''
+/dts-v1/;
+
+/ {
+        description = "Test zstd seek table";
+        #address-cells = <1>;
+
+        images {
+                kernel-1 {
+                        data = /incbin/("%(kernel)s");
+                        type = "kernel";
+                        arch = "sandbox";
+                        os = "linux";
+                        compression = "zstd";
+                        load = <0x100000>;
+                        entry = <0x100000>;
+                        hash-1 {
+                                algo = "sha256";
+                        };
+                };
+        };
+        configurations {
+                default = "conf-1";
+                conf-1 {
+                        kernel = "kernel-1";
+                };
+        };
+};
+'''
+
+def get_data(ubman, fit, node):
+    """Read the data property of an image node as bytes"""
+    out = utils.run_and_log(ubman, ['fdtget', '-tbx', fit, node, 'data'])
+    return bytes(int(val, 16) for val in out.split())
+
+@pytest.mark.buildconfigspec('fit')
+@pytest.mark.requiredtool('dtc')
+@pytest.mark.requiredtool('fdtget')
+@pytest.mark.requiredtool('zstd')
+def test_fit_zstd_seek_table(ubman):
+    """Test that mkimage appends a seek table listing each zstd frame"""
+    mkimage = os.path.join(ubman.config.build_dir, 'tools/mkimage')
+
+    # compress two pieces separately, so the file has two frames
+    frames = []
+    sizes = []
+    for i in range(2):
+        plain = fit_util.make_kernel(ubman, f'zstd-{i}.bin', f'piece {i}')
+        utils.run_and_log(ubman, ['zstd', '-q', '-f', plain, '-o',
+                                  f'{plain}.zst'])
+        sizes.append(os.path.getsize(plain))
+        with open(f'{plain}.zst', 'rb') as inf:
+            frames.append(inf.read())
+    comp = b''.join(frames)
+    kernel = fit_util.make_fname(ubman, 'zstd-frames.zst')
+    with open(kernel, 'wb') as outf:
+        outf.write(comp)
+
+    its = fit_util.make_its(ubman, BASE_ITS, {'kernel': kernel})
+    fit = fit_util.make_fname(ubman, 'zstd.fit')
+    out = utils.run_and_log(ubman, [mkimage, '-f', its, fit])
+    assert "Image 'kernel-1' has 2 zstd frames" in out
+
+    # the frames are unchanged and the table follows them
+    data = get_data(ubman, fit, '/images/kernel-1')
+    assert data[:len(comp)] == comp
+    table = data[len(comp):]
+    assert len(table) == 8 + 2 * 8 + 9
+    assert struct.unpack('<II', table[:8]) == (ZSTD_SEEK_MAGIC,
+                                               len(table) - 8)
+    for i in range(2):
+        entry = struct.unpack('<II', table[8 + i * 8:16 + i * 8])
+        assert entry == (len(frames[i]), sizes[i])
+    assert struct.unpack('<IBI', table[24:]) == (2, 0,
+                                                 ZSTD_SEEK_FOOTER_MAGIC)
+
+    # a single frame is left alone
+    its = fit_util.make_its(ubman, BASE_ITS, {'kernel': f'{plain}.zst'})
+    out = utils.run_and_log(ubman, [mkimage, '-f', its, fit])
+    assert 'zstd frames' not in out
+    assert get_data(ubman, fit, '/images/kernel-1') == frames[1]
@@ -3,13 +3,14 @@
 # Author: Joao Marcos Costa <joaomarcos.costa@bootlin.com>
 
 import os
+import shutil
 import subprocess
 import pytest
 
 from sqfs_common import SQFS_SRC_DIR, STANDARD_TABLE
 from sqfs_common import generate_sqfs_src_dir, make_all_images
 from sqfs_common import clean_sqfs_src_dir, clean_all_images
-from sqfs_common import check_mksquashfs_version
+from sqfs_common import check_mksquashfs_version, mksquashfs
 
 @pytest.mark.requiredtool('md5sum')
 def original_md5sum(path):
@@ -152,3 +153,63 @@ def test_sqfs_load(ubman):
     # clean test environment
     clean_all_images(build_dir)
     clean_sqfs_src_dir(build_dir)
+
+# name of each file in the cache test; the long names fill the directory table
+CACHE_FNAME = 'a-rather-long-file-name-to-fill-up-the-directory-%04d'
+
+def generate_cache_src_dir(path, count):
+    """ Generates a directory with many small files for the cache test.
+
+    Each file holds a different number of lines, so that the files are packed
+    into fragment blocks at different offsets.
+
+    Args:
+        path: path of the directory to create.
+        count: number of files to create.
+    """
+    os.makedirs(path)
+    for i in range(count):
+        with open(os.path.join(path, CACHE_FNAME % i), 'w') as fd:
+            fd.write('line %d\n' % i * (i % 50 + 1))
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_fs_generic')
+@pytest.mark.buildconfigspec('cmd_squashfs')
+@pytest.mark.buildconfigspec('fs_squashfs')
+@pytest.mark.requiredtool('mksquashfs')
+def test_sqfs_load_cache(ubman):
+    """ Loads files through the metadata and fragment caches.
+
+    Each load resolves the path twice, the second time using the inode and
+    directory tables read the first time. The large image has several times
+    more metadata blocks than CONFIG_SQUASHFS_METADATA_CACHE and its files
+    are spread over several fragment-table blocks. Both must give the right
+    data.
+
+    Args:
+        ubman: provides the means to interact with U-Boot's console.
+    """
+    build_dir = ubman.config.build_dir
+    check_mksquashfs_version()
+
+    for name, count in (('sqfs_cache_small', 10), ('sqfs_cache_large', 6000)):
+        src = os.path.join(build_dir, name + '_src')
+        image_path = os.path.join(build_dir, name)
+        try:
+            generate_cache_src_dir(src, count)
+            mksquashfs(' '.join([src, image_path, '-noappend -b 4096']))
+            ubman.run_command('host bind 0 {}'.format(image_path))
+
+            for i in sorted({0, count // 2, count - 1}):
+                fname = CACHE_FNAME % i
+                size = os.path.getsize(os.path.join(src, fname))
+                out = ubman.run_command('sqfsload host 0 $kernel_addr_r ' +
+                                        fname)
+                assert '%d bytes read' % size in out
+                checksum = uboot_md5sum(ubman, '$kernel_addr_r', hex(size))
+                assert checksum == original_md5sum(os.path.join(src, fname))
+        finally:
+            ubman.run_command('host unbind 0')
+            if os.path.exists(image_path):
+                os.remove(image_path)
+            shutil.rmtree(src, ignore_errors=True)
@@ -0,0 +1,183 @@
+# SPDX-License-Identifier: GPL-2.0+
+# Copyright 2026 Google LLC
+
+"""Test UBIFS reading, including bulk-read, on the sandbox NAND emulator"""
+
+import hashlib
+import os
+import shutil
+import subprocess
+import pytest
+
+UBIFS_SRC_DIR = 'ubifs_src_dir'
+UBIFS_IMAGE_NAME = 'ubifs.img'
+
+# nand1 in test.dts: 4KiB pages and 512KiB erase blocks. Use a VID-header
+# offset of one page, since the emulator cannot program a page twice, which
+# leaves 504KiB of each erase block for data
+MIN_IO_SIZE = 4096
+LEB_SIZE = 0x7e000
+LEB_CNT = 24
+
+UBI_SETUP = [
+    'setenv mtdids nand1=nand1',
+    'setenv mtdparts mtdparts=nand1:128m@2g(ubi)',
+    'ubi part ubi 4096',
+    f'ubi create fs {LEB_CNT * LEB_SIZE:x} dynamic',
+]
+
+def make_files():
+    """Create the file contents to put in the image
+
+    Returns:
+        dict: file name -> contents (bytes)
+    """
+    rand = os.urandom
+
+    return {
+        # Many uncompressible data nodes, spanning more than one LEB, so
+        # bulk-reads stop both at the node limit and at the end of a LEB
+        'big': rand(LEB_SIZE * 2 + 12345),
+
+        # Compressed data nodes, of various lengths
+        'text': b''.join(b'line %d of a compressible file\n' % i
+                         for i in range(20000)),
+
+        # Holes between and after data nodes
+        'sparse': (rand(10000) + bytes(5 * 4096) + rand(4096) +
+                   bytes(3 * 4096)),
+
+        # A single, partial block
+        'small': b'small\n',
+
+        'sub/nested': rand(9000),
+    }
+
+def make_image(build_dir, files):
+    """Make the UBIFS image from a directory holding the files
+
+    Args:
+        build_dir (str): Directory to use
+        files (dict): file name -> contents
+
+    Returns:
+        str: Path to the image
+    """
+    src = os.path.join(build_dir, UBIFS_SRC_DIR)
+    shutil.rmtree(src, ignore_errors=True)
+    for name, data in files.items():
+        path = os.path.join(src, name)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, 'wb') as outf:
+            outf.write(data)
+
+    image = os.path.join(build_dir, UBIFS_IMAGE_NAME)
+    subprocess.run(['mkfs.ubifs', '-m', str(MIN_IO_SIZE), '-e',
+                    str(LEB_SIZE), '-c', str(LEB_CNT), '-x', 'zlib', '-r',
+                    src, '-o', image], check=True)
+    shutil.rmtree(src)
+    return image
+
+def corrupt_node(image, data):
+    """Corrupt the magic of the data node holding the given data
+
+    Args:
+        image (str): Path to the image
+        data (bytes): Start of the data in the node, which must not be
+            compressed
+    """
+    with open(image, 'r+b') as fd:
+        buf = fd.read()
+        offset = buf.find(data) - 48
+        assert buf[offset:offset + 4] == b'\x31\x18\x10\x06'
+        fd.seek(offset)
+        fd.write(b'\0')
+
+def write_volume(ubman, image):
+    """Write the image to a new UBI volume and mount it
+
+    Args:
+        ubman (ConsoleBase): U-Boot console
+        image (str): Path to the image
+    """
+    for cmd in UBI_SETUP:
+        ubman.run_command(cmd)
+    ubman.run_command(f'host load hostfs - $kernel_addr_r {image}')
+    output = ubman.run_command('ubi write $kernel_addr_r fs $filesize')
+    assert 'written to volume fs' in output
+    output = ubman.run_command('ubifsmount ubi0:fs')
+    assert 'Error' not in output
+
+def detach(ubman):
+    """Unmount the file system and detach UBI"""
+    ubman.run_command('ubifsumount')
+    ubman.run_command('ubi detach')
+
+def check_load(ubman, name, data, size=None):
+    """Load a file and check its contents
+
+    Args:
+        ubman (ConsoleBase): U-Boot console
+        name (str): File name
+        data (bytes): Expected contents of the file
+        size (int): Number of bytes to load, None for all
+    """
+    cmd = f'ubifsload $kernel_addr_r {name}'
+    if size:
+        cmd += f' {size:x}'
+        data = data[:size]
+    output = ubman.run_command(cmd)
+    assert 'Error' not in output
+    assert ubman.run_command('printenv filesize') == f'filesize={len(data):x}'
+    output = ubman.run_command(f'md5sum $kernel_addr_r {len(data):x}')
+    assert output.split()[-1] == hashlib.md5(data).hexdigest()
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_ubifs')
+@pytest.mark.buildconfigspec('ubifs_bulk_read')
+@pytest.mark.requiredtool('mkfs.ubifs')
+def test_ubifs_load(ubman):
+    """Test loading files whose data nodes are read with bulk-read"""
+    files = make_files()
+    image = make_image(ubman.config.build_dir, files)
+    try:
+        write_volume(ubman, image)
+        output = ubman.run_command('ubifsls')
+        for name, data in files.items():
+            if '/' not in name:
+                assert f'{len(data):>9}' in output
+        for name, data in files.items():
+            check_load(ubman, name, data)
+
+        # Partial reads end on a partial block, which is read on its own
+        check_load(ubman, 'big', files['big'], 0x12345)
+        check_load(ubman, 'sparse', files['sparse'], 0x5000)
+    finally:
+        detach(ubman)
+        os.remove(image)
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_ubifs')
+@pytest.mark.buildconfigspec('ubifs_bulk_read')
+@pytest.mark.requiredtool('mkfs.ubifs')
+def test_ubifs_load_bad_node(ubman):
+    """Test that a bad data node within a bulk-read is reported"""
+    files = make_files()
+    image = make_image(ubman.config.build_dir, files)
+
+    # Break a data node in the middle of a bulk-read run
+    big = files['big']
+    corrupt_node(image, big[40 * 4096:40 * 4096 + 64])
+    try:
+        write_volume(ubman, image)
+        output = ubman.run_command('ubifsload $kernel_addr_r big')
+        assert "Error reading file 'big'" in output
+
+        # The blocks before the bad node are still read
+        check_load(ubman, 'big', big, 40 * 4096)
+
+        # Other files are not affected
+        check_load(ubman, 'text', files['text'])
+    finally:
+        detach(ubman)
+        os.remove(image)
@@ -0,0 +1,73 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+# Test U-Boot's "nvme read" command with a large region, which is split into
+# multiple commands according to the controller's maximum transfer size (MDTS)
+
+import pytest
+import time
+import utils
+
+"""
+Note: This test relies on boardenv_* containing configuration values to define
+the NVMe region to read. This test will be automatically skipped without this.
+
+For example:
+
+# Read 1GiB from the start of NVMe device 0, checking the CRC32 of the data if
+# 'crc32' is provided and that the read takes no more than 'read_duration_max'
+# seconds, if provided.
+env__nvme_rd_config = {
+    'dev_num': 0,
+    'sector': 0,
+    'count': 0x200000,
+    'crc32': '2d2e8c9c',
+    'read_duration_max': 10,
+}
+"""
+
+def nvme_setup(ubman):
+    f = ubman.config.env.get('env__nvme_rd_config', None)
+    if not f:
+        pytest.skip('No NVMe device to test')
+
+    dev_num = f.get('dev_num', None)
+    if not isinstance(dev_num, int):
+        pytest.skip('No device number specified in env file to read')
+
+    return f
+
+@pytest.mark.buildconfigspec('cmd_nvme')
+def test_nvme_rd(ubman):
+    f = nvme_setup(ubman)
+    dev_num = f['dev_num']
+    sector = f.get('sector', 0)
+    count_sectors = f.get('count', 0x200000)
+    expected_crc32 = f.get('crc32', None)
+    read_duration_max = f.get('read_duration_max', 0)
+
+    count_bytes = count_sectors * 512
+    bcfg = ubman.config.buildconfig
+    has_cmd_crc32 = bcfg.get('config_cmd_crc32', 'n') == 'y'
+    addr = '0x%08x' % utils.find_ram_base(ubman)
+
+    ubman.run_command('nvme scan')
+    output = ubman.run_command('nvme dev %d' % dev_num)
+    assert 'is now current device' in output
+
+    tstart = time.time()
+    output = ubman.run_command('nvme read %s %x %x' % (addr, sector,
+                                                       count_sectors))
+    tend = time.time()
+    assert '%d blocks read: OK' % count_sectors in output
+
+    if expected_crc32:
+        if has_cmd_crc32:
+            output = ubman.run_command('crc32 %s 0x%x' % (addr, count_bytes))
+            assert expected_crc32 in output
+        else:
+            ubman.log.warning('CONFIG_CMD_CRC32 != y: Skipping check')
+
+    elapsed = tend - tstart
+    ubman.log.info('Reading %d bytes took %f seconds' % (count_bytes, elapsed))
+    if read_duration_max:
+        assert elapsed <= (read_duration_max - 0.01)
@@ -333,3 +333,49 @@ def test_trace(ubman):
     # Check that the trace buffer can be wiped
     numcalls = wipe_and_collect_trace(ubman)
     assert numcalls == 0
+
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('trace_sample')
+def test_trace_sample(ubman):
+    """Test we can collect statistical samples and create a flamegraph"""
+
+    if not os.path.exists(TMPDIR):
+        os.mkdir(TMPDIR)
+    proftool = os.path.join(ubman.config.build_dir, 'tools', 'proftool')
+    map_fname = os.path.join(ubman.config.build_dir, 'System.map')
+    fname = os.path.join(TMPDIR, 'samples')
+    trace_fg = os.path.join(TMPDIR, 'samples.fg')
+
+    # Burn some CPU time in a known function
+    ubman.run_command('trace pause; trace wipe; trace resume')
+    ubman.run_command('for i in 1 2 3 4 5 6 7 8; do crc32 0 4000000; done')
+    ubman.run_command('trace pause')
+
+    out = ubman.run_command('trace stats')
+    lines = [line.split(maxsplit=1) for line in out.splitlines() if line]
+    vals = {key: val.replace(',', '') for val, key in lines}
+    assert int(vals['samples taken']) > 0
+
+    addr = 0x02000000
+    size = 0x02000000
+    out = ubman.run_command(f'trace samples {addr:x} {size:x}')
+    assert 'Sample list dumped' in out
+    ubman.run_command(
+        'host save hostfs - %x %s ${profoffset}' % (addr, fname))
+
+    utils.run_and_log(
+        ubman, [proftool, '-t', fname, '-o', trace_fg, '-m', map_fname,
+                'dump-flamegraph', '-f', 'samples'])
+
+    # Most of the time should be spent calculating the CRC
+    total = 0
+    crc = 0
+    with open(trace_fg, 'r') as fd:
+        for line in fd:
+            stack, count = line.strip().rsplit(maxsplit=1)
+            total += int(count)
+            if 'crc32' in stack:
+                crc += int(count)
+    assert total
+    assert crc * 2 > total
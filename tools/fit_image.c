@@ -24,6 +24,208 @@
 
 static struct legacy_img_hdr header;
 
+/* zstd frame magic numbers and seek-table layout, see lib/zstd/seekable.c */
+#define ZSTD_FRAME_MAGIC	0xfd2fb528
+#define ZSTD_SKIP_MAGIC		0x184d2a50
+#define ZSTD_SKIP_MASK		0xfffffff0
+#define ZSTD_SEEK_MAGIC		0x184d2a5e
+#define ZSTD_SEEK_FOOTER_MAGIC	0x8f92eab1
+#define ZSTD_SEEK_HDR_SIZE	8
+#define ZSTD_SEEK_ENTRY_SIZE	8
+#define ZSTD_SEEK_FOOTER_SIZE	9
+
+static uint64_t get_le(const uint8_t *buf, int len)
+{
+	uint64_t val = 0;
+
+	while (len--)
+		val = val << 8 | buf[len];
+
+	return val;
+}
+
+static void put_le32(uint8_t *buf, uint32_t val)
+{
+	int i;
+
+	for (i = 0; i < 4; i++, val >>= 8)
+		buf[i] = val;
+}
+
+/**
+ * zstd_frame_sizes() - Find the size of a zstd frame, by walking its blocks
+ *
+ * @buf: Start of the frame
+ * @len: Number of bytes available at @buf
+ * @comp_sizep: Returns the size of the compressed frame
+ * @sizep: Returns the size of the decompressed data (0 for a skippable frame)
+ * Return: 0 if OK, -ENOENT if the frame header does not record the
+ *	decompressed size, -EINVAL if the frame is corrupt
+ */
+static int zstd_frame_sizes(const uint8_t *buf, size_t len,
+			    uint64_t *comp_sizep, uint64_t *sizep)
+{
+	static const int dict_id_size[] = { 0, 1, 2, 4 };
+	uint32_t magic, hdr;
+	size_t pos, fcs_size;
+	bool single, last;
+	uint8_t fhd;
+
+	if (len < 8)
+		return -EINVAL;
+	magic = get_le(buf, 4);
+	if ((magic & ZSTD_SKIP_MASK) == ZSTD_SKIP_MAGIC) {
+		*comp_sizep = 8 + get_le(buf + 4, 4);
+		*sizep = 0;
+		return *comp_sizep <= len ? 0 : -EINVAL;
+	}
+	if (magic != ZSTD_FRAME_MAGIC)
+		return -EINVAL;
+
+	fhd = buf[4];
+	single = fhd & 0x20;
+	pos = 5 + !single + dict_id_size[fhd & 3];
+	fcs_size = fhd >> 6 ? 1 << (fhd >> 6) : single;
+	if (!fcs_size)
+		return -ENOENT;
+	if (pos + fcs_size > len)
+		return -EINVAL;
+	*sizep = get_le(buf + pos, fcs_size) + (fcs_size == 2 ? 256 : 0);
+	pos += fcs_size;
+
+	do {
+		if (pos + 3 > len)
+			return -EINVAL;
+		hdr = get_le(buf + pos, 3);
+		pos += 3;
+		last = hdr & 1;
+		switch ((hdr >> 1) & 3) {
+		case 1:		/* RLE: a single byte, repeated */
+			pos++;
+			break;
+		case 3:
+			return -EINVAL;
+		default:
+			pos += hdr >> 3;
+			break;
+		}
+	} while (!last);
+	if (fhd & 4)
+		pos += 4;	/* content checksum */
+	if (pos > len)
+		return -EINVAL;
+	*comp_sizep = pos;
+
+	return 0;
+}
+
+/**
+ * fit_image_add_seek_table() - Add a seek table to multi-frame zstd data
+ *
+ * Data made up of several independent frames can be decompressed in parallel
+ * by U-Boot, if it has a seek table listing the frames. Add one, unless the
+ * data is a single frame or already has a table.
+ *
+ * @itl: Image-tool info
+ * @fit: FIT to update
+ * @noffset: Image node
+ * Return: 0 if OK (including if nothing was done), -ENOSPC if the FIT needs
+ *	more space, other -ve on error
+ */
+static int fit_image_add_seek_table(struct imgtool *itl, void *fit,
+				    int noffset)
+{
+	const char *name = fit_get_name(fit, noffset, NULL);
+	uint64_t comp_size, size;
+	uint8_t *buf, *table;
+	size_t len, pos, table_size;
+	const void *data;
+	int count, ret;
+
+	if (fit_image_get_emb_data(fit, noffset, &data, &len))
+		return 0;
+	if (len >= ZSTD_SEEK_FOOTER_SIZE &&
+	    get_le((const uint8_t *)data + len - 4, 4) ==
+	    ZSTD_SEEK_FOOTER_MAGIC)
+		return 0;
+
+	/* the table cannot be bigger than this, since frames are >= 8 bytes */
+	table_size = ZSTD_SEEK_HDR_SIZE + len / 8 * ZSTD_SEEK_ENTRY_SIZE +
+		ZSTD_SEEK_FOOTER_SIZE;
+	buf = malloc(len + table_size);
+	if (!buf)
+		return -ENOMEM;
+	memcpy(buf, data, len);
+	table = buf + len + ZSTD_SEEK_HDR_SIZE;
+
+	for (pos = 0, count = 0; pos < len; pos += comp_size, count++) {
+		ret = zstd_frame_sizes(buf + pos, len - pos, &comp_size, &size);
+		if (!ret && size > UINT32_MAX)
+			ret = -E2BIG;
+		if (ret) {
+			/* the image is still valid, just not seekable */
+			if (ret != -EINVAL)
+				printf("%s: Image '%s' is not seekable: frame at %zx has %s\n",
+				       itl->cmdname, name, pos,
+				       ret == -ENOENT ? "no content size" :
+				       "too much data");
+			free(buf);
+			return 0;
+		}
+		put_le32(table, comp_size);
+		put_le32(table + 4, size);
+		table += ZSTD_SEEK_ENTRY_SIZE;
+	}
+	if (count < 2) {
+		free(buf);
+		return 0;
+	}
+
+	put_le32(table, count);
+	table[4] = 0;
+	put_le32(table + 5, ZSTD_SEEK_FOOTER_MAGIC);
+	table += ZSTD_SEEK_FOOTER_SIZE;
+	table_size = table - (buf + len);
+	put_le32(buf + len, ZSTD_SEEK_MAGIC);
+	put_le32(buf + len + 4, table_size - ZSTD_SEEK_HDR_SIZE);
+
+	ret = fdt_setprop(fit, noffset, FIT_DATA_PROP, buf, len + table_size);
+	free(buf);
+	if (ret)
+		return ret == -FDT_ERR_NOSPACE ? -ENOSPC : -EIO;
+	printf("%s: Image '%s' has %d zstd frames, so a %zu-byte seek table was appended\n",
+	       itl->cmdname, name, count, table_size);
+
+	return 0;
+}
+
+/**
+ * fit_add_seek_tables() - Add seek tables to all multi-frame zstd images
+ *
+ * @itl: Image-tool info
+ * @fit: FIT to update
+ * Return: 0 if OK, -ENOSPC if the FIT needs more space, other -ve on error
+ */
+static int fit_add_seek_tables(struct imgtool *itl, void *fit)
+{
+	int images, noffset, ret;
+	uint8_t comp;
+
+	images = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	if (images < 0)
+		return 0;
+	fdt_for_each_subnode(noffset, fit, images) {
+		if (fit_image_get_comp(fit, noffset, &comp) ||
+		    comp != IH_COMP_ZSTD)
+			continue;
+		ret = fit_image_add_seek_table(itl, fit, noffset);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
 static int fit_add_file_data(struct imgtool *itl, size_t size_inc,
 			     const char *tmpfile)
 {
@@ -64,12 +266,17 @@ static int fit_add_file_data(struct imgtool *itl, size_t size_inc,
 	if (CONFIG_IS_ENABLED(FIT_SIGNATURE) && !ret)
 		ret = fit_pre_load_data(itl->keydir, dest_blob, ptr);
 
+	/* before hashing / encrypting, since this changes the image data */
+	if (!ret)
+		ret = fit_add_seek_tables(itl, ptr);
+
 	if (!ret) {
 		ret = fit_cipher_data(itl->keydir, dest_blob, ptr,
 				      itl->comment,
 				      itl->require_keys,
 				      itl->engine_id,
-				      itl->cmdname);
+				      itl->cmdname,
+				      itl->jobs);
 	}
 
 	if (!ret) {
@@ -80,6 +287,7 @@ static int fit_add_file_data(struct imgtool *itl, size_t size_inc,
 						itl->engine_id,
 						itl->cmdname,
 						itl->algo_name,
+						itl->jobs,
 						&itl->summary);
 	}
 
@@ -12,6 +12,7 @@
 #include <bootm.h>
 #include <fdt_region.h>
 #include <image.h>
+#include <pthread.h>
 #include <version.h>
 
 #if CONFIG_IS_ENABLED(FIT_SIGNATURE)
@@ -24,6 +25,163 @@
 #include <openssl/err.h>
 #endif
 
+/**
+ * enum fit_job_type - Type of work to do for a node in a FIT
+ *
+ * @FIT_JOB_NONE: Nothing to do
+ * @FIT_JOB_HASH: Calculate the hash of an image
+ * @FIT_JOB_SIG: Sign an image
+ * @FIT_JOB_CIPHER: Encrypt an image
+ */
+enum fit_job_type {
+	FIT_JOB_NONE,
+	FIT_JOB_HASH,
+	FIT_JOB_SIG,
+	FIT_JOB_CIPHER,
+};
+
+/**
+ * struct fit_job - Work to do for a hash, signature or cipher node of an image
+ *
+ * Each job is done in two parts. First the value is calculated, which only
+ * reads the FIT, so jobs can run in parallel. Then the results are written to
+ * the FIT one at a time, in the order of the nodes, so that the output does
+ * not depend on the number of threads.
+ *
+ * The offsets and pointers into the FIT are only valid until the first result
+ * is written, since that moves things around.
+ *
+ * @type: Type of job
+ * @image_name: Name of the image node
+ * @image_noffset: Offset of the image node
+ * @noffset: Offset of the hash, signature or cipher node
+ * @data: Image data
+ * @size: Size of image data in bytes
+ * @ret: Result of the calculation: 0 if OK, -ve on error
+ * @value: Hash value (FIT_JOB_HASH)
+ * @value_len: Length of @value in bytes
+ * @sig: Signature, allocated (FIT_JOB_SIG)
+ * @sig_len: Length of @sig in bytes
+ * @sign_info: Signing information (FIT_JOB_SIG)
+ * @cipher_info: Cipher information (FIT_JOB_CIPHER)
+ * @ciphered: Encrypted data, allocated (FIT_JOB_CIPHER)
+ * @ciphered_len: Length of @ciphered in bytes
+ */
+struct fit_job {
+	enum fit_job_type type;
+	const char *image_name;
+	int image_noffset;
+	int noffset;
+	const void *data;
+	size_t size;
+	int ret;
+	uint8_t value[FIT_MAX_HASH_LEN];
+	int value_len;
+	uint8_t *sig;
+	uint sig_len;
+	struct image_sign_info sign_info;
+	struct image_cipher_info cipher_info;
+	unsigned char *ciphered;
+	int ciphered_len;
+};
+
+/**
+ * struct fit_jobs - List of jobs for the images in a FIT
+ *
+ * @fit: FIT being processed
+ * @keydir: Directory containing keys (or NULL)
+ * @keyfile: Filename of private key (or NULL)
+ * @require_keys: Mark all keys as 'required'
+ * @engine_id: Engine to use for signing (or NULL)
+ * @algo_name: Algorithm name, or NULL if to be read from FIT
+ * @job: Array of jobs
+ * @count: Number of jobs in @job
+ * @size: Number of jobs allocated in @job
+ * @next: Next job to calculate (protected by @lock)
+ * @pos: Next job to write to the FIT
+ * @lock: Lock for @next
+ */
+struct fit_jobs {
+	void *fit;
+	const char *keydir;
+	const char *keyfile;
+	int require_keys;
+	const char *engine_id;
+	const char *algo_name;
+	struct fit_job *job;
+	int count;
+	int size;
+	int next;
+	int pos;
+	pthread_mutex_t lock;
+};
+
+static void fit_jobs_init(struct fit_jobs *jobs, void *fit, const char *keydir,
+			  const char *keyfile, int require_keys,
+			  const char *engine_id, const char *algo_name)
+{
+	memset(jobs, '\0', sizeof(*jobs));
+	jobs->fit = fit;
+	jobs->keydir = keydir;
+	jobs->keyfile = keyfile;
+	jobs->require_keys = require_keys;
+	jobs->engine_id = engine_id;
+	jobs->algo_name = algo_name;
+}
+
+static void fit_jobs_uninit(struct fit_jobs *jobs)
+{
+	int i;
+
+	for (i = 0; i < jobs->count; i++) {
+		struct fit_job *job = &jobs->job[i];
+
+		free(job->sig);
+		free((void *)job->sign_info.name);
+		free(job->ciphered);
+		free((void *)job->cipher_info.key);
+		free((void *)job->cipher_info.iv);
+	}
+	free(jobs->job);
+}
+
+/**
+ * fit_jobs_add() - Add a new job to the list
+ *
+ * @jobs:	list of jobs
+ * @type:	type of job
+ * @image_noffset: image node to process
+ * @noffset:	hash, signature or cipher node within the image node
+ * Return: new job, or NULL if out of memory
+ */
+static struct fit_job *fit_jobs_add(struct fit_jobs *jobs,
+				    enum fit_job_type type, int image_noffset,
+				    int noffset)
+{
+	struct fit_job *job;
+
+	if (jobs->count == jobs->size) {
+		int size = jobs->size ? jobs->size * 2 : 16;
+
+		job = realloc(jobs->job, size * sizeof(*job));
+		if (!job) {
+			fprintf(stderr, "Out of memory for FIT jobs\n");
+			return NULL;
+		}
+		jobs->job = job;
+		jobs->size = size;
+	}
+
+	job = &jobs->job[jobs->count++];
+	memset(job, '\0', sizeof(*job));
+	job->type = type;
+	job->image_name = fit_get_name(jobs->fit, image_noffset, NULL);
+	job->image_noffset = image_noffset;
+	job->noffset = noffset;
+
+	return job;
+}
+
 /**
  * fit_set_hash_value - set hash value in requested has node
  * @fit: pointer to the FIT format image header
@@ -55,45 +213,63 @@ static int fit_set_hash_value(void *fit, int noffset, uint8_t *value,
 }
 
 /**
- * fit_image_process_hash - Process a single subnode of the images/ node
+ * fit_image_calc_hash() - Calculate the hash for a hash node
  *
- * Check each subnode and process accordingly. For hash nodes we generate
- * a hash of the supplied data and store it in the node.
+ * This does not change the FIT, so can run alongside other jobs
  *
  * @fit:	pointer to the FIT format image header
- * @image_name:	name of image being processed (used to display errors)
- * @noffset:	subnode offset
- * @data:	data to process
- * @size:	size of data in bytes
- * Return: 0 if ok, -1 on error
+ * @job:	job to process; the hash is written to job->value
+ * Return: 0 if ok, -ve on error
  */
-static int fit_image_process_hash(void *fit, const char *image_name,
-		int noffset, const void *data, size_t size)
+static int fit_image_calc_hash(const void *fit, struct fit_job *job)
 {
-	uint8_t value[FIT_MAX_HASH_LEN];
 	const char *node_name;
-	int value_len;
 	const char *algo;
-	int ret;
 
-	node_name = fit_get_name(fit, noffset, NULL);
+	node_name = fit_get_name(fit, job->noffset, NULL);
 
-	if (fit_image_hash_get_algo(fit, noffset, &algo)) {
+	if (fit_image_hash_get_algo(fit, job->noffset, &algo)) {
 		fprintf(stderr,
 			"Can't get hash algo property for '%s' hash node in '%s' image node\n",
-			node_name, image_name);
+			node_name, job->image_name);
 		return -ENOENT;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	if (calculate_hash(job->data, job->size, algo, job->value,
+			   &job->value_len)) {
 		fprintf(stderr,
 			"Unsupported hash algorithm (%s) for '%s' hash node in '%s' image node\n",
-			algo, node_name, image_name);
+			algo, node_name, job->image_name);
 		return -EPROTONOSUPPORT;
 	}
 
-	ret = fit_set_hash_value(fit, noffset, value, value_len);
+	return 0;
+}
+
+/**
+ * fit_image_process_hash - Process a single subnode of the images/ node
+ *
+ * Check each subnode and process accordingly. For hash nodes we store the
+ * hash calculated by fit_image_calc_hash() in the node.
+ *
+ * @fit:	pointer to the FIT format image header
+ * @image_name:	name of image being processed (used to display errors)
+ * @noffset:	subnode offset
+ * @job:	job containing the calculated hash
+ * Return: 0 if ok, -1 on error
+ */
+static int fit_image_process_hash(void *fit, const char *image_name,
+				  int noffset, struct fit_job *job)
+{
+	const char *node_name;
+	int ret;
+
+	if (job->ret)
+		return job->ret;
+
+	ret = fit_set_hash_value(fit, noffset, job->value, job->value_len);
 	if (ret) {
+		node_name = fit_get_name(fit, noffset, NULL);
 		fprintf(stderr, "Can't set hash value for '%s' hash node in '%s' image node\n",
 			node_name, image_name);
 		return ret;
@@ -211,58 +387,78 @@ static int fit_image_setup_sig(struct image_sign_info *info,
 }
 
 /**
- * fit_image_process_sig- Process a single subnode of the images/ node
+ * fit_image_calc_sig() - Sign the data for a signature node
  *
- * Check each subnode and process accordingly. For signature nodes we
- * generate a signed hash of the supplied data and store it in the node.
+ * This does not change the FIT, so can run alongside other jobs
  *
- * @keydir:	Directory containing keys to use for signing
- * @keydest:	Destination FDT blob to write public keys into (NULL if none)
- * @fit:	pointer to the FIT format image header
- * @image_name:	name of image being processed (used to display errors)
- * @noffset:	subnode offset
- * @data:	data to process
- * @size:	size of data in bytes
- * @comment:	Comment to add to signature nodes
- * @require_keys: Mark all keys as 'required'
- * @engine_id:	Engine to use for signing
- * Return: keydest node if @keydest is non-NULL, else 0 if none; -ve error code
- *	on failure
+ * @jobs:	list of jobs, containing the signing options
+ * @job:	job to process; the signature is written to job->sig
+ * Return: 0 if ok, -ENOENT if the key is missing, other -ve value on error
  */
-static int fit_image_process_sig(const char *keydir, const char *keyfile,
-		void *keydest, void *fit, const char *image_name,
-		int noffset, const void *data, size_t size,
-		const char *comment, int require_keys, const char *engine_id,
-		const char *cmdname, const char *algo_name)
+static int fit_image_calc_sig(struct fit_jobs *jobs, struct fit_job *job)
 {
-	struct image_sign_info info;
+	struct image_sign_info *info = &job->sign_info;
 	struct image_region region;
 	const char *node_name;
-	uint8_t *value;
-	uint value_len;
 	int ret;
 
-	if (fit_image_setup_sig(&info, keydir, keyfile, fit, image_name,
-				noffset, require_keys ? "image" : NULL,
-				engine_id, algo_name))
+	if (fit_image_setup_sig(info, jobs->keydir, jobs->keyfile, jobs->fit,
+				job->image_name, job->noffset,
+				jobs->require_keys ? "image" : NULL,
+				jobs->engine_id, jobs->algo_name))
 		return -1;
 
-	node_name = fit_get_name(fit, noffset, NULL);
-	region.data = data;
-	region.size = size;
-	ret = info.crypto->sign(&info, &region, 1, &value, &value_len);
+	node_name = fit_get_name(jobs->fit, job->noffset, NULL);
+	region.data = job->data;
+	region.size = job->size;
+	ret = info->crypto->sign(info, &region, 1, &job->sig, &job->sig_len);
 	if (ret) {
 		fprintf(stderr, "Failed to sign '%s' signature node in '%s' image node: %d\n",
-			node_name, image_name, ret);
+			node_name, job->image_name, ret);
 
 		/* We allow keys to be missing */
 		if (ret == -ENOENT)
-			return 0;
+			return -ENOENT;
 		return -1;
 	}
 
-	ret = fit_image_write_sig(fit, noffset, value, value_len, comment,
-			NULL, 0, cmdname, algo_name);
+	return 0;
+}
+
+/**
+ * fit_image_process_sig- Process a single subnode of the images/ node
+ *
+ * Check each subnode and process accordingly. For signature nodes we store
+ * the signature from fit_image_calc_sig() in the node.
+ *
+ * @keydest:	Destination FDT blob to write public keys into (NULL if none)
+ * @fit:	pointer to the FIT format image header
+ * @image_name:	name of image being processed (used to display errors)
+ * @noffset:	subnode offset
+ * @job:	job containing the signature
+ * @comment:	Comment to add to signature nodes
+ * @algo_name:	Algorithm name, or NULL if to be read from FIT
+ * Return: keydest node if @keydest is non-NULL, else 0 if none; -ve error code
+ *	on failure
+ */
+static int fit_image_process_sig(void *keydest, void *fit,
+		const char *image_name, int noffset, struct fit_job *job,
+		const char *comment, const char *cmdname,
+		const char *algo_name)
+{
+	struct image_sign_info *info = &job->sign_info;
+	const char *node_name;
+	int ret;
+
+	/* We allow keys to be missing */
+	if (job->ret == -ENOENT)
+		return 0;
+	if (job->ret)
+		return job->ret;
+
+	node_name = fit_get_name(fit, noffset, NULL);
+	ret = fit_image_write_sig(fit, noffset, job->sig, job->sig_len,
+				  comment, NULL, 0, cmdname, algo_name);
 	if (ret) {
 		if (ret == -FDT_ERR_NOSPACE)
 			return -ENOSPC;
@@ -271,10 +467,11 @@ static int fit_image_process_sig(const char *keydir, const char *keyfile,
 			node_name, image_name, fdt_strerror(ret));
 		return -1;
 	}
-	free(value);
 
 	/* Get keyname again, as FDT has changed and invalidated our pointer */
-	info.keyname = fdt_getprop(fit, noffset, FIT_KEY_HINT, NULL);
+	info->fit = fit;
+	info->node_offset = noffset;
+	info->keyname = fdt_getprop(fit, noffset, FIT_KEY_HINT, NULL);
 
 	/*
 	 * Write the public key into the supplied FDT file; this might fail
@@ -282,7 +479,7 @@ static int fit_image_process_sig(const char *keydir, const char *keyfile,
 	 * size values
 	 */
 	if (keydest) {
-		ret = info.crypto->add_verify_data(&info, keydest);
+		ret = info->crypto->add_verify_data(info, keydest);
 		if (ret < 0) {
 			fprintf(stderr,
 				"Failed to add verification data for '%s' signature node in '%s' image node\n",
@@ -524,28 +721,49 @@ int fit_image_write_cipher(void *fit, int image_noffset, int noffset,
 	return ret;
 }
 
-static int
-fit_image_process_cipher(const char *keydir, void *keydest, void *fit,
-			 const char *image_name, int image_noffset,
-			 int node_noffset, const void *data, size_t size,
-			 const char *cmdname)
+/**
+ * fit_image_calc_cipher() - Encrypt the data for a cipher node
+ *
+ * This does not change the FIT, so can run alongside other jobs
+ *
+ * @jobs:	list of jobs, containing the key directory
+ * @job:	job to process; the encrypted data is written to job->ciphered
+ * Return: 0 if ok, -ve on error
+ */
+static int fit_image_calc_cipher(struct fit_jobs *jobs, struct fit_job *job)
 {
-	struct image_cipher_info info;
-	unsigned char *data_ciphered = NULL;
-	int data_ciphered_len;
+	struct image_cipher_info *info = &job->cipher_info;
 	int ret;
 
-	memset(&info, 0, sizeof(info));
-
-	ret = fit_image_setup_cipher(&info, keydir, fit, image_name,
-				     image_noffset, node_noffset);
+	ret = fit_image_setup_cipher(info, jobs->keydir, jobs->fit,
+				     job->image_name, job->image_noffset,
+				     job->noffset);
 	if (ret)
-		goto out;
+		return ret;
 
-	ret = info.cipher->encrypt(&info, data, size,
-				    &data_ciphered, &data_ciphered_len);
-	if (ret)
-		goto out;
+	return info->cipher->encrypt(info, job->data, job->size,
+				     &job->ciphered, &job->ciphered_len);
+}
+
+static int
+fit_image_process_cipher(void *keydest, void *fit, const char *image_name,
+			 int image_noffset, int node_noffset,
+			 struct fit_job *job)
+{
+	struct image_cipher_info *info = &job->cipher_info;
+	char *algo_name;
+	int ret;
+
+	if (job->ret)
+		return job->ret;
+
+	/* Get the names again, as FDT may have changed since they were read */
+	fit_image_cipher_get_algo(fit, node_noffset, &algo_name);
+	info->name = algo_name;
+	info->keyname = fdt_getprop(fit, node_noffset, FIT_KEY_HINT, NULL);
+	info->ivname = fdt_getprop(fit, node_noffset, "iv-name-hint", NULL);
+	info->fit = fit;
+	info->node_noffset = node_noffset;
 
 	/*
 	 * Write the public key into the supplied FDT file; this might fail
@@ -553,50 +771,36 @@ fit_image_process_cipher(const char *keydir, void *keydest, void *fit,
 	 * size values
 	 * And, if needed, write the iv in the FIT file
 	 */
-	if (keydest || (!keydest && !info.ivname)) {
-		ret = info.cipher->add_cipher_data(&info, keydest, fit, node_noffset);
+	if (keydest || (!keydest && !info->ivname)) {
+		ret = info->cipher->add_cipher_data(info, keydest, fit,
+						    node_noffset);
 		if (ret) {
 			fprintf(stderr,
 				"Failed to add verification data for cipher '%s' in image '%s'\n",
-				info.keyname, image_name);
-			goto out;
+				info->keyname, image_name);
+			return ret;
 		}
 	}
 
-	ret = fit_image_write_cipher(fit, image_noffset, node_noffset,
-				     data, size,
-				     data_ciphered, data_ciphered_len);
-
- out:
-	free(data_ciphered);
-	free((void *)info.key);
-	free((void *)info.iv);
-	return ret;
+	return fit_image_write_cipher(fit, image_noffset, node_noffset,
+				      job->data, job->size, job->ciphered,
+				      job->ciphered_len);
 }
 
-int fit_image_cipher_data(const char *keydir, void *keydest,
-			  void *fit, int image_noffset, const char *comment,
-			  int require_keys, const char *engine_id,
-			  const char *cmdname)
+/**
+ * fit_image_cipher_node() - Find the cipher node of an image to be encrypted
+ *
+ * @keydir:	Directory containing keys
+ * @fit:	pointer to the FIT format image header
+ * @image_noffset: Image node to check
+ * Return: offset of the cipher node, -FDT_ERR_NOTFOUND if there is nothing to
+ *	do for this image, or -1 on error
+ */
+static int fit_image_cipher_node(const char *keydir, const void *fit,
+				 int image_noffset)
 {
-	const char *image_name;
-	const void *data;
-	size_t size;
 	int cipher_node_offset, len;
 
-	/* Get image name */
-	image_name = fit_get_name(fit, image_noffset, NULL);
-	if (!image_name) {
-		fprintf(stderr, "Can't get image name\n");
-		return -1;
-	}
-
-	/* Get image data and data length */
-	if (fit_image_get_emb_data(fit, image_noffset, &data, &size)) {
-		fprintf(stderr, "Can't get image data/size\n");
-		return -1;
-	}
-
 	/*
 	 * Don't cipher ciphered data.
 	 *
@@ -605,7 +809,7 @@ int fit_image_cipher_data(const char *keydir, void *keydest,
 	 * run multiple times on a FIT image.
 	 */
 	if (fdt_getprop(fit, image_noffset, "data-size-unciphered", &len))
-		return 0;
+		return -FDT_ERR_NOTFOUND;
 	if (len != -FDT_ERR_NOTFOUND) {
 		fprintf(stderr, "Failure testing for data-size-unciphered\n");
 		return -1;
@@ -615,15 +819,147 @@ int fit_image_cipher_data(const char *keydir, void *keydest,
 	cipher_node_offset = fdt_subnode_offset(fit, image_noffset,
 						FIT_CIPHER_NODENAME);
 	if (cipher_node_offset == -FDT_ERR_NOTFOUND)
-		return 0;
+		return -FDT_ERR_NOTFOUND;
 	if (cipher_node_offset < 0) {
 		fprintf(stderr, "Failure getting cipher node\n");
 		return -1;
 	}
 	if (!IMAGE_ENABLE_ENCRYPT || !keydir)
+		return -FDT_ERR_NOTFOUND;
+
+	return cipher_node_offset;
+}
+
+/**
+ * fit_image_add_cipher_job() - Add a job to encrypt an image, if needed
+ *
+ * @jobs:	list of jobs to add to
+ * @image_noffset: Image node to process
+ * Return: 0 if OK, -ve on error
+ */
+static int fit_image_add_cipher_job(struct fit_jobs *jobs, int image_noffset)
+{
+	struct fit_job *job;
+	int cipher_node_offset;
+
+	const void *data;
+	size_t size;
+
+	/* Get image name */
+	if (!fit_get_name(jobs->fit, image_noffset, NULL)) {
+		fprintf(stderr, "Can't get image name\n");
+		return -1;
+	}
+
+	/* Get image data and data length */
+	if (fit_image_get_emb_data(jobs->fit, image_noffset, &data, &size)) {
+		fprintf(stderr, "Can't get image data/size\n");
+		return -1;
+	}
+
+	cipher_node_offset = fit_image_cipher_node(jobs->keydir, jobs->fit,
+						   image_noffset);
+	if (cipher_node_offset == -FDT_ERR_NOTFOUND)
 		return 0;
-	return fit_image_process_cipher(keydir, keydest, fit, image_name,
-		image_noffset, cipher_node_offset, data, size, cmdname);
+	if (cipher_node_offset < 0)
+		return -1;
+
+	job = fit_jobs_add(jobs, FIT_JOB_CIPHER, image_noffset,
+			   cipher_node_offset);
+	if (!job)
+		return -ENOMEM;
+	job->data = data;
+	job->size = size;
+
+	return 0;
+}
+
+/**
+ * fit_image_cipher_data() - Write the encrypted data for an image
+ *
+ * @jobs:	list of jobs, where the calculations have been done
+ * @keydest:	FDT blob to write public keys into (NULL if none)
+ * @image_noffset: Image node to process
+ * Return: 0 if OK, -ve on error
+ */
+static int fit_image_cipher_data(struct fit_jobs *jobs, void *keydest,
+				 int image_noffset)
+{
+	void *fit = jobs->fit;
+	int cipher_node_offset;
+
+	cipher_node_offset = fit_image_cipher_node(jobs->keydir, fit,
+						   image_noffset);
+	if (cipher_node_offset == -FDT_ERR_NOTFOUND)
+		return 0;
+	if (cipher_node_offset < 0)
+		return -1;
+
+	return fit_image_process_cipher(keydest, fit,
+					fit_get_name(fit, image_noffset, NULL),
+					image_noffset, cipher_node_offset,
+					&jobs->job[jobs->pos++]);
+}
+
+/**
+ * fit_image_node_job() - Get the type of job needed for a subnode of an image
+ *
+ * Multiple hash nodes require unique unit node names, e.g. hash-1, hash-2,
+ * signature-1, etc.
+ *
+ * @jobs:	list of jobs, containing the signing options
+ * @noffset:	Subnode of the image node
+ * Return: type of job, FIT_JOB_NONE if nothing is needed
+ */
+static enum fit_job_type fit_image_node_job(struct fit_jobs *jobs, int noffset)
+{
+	const char *node_name;
+
+	/* Check subnode name, must be equal to "hash" or "signature" */
+	node_name = fit_get_name(jobs->fit, noffset, NULL);
+	if (!strncmp(node_name, FIT_HASH_NODENAME, strlen(FIT_HASH_NODENAME)))
+		return FIT_JOB_HASH;
+	if (IMAGE_ENABLE_SIGN && (jobs->keydir || jobs->keyfile) &&
+	    !strncmp(node_name, FIT_SIG_NODENAME, strlen(FIT_SIG_NODENAME)))
+		return FIT_JOB_SIG;
+
+	return FIT_JOB_NONE;
+}
+
+/**
+ * fit_image_add_verification_jobs() - Add jobs to hash/sign an image
+ *
+ * @jobs:	list of jobs to add to
+ * @image_noffset: Image node to process
+ * Return: 0 if OK, -ve on error
+ */
+static int fit_image_add_verification_jobs(struct fit_jobs *jobs,
+					   int image_noffset)
+{
+	const void *data;
+	size_t size;
+	int noffset;
+
+	/* Get image data and data length */
+	if (fit_image_get_emb_data(jobs->fit, image_noffset, &data, &size)) {
+		fprintf(stderr, "Can't get image data/size\n");
+		return -1;
+	}
+
+	fdt_for_each_subnode(noffset, jobs->fit, image_noffset) {
+		enum fit_job_type type = fit_image_node_job(jobs, noffset);
+		struct fit_job *job;
+
+		if (type == FIT_JOB_NONE)
+			continue;
+		job = fit_jobs_add(jobs, type, image_noffset, noffset);
+		if (!job)
+			return -ENOMEM;
+		job->data = data;
+		job->size = size;
+	}
+
+	return 0;
 }
 
 /**
@@ -650,60 +986,45 @@ int fit_image_cipher_data(const char *keydir, void *keydest,
  *     |- algo = "sha1"
  *     |- value = sha1(data)
  *
+ * The values are calculated beforehand by fit_jobs_run(), for all the images
+ * at once; this writes them to the FIT.
+ *
  * For signature details, please see doc/uImage.FIT/signature.txt
  *
- * @keydir	Directory containing *.key and *.crt files (or NULL)
+ * @jobs:	List of jobs, where the calculations have been done
  * @keydest	FDT Blob to write public keys into (NULL if none)
- * @fit:	Pointer to the FIT format image header
  * @image_noffset: Requested component image node
  * @comment:	Comment to add to signature nodes
- * @require_keys: Mark all keys as 'required'
- * @engine_id:	Engine to use for signing
+ * @cmdname:	Command name used when reporting errors
+ * @algo_name:	Algorithm name, or NULL if to be read from FIT
  * @return: 0 on success, <0 on failure
  */
-int fit_image_add_verification_data(const char *keydir, const char *keyfile,
-		void *keydest, void *fit, int image_noffset,
-		const char *comment, int require_keys, const char *engine_id,
-		const char *cmdname, const char* algo_name)
+static int fit_image_add_verification_data(struct fit_jobs *jobs,
+		void *keydest, int image_noffset, const char *comment,
+		const char *cmdname, const char *algo_name)
 {
+	void *fit = jobs->fit;
 	const char *image_name;
-	const void *data;
-	size_t size;
 	int noffset;
 
-	/* Get image data and data length */
-	if (fit_image_get_emb_data(fit, image_noffset, &data, &size)) {
-		fprintf(stderr, "Can't get image data/size\n");
-		return -1;
-	}
-
 	image_name = fit_get_name(fit, image_noffset, NULL);
 
 	/* Process all hash subnodes of the component image node */
-	for (noffset = fdt_first_subnode(fit, image_noffset);
-	     noffset >= 0;
-	     noffset = fdt_next_subnode(fit, noffset)) {
-		const char *node_name;
-		int ret = 0;
+	fdt_for_each_subnode(noffset, fit, image_noffset) {
+		enum fit_job_type type = fit_image_node_job(jobs, noffset);
+		struct fit_job *job;
+		int ret;
 
-		/*
-		 * Check subnode name, must be equal to "hash" or "signature".
-		 * Multiple hash nodes require unique unit node
-		 * names, e.g. hash-1, hash-2, signature-1, etc.
-		 */
-		node_name = fit_get_name(fit, noffset, NULL);
-		if (!strncmp(node_name, FIT_HASH_NODENAME,
-			     strlen(FIT_HASH_NODENAME))) {
+		if (type == FIT_JOB_NONE)
+			continue;
+		job = &jobs->job[jobs->pos++];
+		if (type == FIT_JOB_HASH)
 			ret = fit_image_process_hash(fit, image_name, noffset,
-						data, size);
-		} else if (IMAGE_ENABLE_SIGN && (keydir || keyfile) &&
-			   !strncmp(node_name, FIT_SIG_NODENAME,
-				strlen(FIT_SIG_NODENAME))) {
-			ret = fit_image_process_sig(keydir, keyfile, keydest,
-				fit, image_name, noffset, data, size,
-				comment, require_keys, engine_id, cmdname,
-				algo_name);
-		}
+						     job);
+		else
+			ret = fit_image_process_sig(keydest, fit, image_name,
+						    noffset, job, comment,
+						    cmdname, algo_name);
 		if (ret < 0)
 			return ret;
 	}
@@ -1293,13 +1614,81 @@ int fit_pre_load_data(const char *keydir, void *keydest, void *fit)
 }
 #endif
 
+static void *fit_jobs_thread(void *arg)
+{
+	struct fit_jobs *jobs = arg;
+
+	while (1) {
+		struct fit_job *job = NULL;
+
+		pthread_mutex_lock(&jobs->lock);
+		if (jobs->next < jobs->count)
+			job = &jobs->job[jobs->next++];
+		pthread_mutex_unlock(&jobs->lock);
+		if (!job)
+			break;
+
+		switch (job->type) {
+		case FIT_JOB_HASH:
+			job->ret = fit_image_calc_hash(jobs->fit, job);
+			break;
+		case FIT_JOB_SIG:
+			job->ret = fit_image_calc_sig(jobs, job);
+			break;
+		case FIT_JOB_CIPHER:
+			job->ret = fit_image_calc_cipher(jobs, job);
+			break;
+		case FIT_JOB_NONE:
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * fit_jobs_run() - Do the calculations for all jobs
+ *
+ * OpenSSL engines are not necessarily thread-safe, so only one thread is used
+ * if an engine is selected.
+ *
+ * @jobs:	list of jobs
+ * @threads:	maximum number of threads to use
+ */
+static void fit_jobs_run(struct fit_jobs *jobs, int threads)
+{
+	pthread_t *tids = NULL;
+	int i, started = 0;
+
+	if (jobs->engine_id)
+		threads = 1;
+	if (threads > jobs->count)
+		threads = jobs->count;
+	if (threads > 1)
+		tids = calloc(threads - 1, sizeof(*tids));
+
+	/* this thread does its share too, or all of it if threads fail */
+	pthread_mutex_init(&jobs->lock, NULL);
+	for (i = 0; tids && i < threads - 1; i++) {
+		if (pthread_create(&tids[i], NULL, fit_jobs_thread, jobs))
+			break;
+		started++;
+	}
+	fit_jobs_thread(jobs);
+	for (i = 0; i < started; i++)
+		pthread_join(tids[i], NULL);
+	pthread_mutex_destroy(&jobs->lock);
+	free(tids);
+}
+
 int fit_cipher_data(const char *keydir, void *keydest, void *fit,
 		    const char *comment, int require_keys,
-		    const char *engine_id, const char *cmdname)
+		    const char *engine_id, const char *cmdname, int threads)
 {
+	struct fit_jobs jobs;
 	int images_noffset;
 	int noffset;
-	int ret;
+	int ret = 0;
 
 	/* Find images parent node offset */
 	images_noffset = fdt_path_offset(fit, FIT_IMAGES_PATH);
@@ -1309,6 +1698,15 @@ int fit_cipher_data(const char *keydir, void *keydest, void *fit,
 		return images_noffset;
 	}
 
+	/* Encrypt all the images first, then write the results in order */
+	fit_jobs_init(&jobs, fit, keydir, NULL, require_keys, engine_id, NULL);
+	fdt_for_each_subnode(noffset, fit, images_noffset) {
+		ret = fit_image_add_cipher_job(&jobs, noffset);
+		if (ret)
+			goto out;
+	}
+	fit_jobs_run(&jobs, threads);
+
 	/* Process its subnodes, print out component images details */
 	for (noffset = fdt_first_subnode(fit, images_noffset);
 	     noffset >= 0;
@@ -1317,23 +1715,24 @@ int fit_cipher_data(const char *keydir, void *keydest, void *fit,
 		 * Direct child node of the images parent node,
 		 * i.e. component image node.
 		 */
-		ret = fit_image_cipher_data(keydir, keydest,
-					    fit, noffset, comment,
-					    require_keys, engine_id,
-					    cmdname);
+		ret = fit_image_cipher_data(&jobs, keydest, noffset);
 		if (ret)
-			return ret;
+			goto out;
 	}
 
-	return 0;
+out:
+	fit_jobs_uninit(&jobs);
+
+	return ret;
 }
 
 int fit_add_verification_data(const char *keydir, const char *keyfile,
 			      void *keydest, void *fit, const char *comment,
 			      int require_keys, const char *engine_id,
 			      const char *cmdname, const char *algo_name,
-			      struct image_summary *summary)
+			      int threads, struct image_summary *summary)
 {
+	struct fit_jobs jobs;
 	int images_noffset, confs_noffset;
 	int noffset;
 	int ret;
@@ -1346,6 +1745,21 @@ int fit_add_verification_data(const char *keydir, const char *keyfile,
 		return images_noffset;
 	}
 
+	/* Hash and sign all the images first, then write the results */
+	fit_jobs_init(&jobs, fit, keydir, keyfile, require_keys, engine_id,
+		      algo_name);
+	fdt_for_each_subnode(noffset, fit, images_noffset) {
+		ret = fit_image_add_verification_jobs(&jobs, noffset);
+		if (ret) {
+			fprintf(stderr, "Can't add verification data for node '%s' (%s)\n",
+				fdt_get_name(fit, noffset, NULL),
+				strerror(-ret));
+			fit_jobs_uninit(&jobs);
+			return ret;
+		}
+	}
+	fit_jobs_run(&jobs, threads);
+
 	/* Process its subnodes, print out component images details */
 	for (noffset = fdt_first_subnode(fit, images_noffset);
 	     noffset >= 0;
@@ -1354,16 +1768,18 @@ int fit_add_verification_data(const char *keydir, const char *keyfile,
 		 * Direct child node of the images parent node,
 		 * i.e. component image node.
 		 */
-		ret = fit_image_add_verification_data(keydir, keyfile, keydest,
-				fit, noffset, comment, require_keys, engine_id,
-				cmdname, algo_name);
+		ret = fit_image_add_verification_data(&jobs, keydest, noffset,
+						      comment, cmdname,
+						      algo_name);
 		if (ret) {
 			fprintf(stderr, "Can't add verification data for node '%s' (%s)\n",
 				fdt_get_name(fit, noffset, NULL),
 				strerror(-ret));
+			fit_jobs_uninit(&jobs);
 			return ret;
 		}
 	}
+	fit_jobs_uninit(&jobs);
 
 	/* If there are no keys, we can't sign configurations */
 	if (!IMAGE_ENABLE_SIGN || !(keydir || keyfile))
@@ -109,6 +109,7 @@ struct imgtool {
 	unsigned int external_offset;	/* Add padding to external data */
 	int bl_len;		/* Block length in byte for external data */
 	const char *engine_id;	/* Engine to use for signing */
+	int jobs;		/* Number of threads for hashing/signing */
 	bool reset_timestamp;	/* Reset the timestamp on an existing image */
 	struct image_summary summary;	/* results of signing process */
 	bool load_only;		/* true to create a load-only FIT */
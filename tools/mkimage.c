@@ -97,7 +97,7 @@ static int usage(const struct imgtool *itl, const char *msg)
 		"          -v ==> verbose\n",
 		itl->cmdname);
 	fprintf(stderr,
-		"       %s [-D dtc_options] [-f fit-image.its|-f auto|-f auto-conf|-F] [-b <dtb> [-b <dtb>]] [-E] [-B size] [-i <ramdisk.cpio.gz>] fit-image\n"
+		"       %s [-D dtc_options] [-f fit-image.its|-f auto|-f auto-conf|-F] [-b <dtb> [-b <dtb>]] [-E] [-B size] [-i <ramdisk.cpio.gz>] [-j jobs] fit-image\n"
 		"           <dtb> file is used with -f auto, it may occur multiple times.\n",
 		itl->cmdname);
 	fprintf(stderr,
@@ -107,7 +107,8 @@ static int usage(const struct imgtool *itl, const char *msg)
 		"          -E => place data outside of the FIT structure\n"
 		"          -B => align size in hex for FIT structure and header\n"
 		"          -b => append the device tree binary to the FIT\n"
-		"          -t => update the timestamp in the FIT\n");
+		"          -t => update the timestamp in the FIT\n"
+		"          -j => number of threads for hashing/signing (0 = one per CPU)\n");
 #if CONFIG_IS_ENABLED(FIT_SIGNATURE)
 	fprintf(stderr,
 		"Signing / verified boot options: [-k keydir] [-K dtb] [ -c <comment>] [-p addr] [-r] [-N engine]\n"
@@ -153,7 +154,7 @@ static int add_content(struct imgtool *itl, int type, const char *fname)
 }
 
 static const char optstring[] =
-	"a:A:b:B:c:C:d:D:e:Ef:Fg:G:i:k:K:ln:N:o:O:p:qrR:stT:vVx";
+	"a:A:b:B:c:C:d:D:e:Ef:Fg:G:i:j:k:K:ln:N:o:O:p:qrR:stT:vVx";
 
 enum {
 	OPT_LOAD_ONLY	= 1,
@@ -176,6 +177,7 @@ static const struct option longopts[] = {
 	{ "key-file", required_argument, NULL, 'G' },
 	{ "help", no_argument, NULL, 'h' },
 	{ "initramfs", required_argument, NULL, 'i' },
+	{ "jobs", required_argument, NULL, 'j' },
 	{ "key-dir", required_argument, NULL, 'k' },
 	{ "key-dest", required_argument, NULL, 'K' },
 	{ "list", no_argument, NULL, 'l' },
@@ -293,6 +295,16 @@ static int process_args(struct imgtool *itl, int argc, char **argv)
 		case 'i':
 			itl->fit_ramdisk = optarg;
 			break;
+		case 'j':
+			itl->jobs = strtol(optarg, &ptr, 10);
+			if (*ptr || itl->jobs < 0) {
+				fprintf(stderr, "%s: invalid job count %s\n",
+					itl->cmdname, optarg);
+				return EXIT_FAILURE;
+			}
+			if (!itl->jobs)
+				itl->jobs = sysconf(_SC_NPROCESSORS_ONLN);
+			break;
 		case 'k':
 			itl->keydir = optarg;
 			break;
@@ -1018,6 +1030,7 @@ int main(int argc, char **argv)
 		.dtc = MKIMAGE_DEFAULT_DTC_OPTIONS,
 		.imagename = "",
 		.imagename2 = "",
+		.jobs = 1,
 	};
 	int ret;
 
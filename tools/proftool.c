@@ -70,6 +70,8 @@ enum {
  * @OUT_FMT_FLAMEGRAPH_CALLS: Write a file suitable for flamegraph.pl
  * @OUT_FMT_FLAMEGRAPH_TIMING: Write a file suitable for flamegraph.pl with the
  * counts set to the number of microseconds used by each function
+ * @OUT_FMT_FLAMEGRAPH_SAMPLES: Write a file suitable for flamegraph.pl with the
+ * counts set to the number of statistical samples seen in each call stack
  */
 enum out_format_t {
 	OUT_FMT_DEFAULT,
@@ -77,6 +79,7 @@ enum out_format_t {
 	OUT_FMT_FUNCGRAPH,
 	OUT_FMT_FLAMEGRAPH_CALLS,
 	OUT_FMT_FLAMEGRAPH_TIMING,
+	OUT_FMT_FLAMEGRAPH_SAMPLES,
 };
 
 /* Section types for v7 format (trace-cmd format) */
@@ -254,6 +257,9 @@ struct func_info *func_list;
 int func_count;			/* number of functions */
 struct trace_call *call_list;	/* list of all calls in the input trace file */
 int call_count;			/* number of calls */
+struct trace_sample *sample_list;	/* list of all samples in the trace file */
+int sample_count;		/* number of samples */
+ulong sample_period;		/* microseconds between samples */
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 ulong text_offset;		/* text address of first function */
 ulong text_base;		/* CONFIG_TEXT_BASE from trace file */
@@ -292,7 +298,8 @@ static void usage(void)
 		"   -f <subtype>\tSpecify output subtype\n"
 		"   -m <map>\tSpecify System.map file\n"
 		"   -o <fname>\tSpecify output file\n"
-		"   -t <fname>\tSpecify trace data file (from U-Boot 'trace calls')\n"
+		"   -t <fname>\tSpecify trace data file (from U-Boot 'trace calls' or\n"
+		"\t\t'trace samples')\n"
 		"   -v <0-4>\tSpecify verbosity\n"
 		"\n"
 		"Subtypes for dump-ftrace:\n"
@@ -301,7 +308,8 @@ static void usage(void)
 		"\n"
 		"Subtypes for dump-flamegraph\n"
 		"   calls - create a flamegraph of stack frames\n"
-		"   timing - create a flamegraph of microseconds for each stack frame\n");
+		"   timing - create a flamegraph of microseconds for each stack frame\n"
+		"   samples - create a flamegraph from statistical samples\n");
 	exit(EXIT_FAILURE);
 }
 
@@ -483,6 +491,40 @@ static int read_calls(FILE *fin, size_t count)
 	return 0;
 }
 
+/**
+ * read_samples() - Read the list of statistical samples from the trace data
+ *
+ * The samples are stored consecutively in the trace output produced by U-Boot
+ *
+ * @fin: File to read from
+ * @count: Number of samples to read
+ * Returns: 0 if OK, -1 on error
+ */
+static int read_samples(FILE *fin, size_t count)
+{
+	struct trace_sample *sample;
+	int i;
+
+	notice("sample count: %zu\n", count);
+	sample_list = calloc(count, sizeof(*sample));
+	if (!sample_list) {
+		error("Cannot allocate sample_list\n");
+		return -1;
+	}
+	sample_count = count;
+
+	sample = sample_list;
+	for (i = 0; i < count; i++, sample++) {
+		if (read_data(fin, sample, sizeof(*sample)))
+			return -1;
+		if (sample->depth > TRACE_SAMPLE_DEPTH) {
+			error("Invalid sample depth %u\n", sample->depth);
+			return -1;
+		}
+	}
+	return 0;
+}
+
 /**
  * read_trace() - Read the U-Boot trace file
  *
@@ -515,6 +557,12 @@ static int read_trace(FILE *fin)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_SAMPLES:
+			sample_period = hdr.spare;
+			if (read_samples(fin, hdr.rec_count))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -1638,6 +1686,38 @@ static struct flame_node *create_node(const char *msg)
 	return node;
 }
 
+/**
+ * find_child() - Find or create the child node for a function
+ *
+ * @state: Current flamegraph state
+ * @node: Parent node
+ * @func: Function to look for
+ * Returns: Child node, or NULL if out of memory
+ */
+static struct flame_node *find_child(struct flame_state *state,
+				     struct flame_node *node,
+				     struct func_info *func)
+{
+	struct flame_node *child;
+
+	/* see if we have this as a child node already */
+	list_for_each_entry(child, &node->child_head, sibling_node) {
+		if (child->func == func)
+			return child;
+	}
+
+	/* create a new node */
+	child = create_node("child");
+	if (!child)
+		return NULL;
+	list_add_tail(&child->sibling_node, &node->child_head);
+	child->func = func;
+	child->parent = node;
+	state->nodes++;
+
+	return child;
+}
+
 /**
  * process_call(): Add a call to the flamegraph info
  *
@@ -1661,26 +1741,11 @@ static int process_call(struct flame_state *state, bool entry, ulong timestamp,
 	int stack_ptr = state->stack_ptr;
 
 	if (entry) {
-		struct flame_node *child, *chd;
-
-		/* see if we have this as a child node already */
-		child = NULL;
-		list_for_each_entry(chd, &node->child_head, sibling_node) {
-			if (chd->func == func) {
-				child = chd;
-				break;
-			}
-		}
-		if (!child) {
-			/* create a new node */
-			child = create_node("child");
-			if (!child)
-				return -1;
-			list_add_tail(&child->sibling_node, &node->child_head);
-			child->func = func;
-			child->parent = node;
-			state->nodes++;
-		}
+		struct flame_node *child;
+
+		child = find_child(state, node, func);
+		if (!child)
+			return -1;
 		debug("entry %s: move from %s to %s\n", func->name,
 		      node->func ? node->func->name : "(root)",
 		      child->func->name);
@@ -1777,6 +1842,56 @@ static int make_flame_tree(enum out_format_t out_format,
 	return 0;
 }
 
+/**
+ * make_sample_tree() - Create a tree of stack traces from samples
+ *
+ * Each sample gives a call stack, innermost first. This is added to the tree
+ * starting with the outermost function, and the count of the innermost node is
+ * incremented. Functions which cannot be found are skipped.
+ *
+ * @treep: Returns the resulting flamegraph tree
+ * Returns: 0 on success, -ve on error
+ */
+static int make_sample_tree(struct flame_node **treep)
+{
+	struct flame_state state;
+	struct trace_sample *sample;
+	struct flame_node *tree;
+	int i, j;
+
+	tree = create_node("tree");
+	if (!tree)
+		return -1;
+	state.nodes = 0;
+
+	for (i = 0, sample = sample_list; i < sample_count; i++, sample++) {
+		struct flame_node *node = tree;
+
+		for (j = sample->depth - 1; j >= 0; j--) {
+			struct func_info *func;
+
+			func = find_caller_by_offset(sample->pc[j]);
+			if (!func) {
+				warn("Cannot find function at %lx\n",
+				     text_offset + sample->pc[j]);
+				continue;
+			}
+			node = find_child(&state, node, func);
+			if (!node)
+				return -1;
+		}
+		if (node != tree) {
+			node->count++;
+			node->duration += sample_period;
+		}
+	}
+	fprintf(stderr, "%d nodes from %d samples\n", state.nodes,
+		sample_count);
+	*treep = tree;
+
+	return 0;
+}
+
 /**
  * output_tree() - Output a flamegraph tree
  *
@@ -1813,7 +1928,8 @@ static int output_tree(FILE *fout, enum out_format_t out_format,
 	char *str = abuf_data(str_buf);
 
 	if (node->count) {
-		if (out_format == OUT_FMT_FLAMEGRAPH_CALLS) {
+		if (out_format == OUT_FMT_FLAMEGRAPH_CALLS ||
+		    out_format == OUT_FMT_FLAMEGRAPH_SAMPLES) {
 			fprintf(fout, "%s %d\n", str, node->count);
 		} else {
 			/*
@@ -1878,8 +1994,16 @@ static int make_flamegraph(FILE *fout, enum out_format_t out_format)
 	char *str;
 	int ret = 0;
 
-	if (make_flame_tree(out_format, &tree))
+	if (out_format == OUT_FMT_FLAMEGRAPH_SAMPLES) {
+		if (!sample_count) {
+			error("No samples found in trace file\n");
+			return -1;
+		}
+		if (make_sample_tree(&tree))
+			return -1;
+	} else if (make_flame_tree(out_format, &tree)) {
 		return -1;
+	}
 
 	abuf_init(&str_buf);
 	if (!abuf_realloc(&str_buf, 500))
@@ -1941,7 +2065,8 @@ static int prof_tool(int argc, char *const argv[],
 			FILE *fout;
 
 			if (out_format != OUT_FMT_FLAMEGRAPH_CALLS &&
-			    out_format != OUT_FMT_FLAMEGRAPH_TIMING)
+			    out_format != OUT_FMT_FLAMEGRAPH_TIMING &&
+			    out_format != OUT_FMT_FLAMEGRAPH_SAMPLES)
 				out_format = OUT_FMT_FLAMEGRAPH_CALLS;
 			fout = fopen(out_fname, "w");
 			if (!fout) {
@@ -1983,9 +2108,11 @@ int main(int argc, char *argv[])
 				out_format = OUT_FMT_FLAMEGRAPH_CALLS;
 			} else if (!strcmp("timing", optarg)) {
 				out_format = OUT_FMT_FLAMEGRAPH_TIMING;
+			} else if (!strcmp("samples", optarg)) {
+				out_format = OUT_FMT_FLAMEGRAPH_SAMPLES;
 			} else {
 				fprintf(stderr,
-					"Invalid format: use function, funcgraph, calls, timing\n");
+					"Invalid format: use function, funcgraph, calls, timing, samples\n");
 				exit(1);
 			}
 			break;